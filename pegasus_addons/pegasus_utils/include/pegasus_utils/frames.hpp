@@ -30,7 +30,7 @@ namespace Frames {
  * 			the inertial frame
  */
 template <typename T>
-static const Eigen::Quaternion<T> ENU_NED_INERTIAL_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(M_PI, 0.0, M_PI_2));
+static const Eigen::Quaternion<T> ENU_NED_INERTIAL_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(T(M_PI), T(0), T(M_PI_2)));
 
 /**
  * @brief Static quaternion to convert a rotation expressed in ENU body frame (ROS base_link) to
@@ -41,7 +41,7 @@ static const Eigen::Quaternion<T> ENU_NED_INERTIAL_Q = Pegasus::Rotations::euler
  * 			the body frame
 */
 template <typename T>
-static const Eigen::Quaternion<T> ENU_NED_BODY_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(M_PI, 0.0, 0.0));
+static const Eigen::Quaternion<T> ENU_NED_BODY_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(T(M_PI), T(0), T(0)));
 
 /**
  * @brief Static quaternion needed for rotating vectors in body frames between ENU and NED
@@ -49,7 +49,7 @@ static const Eigen::Quaternion<T> ENU_NED_BODY_Q = Pegasus::Rotations::euler_to_
  * Fto Forward, Left, Up (body frame in ENU).
  */
 template <typename T>
-static const Eigen::Quaternion<T> BODY_ENU_NED_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(M_PI, 0.0, 0.0));
+static const Eigen::Quaternion<T> BODY_ENU_NED_Q = Pegasus::Rotations::euler_to_quaternion(Eigen::Matrix<T, 3, 1>(T(M_PI), T(0), T(0)));
 
 /**
  * @brief Static affine matrix to roate vectors ENU (or NED) -> NED (or ENU) expressed in body frame
@@ -90,10 +90,10 @@ inline T yaw_from_quaternion(const Eigen::Quaternion<T> &q) {
 template <typename T>
 inline T wrapTo2pi(T angle) {
 
-    double wrapped_angle = std::fmod(angle, 2 * M_PI);
+    T wrapped_angle = std::fmod(angle, T(2 * M_PI));
 
     if(wrapped_angle < 0) 
-        wrapped_angle += 2 * M_PI;
+        wrapped_angle += T(2 * M_PI);
     return wrapped_angle;
 }
 
@@ -106,12 +106,12 @@ inline T wrapTo2pi(T angle) {
 template <typename T>
 inline T wrapTopi(T angle) {
 
-    double wrapped_angle = std::fmod(angle + M_PI, 2 * M_PI);
+    T wrapped_angle = std::fmod(angle + T(M_PI), T(2 * M_PI));
 
     if (wrapped_angle < 0)
-        wrapped_angle += 2 * M_PI;
+        wrapped_angle += T(2 * M_PI);
 
-    return wrapped_angle - M_PI;
+    return wrapped_angle - T(M_PI);
 }
 
 /**
@@ -122,7 +122,7 @@ inline T wrapTopi(T angle) {
  */
 template <typename T>
 inline T rad_to_deg(T angle) {
-    return angle * 180 / M_PI;
+    return angle * T(180) / T(M_PI);
 }
 
 /**
@@ -133,7 +133,7 @@ inline T rad_to_deg(T angle) {
  */
 template <typename T>
 inline T deg_to_rad(T angle) {
-    return angle * M_PI / 180;
+    return angle * T(M_PI) / T(180);
 }
 
 /**
@@ -145,9 +145,9 @@ inline T deg_to_rad(T angle) {
  */
 template <typename T>
 inline T angleDiff(T a, T b) {
-    double aux = std::fmod(a - b + M_PI, 2 * M_PI);
-    if (aux < 0) aux += (2 * M_PI);
-    aux = aux - M_PI;
+    T aux = std::fmod(a - b + T(M_PI), T(2 * M_PI));
+    if (aux < 0) aux += T(2 * M_PI);
+    aux = aux - T(M_PI);
     return aux;
 }
 
@@ -159,7 +159,7 @@ inline T angleDiff(T a, T b) {
  */ 
 template <typename T> 
 inline Eigen::Matrix<T, 3, 3> proj(const Eigen::Matrix<T, 3, 1> &v) {
-        return Eigen::Matrix3d::Identity() - v * v.transpose();
+        return Eigen::Matrix<T, 3, 3>::Identity() - v * v.transpose();
 }
 
 /** 
@@ -206,8 +206,8 @@ inline Eigen::Matrix<T, 3, 3> skew3(const Eigen::Matrix<T, 3, 1> &v) {
 }
 
 template <typename T>
-inline Eigen::Matrix<T, 3, 3> rodrigues(const double psi, const Eigen::Matrix<T, 3, 1> &v) {
-    return Eigen::Matrix3d::Identity() + sin(psi) * skew3(v) + (1 - cos(psi)) * skew3(v) * skew3(v);
+inline Eigen::Matrix<T, 3, 3> rodrigues(const T psi, const Eigen::Matrix<T, 3, 1> &v) {
+    return Eigen::Matrix<T, 3, 3>::Identity() + std::sin(psi) * skew3(v) + (T(1) - std::cos(psi)) * skew3(v) * skew3(v);
 }
 
 /**
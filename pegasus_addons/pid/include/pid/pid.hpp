@@ -47,14 +47,23 @@
  ****************************************************************************/
 #pragma once
 
+#include <cmath>
+#include <string>
 #include <memory>
 #include <limits>
+#include <stdexcept>
+#include <Eigen/Core>
 
 namespace Pegasus {
 
 /**
- * @brief Class that implement the generic, boring, old school but good enough PID controller
+ * @brief Class that implement the generic, boring, old school but good enough PID controller, for N independent axis
+ * at once (for example, the x, y and z position of a vehicle). All the axis are updated in a single pass over
+ * fixed-size Eigen arrays, such that no heap memory is used and the compiler can vectorize the computations
+ * @tparam N The number of axis controlled
+ * @tparam Scalar The floating point type used in the computations
  */
+template <int N, typename Scalar = double>
 class Pid {
 
 public:
@@ -74,41 +83,84 @@ public:
      */
     using WeakPtr = std::weak_ptr<Pid>;
 
+    /**
+     * @brief An alias for the array that holds one value per axis
+     */
+    using Vector = Eigen::Array<Scalar, N, 1>;
+
+    /**
+     * @brief The mechanism used to prevent the integral term from winding up while the output is saturated
+     */
+    enum class AntiWindup {
+        NONE,               /**< @brief The integral keeps accumulating the error while the output is saturated */
+        CLAMPING,           /**< @brief The integral stops accumulating the error that pushes the output further into saturation */
+        BACK_CALCULATION    /**< @brief The integral is discharged proportionally to the amount by which the output is saturated */
+    };
+
+    /**
+     * @brief Converts the name of an anti-windup mechanism ("none", "clamping" or "back_calculation") to the enum value.
+     * Throws a runtime exception if the name is not valid
+     * @param name The name of the anti-windup mechanism
+     * @return AntiWindup The anti-windup mechanism
+     */
+    static AntiWindup anti_windup_from_string(const std::string & name) {
+        if (name == "none") return AntiWindup::NONE;
+        if (name == "clamping") return AntiWindup::CLAMPING;
+        if (name == "back_calculation") return AntiWindup::BACK_CALCULATION;
+        throw std::runtime_error("Unknown PID anti-windup mechanism: " + name);
+    }
+
+    struct Gains {
+        Vector kp{Vector::Zero()};              /**< @brief The proportional gain */
+        Vector kd{Vector::Zero()};              /**< @brief The derivative gain */
+        Vector ki{Vector::Zero()};              /**< @brief The integral gain */
+        Vector kff{Vector::Zero()};             /**< @brief The feed-forward gain */
+        Vector min_output{Vector::Constant(-std::numeric_limits<Scalar>::infinity())};  /**< @brief The minimum output allowed */
+        Vector max_output{Vector::Constant(std::numeric_limits<Scalar>::infinity())};   /**< @brief The maximum output allowed */
+
+        AntiWindup anti_windup{AntiWindup::CLAMPING};   /**< @brief The anti-windup mechanism */
+        Vector kb{Vector::Ones()};                      /**< @brief The back-calculation gain (only used with AntiWindup::BACK_CALCULATION) */
+
+        /**
+         * @brief The cutoff frequency (in Hz) of the first order low-pass filter applied to the derivative of the error.
+         * A value of zero disables the filter
+         */
+        Scalar derivative_cutoff{0};
+    };
 
     struct Statistics {
 
         /* The last time step in seconds taken between the current and last iteration */
-        double dt{0.0};
+        Scalar dt{0};
 
         /* Errors and references not affected by the gains */
-        double error_p{0.0};        /**< @brief The proportional error fed into the p_term */
-        double error_d{0.0};        /**< @brief The derivative error fed into the d_term */
-        double integral{0.0};       /**< @brief The integral value fed into the i_term */
-        double ff_ref{0.0};         /**< @brief The fead-forward value fed into the ff_term */
-        
+        Vector error_p{Vector::Zero()};     /**< @brief The proportional error fed into the p_term */
+        Vector error_d{Vector::Zero()};     /**< @brief The derivative error fed into the d_term (after being filtered) */
+        Vector integral{Vector::Zero()};    /**< @brief The integral value fed into the i_term */
+        Vector ff_ref{Vector::Zero()};      /**< @brief The fead-forward value fed into the ff_term */
+
         /* PID terms already afftected by the gains */
-        double p_term{0.0};         /**< @brief The scaled proportional error (kp * error_p) */
-        double d_term{0.0};         /**< @brief The scaled derivative error (kd * error_d) */
-        double i_term{0.0};         /**< @brief The scaled integral value (i_term <=> iterm += ki * (error_p - prev_error_p)) */
-        double ff_term{0.0};        /**< @brief The scaled feed-forward value (kff * ff_ref) */
-        
+        Vector p_term{Vector::Zero()};      /**< @brief The scaled proportional error (kp * error_p) */
+        Vector d_term{Vector::Zero()};      /**< @brief The scaled derivative error (kd * error_d) */
+        Vector i_term{Vector::Zero()};      /**< @brief The scaled integral value (i_term <=> iterm += ki * error_p * dt) */
+        Vector ff_term{Vector::Zero()};     /**< @brief The scaled feed-forward value (kff * ff_ref) */
+
         /* Outputs of the control loop */
-        double anti_windup_discharge{0.0}; /**< @brief The amount that was discharged from the integral via the anti-windup mechanism */
-        double output_pre_sat{0.0};        /**< @brief The output of the PID before being saturated */
-        double output{0.0};                /**< @brief The actual output of the PID */    
+        Vector anti_windup_discharge{Vector::Zero()};   /**< @brief The amount that was discharged from the integral via the anti-windup mechanism */
+        Vector output_pre_sat{Vector::Zero()};          /**< @brief The output of the PID before being saturated */
+        Vector output{Vector::Zero()};                  /**< @brief The actual output of the PID */
     };
 
+    /**
+     * @brief Construct a new Pid controller object with all the gains set to zero
+     */
+    Pid() = default;
+
     /**
      * @brief Construct a new Pid controller object
-     * @param kp The proportional gain
-     * @param kd The derivative gain
-     * @param ki The integral gain
-     * @param kff The feed-forward gain
-     * @param min_out the minimum output reference allowed
-     * @param max_out the maximum output reference allowed
+     * @param gains The gains, saturations, anti-windup and filtering configurations of the controller
      */
-    Pid(double kp, double kd, double ki, double kff, double min_out, double max_out) : 
-        kp_(kp), kd_(kd), ki_(ki), kff_(kff), min_output_(min_out), max_output_(max_out) {}
+    explicit Pid(const Gains & gains) : gains_(gains) {}
 
     /**
      * @brief Destroy the Pid controller object
@@ -118,14 +170,21 @@ public:
     /**
      * @brief Method to update the output of the PID controller. Note, when this method is invoked,
      * the derivative part of the control is computed numerically based on the previous value of the error.
-     * No filtering is applied, so be aware of possible shuttering effect.
+     * Use the derivative low-pass filter to attenuate the shuttering effect of the numerical differentiation.
      * 
      * @param error_p The error between the reference value and the actual value
      * @param feed_forward_ref The reference used to multiply by the feed-forward term
      * @param dt The time delay between the previous function call and the next function call (in seconds)
-     * @return double the output of the PID controller
+     * @return Vector the output of the PID controller
      */
-    double compute_output(double error_p, double feed_forward_ref, double dt);
+    Vector compute_output(const Vector & error_p, const Vector & feed_forward_ref, Scalar dt) {
+
+        // Compute the derivative of the error numerically (there is no previous error in the first iteration)
+        Vector error_d = (has_prev_error_ && dt > Scalar(0)) ? Vector((error_p - prev_error_p_) / dt) : Vector::Zero();
+
+        // Invoke the PID control
+        return compute_output(error_p, error_d, feed_forward_ref, dt);
+    }
 
     /**
      * @brief Method to update the output of the PID controller
@@ -133,91 +192,174 @@ public:
      * @param error_d The derivative of the error. I.e. pref_dot - p_dot.
      * @param feed_forward_ref The reference used to multiply by the feed-forward term
      * @param dt The time delay between the previous function call and the next function call (in seconds)
-     * @return double the output of the PID controller
+     * @return Vector the output of the PID controller
      */
-    double compute_output(double error_p, double error_d, double feed_forward_ref, double dt);
+    Vector compute_output(const Vector & error_p, const Vector & error_d, const Vector & feed_forward_ref, Scalar dt) {
+
+        // Filter the derivative of the error with a first order low-pass filter (if enabled)
+        if (gains_.derivative_cutoff > Scalar(0) && has_prev_error_ && dt > Scalar(0)) {
+            const Scalar tau = Scalar(1) / (Scalar(2 * M_PI) * gains_.derivative_cutoff);
+            const Scalar alpha = dt / (tau + dt);
+            error_d_ += alpha * (error_d - error_d_);
+        } else {
+            error_d_ = error_d;
+        }
+
+        // Compute the candidate integral term (using euler integration)
+        const Vector integral = error_i_ + gains_.ki * error_p * dt;
+
+        // Compute the PID terms
+        const Vector p_term = gains_.kp * error_p;
+        const Vector d_term = gains_.kd * error_d_;
+        const Vector ff_term = gains_.kff * feed_forward_ref;
+
+        // Compute the output and saturate it
+        const Vector output = p_term + d_term + integral + ff_term;
+        const Vector saturated_output = output.max(gains_.min_output).min(gains_.max_output);
+
+        // Update the integral term, discharging it if the output is being saturated
+        Vector discharge = Vector::Zero();
+
+        switch (gains_.anti_windup) {
+            case AntiWindup::NONE:
+                break;
+            case AntiWindup::CLAMPING:
+                // Do not integrate the error in the axis where it pushes the output further into saturation
+                discharge = ((output > gains_.max_output && integral > error_i_) || (output < gains_.min_output && integral < error_i_)).select(integral - error_i_, Vector::Zero());
+                break;
+            case AntiWindup::BACK_CALCULATION: {
+                // Feed back the excess of output to the integral, such that it does not keep growing while saturated.
+                // The integral is only discharged (towards zero), otherwise it would be charged in the opposite direction
+                // whenever the other terms alone saturate the output
+                const Vector excess = gains_.kb * (output - saturated_output) * dt;
+                discharge = (excess * integral > Scalar(0)).select(excess.sign() * excess.abs().min(integral.abs()), Vector::Zero());
+                break;
+            }
+        }
+        error_i_ = integral - discharge;
+
+        // Update the prev error variable
+        prev_error_p_ = error_p;
+        has_prev_error_ = true;
+
+        // Update the statistics structure used for extracting the performance of the control loop
+        if (statistics_enabled_) {
+            stats_.dt = dt;
+            stats_.error_p = error_p;
+            stats_.error_d = error_d_;
+            stats_.integral = error_i_;
+            stats_.ff_ref = feed_forward_ref;
+            stats_.p_term = p_term;
+            stats_.d_term = d_term;
+            stats_.i_term = integral;
+            stats_.ff_term = ff_term;
+            stats_.anti_windup_discharge = discharge;
+            stats_.output_pre_sat = output;
+            stats_.output = saturated_output;
+        }
+
+        return saturated_output;
+    }
 
     /**
      * @brief Method used to get the reference to the statistics structure object in which the 
-     * statics of the controller are saved for debugging and performance analysis purposes
+     * statics of the controller are saved for debugging and performance analysis purposes.
+     * The statistics are only updated while enabled
      * @return Statistics& A reference to the stats_ private object
      */
-    inline Statistics& get_statistics() {return stats_;}
+    inline const Statistics & get_statistics() const {return stats_;}
 
     /**
-     * @brief Method that is used to reset the pid controller variables
+     * @brief Method used to enable or disable the update of the statistics in every iteration of the controller.
+     * If disabled, the controller skips copying its internal terms to the statistics structure
+     * @param enabled Whether the statistics should be updated
      */
-    void reset_controller();
-
-private:
+    inline void set_statistics_enabled(bool enabled) {statistics_enabled_ = enabled;}
 
     /**
-     * @brief Structure that will hold the computed errors and outputs of the controller for debuging purposes
+     * @brief Method used to get the gains of the controller
+     * @return Gains& A reference to the gains of the controller
      */
-    Statistics stats_;
+    inline const Gains & get_gains() const {return gains_;}
 
     /**
-     * @defgroup gains 
-     * This section defines the controller gains
+     * @brief Method used to update the gains of the controller. The integral term is kept
+     * @param gains The new gains of the controller
      */
+    inline void set_gains(const Gains & gains) {gains_ = gains;}
 
     /**
-     * @ingroup gains
-     * @brief The proportional gain of the controller
+     * @brief Method used to update the gains of the controller without a jump in its output (bumpless transfer).
+     * The integral term absorbs the change of the proportional and derivative terms for the errors of the last iteration,
+     * such that the output with the new gains starts where the output with the previous gains stopped. Since the integral
+     * is kept already multiplied by ki, a change of ki alone never causes a jump
+     * @param gains The new gains of the controller
      */
-    double kp_;
+    void set_gains_bumpless(const Gains & gains) {
+
+        // Nothing to transfer if the controller did not run since it was reset
+        if (has_prev_error_) {
+            error_i_ += (gains_.kp - gains.kp) * prev_error_p_ + (gains_.kd - gains.kd) * error_d_;
+            error_i_ = error_i_.max(gains.min_output).min(gains.max_output);
+        }
+        gains_ = gains;
+    }
 
     /**
-     * @ingroup gains
-     * @brief The derivative gain of the controller
+     * @brief Method that is used to reset the pid controller variables
      */
-    double kd_;
+    void reset_controller() {
+        prev_error_p_.setZero();
+        error_d_.setZero();
+        error_i_.setZero();
+        has_prev_error_ = false;
+    }
+
+private:
 
     /**
-     * @ingroup gains
-     * @brief The integral gain of the controller
+     * @brief The gains, saturations, anti-windup and filtering configurations of the controller
      */
-    double ki_;
+    Gains gains_;
 
     /**
-     * @ingroup gains
-     * @brief The feed-forward gain of the controller
+     * @brief Structure that will hold the computed errors and outputs of the controller for debuging purposes
      */
-    double kff_;
+    Statistics stats_;
 
     /**
-     * @defgroup saturations
-     * This sections defines all the saturations variables
+     * @brief Whether the statistics structure is updated in every iteration
      */
+    bool statistics_enabled_{true};
 
     /**
-     * @ingroup saturations
-     * @brief The minimum output allowed
+     * @defgroup state
+     * This section defines the internal state of the controller
      */
-    double min_output_;
 
     /**
-     * @ingroup saturations
-     * @brief The maximum output allowed
+     * @ingroup state
+     * @brief The error in the previous iteration, used to compute the derivative of the error numerically
      */
-    double max_output_;
+    Vector prev_error_p_{Vector::Zero()};
 
     /**
-     * @defgroup auxiliaryVariables
-     * This section defines all auxiliary variables used
-     * by the controller between iterations
+     * @ingroup state
+     * @brief Whether prev_error_p_ holds the error of a previous iteration (false after a reset)
      */
-    
+    bool has_prev_error_{false};
+
     /**
-     * @brief The previous value of the reference error
+     * @ingroup state
+     * @brief The (filtered) derivative of the error
      */
-    double prev_error_p_{0.0};
+    Vector error_d_{Vector::Zero()};
 
     /**
-     * @brief The acumulated value of the integral
+     * @ingroup state
+     * @brief The integral of the error, already multiplied by the integral gain
      */
-    double error_i_{0.0};
-
+    Vector error_i_{Vector::Zero()};
 };
 
-}
\ No newline at end of file
+} // namespace Pegasus
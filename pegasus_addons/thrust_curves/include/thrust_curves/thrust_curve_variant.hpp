@@ -0,0 +1,418 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <variant>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace Pegasus {
+
+/**
+ * @brief Get a parameter from the map of parameters used to configure the thrust curves, 
+ * or a default value if the parameter is not defined
+ */
+inline double parameter_or(const std::map<std::string, double> & parameters, const std::string & name, double default_value) {
+    auto it = parameters.find(name);
+    return it != parameters.end() ? it->second : default_value;
+}
+
+/**
+ * @brief Parameters of a quadratic thrust curve: force = a * (x/scale)^2 + b * (x/scale) + c, 
+ * where x is a percentage from 0-100% and the force is given in Newton (N)
+ */
+struct QuadraticParameters {
+    double a{0.0};
+    double b{0.0};
+    double c{0.0};
+    double scale{1.0};
+};
+
+/**
+ * @brief Parameters of an arctangent thrust curve: force = a * arctan(b * x + c) + d,
+ * where x is a percentage from 0-100% and the force is given in Newton (N)
+ */
+struct ArctangentParameters {
+    double a{0.0};
+    double b{0.0};
+    double c{0.0};
+    double d{0.0};
+};
+
+/**
+ * @brief Parameters of a linear-exponential thrust curve: percentage = (a * exp(b * force) * sqrt(force) + (c * force) + d) * scale
+ */
+struct LinearExponentialParameters {
+    double a{0.0};
+    double b{0.0};
+    double c{0.0};
+    double d{0.0};
+    double scale{1.0};
+};
+
+/**
+ * @brief Quadratic thrust curve, as a value type with the conversions defined inline
+ */
+class QuadraticCurve {
+
+public:
+
+    using Parameters = QuadraticParameters;
+    static constexpr std::string_view IDENTIFIER{"Quadratic"};
+
+    explicit QuadraticCurve(const Parameters & parameters) : parameters_(parameters), max_force_(percentage_to_force(100.0)) {}
+
+    static QuadraticCurve from_map(const std::map<std::string, double> & parameters) {
+        return QuadraticCurve(Parameters{parameter_or(parameters, "a", 0.0), parameter_or(parameters, "b", 0.0), parameter_or(parameters, "c", 0.0), parameter_or(parameters, "scale", 1.0)});
+    }
+
+    std::map<std::string, double> to_map() const {
+        return {{"a", parameters_.a}, {"b", parameters_.b}, {"c", parameters_.c}, {"scale", parameters_.scale}};
+    }
+
+    inline double force_to_percentage(double force) const {
+        // Make sure the desired force to apply in Newtons is not bellow zero
+        const double f = std::max(0.0, force);
+        const Parameters & p = parameters_;
+        return std::max(0.0, std::min(100.0, (-p.b + std::sqrt(p.b * p.b - (4 * p.a * (p.c - f)))) / (2 * p.a) * p.scale));
+    }
+
+    inline double percentage_to_force(double percentage) const {
+        const double x = std::min(100.0, std::max(0.0, percentage)) / parameters_.scale;
+        return (parameters_.a * (x * x)) + (parameters_.b * x) + parameters_.c;
+    }
+
+    inline double get_max_force() const { return max_force_; }
+    inline const Parameters & parameters() const { return parameters_; }
+
+private:
+
+    Parameters parameters_;
+    double max_force_;
+};
+
+/**
+ * @brief Arctangent thrust curve, as a value type with the conversions defined inline
+ */
+class ArctangentCurve {
+
+public:
+
+    using Parameters = ArctangentParameters;
+    static constexpr std::string_view IDENTIFIER{"Arctan"};
+
+    explicit ArctangentCurve(const Parameters & parameters) : parameters_(parameters), max_force_(percentage_to_force(100.0)) {}
+
+    static ArctangentCurve from_map(const std::map<std::string, double> & parameters) {
+        return ArctangentCurve(Parameters{parameter_or(parameters, "a", 0.0), parameter_or(parameters, "b", 0.0), parameter_or(parameters, "c", 0.0), parameter_or(parameters, "d", 0.0)});
+    }
+
+    std::map<std::string, double> to_map() const {
+        return {{"a", parameters_.a}, {"b", parameters_.b}, {"c", parameters_.c}, {"d", parameters_.d}};
+    }
+
+    inline double force_to_percentage(double force) const {
+        // Make sure the desired force is within the limits
+        const double f = std::min(std::max(0.0, force), max_force_);
+        const Parameters & p = parameters_;
+        const double u = (std::tan((f - p.d) / p.a) - p.c) / p.b;
+        return std::max(0.0, std::min(u, 100.0));
+    }
+
+    inline double percentage_to_force(double percentage) const {
+        const double x = std::min(100.0, std::max(0.0, percentage));
+        return (parameters_.a * std::atan(parameters_.b * x + parameters_.c)) + parameters_.d;
+    }
+
+    inline double get_max_force() const { return max_force_; }
+    inline const Parameters & parameters() const { return parameters_; }
+
+private:
+
+    Parameters parameters_;
+    double max_force_;
+};
+
+/**
+ * @brief Linear-exponential thrust curve, as a value type with the conversions defined inline. This curve is defined
+ * from force to percentage and has no closed form inverse: percentage_to_force returns 0 (as does get_max_force).
+ * Sample it into a TabulatedCurve to get the inverse
+ */
+class LinearExponentialCurve {
+
+public:
+
+    using Parameters = LinearExponentialParameters;
+    static constexpr std::string_view IDENTIFIER{"LinearExponential"};
+
+    explicit LinearExponentialCurve(const Parameters & parameters) : parameters_(parameters), max_force_(percentage_to_force(100.0)) {}
+
+    static LinearExponentialCurve from_map(const std::map<std::string, double> & parameters) {
+        return LinearExponentialCurve(Parameters{parameter_or(parameters, "a", 0.0), parameter_or(parameters, "b", 0.0), parameter_or(parameters, "c", 0.0), parameter_or(parameters, "d", 0.0), parameter_or(parameters, "scale", 1.0)});
+    }
+
+    std::map<std::string, double> to_map() const {
+        return {{"a", parameters_.a}, {"b", parameters_.b}, {"c", parameters_.c}, {"d", parameters_.d}, {"scale", parameters_.scale}};
+    }
+
+    inline double force_to_percentage(double force) const {
+        // Make sure the desired force to apply in Newtons is not bellow zero
+        const double f = std::max(0.0, force);
+        const Parameters & p = parameters_;
+        return std::min(100.0, std::max(0.0, ((p.a * std::exp(p.b * f) * std::sqrt(f)) + (p.c * f) + p.d) * p.scale));
+    }
+
+    inline double percentage_to_force(double percentage) const {
+        (void) percentage;
+        return 0.0;
+    }
+
+    inline double get_max_force() const { return max_force_; }
+    inline const Parameters & parameters() const { return parameters_; }
+
+private:
+
+    Parameters parameters_;
+    double max_force_;
+};
+
+/**
+ * @brief Thrust curve defined by a dense lookup table, sampled from another thrust curve or from the measurements
+ * of a thrust stand. The samples are made monotone (the force never decreases with the percentage), and are resampled
+ * into two tables with uniform spacing, one for each direction of the conversion. Both conversions are then made in
+ * constant time, with a linear interpolation without branches, and the inverse is available for any curve that is sampled
+ */
+class TabulatedCurve {
+
+public:
+
+    static constexpr std::string_view IDENTIFIER{"Tabulated"};
+
+    /**
+     * @brief The default number of entries of each table
+     */
+    static constexpr std::size_t DEFAULT_SIZE = 1024;
+
+    /**
+     * @brief Maximum error of the conversions of the table, with respect to the curve it was sampled from 
+     * (or to the samples, when created from measurements)
+     */
+    struct ApproximationError {
+        double force_to_percentage{0.0};    // Maximum error of force_to_percentage, in percentage (0-100%)
+        double percentage_to_force{0.0};    // Maximum error of percentage_to_force, in Newton (N)
+    };
+
+    /**
+     * @brief Create a table from samples of the curve (in any order)
+     * @param percentages The percentages (0-100%) of the samples
+     * @param forces The forces in Newton (N) of the samples
+     * @param size The number of entries of each table
+     */
+    TabulatedCurve(const std::vector<double> & percentages, const std::vector<double> & forces, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Create a table from a map where each key is a percentage (0-100%) and the value is the force in Newton (N), 
+     * for example {"0.0": 0.0, "50.0": 7.5, "100.0": 28.0}. The key "size" optionally sets the number of entries of each table
+     */
+    static TabulatedCurve from_map(const std::map<std::string, double> & parameters);
+
+    /**
+     * @brief Create a table from the measurements of a thrust stand, saved in a CSV file with two columns: the percentage 
+     * (0-100%) and the force in Newton (N). Empty lines, lines starting with '#' and a header line are ignored
+     * @param file The path to the CSV file
+     * @param size The number of entries of each table
+     */
+    static TabulatedCurve from_csv(const std::string & file, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Sample another thrust curve into a table. The curve is sampled with its conversion from force to percentage, 
+     * which is implemented by all the curves, such that the table also provides the inverse of the curve
+     * @param curve The thrust curve to sample (any type with force_to_percentage and get_max_force methods)
+     * @param size The number of entries of each table
+     */
+    template <typename Curve>
+    static TabulatedCurve from_curve(Curve && curve, std::size_t size=DEFAULT_SIZE) {
+        return sample([&curve](double force) { return curve.force_to_percentage(force); }, curve.get_max_force(), size);
+    }
+
+    /**
+     * @brief Sample a conversion from force to percentage into a table
+     * @param force_to_percentage The conversion from force to percentage of the curve
+     * @param max_force The max force of the curve. If not positive, it is searched as the force that saturates the curve
+     * @param size The number of entries of each table
+     */
+    static TabulatedCurve sample(const std::function<double(double)> & force_to_percentage, double max_force, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Get the samples the table was created from (as given to from_map), and the number of entries of each table
+     */
+    std::map<std::string, double> to_map() const;
+
+    inline double force_to_percentage(double force) const {
+        return interpolate(percentage_table_, force_scale_, force);
+    }
+
+    inline double percentage_to_force(double percentage) const {
+        return interpolate(force_table_, percentage_scale_, percentage);
+    }
+
+    inline double get_max_force() const { return max_force_; }
+    inline std::size_t size() const { return force_table_.size(); }
+    inline const ApproximationError & get_approximation_error() const { return error_; }
+
+private:
+
+    /**
+     * @brief Linear interpolation on a table with uniform spacing that starts at 0. The position in the table is 
+     * clamped to its limits with min/max, which compile to instructions without branches (a NaN maps to the first entry)
+     * @param table The table to interpolate
+     * @param scale The inverse of the spacing of the table
+     * @param x The value to look up
+     * @return double The interpolated value
+     */
+    static inline double interpolate(const std::vector<double> & table, double scale, double x) {
+        const double t = std::min(std::max(0.0, x * scale), static_cast<double>(table.size() - 1));
+        const std::size_t i = std::min(static_cast<std::size_t>(t), table.size() - 2);
+        const double alpha = t - static_cast<double>(i);
+        return table[i] + alpha * (table[i + 1] - table[i]);
+    }
+
+    // The percentages at uniformly spaced forces, from 0 to the max force
+    std::vector<double> percentage_table_;
+    double force_scale_{1.0};
+
+    // The forces at uniformly spaced percentages, from 0 to 100%
+    std::vector<double> force_table_;
+    double percentage_scale_{1.0};
+
+    // The max force that the vehicle can output in Newton (N)
+    double max_force_{0.0};
+
+    // The samples the table was created from (empty when sampled from another curve)
+    std::vector<double> sample_percentages_;
+    std::vector<double> sample_forces_;
+
+    // The maximum error of the conversions of the table
+    ApproximationError error_;
+};
+
+/**
+ * @brief Value-semantic thrust curve, that holds any of the thrust curves above in a std::variant. The conversions are 
+ * dispatched with std::visit, which the compiler can inline, instead of a virtual call through a pointer. The variant
+ * also works as a registry of the thrust curves known at compile time, which does not depend on the static initialization
+ * of the program (unlike the ThrustCurveFactory)
+ */
+class ThrustCurveVariant {
+
+public:
+
+    using Curves = std::variant<QuadraticCurve, ArctangentCurve, LinearExponentialCurve, TabulatedCurve>;
+
+    template <typename Curve, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Curve>, ThrustCurveVariant>>>
+    ThrustCurveVariant(Curve && curve) : curve_(std::forward<Curve>(curve)) {}
+
+    /**
+     * @brief Create a thrust curve from its identifier and the map of parameters used in the configuration files
+     * @param identifier The identifier of the thrust curve (e.g. "Quadratic")
+     * @param parameters The map with the parameters of the thrust curve
+     * @return ThrustCurveVariant The thrust curve
+     */
+    static ThrustCurveVariant create(const std::string & identifier, const std::map<std::string, double> & parameters) {
+        return create(identifier, parameters, static_cast<Curves *>(nullptr));
+    }
+
+    inline double force_to_percentage(double force) const {
+        return std::visit([force](const auto & curve) { return curve.force_to_percentage(force); }, curve_);
+    }
+
+    inline double percentage_to_force(double percentage) const {
+        return std::visit([percentage](const auto & curve) { return curve.percentage_to_force(percentage); }, curve_);
+    }
+
+    inline double get_max_force() const {
+        return std::visit([](const auto & curve) { return curve.get_max_force(); }, curve_);
+    }
+
+    std::string get_type() const {
+        return std::visit([](const auto & curve) { return std::string(std::decay_t<decltype(curve)>::IDENTIFIER); }, curve_);
+    }
+
+    std::map<std::string, double> get_parameters() const {
+        return std::visit([](const auto & curve) { return curve.to_map(); }, curve_);
+    }
+
+    /**
+     * @brief Get the curve held by the variant (e.g. to access its parameters)
+     */
+    inline const Curves & curve() const { return curve_; }
+
+private:
+
+    // Compile-time registry: create the first curve of the variant with the given identifier
+    template <typename... Alternatives>
+    static ThrustCurveVariant create(const std::string & identifier, const std::map<std::string, double> & parameters, std::variant<Alternatives...> *) {
+        std::optional<ThrustCurveVariant> curve;
+        ((curve.has_value() || identifier != Alternatives::IDENTIFIER ? void() : void(curve.emplace(Alternatives::from_map(parameters)))), ...);
+        if (!curve.has_value()) {
+            throw std::runtime_error("Thrust curve " + identifier + " is not one of the curves of ThrustCurveVariant!");
+        }
+        return std::move(*curve);
+    }
+
+    Curves curve_;
+};
+
+}
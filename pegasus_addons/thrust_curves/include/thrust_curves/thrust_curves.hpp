@@ -51,12 +51,15 @@
 #include <string>
 #include <vector>
 #include <map>
-
+#include <algorithm>
+#include "thrust_curves/thrust_curve_variant.hpp"
 
 namespace Pegasus {
 
 /**
- * @brief An abstract thrust curve class to be used as template for other thrust curve classes
+ * @brief An abstract thrust curve class to be used as template for other thrust curve classes. The thrust curves
+ * provided by this package forward their conversions to the value types in thrust_curve_variant.hpp, which should
+ * be preferred in the control loops (see ThrustCurveVariant)
  */
 class ThrustCurve {
 
@@ -186,21 +189,16 @@ public:
 private:
     
     /**
-     * @brief Construct a new Quadratic Thrust Curve object, that will encode a thrust curve of the type
+     * @brief Construct a new Arctangent Thrust Curve object, that will encode a thrust curve of the type
      * force = a * arctan(b * input + c) + d, with x a percentage between 0-100%
-     * @param a The output gain
-     * @param b The input gain
-     * @param c The input offset
-     * @param d The output offset
+     * @param curve The value type that implements the thrust curve
      */
-    ArctangentThrustCurve(double a, double b, double c, double d);
+    explicit ArctangentThrustCurve(const ArctangentCurve & curve);
 
     /**
-     * @brief The max force that the vehicle can output in Newton (N)
+     * @brief The thrust curve to which the conversions are forwarded
      */
-    double max_force_;
-
-    double a_, b_, c_, d_;
+    ArctangentCurve curve_;
 
     /**
      * @brief The unique identifier for this thrust curve
@@ -268,25 +266,15 @@ private:
     
     /**
      * @brief Construct a new Quadratic Thrust Curve object, that will encode a thrust curve of the type
-     * force = ax^2+bx+c, with x a percentage between 0-100%
-     * @param a The qudratic gain
-     * @param b The linear gain
-     * @param c The offset
-     * @param scale The scale through x is affected. By default is 1.0. Sometimes, the parameters a, b, and c
-     * are defined assuming that x varies from [0, 1], hence if in thoses cases we choose scale = 100, then
-     * force = a(x/100.0)^2 + b(x/scale) + c
-     */
-    QuadraticThrustCurve(double a, double b, double c, double scale=1.0);
-
-    /**
-     * @brief Quadratic equation terms
+     * force = a(x/scale)^2 + b(x/scale) + c, with x a percentage between 0-100%
+     * @param curve The value type that implements the thrust curve
      */
-    double a_, b_, c_, scale_;
+    explicit QuadraticThrustCurve(const QuadraticCurve & curve);
 
     /**
-     * @brief The max force that the vehicle can output in Newton (N)
+     * @brief The thrust curve to which the conversions are forwarded
      */
-    double max_force_;
+    QuadraticCurve curve_;
 
     /**
      * @brief The unique identifier for this thrust curve
@@ -355,27 +343,135 @@ public:
 private:
     
     /**
-     * @brief Construct a new Quadratic Thrust Curve object, that will encode a thrust curve of the type
-     * force = ax^2+bx+c, with x a percentage between 0-100%
-     * @param a The linear-exponential gain
-     * @param b The exponential gain
-     * @param c The linear gain
-     * @param d The offset
-     * @param scale The scale through x is affected. By default is 1.0. Sometimes, the parameters a, b, and c
-     * are defined assuming that the percentage varies from [0, 1], hence if in thoses cases we choose scale = 100, then
-     * the output percentage will be scaled such that it varies from [0, 100%]
+     * @brief Construct a new Linear Exponential Thrust Curve object, that will encode a thrust curve of the type
+     * percentage = (a * exp(b*force) * sqrt(force) + (c * force) + d) * scale
+     * @param curve The value type that implements the thrust curve
+     */
+    explicit LinearExponentialThrustCurve(const LinearExponentialCurve & curve);
+
+    /**
+     * @brief The thrust curve to which the conversions are forwarded
+     */
+    LinearExponentialCurve curve_;
+
+    /**
+     * @brief The unique identifier for this thrust curve
+     */
+    static const std::string IDENTIFIER;
+
+    /**
+     * @brief A Bolean that ensures that the thrust
+     * curve is registered with the factory at compile time
      */
-    LinearExponentialThrustCurve(double a, double b, double c, double d, double scale=1.0);
+    static const bool REGISTERED_WITH_FACTORY;
+};
+
+
+/**
+ * @brief A thrust curve defined by a dense lookup table, sampled from another thrust curve or from the measurements
+ * of a thrust stand. The samples are made monotone (the force never decreases with the percentage), and are resampled
+ * into two tables with uniform spacing, one for each direction of the conversion. Both conversions are then made in
+ * constant time, with a linear interpolation without branches, and the inverse is available for any curve that is sampled
+ */
+class TabulatedThrustCurve : public ThrustCurve {
+
+public:
+
+    using SharedPtr = std::shared_ptr<TabulatedThrustCurve>;
+
+    using ApproximationError = TabulatedCurve::ApproximationError;
+
+    /**
+     * @brief The default number of entries of each table
+     */
+    static constexpr std::size_t DEFAULT_SIZE = TabulatedCurve::DEFAULT_SIZE;
+
+    /**
+     * @brief Static method used to instantiate a tabulated thrust curve object through the ThrustCurveFactory
+     * @param gains A map with the measured samples of the curve, where each key is the percentage (0-100%) and the value
+     * is the force in Newton (N), for example {"0.0": 0.0, "50.0": 7.5, "100.0": 28.0}. The key "size" optionally sets the
+     * number of entries of each table
+     * @return ThrustCurve A shared pointer to a ThrustCurve object
+     */
+    static ThrustCurve::SharedPtr create_thrust_curve(std::map<std::string, double> gains);
+
+    /**
+     * @brief Sample another thrust curve into a table. The curve is sampled with its conversion from force to percentage, 
+     * which is implemented by all the curves, such that the table also provides the inverse of the curve
+     * @param curve The thrust curve to sample
+     * @param size The number of entries of each table
+     * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+     */
+    static TabulatedThrustCurve::SharedPtr from_curve(const ThrustCurve::SharedPtr & curve, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Create a table from the measurements of a thrust stand, saved in a CSV file with two columns: the percentage 
+     * (0-100%) and the force in Newton (N). Empty lines, lines starting with '#' and a header line are ignored
+     * @param file The path to the CSV file
+     * @param size The number of entries of each table
+     * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+     */
+    static TabulatedThrustCurve::SharedPtr from_csv(const std::string & file, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Create a table from samples of the curve (in any order)
+     * @param percentages The percentages (0-100%) of the samples
+     * @param forces The forces in Newton (N) of the samples
+     * @param size The number of entries of each table
+     * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+     */
+    static TabulatedThrustCurve::SharedPtr from_samples(const std::vector<double> & percentages, const std::vector<double> & forces, std::size_t size=DEFAULT_SIZE);
+
+    /**
+     * @brief Method that is used to convert a force in Newton (N) to a percentage from 0-100%
+     * @param force The force to apply in Newton (N)
+     * @return double The percentage of the total force a vehicle can apply, from 0-100%
+     */
+    virtual double force_to_percentage(double force);
+
+    /**
+     * @brief Method that is used to convert a percentage from 0-100% of total force a vehicle can apply and 
+     * convert it to a force in Newton (N)
+     * @param percentage The percentage of the total force a vehicle can apply, from 0-100%
+     * @return double The force to apply in Newton (N)
+     */
+    virtual double percentage_to_force(double percentage);
+
+    /**
+     * @brief Get the max force that the vehicle can output when given 100% of percentage of thrust
+     * @return double The maximum force the vehicle can apply in Newton (N)
+     */
+    virtual double get_max_force();
+
+    /**
+     * @brief Get the type of thrust curve that is instantiated
+     * @return std::string A string with the name of the thrust curve instantiated
+     */
+    virtual std::string get_type() { return IDENTIFIER; };
+
+    /**
+     * @brief Get the maximum error of the conversions of the table
+     * @return ApproximationError The maximum error in each direction
+     */
+    const ApproximationError & get_approximation_error() const { return curve_.get_approximation_error(); }
+
+    /**
+     * @brief Destructor of the TabulatedThrustCurve class
+     */
+    ~TabulatedThrustCurve() {};
+
+private:
 
     /**
-     * @brief Quadratic equation terms
+     * @brief Construct a new Tabulated Thrust Curve object from a table
+     * @param curve The value type that implements the table
      */
-    double a_, b_, c_, d_, scale_;
+    explicit TabulatedThrustCurve(TabulatedCurve curve);
 
     /**
-     * @brief The max force that the vehicle can output in Newton (N)
+     * @brief The table to which the conversions are forwarded
      */
-    double max_force_;
+    TabulatedCurve curve_;
 
     /**
      * @brief The unique identifier for this thrust curve
@@ -389,4 +485,4 @@ private:
     static const bool REGISTERED_WITH_FACTORY;
 };
 
-}
+}
\ No newline at end of file
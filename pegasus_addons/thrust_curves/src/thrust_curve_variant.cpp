@@ -0,0 +1,328 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <cmath>
+#include <charconv>
+#include <numeric>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "thrust_curves/thrust_curve_variant.hpp"
+
+namespace Pegasus {
+
+/**
+ * -------------------------------------------------------------
+ * In this section we define all the methods associated with the 
+ *                       TabulatedCurve 
+ * -------------------------------------------------------------
+ */
+
+namespace {
+
+/**
+ * @brief Linear interpolation of y(x) on samples with non-decreasing x (only used while building the tables). 
+ * The values outside of the samples are clamped to the first and last samples, and when several samples
+ * have the same x, the first one is used (e.g. the lowest percentage that produces a given force)
+ */
+double interpolate_samples(const std::vector<double> & x, const std::vector<double> & y, double value) {
+
+    if (!(value > x.front())) return y.front();
+    if (value >= x.back()) return y.back();
+
+    // First sample with x >= value. The previous one has x < value, hence the segment is not degenerate
+    const std::size_t i = std::lower_bound(x.begin(), x.end(), value) - x.begin();
+    const double alpha = (value - x[i - 1]) / (x[i] - x[i - 1]);
+    return y[i - 1] + alpha * (y[i] - y[i - 1]);
+}
+
+/**
+ * @brief Make the values non-decreasing with the pool adjacent violators algorithm, which replaces each block of 
+ * values that decreases by its average (the closest non-decreasing sequence in the least squares sense)
+ */
+void make_monotone(std::vector<double> & values) {
+
+    std::vector<double> blocks;
+    std::vector<std::size_t> counts;
+
+    for (double value : values) {
+        blocks.push_back(value);
+        counts.push_back(1);
+
+        // Merge the last block with the previous ones while they decrease
+        while (blocks.size() > 1 && blocks[blocks.size() - 2] > blocks.back()) {
+            const std::size_t n = blocks.size();
+            blocks[n - 2] = (blocks[n - 2] * counts[n - 2] + blocks[n - 1] * counts[n - 1]) / (counts[n - 2] + counts[n - 1]);
+            counts[n - 2] += counts[n - 1];
+            blocks.pop_back();
+            counts.pop_back();
+        }
+    }
+
+    std::size_t k = 0;
+    for (std::size_t b = 0; b < blocks.size(); b++) {
+        for (std::size_t j = 0; j < counts[b]; j++) values[k++] = blocks[b];
+    }
+}
+
+/**
+ * @brief Search for the lowest force at which a curve reaches a given percentage (by bisection, as the curves are monotone)
+ */
+double search_force(const std::function<double(double)> & force_to_percentage, double percentage, double max_force) {
+    double low = 0.0;
+    double high = max_force;
+    for (int i = 0; i < 100; i++) {
+        const double middle = 0.5 * (low + high);
+        if (force_to_percentage(middle) < percentage) low = middle;
+        else high = middle;
+    }
+    return high;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a new Tabulated Curve object from samples of the curve
+ * @param percentages The percentages (0-100%) of the samples
+ * @param forces The forces in Newton (N) of the samples
+ * @param size The number of entries of each table
+ */
+TabulatedCurve::TabulatedCurve(const std::vector<double> & percentages, const std::vector<double> & forces, std::size_t size) : 
+    sample_percentages_(percentages), sample_forces_(forces) {
+
+    if (percentages.size() != forces.size() || percentages.size() < 2 || size < 2) {
+        throw std::runtime_error("Tabulated thrust curve: at least 2 samples (with a percentage and a force) and 2 entries per table are required");
+    }
+
+    // Sort the samples by percentage
+    std::vector<std::size_t> order(percentages.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return percentages[a] < percentages[b]; });
+
+    std::vector<double> sorted_percentages(order.size());
+    std::vector<double> sorted_forces(order.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        sorted_percentages[i] = percentages[order[i]];
+        sorted_forces[i] = forces[order[i]];
+    }
+
+    // Make sure the force never decreases with the percentage (e.g. due to noise in the measurements)
+    make_monotone(sorted_forces);
+
+    max_force_ = interpolate_samples(sorted_percentages, sorted_forces, 100.0);
+    if (!(max_force_ > 0.0)) {
+        throw std::runtime_error("Tabulated thrust curve: the max force must be positive");
+    }
+
+    // Table with the force at uniformly spaced percentages
+    force_table_.resize(size);
+    percentage_scale_ = static_cast<double>(size - 1) / 100.0;
+    for (std::size_t i = 0; i < size; i++) {
+        force_table_[i] = interpolate_samples(sorted_percentages, sorted_forces, static_cast<double>(i) / percentage_scale_);
+    }
+
+    // Table with the percentage at uniformly spaced forces (the inverse of the samples)
+    percentage_table_.resize(size);
+    force_scale_ = static_cast<double>(size - 1) / max_force_;
+    for (std::size_t i = 0; i < size; i++) {
+        percentage_table_[i] = std::min(100.0, std::max(0.0, interpolate_samples(sorted_forces, sorted_percentages, static_cast<double>(i) / force_scale_)));
+    }
+
+    // Measure the error of the table at the samples
+    error_ = ApproximationError();
+    for (std::size_t i = 0; i < order.size(); i++) {
+        error_.percentage_to_force = std::max(error_.percentage_to_force, std::abs(percentage_to_force(percentages[i]) - forces[i]));
+        if (forces[i] >= 0.0 && forces[i] <= max_force_) {
+            error_.force_to_percentage = std::max(error_.force_to_percentage, std::abs(force_to_percentage(forces[i]) - percentages[i]));
+        }
+    }
+}
+
+/**
+ * @brief Convert a percentage to a key of the map of parameters. The shortest representation that is read back as the 
+ * exact same value is used (std::to_string only keeps 6 decimal places, which merges or moves close samples)
+ * @return std::string The key of the percentage
+ */
+static std::string percentage_key(double percentage) {
+    char buffer[32];
+    const auto [ptr, error] = std::to_chars(buffer, buffer + sizeof(buffer), percentage);
+    return std::string(buffer, ptr);
+}
+
+/**
+ * @brief Create a table from a map where the keys are the percentages and the values are the forces
+ * @return TabulatedCurve The tabulated curve
+ */
+TabulatedCurve TabulatedCurve::from_map(const std::map<std::string, double> & parameters) {
+
+    std::size_t size = DEFAULT_SIZE;
+    std::vector<double> percentages;
+    std::vector<double> forces;
+
+    for (const auto & [key, value] : parameters) {
+        if (key == "size") {
+            size = static_cast<std::size_t>(value);
+            continue;
+        }
+        // The whole key must be a number (e.g. "0.5abc" is rejected instead of being read as 0.5)
+        double percentage;
+        const auto [ptr, error] = std::from_chars(key.data(), key.data() + key.size(), percentage);
+        if (error != std::errc() || ptr != key.data() + key.size()) {
+            throw std::runtime_error("Tabulated thrust curve: the parameter " + key + " is not a percentage");
+        }
+        percentages.push_back(percentage);
+        forces.push_back(value);
+    }
+
+    return TabulatedCurve(percentages, forces, size);
+}
+
+/**
+ * @brief Create a table from the measurements of a thrust stand, saved in a CSV file
+ * @return TabulatedCurve The tabulated curve
+ */
+TabulatedCurve TabulatedCurve::from_csv(const std::string & file, std::size_t size) {
+
+    std::ifstream stream(file);
+    if (!stream.is_open()) {
+        throw std::runtime_error("Tabulated thrust curve: could not open the file " + file);
+    }
+
+    std::vector<double> percentages;
+    std::vector<double> forces;
+    std::string line;
+    std::size_t line_number = 0;
+
+    while (std::getline(stream, line)) {
+        line_number++;
+
+        // Ignore empty lines and comments
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[line.find_first_not_of(" \t\r")] == '#') continue;
+
+        std::stringstream columns(line);
+        std::string percentage;
+        std::string force;
+        std::getline(columns, percentage, ',');
+        std::getline(columns, force, ',');
+
+        try {
+            percentages.push_back(std::stod(percentage));
+            forces.push_back(std::stod(force));
+        } catch (const std::exception &) {
+            // The first line that is not a number is the header
+            if (percentages.empty() && line_number == 1) continue;
+            throw std::runtime_error("Tabulated thrust curve: invalid sample in line " + std::to_string(line_number) + " of the file " + file);
+        }
+    }
+
+    return TabulatedCurve(percentages, forces, size);
+}
+
+/**
+ * @brief Sample a conversion from force to percentage into a table
+ * @return TabulatedCurve The tabulated curve
+ */
+TabulatedCurve TabulatedCurve::sample(const std::function<double(double)> & force_to_percentage, double max_force, std::size_t size) {
+
+    // Get the force at which the curve saturates. The curves that do not implement the conversion from percentage to force 
+    // report a max force of 0, so in that case it is searched with the conversion from force to percentage
+    if (!(max_force > 0.0)) {
+        double high = 1.0;
+        while (force_to_percentage(high) < 100.0 && high < 1e6) high *= 2.0;
+        max_force = search_force(force_to_percentage, 100.0, high);
+    }
+
+    // Sample the curve with a finer spacing than the tables
+    const std::size_t samples = 4 * std::max<std::size_t>(size, 2);
+    std::vector<double> percentages(samples);
+    std::vector<double> forces(samples);
+    for (std::size_t i = 0; i < samples; i++) {
+        forces[i] = max_force * static_cast<double>(i) / static_cast<double>(samples - 1);
+        percentages[i] = force_to_percentage(forces[i]);
+    }
+
+    TabulatedCurve table(percentages, forces, size);
+
+    // The samples are not kept, as the table can be sampled again from the curve
+    table.sample_percentages_.clear();
+    table.sample_forces_.clear();
+
+    // Measure the error of the table with respect to the curve, in the middle of the entries of the tables (where it is the largest).
+    // The error of the inverse is measured against the inverse of the curve obtained by bisection
+    table.error_ = ApproximationError();
+    for (std::size_t i = 0; i + 1 < table.percentage_table_.size(); i++) {
+        const double force = (static_cast<double>(i) + 0.5) / table.force_scale_;
+        table.error_.force_to_percentage = std::max(table.error_.force_to_percentage, std::abs(table.force_to_percentage(force) - force_to_percentage(force)));
+    }
+    for (std::size_t i = 0; i + 1 < table.force_table_.size(); i++) {
+        const double percentage = (static_cast<double>(i) + 0.5) / table.percentage_scale_;
+        table.error_.percentage_to_force = std::max(table.error_.percentage_to_force, std::abs(table.percentage_to_force(percentage) - search_force(force_to_percentage, percentage, max_force)));
+    }
+
+    return table;
+}
+
+/**
+ * @brief Get the samples the table was created from, and the number of entries of each table. 
+ * When the table was sampled from another curve, the entries of the table are used as the samples
+ * @return std::map The map with the samples (with the same format used by from_map)
+ */
+std::map<std::string, double> TabulatedCurve::to_map() const {
+
+    std::map<std::string, double> parameters;
+
+    if (sample_percentages_.empty()) {
+        for (std::size_t i = 0; i < force_table_.size(); i++) parameters[percentage_key(static_cast<double>(i) / percentage_scale_)] = force_table_[i];
+    } else {
+        for (std::size_t i = 0; i < sample_percentages_.size(); i++) parameters[percentage_key(sample_percentages_[i])] = sample_forces_[i];
+    }
+
+    parameters["size"] = static_cast<double>(force_table_.size());
+    return parameters;
+}
+
+}
@@ -45,8 +45,8 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
-#include <cmath>
 #include <iostream>
+#include <stdexcept>
 #include "thrust_curves/thrust_curves.hpp"
 
 namespace Pegasus {
@@ -145,22 +145,16 @@ const bool QuadraticThrustCurve::REGISTERED_WITH_FACTORY = ThrustCurveFactory::g
  * @return ThrustCurve A shared pointer to a ThrustCurve object
  */
 ThrustCurve::SharedPtr QuadraticThrustCurve::create_thrust_curve(std::map<std::string, double> gains) {
-    return std::shared_ptr<QuadraticThrustCurve>(new QuadraticThrustCurve(gains["a"], gains["b"], gains["c"], gains["scale"]));
+    return std::shared_ptr<QuadraticThrustCurve>(new QuadraticThrustCurve(QuadraticCurve::from_map(gains)));
 }
 
 /**
  * @brief Construct a new Quadratic Thrust Curve object, that will encode a thrust curve of the type
- * force = ax^2+bx+c, with x a percentage between 0-100%
- * @param a The qudratic gain
- * @param b The linear gain
- * @param c The offset
- */
-QuadraticThrustCurve::QuadraticThrustCurve(double a, double b, double c, double scale) : a_(a), b_(b), c_(c), scale_(scale) {
-    max_force_ = percentage_to_force(100.0);
-    parameters_["a"] = a_;
-    parameters_["b"] = b_;
-    parameters_["c"] = c_;
-    parameters_["scale"] = scale_;
+ * force = a(x/scale)^2 + b(x/scale) + c, with x a percentage between 0-100%
+ * @param curve The value type that implements the thrust curve
+ */
+QuadraticThrustCurve::QuadraticThrustCurve(const QuadraticCurve & curve) : curve_(curve) {
+    parameters_ = curve_.to_map();
 }
 
 /**
@@ -170,9 +164,7 @@ QuadraticThrustCurve::QuadraticThrustCurve(double a, double b, double c, double
  * @return double The percentage of the total force a vehicle can apply, from 0-100%
  */
 double QuadraticThrustCurve::force_to_percentage(double force) {
-    // Make sure the desired force to apply in Newtons is not bellow zero
-    double f = std::max(0.0, force);
-    return std::max(0.0, std::min(100.0, (-b_ + std::sqrt(std::pow(b_, 2) - (4 * a_ * (c_ - f)))) / (2 * a_) * scale_));
+    return curve_.force_to_percentage(force);
 }
 
 /**
@@ -182,8 +174,7 @@ double QuadraticThrustCurve::force_to_percentage(double force) {
  * @return double The force to apply in Newton (N)
  */
 double QuadraticThrustCurve::percentage_to_force(double percentage) {
-    double x = std::min(100.0, std::max(0.0, percentage)) / scale_;
-    return (a_ * std::pow(x, 2)) + (b_ * x) + c_;
+    return curve_.percentage_to_force(percentage);
 }
 
 /**
@@ -191,7 +182,7 @@ double QuadraticThrustCurve::percentage_to_force(double percentage) {
  * @return double The maximum force the vehicle can apply in Newton (N)
  */
 double QuadraticThrustCurve::get_max_force() {
-    return max_force_;
+    return curve_.get_max_force();
 }
 
 /**
@@ -216,37 +207,19 @@ const bool ArctangentThrustCurve::REGISTERED_WITH_FACTORY = ThrustCurveFactory::
  * @return ThrustCurve A shared pointer to a ThrustCurve object
  */
 ThrustCurve::SharedPtr ArctangentThrustCurve::create_thrust_curve(std::map<std::string, double> gains) {
-    return std::shared_ptr<ArctangentThrustCurve>(new ArctangentThrustCurve(gains["a"], gains["b"], gains["c"], gains["d"]));
+    return std::shared_ptr<ArctangentThrustCurve>(new ArctangentThrustCurve(ArctangentCurve::from_map(gains)));
 }
 
-ArctangentThrustCurve::ArctangentThrustCurve(double a, double b, double c, double d) : a_(a), b_(b), c_(c), d_(d) {
-
-    max_force_ = percentage_to_force(100.0);
-    parameters_["a"] = a;
-    parameters_["b"] = b;
-    parameters_["c"] = c;
-    parameters_["d"] = d;
+ArctangentThrustCurve::ArctangentThrustCurve(const ArctangentCurve & curve) : curve_(curve) {
+    parameters_ = curve_.to_map();
 }
 
 double ArctangentThrustCurve::force_to_percentage(double force) {
-
-    // Make sure the desired force is within the limits
-    double f = std::min(std::max(0.0, force), max_force_);
-
-    // Compute the output in percentage
-    double u = (std::tan((f-d_)/a_)-c_)/b_;
-
-    // Output the percentage clipped between 0-100%. It should be, but just in case
-    return std::max(0.0, std::min(u, 100.0));
+    return curve_.force_to_percentage(force);
 }
 
 double ArctangentThrustCurve::percentage_to_force(double percentage) {
-
-    // Clip the percentage between 0-100%
-    double x = std::min(100.0, std::max(0.0, percentage));
-
-    // Return the force in Newtons
-    return (a_ * std::atan(b_ * x + c_)) + d_;
+    return curve_.percentage_to_force(percentage);
 }
 
 /**
@@ -254,7 +227,7 @@ double ArctangentThrustCurve::percentage_to_force(double percentage) {
  * @return double The maximum force the vehicle can apply in Newton (N)
  */
 double ArctangentThrustCurve::get_max_force() {
-    return max_force_;
+    return curve_.get_max_force();
 }
 
 
@@ -276,23 +249,12 @@ const std::string LinearExponentialThrustCurve::IDENTIFIER = "LinearExponential"
 const bool LinearExponentialThrustCurve::REGISTERED_WITH_FACTORY = ThrustCurveFactory::get_instance().register_creator(LinearExponentialThrustCurve::IDENTIFIER, LinearExponentialThrustCurve::create_thrust_curve);
 
 /**
- * @brief Construct a new Quadratic Thrust Curve object, that will encode a thrust curve of the type
- * force = ax^2+bx+c, with x a percentage between 0-100%
- * @param a The linear-exponential gain
- * @param b The exponential gain
- * @param c The linear gain
- * @param d The offset
- * @param scale The scale through x is affected. By default is 1.0. Sometimes, the parameters a, b, and c
- * are defined assuming that the percentage varies from [0, 1], hence if in thoses cases we choose scale = 100, then
- * the output percentage will be scaled such that it varies from [0, 100%]
- */
-LinearExponentialThrustCurve::LinearExponentialThrustCurve(double a, double b, double c, double d, double scale) : a_(a), b_(b), c_(c), d_(d), scale_(scale) {
-    max_force_ = percentage_to_force(100.0);
-    parameters_["a"] = a_;
-    parameters_["b"] = b_;
-    parameters_["c"] = c_;
-    parameters_["d"] = d_;
-    parameters_["scale"] = scale_;
+ * @brief Construct a new Linear Exponential Thrust Curve object, that will encode a thrust curve of the type
+ * percentage = (a * exp(b*force) * sqrt(force) + (c * force) + d) * scale
+ * @param curve The value type that implements the thrust curve
+ */
+LinearExponentialThrustCurve::LinearExponentialThrustCurve(const LinearExponentialCurve & curve) : curve_(curve) {
+    parameters_ = curve_.to_map();
 }
 
 /**
@@ -303,7 +265,7 @@ LinearExponentialThrustCurve::LinearExponentialThrustCurve(double a, double b, d
  * @return ThrustCurve A shared pointer to a ThrustCurve object
  */
 ThrustCurve::SharedPtr LinearExponentialThrustCurve::create_thrust_curve(std::map<std::string, double> gains) {
-    return std::shared_ptr<LinearExponentialThrustCurve>(new LinearExponentialThrustCurve(gains["a"], gains["b"], gains["c"], gains["d"], gains["scale"]));
+    return std::shared_ptr<LinearExponentialThrustCurve>(new LinearExponentialThrustCurve(LinearExponentialCurve::from_map(gains)));
 }
 
 /**
@@ -313,9 +275,7 @@ ThrustCurve::SharedPtr LinearExponentialThrustCurve::create_thrust_curve(std::ma
  * @return double The percentage of the total force a vehicle can apply, from 0-100%
  */
 double LinearExponentialThrustCurve::force_to_percentage(double force) {
-    // Make sure the desired force to apply in Newtons is not bellow zero
-    double f = std::max(0.0, force);
-    return std::min(100.0, std::max(0.0, ((a_ * std::exp(b_ * f) * std::sqrt(f)) + (c_ * f) + d_) * scale_));
+    return curve_.force_to_percentage(force);
 }
 
 /**
@@ -325,8 +285,7 @@ double LinearExponentialThrustCurve::force_to_percentage(double force) {
  * @return double The force to apply in Newton (N)
  */
 double LinearExponentialThrustCurve::percentage_to_force(double percentage) {
-    (void) percentage;
-    return 0.0; // TODO - try to invert this expression the best I can :)
+    return curve_.percentage_to_force(percentage); // TODO - try to invert this expression the best I can :)
 }
 
 /**
@@ -334,7 +293,95 @@ double LinearExponentialThrustCurve::percentage_to_force(double percentage) {
  * @return double The maximum force the vehicle can apply in Newton (N)
  */
 double LinearExponentialThrustCurve::get_max_force() {
-    return max_force_;
+    return curve_.get_max_force();
+}
+
+
+/**
+ * -------------------------------------------------------------
+ * In this section we define all the methods associated with the 
+ *                   TabulatedThrustCurve 
+ * -------------------------------------------------------------
+ */
+
+/**
+ * @brief Define the string Idenfifier for this thrust curve
+ */
+const std::string TabulatedThrustCurve::IDENTIFIER = "Tabulated";
+
+/**
+ * @brief Register this thrust curve in the ThrustCurveFactory
+ */
+const bool TabulatedThrustCurve::REGISTERED_WITH_FACTORY = ThrustCurveFactory::get_instance().register_creator(TabulatedThrustCurve::IDENTIFIER, TabulatedThrustCurve::create_thrust_curve);
+
+/**
+ * @brief Static method used to instantiate a tabulated thrust curve object through the ThrustCurveFactory, from
+ * a map where the keys are the percentages and the values are the forces
+ * @return ThrustCurve A shared pointer to a ThrustCurve object
+ */
+ThrustCurve::SharedPtr TabulatedThrustCurve::create_thrust_curve(std::map<std::string, double> gains) {
+    return TabulatedThrustCurve::SharedPtr(new TabulatedThrustCurve(TabulatedCurve::from_map(gains)));
+}
+
+/**
+ * @brief Sample another thrust curve into a table
+ * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+ */
+TabulatedThrustCurve::SharedPtr TabulatedThrustCurve::from_curve(const ThrustCurve::SharedPtr & curve, std::size_t size) {
+    return TabulatedThrustCurve::SharedPtr(new TabulatedThrustCurve(TabulatedCurve::sample([&curve](double force) { return curve->force_to_percentage(force); }, curve->get_max_force(), size)));
+}
+
+/**
+ * @brief Create a table from the measurements of a thrust stand, saved in a CSV file
+ * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+ */
+TabulatedThrustCurve::SharedPtr TabulatedThrustCurve::from_csv(const std::string & file, std::size_t size) {
+    return TabulatedThrustCurve::SharedPtr(new TabulatedThrustCurve(TabulatedCurve::from_csv(file, size)));
+}
+
+/**
+ * @brief Create a table from samples of the curve
+ * @return TabulatedThrustCurve::SharedPtr A shared pointer to the tabulated curve
+ */
+TabulatedThrustCurve::SharedPtr TabulatedThrustCurve::from_samples(const std::vector<double> & percentages, const std::vector<double> & forces, std::size_t size) {
+    return TabulatedThrustCurve::SharedPtr(new TabulatedThrustCurve(TabulatedCurve(percentages, forces, size)));
+}
+
+/**
+ * @brief Construct a new Tabulated Thrust Curve object from a table
+ * @param curve The value type that implements the table
+ */
+TabulatedThrustCurve::TabulatedThrustCurve(TabulatedCurve curve) : curve_(std::move(curve)) {
+
+    // Keep the samples as the parameters of the curve (with the same format used by the ThrustCurveFactory)
+    parameters_ = curve_.to_map();
+}
+
+/**
+ * @brief Method that is used to convert a force in Newton (N) to a percentage from 0-100%
+ * @param force The force to apply in Newton (N)
+ * @return double The percentage of the total force a vehicle can apply, from 0-100%
+ */
+double TabulatedThrustCurve::force_to_percentage(double force) {
+    return curve_.force_to_percentage(force);
+}
+
+/**
+ * @brief Method that is used to convert a percentage from 0-100% of total force a vehicle can apply and 
+ * convert it to a force in Newton (N)
+ * @param percentage The percentage of the total force a vehicle can apply, from 0-100%
+ * @return double The force to apply in Newton (N)
+ */
+double TabulatedThrustCurve::percentage_to_force(double percentage) {
+    return curve_.percentage_to_force(percentage);
+}
+
+/**
+ * @brief Get the max force that the vehicle can output when given 100% of percentage of thrust
+ * @return double The maximum force the vehicle can apply in Newton (N)
+ */
+double TabulatedThrustCurve::get_max_force() {
+    return curve_.get_max_force();
+}
+
 }
-    
-}
\ No newline at end of file
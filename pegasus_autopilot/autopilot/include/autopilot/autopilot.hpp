@@ -48,31 +48,46 @@
 #pragma once
 
 #include <map>
+#include <array>
+#include <deque>
+#include <chrono>
+#include <bitset>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include <vector>
+#include <functional>
 #include <Eigen/Core>
 
 // ROS Libraries
 #include "rclcpp/rclcpp.hpp"
 
-// Plugin libraries
-#include <pluginlib/class_loader.hpp>
-
 // ROS 2 messages
 #include "nav_msgs/msg/odometry.hpp"
+#include "std_msgs/msg/u_int8.hpp"
+#include "std_msgs/msg/u_int64.hpp"
+#include "std_msgs/msg/float64.hpp"
 #include "pegasus_msgs/msg/status.hpp"
 #include "pegasus_msgs/msg/vehicle_constants.hpp"
 #include "pegasus_msgs/msg/autopilot_status.hpp"
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
 
 // ROS 2 services
 #include "pegasus_msgs/srv/arm.hpp"
 #include "pegasus_msgs/srv/offboard.hpp"
 #include "pegasus_msgs/srv/set_mode.hpp"
+#include "std_srvs/srv/trigger.hpp"
 
 // Auxiliary libraries
 #include "mode.hpp"
 #include "state.hpp"
 #include "geofencing.hpp"
+#include "tick_context.hpp"
 #include "controller.hpp"
+#include "timed_controller.hpp"
+#include "latency_histogram.hpp"
+#include "plugin_loaders.hpp"
 #include "trajectory_manager.hpp"
 
 namespace autopilot {
@@ -81,34 +96,64 @@ class Autopilot : public rclcpp::Node {
 
 public:
 
-    Autopilot();
-    ~Autopilot() {}
+    // Numeric identifier of an operating mode, given by the order in which the modes are loaded
+    using ModeId = std::int32_t;
+    static constexpr ModeId INVALID_MODE{-1};
+
+    // Maximum number of operating modes that can be loaded (size of each row of the transition matrix)
+    static constexpr std::size_t MAX_MODES{64};
 
-    // Function that executes periodically the control loop of each operation mode
+    // The autopilot can be created as a standalone node or loaded as a ROS 2 component. When several autopilots run in the
+    // same process, they can share the same plugin class loaders
+    explicit Autopilot(const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
+    Autopilot(const rclcpp::NodeOptions & options, PluginLoaders::SharedPtr plugin_loaders);
+    ~Autopilot();
+
+    // Function that executes periodically the control loop of each operation mode (at the current time or at a given time instant)
     virtual void update();
+    virtual void update(const rclcpp::Time & now);
     
     // Function that establishes the state machine to transition between operating modes
     virtual bool change_mode(const std::string new_mode, bool force=false);
+    virtual bool change_mode(ModeId new_mode, bool force=false);
 
     // Function that signals that the current mode has finished its operation and should transition to the fallback mode
     virtual void signal_mode_finished();
 
     // Returns the current mode of operation of the autopilot and state of the vehicle
-    inline std::string get_mode() const { return current_mode_; }
-    inline State get_state() const { return state_; }
-    inline VehicleStatus get_status() const { return status_; }
-    inline VehicleConstants get_vehicle_constants() const { return vehicle_constants_; }
-
-    // Initializes the autopilot to run
-    void initialize();
+    inline std::string get_mode() const { return get_mode_name(current_mode_); }
+    inline ModeId get_mode_id() const { return current_mode_; }
+    inline State get_state() const { return state_.load(); }
+    inline VehicleStatus get_status() const { return status_.load(); }
+    inline const VehicleConstants & get_vehicle_constants() const { return *vehicle_constants_.load(std::memory_order_acquire); }
+    inline TrajectoryManager::SharedPtr get_trajectory_manager() const { return trajectory_manager_; }
+
+    // Feed the state, status and constants of the vehicle directly, bypassing the ROS 2 subscribers (e.g. from a simulator
+    // that steps the autopilot in lockstep). The subscriber callbacks forward the received messages to these methods. The first
+    // constants initialize the autopilot (throwing std::runtime_error if its configuration is invalid) and later ones are ignored
+    void set_state(const State & state);
+    void set_status(const VehicleStatus & status);
+    void set_vehicle_constants(const VehicleConstants & vehicle_constants);
+
+    // Callback invoked when the constants received through the subscriber fail to initialize the autopilot. By default the error
+    // is only logged, leaving this autopilot uninitialized without stopping the other nodes that run in the same process
+    inline void set_configuration_error_callback(std::function<void(const std::exception &)> callback) { configuration_error_callback_ = std::move(callback); }
+
+    // Convert between the names of the modes and their numeric identifiers (INVALID_MODE if the mode was not loaded)
+    ModeId get_mode_id(const std::string & mode) const;
+    inline std::string get_mode_name(ModeId mode) const { return (mode >= 0 && mode < static_cast<ModeId>(mode_names_.size())) ? mode_names_[mode] : "Uninitialized"; }
 
 private:
 
+    // Initializes the autopilot to run (called by the constructor)
+    void initialize();
+
     // Pre-initializations of the autopilot
     void initialize_controller();
     void initialize_geofencing();
     void initialize_trajectory_manager();
     void initialize_operating_modes();
+    void initialize_control_loop();
 
     // ROS2 node initializations
     void initialize_autopilot();
@@ -116,6 +161,17 @@ private:
     void initialize_subscribers();
     void initialize_services();
 
+    // Auxiliar methods of the state machine to complete, poll or abort the transition to a new mode
+    void complete_mode_change(ModeId new_mode);
+    void update_pending_mode(const TickContext & ctx);
+    void abort_pending_mode();
+
+    // Control loop executed by a dedicated real-time thread (when enabled)
+    void realtime_control_loop(double rate);
+
+    // Timer callback that runs the control loop when the state of the vehicle stops arriving (when the loop is triggered by the state)
+    void watchdog_callback();
+
     // Subscriber callbacks to get the current state of the vehicle
     void state_callback(const nav_msgs::msg::Odometry::ConstSharedPtr msg);
     void status_callback(const pegasus_msgs::msg::Status::ConstSharedPtr msg);
@@ -124,11 +180,22 @@ private:
     // Services callbacks to set the operation mode of the autopilot
     void change_mode_callback(const std::shared_ptr<pegasus_msgs::srv::SetMode::Request> request, std::shared_ptr<pegasus_msgs::srv::SetMode::Response> response);
 
+    // Timer callback to publish a summary of the performance of the control loop and service callback to reset it
+    void perf_callback();
+    void reset_perf_callback(const std::shared_ptr<std_srvs::srv::Trigger::Request> request, std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+
     // ROS 2 service to change the operation mode
     rclcpp::Service<pegasus_msgs::srv::SetMode>::SharedPtr change_mode_service_;
 
+    // ROS 2 service to reset the performance histograms
+    rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr reset_perf_service_;
+
     // ROS2 publishers
     rclcpp::Publisher<pegasus_msgs::msg::AutopilotStatus>::SharedPtr status_publisher_;
+    rclcpp::Publisher<std_msgs::msg::UInt8>::SharedPtr mode_id_publisher_;
+    rclcpp::Publisher<std_msgs::msg::UInt64>::SharedPtr overruns_publisher_;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr perf_publisher_;
+    rclcpp::Publisher<std_msgs::msg::Float64>::SharedPtr state_age_publisher_;
     
     // ROS2 subscribers
     rclcpp::Subscription<nav_msgs::msg::Odometry>::SharedPtr state_subscriber_;
@@ -137,31 +204,104 @@ private:
 
     // ROS2 messages
     pegasus_msgs::msg::AutopilotStatus status_msg_;
+    std_msgs::msg::UInt8 mode_id_msg_;
     pegasus_msgs::msg::VehicleConstants vehicle_constants_msg_;
+    std_msgs::msg::UInt64 overruns_msg_;
+    diagnostic_msgs::msg::DiagnosticArray perf_msg_;
+    std_msgs::msg::Float64 state_age_msg_;
 
     // ROS 2 timer to handle the control modes, update the controllers and publish the control commands
     rclcpp::TimerBase::SharedPtr timer_;
 
-    // Modes of operation of the autopilot
-    std::map<std::string, autopilot::Mode::UniquePtr> operating_modes_;
-    std::map<std::string, std::vector<std::string>> valid_transitions_;
-    std::map<std::string, std::string> fallback_modes_;
-    std::map<std::string, std::string> on_finish_modes_;
-    std::map<std::string, std::string> geofencing_violation_fallback_;
+    // When enabled, the control loop runs as soon as a new state of the vehicle arrives, limited to a maximum rate. The timer is
+    // then only used as a watchdog, to keep running the control loop if no state was received for longer than the timeout
+    bool trigger_on_state_{false};
+    double trigger_max_rate_{0.0};
+    double watchdog_timeout_{0.0};
+    rclcpp::Time last_state_trigger_;
+    rclcpp::Time last_trigger_stamp_;
+
+    // Configuration of the state source to compensate for its latency. The age of the state is measured from its stamp (plus
+    // a fixed offset, for sources that stamp the messages when they are sent instead of when they are measured) and, if
+    // enabled, the state is predicted forward to the time of each iteration (up to a maximum horizon)
+    bool state_prediction_enabled_{false};
+    double state_prediction_max_horizon_{0.0};
+    double state_latency_offset_{0.0};
+
+    // Dedicated real-time thread that can replace the ROS 2 timer to run the control loop
+    std::thread control_thread_;
+    std::atomic<bool> control_thread_running_{false};
+    int realtime_priority_{0};
+    std::vector<long int> realtime_cpu_affinity_;
+
+    // Number of control loop deadlines that were missed by the real-time thread
+    std::uint64_t deadline_overruns_{0};
+
+    // Histograms with the duration of each part of the control loop, the period between iterations, its jitter (difference
+    // between consecutive periods) and the age of the state used. They are only written by the control loop (which also
+    // resets them when requested) and read by the timer that publishes their summary
+    enum PerfMetric { PERF_TICK, PERF_MODE, PERF_CONTROLLER, PERF_GEOFENCING, PERF_PUBLISH, PERF_PERIOD, PERF_JITTER, PERF_STATE_AGE, PERF_STATE_STAMP_AGE, NUM_PERF_METRICS };
+    std::array<LatencyHistogram, NUM_PERF_METRICS> perf_histograms_;
+    std::atomic<bool> perf_reset_requested_{false};
+    rclcpp::TimerBase::SharedPtr perf_timer_;
+
+    // Clock used to throttle the logs in the control loop (created once, as the logs can be hit at every iteration)
+    rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
+
+    // Auxiliar variables to measure the period of the control loop and the age of the state (in steady clock time)
+    std::chrono::steady_clock::time_point last_tick_start_{};
+    std::int64_t last_tick_period_{-1};
+    std::atomic<std::int64_t> last_state_arrival_{0};
+
+    // Mutex to prevent the ROS 2 callbacks from changing the autopilot while the real-time thread is running an update
+    std::mutex update_mutex_;
+
+    // Class loaders for the plugins (declared before the plugins, such that they are destroyed after them)
+    PluginLoaders::SharedPtr plugin_loaders_{nullptr};
+
+    // Modes of operation of the autopilot, compiled into flat arrays indexed by the mode id. The names are only
+    // used when loading the modes, logging and handling mode change requests - never inside the control loop
+    std::vector<std::string> mode_names_;
+    std::map<std::string, ModeId> mode_ids_;
+    std::vector<autopilot::Mode::UniquePtr> operating_modes_;
+    std::vector<std::bitset<MAX_MODES>> valid_transitions_;
+    std::vector<ModeId> fallback_modes_;
+    std::vector<ModeId> on_finish_modes_;
+    std::vector<ModeId> geofencing_violation_fallback_;
+    std::vector<double> enter_timeouts_;
+
+    // Mode that is being entered asynchronously (the current mode keeps running until it is entered) and when it started
+    ModeId pending_mode_{INVALID_MODE};
+    rclcpp::Time pending_mode_start_;
+
+    // Ids of the modes that the autopilot forces when the vehicle status does not match the current mode
+    ModeId disarm_mode_{INVALID_MODE};
+    ModeId hold_mode_{INVALID_MODE};
 
     // Configuration for the operation modes for the autopilot
     Mode::Config mode_config_;
 
-    // Current state and status of the vehicle
-    State state_;
-    VehicleStatus status_;
-    VehicleConstants vehicle_constants_;
-    std::string current_mode_{"Uninitialized"};
+    // Current state and status of the vehicle. These are written by the subscribers and can be read
+    // from any thread (including the real-time control thread) without locking
+    SeqLock<State> state_;
+    SeqLock<VehicleStatus> status_;
+
+    // The vehicle constants own heap memory, so they are published as immutable snapshots instead. Each new snapshot
+    // is appended to the history (never modified or freed while the autopilot is alive) and readers access the last one
+    // through an atomic pointer. In practice the constants are only received once (see set_vehicle_constants)
+    std::deque<VehicleConstants> vehicle_constants_history_{1};
+    std::atomic<const VehicleConstants*> vehicle_constants_{&vehicle_constants_history_.front()};
+    std::atomic<bool> vehicle_constants_received_{false};
+    std::function<void(const std::exception &)> configuration_error_callback_;
+    ModeId current_mode_{INVALID_MODE};
 
     // Low level controllers for reference tracking
     Controller::Config controller_config_;
     autopilot::Controller::SharedPtr controller_{nullptr};
 
+    // Wrapper around the controller given to the operation modes, which measures the time spent in the controller
+    std::shared_ptr<TimedController> timed_controller_{nullptr};
+
     // Geofencing object to check if the vehicle is inside the geofence
     Geofencing::Config geofencing_config_;
     autopilot::Geofencing::UniquePtr geofencing_{nullptr};
@@ -179,11 +319,6 @@ private:
     // Auxiliar flag to check if the operating mode has finished
     bool mode_finished_{false};
 
-    // Class loaders for the plugins
-    std::unique_ptr<pluginlib::ClassLoader<autopilot::Mode>> mode_loader_;
-    std::unique_ptr<pluginlib::ClassLoader<autopilot::Controller>> controller_loader_;
-    std::unique_ptr<pluginlib::ClassLoader<autopilot::Geofencing>> geofencing_loader_;
-    std::unique_ptr<pluginlib::ClassLoader<autopilot::TrajectoryManager>> trajectory_manager_loader_;
 };
 
 } // namespace autopilot
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace autopilot {
+
+/**
+ * @brief Result of a command sent to a controller. The commands are sent at every iteration of the control loop, so they report
+ * the result instead of throwing, and the autopilot enters the fallback mode of the current mode when a command is not OK
+ */
+enum class ControlStatus : std::uint8_t {
+    OK,                 // The command was accepted by the controller
+    NOT_SUPPORTED,      // The controller does not implement the command
+    FAILED              // The controller could not compute or send the command
+};
+
+inline const char * to_string(ControlStatus status) {
+    switch (status) {
+        case ControlStatus::OK: return "OK";
+        case ControlStatus::NOT_SUPPORTED: return "NOT_SUPPORTED";
+        case ControlStatus::FAILED: return "FAILED";
+    }
+    return "UNKNOWN";
+}
+
+/**
+ * @brief Bitmask with the capabilities of a controller or trajectory manager. They are reported once, when the plugin is loaded,
+ * and checked by the autopilot against the capabilities required by each operation mode before the control loop starts
+ */
+using Capabilities = std::uint32_t;
+
+// Commands that a controller can track
+enum ControllerCapability : Capabilities {
+    CONTROL_POSITION = 1u << 0,                 // set_position()
+    CONTROL_INERTIAL_VELOCITY = 1u << 1,        // set_inertial_velocity()
+    CONTROL_BODY_VELOCITY = 1u << 2,            // set_body_velocity()
+    CONTROL_INERTIAL_ACCELERATION = 1u << 3,    // set_inertial_acceleration()
+    CONTROL_ATTITUDE = 1u << 4,                 // set_attitude()
+    CONTROL_ATTITUDE_RATE = 1u << 5,            // set_attitude_rate()
+    CONTROL_MOTOR_SPEED = 1u << 6,              // set_motor_speed()
+    CONTROL_ALL = (1u << 7) - 1u
+};
+
+// Queries that a trajectory manager can answer
+enum TrajectoryCapability : Capabilities {
+    TRAJECTORY_PATH = 1u << 0,                  // pd(), min_gamma(), max_gamma() and empty()
+    TRAJECTORY_PARAMETER_SPEED = 1u << 1,       // vd()
+    TRAJECTORY_VEHICLE_SPEED = 1u << 2,         // vehicle_speed()
+    TRAJECTORY_ALL = (1u << 3) - 1u
+};
+
+/**
+ * @brief Get the names of the capabilities set in a bitmask of controller capabilities (used to log missing capabilities)
+ * @param capabilities The bitmask of capabilities
+ * @return The names of the capabilities, separated by commas
+ */
+inline std::string controller_capability_names(Capabilities capabilities) {
+    static const char * names[] = {"position", "inertial_velocity", "body_velocity", "inertial_acceleration", "attitude", "attitude_rate", "motor_speed"};
+    std::string result;
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (capabilities & (1u << i)) result += (result.empty() ? "" : ", ") + std::string(names[i]);
+    }
+    return result;
+}
+
+/**
+ * @brief Get the names of the capabilities set in a bitmask of trajectory manager capabilities (used to log missing capabilities)
+ * @param capabilities The bitmask of capabilities
+ * @return The names of the capabilities, separated by commas
+ */
+inline std::string trajectory_capability_names(Capabilities capabilities) {
+    static const char * names[] = {"path", "parameter_speed", "vehicle_speed"};
+    std::string result;
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (capabilities & (1u << i)) result += (result.empty() ? "" : ", ") + std::string(names[i]);
+    }
+    return result;
+}
+
+} // namespace autopilot
@@ -58,6 +58,9 @@
 
 // Pegasus imports
 #include "state.hpp"
+#include "capabilities.hpp"
+#include "tick_context.hpp"
+#include "trajectory_manager.hpp"
 
 namespace autopilot {
 
@@ -74,7 +77,7 @@ public:
         rclcpp::Node::SharedPtr node;                                           // ROS 2 node ptr (in case the mode needs to create publishers, subscribers, etc.)
         std::function<State()> get_vehicle_state;                               // Function pointer to get the current state of the vehicle      
         std::function<VehicleStatus()> get_vehicle_status;                      // Function pointer to get the current status of the vehicle  
-        std::function<VehicleConstants()> get_vehicle_constants;                // Function pointer to get the current dynamical constants of the vehicle    
+        std::function<const VehicleConstants &()> get_vehicle_constants;        // Function pointer to get the current dynamical constants of the vehicle    
     };
 
     inline void initialize_controller(const Controller::Config & config) {
@@ -100,42 +103,105 @@ public:
      */
     virtual void reset_controller() {};
 
+    /**
+     * @brief Method called by the autopilot when the controller is loaded, to check that it can track the commands of every
+     * operation mode before the control loop starts. If not implemented, the controller is assumed to support every command
+     * (the commands that are not implemented still return ControlStatus::NOT_SUPPORTED, which makes the autopilot fallback)
+     * @return The bitmask of ControllerCapability flags with the commands implemented by the controller
+     */
+    virtual Capabilities capabilities() const { return CONTROL_ALL; }
+
     /** 
-     * @brief Sets the target position of the vehicle in the inertial frame and the target yaw (in degres)
+     * @brief Sets the target position of the vehicle in the inertial frame and the target yaw (in degres).
+     * All the commands below are called in the control loop, so they must not throw. Instead, they report whether the command
+     * was accepted, and the autopilot enters the fallback mode of the current mode if it was not
      * @param position The target position in the inertial frame
      * @param yaw The target yaw in degrees
+     * @return ControlStatus::OK if the command was accepted, ControlStatus::NOT_SUPPORTED if not implemented by the controller
     */
-   virtual void set_position(const Eigen::Vector3d & position, double yaw, double dt) {
-        set_position(position, yaw, 0.0, dt);
+   virtual ControlStatus set_position(const Eigen::Vector3d & position, double yaw, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return set_position(position, yaw, 0.0, *forwarded_context_);
+        return set_position(position, yaw, 0.0, dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, double yaw, double yaw_rate, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return set_position(position, Eigen::Vector3d::Zero(), yaw, yaw_rate, *forwarded_context_);
+        return set_position(position, Eigen::Vector3d::Zero(), yaw, yaw_rate, dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, double yaw, double yaw_rate, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return set_position(position, velocity, Eigen::Vector3d::Zero(), yaw, yaw_rate, *forwarded_context_);
+        return set_position(position, velocity, Eigen::Vector3d::Zero(), yaw, yaw_rate, dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, double yaw, double yaw_rate, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return set_position(position, velocity, acceleration, Eigen::Vector3d::Zero(3), yaw, yaw_rate, *forwarded_context_);
+        return set_position(position, velocity, acceleration, Eigen::Vector3d::Zero(3), yaw, yaw_rate, dt);
     }
 
-    virtual void set_position(const Eigen::Vector3d& position, double yaw, double yaw_rate, double dt) {
-        set_position(position, Eigen::Vector3d::Zero(), yaw, yaw_rate, dt);
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, double yaw, double yaw_rate, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return set_position(position, velocity, acceleration, jerk, Eigen::Vector3d::Zero(3), yaw, yaw_rate, *forwarded_context_);
+        return set_position(position, velocity, acceleration, jerk, Eigen::Vector3d::Zero(3), yaw, yaw_rate, dt);
     }
 
-    virtual void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, double yaw, double yaw_rate, double dt) {
-        set_position(position, velocity, Eigen::Vector3d::Zero(), yaw, yaw_rate, dt);
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept {
+        if (forwarded_context_ != nullptr) return ControlStatus::NOT_SUPPORTED;
+        return set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, make_tick_context(dt));
     }
 
-    virtual void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, double yaw, double yaw_rate, double dt) {
-        set_position(position, velocity, acceleration, Eigen::Vector3d::Zero(3), yaw, yaw_rate, dt);
+    /** 
+     * @brief Same as the set_position methods above, but receive the snapshot of the vehicle captured at the beginning of 
+     * the control loop iteration, instead of the time step. Each of these methods falls back to the version with the same 
+     * arguments that receives the time step, which falls back to the next version with the context (until one of them is 
+     * implemented by the controller). Controllers can override any of them, with either the context or the time step
+     * @param ctx The context of the current control loop iteration
+    */
+    virtual ControlStatus set_position(const Eigen::Vector3d & position, double yaw, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, yaw, ctx.dt);
     }
 
-    virtual void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, double yaw, double yaw_rate, double dt) {
-        set_position(position, velocity, acceleration, jerk, Eigen::Vector3d::Zero(3), yaw, yaw_rate, dt);
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, yaw, yaw_rate, ctx.dt);
     }
 
-    virtual void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) {
-        throw std::runtime_error("set_position() not implemented in derived class");
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, velocity, yaw, yaw_rate, ctx.dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, velocity, acceleration, yaw, yaw_rate, ctx.dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, velocity, acceleration, jerk, yaw, yaw_rate, ctx.dt);
+    }
+
+    virtual ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+        const ForwardedContext forward(*this, ctx);
+        return set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, ctx.dt);
     }
 
+    /**
+     * @brief Provides the trajectory that the vehicle is following, such that controllers which predict the future references
+     * (e.g. model predictive controllers) can sample it over their horizon. It is only valid for the next call to set_position,
+     * in the same iteration of the control loop. If not implemented, it does nothing.
+     * @param trajectory_manager The trajectory manager with the trajectory being followed
+     * @param gamma The value of the parameter of the trajectory that corresponds to the next position reference
+     */
+    virtual void set_trajectory_preview(const std::shared_ptr<TrajectoryManager> & trajectory_manager, double gamma) noexcept {}
+
     /**
      * @brief Sets the target velocity of the vehicle in the inertial frame and the target yaw rate (in degres/s)
      * @param velocity The target velocity in the inertial frame (m/s NED)
      * @param yaw_rate The target yaw in degrees
     */
-    virtual void set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt=0) {
-        throw std::runtime_error("set_inertial_velocity() not implemented in derived class");
+    virtual ControlStatus set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
     }
 
     /**
@@ -143,16 +209,16 @@ public:
      * @param position The target position in the body frame (m/s f.r.d)
      * @param yaw The target yaw-rate in degrees/s
     */
-    virtual void set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt=0) {
-        throw std::runtime_error("set_body_velocity() not implemented in derived class");
+    virtual ControlStatus set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
     }
 
     /**
      * @brief Set the inertial acceleration (Ax, Ay, Az) (m/s^2) of the vehicle. The adopted frame is NED 
      * @param acceleration The target acceleration in the inertial frame (NED)
      */
-    virtual void set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt=0) {
-        throw std::runtime_error("set_acceleration() not implemented in derived class");
+    virtual ControlStatus set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
     }
 
     /**
@@ -160,8 +226,8 @@ public:
      * @param attitude The target attitude in the body frame (in degrees)
      * @param thrust_force The target thrust force (in Newton)
     */
-    virtual void set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) {
-        throw std::runtime_error("set_attitude() not implemented in derived class");
+    virtual ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
     }
 
     /**
@@ -169,26 +235,90 @@ public:
      * @param attitude_rate The target attitude rate in the body frame (in degrees/s)
      * @param thrust_force The target thrust force (in Newton)
     */
-    virtual void set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) {
-        throw std::runtime_error("set_attitude_rate() not implemented in derived class");
+    virtual ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
     }
 
     /**
      * @brief Sets the target motor speed of the vehicle (from 0-100%)
     */
-    virtual void set_motor_speed(const Eigen::VectorXd& motor_velocity, double dt=0) {
-        throw std::runtime_error("set_motor_velocity() not implemented in derived class");
+    virtual ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, double dt=0) noexcept {
+        return ControlStatus::NOT_SUPPORTED;
+    }
+
+    /**
+     * @brief Same as the methods above, but receive the context of the current control loop iteration instead of the time step.
+     * By default, they fallback to the versions that receive the time step
+     */
+    virtual ControlStatus set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, const TickContext & ctx) noexcept {
+        return set_inertial_velocity(velocity, yaw, ctx.dt);
+    }
+
+    virtual ControlStatus set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, const TickContext & ctx) noexcept {
+        return set_body_velocity(velocity, yaw_rate, ctx.dt);
+    }
+
+    virtual ControlStatus set_inertial_acceleration(const Eigen::Vector3d& acceleration, const TickContext & ctx) noexcept {
+        return set_inertial_acceleration(acceleration, ctx.dt);
+    }
+
+    virtual ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, const TickContext & ctx) noexcept {
+        return set_attitude(attitude, thrust_force, ctx.dt);
+    }
+
+    virtual ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, const TickContext & ctx) noexcept {
+        return set_attitude_rate(attitude_rate, thrust_force, ctx.dt);
+    }
+
+    virtual ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, const TickContext & ctx) noexcept {
+        return set_motor_speed(motor_velocity, ctx.dt);
     }
 
 protected:
 
+    /**
+     * @brief Captures a context from the getter functions. Used by controllers that implement the methods which receive 
+     * a TickContext, to also support the methods that only receive the time step
+     * @param dt The time step (in seconds)
+     * @return The context with the current state, status and constants of the vehicle
+     */
+    inline TickContext make_tick_context(double dt) {
+
+        // Reuse the snapshot of the iteration, if called while forwarding a method that received the context
+        if (forwarded_context_ != nullptr) {
+            TickContext ctx = *forwarded_context_;
+            ctx.dt = dt;
+            return ctx;
+        }
+        return TickContext{get_vehicle_state(), get_vehicle_status(), get_vehicle_constants(), dt, node_->get_clock()->now()};
+    }
+
     // The ROS 2 node
     rclcpp::Node::SharedPtr node_{nullptr};
 
     // Function pointer which will be instantiated with the function pointers passed in the configuration
     std::function<State()> get_vehicle_state{nullptr};
     std::function<VehicleStatus()> get_vehicle_status{nullptr};
-    std::function<VehicleConstants()> get_vehicle_constants{nullptr};
+    std::function<const VehicleConstants &()> get_vehicle_constants{nullptr};
+
+private:
+
+    /**
+     * @brief Keeps the context of the iteration while a set_position method that received it falls back to the version with
+     * the time step, such that the versions with the time step continue to the versions with the context (and make_tick_context
+     * returns the same snapshot of the vehicle)
+     */
+    struct ForwardedContext {
+        ForwardedContext(Controller & controller, const TickContext & ctx) : controller_(controller), previous_(controller.forwarded_context_) { 
+            controller_.forwarded_context_ = &ctx; 
+        }
+        ~ForwardedContext() { controller_.forwarded_context_ = previous_; }
+        Controller & controller_;
+        const TickContext * previous_;
+    };
+
+    // The context being forwarded to the set_position methods that receive the time step (only set during the call)
+    const TickContext * forwarded_context_{nullptr};
 };
 
 } // namespace autopilot
\ No newline at end of file
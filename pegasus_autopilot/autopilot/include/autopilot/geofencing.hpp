@@ -48,6 +48,7 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 #include <functional>
 
 // ROS imports
@@ -55,6 +56,7 @@
 
 // Pegasus imports 
 #include "state.hpp"
+#include "tick_context.hpp"
 
 namespace autopilot {
 
@@ -71,7 +73,7 @@ public:
         rclcpp::Node::SharedPtr node;                                           // ROS 2 node ptr (in case the mode needs to create publishers, subscribers, etc.)
         std::function<State()> get_vehicle_state;                               // Function pointer to get the current state of the vehicle
         std::function<VehicleStatus()> get_vehicle_status;                      // Function pointer to get the current status of the vehicle
-        std::function<VehicleConstants()> get_vehicle_constants;                // Function pointer to get the current constants of the vehicle
+        std::function<const VehicleConstants &()> get_vehicle_constants;        // Function pointer to get the current constants of the vehicle
     };
 
     // Custom constructor like function - as we must have the default constructor for the pluginlib
@@ -96,7 +98,19 @@ public:
      * @brief Checks if a geofencing violation has ocurred.
      * @return true if a geofencing violation has ocurred, false otherwise
      */
-    virtual bool check_geofencing_violation() = 0;
+    virtual bool check_geofencing_violation() {
+        throw std::runtime_error("check_geofencing_violation() not implemented in derived class");
+    }
+
+    /** 
+     * @brief Checks if a geofencing violation has ocurred, using the snapshot of the vehicle captured at the beginning
+     * of the control loop iteration. By default, it fallbacks to the method without arguments
+     * @param ctx The context of the current control loop iteration
+     * @return true if a geofencing violation has ocurred, false otherwise
+     */
+    virtual bool check_geofencing_violation(const TickContext & ctx) {
+        return check_geofencing_violation();
+    }
 
 protected:
 
@@ -106,7 +120,7 @@ protected:
     // Function pointers
     std::function<State()> get_vehicle_state_;
     std::function<VehicleStatus()> get_vehicle_status_;
-    std::function<VehicleConstants()> get_vehicle_constants_;
+    std::function<const VehicleConstants &()> get_vehicle_constants_;
 };
 
 } // namespace autopilot
\ No newline at end of file
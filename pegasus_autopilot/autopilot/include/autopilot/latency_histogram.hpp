@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <bit>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+namespace autopilot {
+
+/**
+ * @brief Fixed-size histogram (in the style of HDR histograms) to record latencies in nanoseconds without allocating memory.
+ * Values smaller than SUB_BUCKETS are stored exactly. Above that, each power of two is split into SUB_BUCKETS linear buckets,
+ * so the relative error of the reported percentiles is bounded by 1/SUB_BUCKETS. Values are recorded by a single writer thread
+ * (the control loop) and can be read at any time by other threads (e.g. to publish a summary)
+ */
+class LatencyHistogram {
+
+public:
+
+    static constexpr unsigned int SUB_BITS{4};
+    static constexpr std::uint64_t SUB_BUCKETS{1u << SUB_BITS};
+    static constexpr unsigned int MAX_EXPONENT{36};                                   // Values above 2^37 ns (~137 s) are clamped
+    static constexpr std::uint64_t MAX_VALUE{(std::uint64_t{1} << (MAX_EXPONENT + 1)) - 1};
+    static constexpr std::size_t NUM_BUCKETS{(MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS};
+
+    /**
+     * @brief Record a new value. Must only be called by a single writer thread
+     * @param value The value to record (in nanoseconds)
+     */
+    inline void record(std::uint64_t value) {
+        value = std::min(value, MAX_VALUE);
+        std::atomic<std::uint64_t> & bucket = counts_[bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed)) max_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Clear all the recorded values. Must only be called by the writer thread
+     */
+    inline void reset() {
+        for (auto & bucket : counts_) bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the value below which a given percentage of the recorded values fall
+     * @param percentile The percentile in the interval [0, 100]
+     * @return The highest value equivalent to the bucket that contains the percentile (in nanoseconds)
+     */
+    inline std::uint64_t percentile(double percentile) const {
+
+        // Get the number of values that must be below the percentile
+        const std::uint64_t total = count();
+        if (total == 0) return 0;
+        const std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(percentile / 100.0 * total + 0.5));
+
+        // Walk the buckets until that number of values is reached
+        std::uint64_t accumulated = 0;
+        for (std::size_t i = 0; i < NUM_BUCKETS; i++) {
+            accumulated += counts_[i].load(std::memory_order_relaxed);
+            if (accumulated >= target) return std::min(bucket_upper_value(i), max());
+        }
+        return max();
+    }
+
+    inline std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    inline std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+protected:
+
+    static inline std::size_t bucket_index(std::uint64_t value) {
+
+        // Small values have a bucket of their own
+        if (value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+
+        // Otherwise, use the power of two of the value and the next SUB_BITS most significant bits
+        const unsigned int exponent = std::bit_width(value) - 1;
+        const unsigned int shift = exponent - SUB_BITS;
+        return static_cast<std::size_t>((shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS));
+    }
+
+    static inline std::uint64_t bucket_upper_value(std::size_t index) {
+
+        if (index < SUB_BUCKETS) return index;
+
+        const unsigned int shift = static_cast<unsigned int>(index / SUB_BUCKETS) - 1;
+        const std::uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+        return lower + (std::uint64_t{1} << shift) - 1;
+    }
+
+    std::array<std::atomic<std::uint64_t>, NUM_BUCKETS> counts_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+} // namespace autopilot
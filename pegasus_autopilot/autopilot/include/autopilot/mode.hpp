@@ -48,7 +48,9 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 #include <functional>
+#include <type_traits>
 #include <Eigen/Core>
 
 // ROS imports
@@ -56,7 +58,9 @@
 
 // Pegasus imports
 #include "state.hpp"
+#include "capabilities.hpp"
 #include "controller.hpp"
+#include "tick_context.hpp"
 #include "trajectory_manager.hpp"
 
 namespace autopilot {
@@ -69,12 +73,15 @@ public:
     using UniquePtr = std::unique_ptr<Mode>;
     using WeakPtr = std::weak_ptr<Mode>;
 
+    // Result of an attempt to enter an operation mode
+    enum class EnterResult { SUCCESS, PENDING, FAILED };
+
     // Configuration for the operation mode
     struct Config {
         rclcpp::Node::SharedPtr node;                                           // ROS 2 node ptr (in case the mode needs to create publishers, subscribers, etc.)
         std::function<State()> get_vehicle_state;                               // Function pointer to get the current state of the vehicle      
         std::function<VehicleStatus()> get_vehicle_status;                      // Function pointer to get the current status of the vehicle  
-        std::function<VehicleConstants()> get_vehicle_constants;                // Function pointer to get the current dynamical constants of the vehicle    
+        std::function<const VehicleConstants &()> get_vehicle_constants;        // Function pointer to get the current dynamical constants of the vehicle    
         std::function<void()> signal_mode_finished;                             // Function pointer to signal that the mode has finished operating
         Controller::SharedPtr controller;                                       // Controller to be used by the mode
         TrajectoryManager::SharedPtr trajectory_manager;                        // Trajectory manager that can be used by some modes
@@ -105,7 +112,24 @@ public:
     virtual void initialize() = 0;
     virtual bool enter() = 0;
     virtual bool exit() = 0;
-    virtual void update(double dt) = 0;
+
+    // Asynchronous protocol used by the state machine to enter a mode. If begin_enter() returns PENDING, the previous mode
+    // keeps running and poll_enter() is called at every iteration of the control loop until it returns SUCCESS or FAILED.
+    // If the mode takes longer than its enter_timeout, the state machine calls abort_enter() and keeps the previous mode.
+    // Modes that can enter immediately only need to implement the enter() method
+    virtual EnterResult begin_enter() { return enter() ? EnterResult::SUCCESS : EnterResult::FAILED; }
+    virtual EnterResult poll_enter(const TickContext & ctx) { return EnterResult::SUCCESS; }
+    virtual void abort_enter() {}
+
+    // Method called by the state machine at every iteration of the control loop, with the snapshot of the vehicle
+    // captured at the beginning of the iteration. Modes that do not override it fallback to the update(dt) method
+    virtual void update(const TickContext & ctx) { update(ctx.dt); }
+    virtual void update(double dt) { throw std::runtime_error("update() not implemented in derived class"); }
+
+    // Capabilities that the controller (bitmask of ControllerCapability) and the trajectory manager (bitmask of TrajectoryCapability)
+    // must report for this mode to operate. They are checked by the autopilot when the modes are loaded, before the control loop starts
+    virtual Capabilities required_controller_capabilities() const { return 0; }
+    virtual Capabilities required_trajectory_capabilities() const { return 0; }
 
 protected:
 
@@ -121,10 +145,26 @@ protected:
     // Function pointer which will be instantiated with the function pointers passed in the configuration
     std::function<State()> get_vehicle_state{nullptr};
     std::function<VehicleStatus()> get_vehicle_status{nullptr};
-    std::function<VehicleConstants()> get_vehicle_constants{nullptr};
+    std::function<const VehicleConstants &()> get_vehicle_constants{nullptr};
 
     // Function pointer to signal that the mode has finished operating
     std::function<void()> signal_mode_finished{nullptr};
 };
 
-} // namespace autopilot
\ No newline at end of file
+// Class that declares each of the update methods of a mode (Mode itself if the method is not overridden)
+template <typename C> C mode_update_owner(void (C::*)(double));
+template <typename C> C mode_context_update_owner(void (C::*)(const TickContext &));
+
+// A mode must override at least one of the update methods (either update(const TickContext &) or the legacy update(double))
+template <typename T>
+concept ImplementsModeUpdate = std::is_base_of_v<Mode, T> && (
+    (requires { mode_context_update_owner(&T::update); } && !std::is_same_v<decltype(mode_context_update_owner(&T::update)), Mode>) ||
+    (requires { mode_update_owner(&T::update); } && !std::is_same_v<decltype(mode_update_owner(&T::update)), Mode>));
+
+} // namespace autopilot
+
+// Export an operation mode as a plugin, checking at compile time that it implements one of the update methods
+// (requires <pluginlib/class_list_macros.hpp>)
+#define AUTOPILOT_EXPORT_MODE(ModeClass) \
+    static_assert(autopilot::ImplementsModeUpdate<ModeClass>, #ModeClass " must override update(const TickContext &) or update(double)"); \
+    PLUGINLIB_EXPORT_CLASS(ModeClass, autopilot::Mode)
\ No newline at end of file
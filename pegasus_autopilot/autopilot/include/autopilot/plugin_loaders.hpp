@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <mutex>
+#include <memory>
+
+// Plugin libraries
+#include <pluginlib/class_loader.hpp>
+
+// Pegasus imports
+#include "mode.hpp"
+#include "controller.hpp"
+#include "geofencing.hpp"
+#include "trajectory_manager.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Class loaders for all the plugins used by the autopilot. When running several autopilots in the same process
+ * (one per vehicle), a single instance is shared by all of them, such that the plugin manifests are only parsed and 
+ * each plugin library is only loaded once. The class loaders must outlive all the plugins created through them
+ */
+struct PluginLoaders {
+
+    using SharedPtr = std::shared_ptr<PluginLoaders>;
+
+    PluginLoaders() :
+        mode(std::make_unique<pluginlib::ClassLoader<autopilot::Mode>>("autopilot", "autopilot::Mode")),
+        controller(std::make_unique<pluginlib::ClassLoader<autopilot::Controller>>("autopilot", "autopilot::Controller")),
+        geofencing(std::make_unique<pluginlib::ClassLoader<autopilot::Geofencing>>("autopilot", "autopilot::Geofencing")),
+        trajectory_manager(std::make_unique<pluginlib::ClassLoader<autopilot::TrajectoryManager>>("autopilot", "autopilot::TrajectoryManager")) {}
+
+    // The pluginlib class loaders are not thread-safe, so the autopilots must hold this mutex while creating plugins
+    std::mutex mutex;
+
+    std::unique_ptr<pluginlib::ClassLoader<autopilot::Mode>> mode;
+    std::unique_ptr<pluginlib::ClassLoader<autopilot::Controller>> controller;
+    std::unique_ptr<pluginlib::ClassLoader<autopilot::Geofencing>> geofencing;
+    std::unique_ptr<pluginlib::ClassLoader<autopilot::TrajectoryManager>> trajectory_manager;
+};
+
+} // namespace autopilot
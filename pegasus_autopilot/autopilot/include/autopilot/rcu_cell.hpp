@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace autopilot {
+
+/**
+ * @brief Read-copy-update cell with a single reader (the control loop) and any number of writers. The writers build a new
+ * immutable copy of the value and publish it with an atomic pointer swap, such that the reader never blocks, allocates or 
+ * copies the value. The previous copies are freed by the writers once the reader has moved past them (the reader publishes
+ * the version it is using), so that values can be replaced an unbounded number of times, e.g. when tuning gains in flight.
+ * The reader only moves past a copy when it calls read(), so a reader that does not use the value every iteration should
+ * still call read() once per iteration (otherwise every copy published in the meantime is kept alive)
+ */
+template <typename T>
+class RcuCell {
+
+public:
+
+    RcuCell() { publish(T{}); }
+    explicit RcuCell(const T & value) { publish(value); }
+
+    RcuCell(const RcuCell &) = delete;
+    RcuCell & operator=(const RcuCell &) = delete;
+
+    /**
+     * @brief Publish a new value to the reader. Can be called from any thread (it allocates memory and may take a lock,
+     * so it should not be called from the control loop)
+     * @param value The new value
+     */
+    void publish(const T & value) {
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Free the copies older than the one being used by the reader (the last copy is never freed)
+        const std::uint64_t in_use = reader_version_.load(std::memory_order_acquire);
+        while (copies_.size() > 1 && copies_.front()->version < in_use) copies_.pop_front();
+
+        // Build the new copy and make it visible to the reader
+        copies_.push_back(std::make_unique<Copy>(Copy{value, ++last_version_}));
+        current_.store(copies_.back().get(), std::memory_order_release);
+    }
+
+    /**
+     * @brief Get the last value published. Must only be called by the reader thread. The reference
+     * remains valid until the next call to read()
+     * @return const T& The last value published
+     */
+    inline const T & read() {
+        const Copy * copy = current_.load(std::memory_order_acquire);
+
+        // Let the writers know that the previous copies are no longer in use (only when a new copy was published)
+        if (copy->version != read_version_) {
+            reader_version_.store(copy->version, std::memory_order_release);
+            read_version_ = copy->version;
+        }
+        return copy->value;
+    }
+
+    /**
+     * @brief Get the version of the value returned by the last call to read() (it increases with every value published).
+     * Can be used by the reader to check if the value changed since it was last applied
+     * @return std::uint64_t The version of the last value read
+     */
+    inline std::uint64_t read_version() const { return read_version_; }
+
+private:
+
+    struct Copy {
+        T value;
+        std::uint64_t version;
+    };
+
+    // Copies that may still be in use by the reader (protected by the mutex of the writers)
+    std::mutex mutex_;
+    std::deque<std::unique_ptr<Copy>> copies_;
+    std::uint64_t last_version_{0};
+
+    // The last copy published and the version of the copy being used by the reader
+    std::atomic<const Copy *> current_{nullptr};
+    std::atomic<std::uint64_t> reader_version_{0};
+
+    // Version returned by the last read (only accessed by the reader)
+    std::uint64_t read_version_{0};
+};
+
+}
@@ -47,18 +47,80 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
 #include <Eigen/Dense>
 
 namespace autopilot {
 
+/**
+ * @brief Floating point type used in the control math of the autopilot (controllers and PIDs). The autopilot
+ * is built in single precision (float) when the AUTOPILOT_SINGLE_PRECISION option is enabled in CMake
+ */
+#ifdef AUTOPILOT_SINGLE_PRECISION
+using Scalar = float;
+#else
+using Scalar = double;
+#endif
+
 // State of the vehicle
-struct State {
-    Eigen::Vector3d position{Eigen::Vector3d::Zero()};           // Position of the vehicle (FRD) in the world frame NED
-    Eigen::Vector3d velocity{Eigen::Vector3d::Zero()};           // Velocity of the vehicle (FRD) with respect to the world frame NED expressed in the world frame NED
-    Eigen::Quaterniond attitude{1.0, 0.0, 0.0, 0.0};             // Attitude of the vehicle (FRD) with respect to the world frame NED expressed in the world frame NED
-    Eigen::Vector3d angular_velocity{Eigen::Vector3d::Zero()};   // Angular velocity of the vehicle (FRD) with respect to the world frame NED expressed in the body frame FRD
+template <typename T>
+struct StateT {
+    Eigen::Matrix<T, 3, 1> position{Eigen::Matrix<T, 3, 1>::Zero()};          // Position of the vehicle (FRD) in the world frame NED
+    Eigen::Matrix<T, 3, 1> velocity{Eigen::Matrix<T, 3, 1>::Zero()};          // Velocity of the vehicle (FRD) with respect to the world frame NED expressed in the world frame NED
+    Eigen::Quaternion<T> attitude{T(1), T(0), T(0), T(0)};                     // Attitude of the vehicle (FRD) with respect to the world frame NED expressed in the world frame NED
+    Eigen::Matrix<T, 3, 1> angular_velocity{Eigen::Matrix<T, 3, 1>::Zero()};  // Angular velocity of the vehicle (FRD) with respect to the world frame NED expressed in the body frame FRD
+    std::int64_t stamp{0};                                                      // Time at which the state was measured (in nanoseconds). 0 if unknown
+
+    /**
+     * @brief Convert the state to another floating point type (e.g. to run the controllers in single precision)
+     * @tparam U The floating point type of the converted state
+     * @return StateT<U> The converted state
+     */
+    template <typename U>
+    StateT<U> cast() const {
+        StateT<U> state;
+        state.position = position.template cast<U>();
+        state.velocity = velocity.template cast<U>();
+        state.attitude = attitude.template cast<U>();
+        state.angular_velocity = angular_velocity.template cast<U>();
+        state.stamp = stamp;
+        return state;
+    }
 };
 
+// State of the vehicle, as received from and exchanged with ROS 2 (always in double precision)
+using State = StateT<double>;
+
+/**
+ * @brief Propagate the state of the vehicle forward in time, assuming constant linear velocity (in the world frame)
+ * and constant angular velocity (in the body frame). Used to compensate for the latency of the state measurements
+ * @param state The state of the vehicle
+ * @param horizon The time to propagate the state forward (in seconds)
+ * @return The predicted state of the vehicle
+ */
+template <typename T>
+inline StateT<T> predict_state(const StateT<T> & state, T horizon) {
+
+    StateT<T> predicted = state;
+
+    // Constant velocity model for the position
+    predicted.position += state.velocity * horizon;
+
+    // Constant body rate model for the attitude (integrated exactly on SO(3))
+    const T angle = state.angular_velocity.norm() * horizon;
+    if (angle > T(1e-9)) {
+        predicted.attitude = (state.attitude * Eigen::Quaternion<T>(Eigen::AngleAxis<T>(angle, state.angular_velocity.normalized()))).normalized();
+    }
+
+    // The predicted state corresponds to a later time instant
+    predicted.stamp = state.stamp + static_cast<std::int64_t>(horizon * T(1.0e9));
+    return predicted;
+}
+
 // Status of the vehicle
 struct VehicleStatus {
     bool armed{false};      // Whether the vehicle is armed
@@ -75,6 +137,66 @@ struct VehicleConstants {
     std::vector<double> thrust_curve_values{std::vector<double>()};           // Thrust curve values associated with the parameters
 };
 
+/**
+ * @brief Single-writer/multi-reader sequence lock. The writer never blocks and the readers
+ * retry until they copy a consistent snapshot, without taking a mutex. Since a reader may copy
+ * a value that is being overwritten (and then discard it), it is only meant for plain data types
+ * that do not own heap memory, such as State and VehicleStatus
+ */
+template <typename T>
+class SeqLock {
+
+    static_assert(std::is_trivially_destructible_v<T>, "SeqLock can only hold plain data types");
+
+public:
+
+    SeqLock() = default;
+    explicit SeqLock(const T & value) : value_(value) {}
+
+    /**
+     * @brief Write a new value. Must only be called by a single writer thread
+     * @param value The new value to store
+     */
+    void store(const T & value) {
+
+        // Mark the value as being written (odd sequence number)
+        std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Write the value and mark it as consistent again (even sequence number)
+        value_ = value;
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Read a consistent snapshot of the value. Can be called by any number of threads
+     * @return A copy of the last value written
+     */
+    T load() const {
+
+        T value;
+        std::uint64_t start, end;
+
+        do {
+            // Wait until no write is in progress
+            while ((start = sequence_.load(std::memory_order_acquire)) & 1) {}
+
+            // Copy the value and check that no write happened in the meantime
+            value = value_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            end = sequence_.load(std::memory_order_relaxed);
+        } while (start != end);
+
+        return value;
+    }
+
+private:
+
+    std::atomic<std::uint64_t> sequence_{0};
+    T value_{};
+};
+
 }
 
 
@@ -0,0 +1,206 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Publisher of the debug statistics of a controller (or any other component that runs in the control loop). 
+ * It decides, in every iteration, whether the statistics should be computed at all: they are only computed once every 
+ * "decimation" iterations, and only if someone is subscribed to the topic. The statistics can either be published
+ * right away, or accumulated in a ring buffer (without allocating memory) and published in batches by a timer, 
+ * such that the control loop never writes to the middleware while the full-rate data is still available (e.g. for PlotJuggler).
+ * 
+ * The following parameters are read, under the given prefix:
+ *  - <prefix>.statistics.decimation: Compute the statistics once every N iterations (1 to compute them in every iteration)
+ *  - <prefix>.statistics.batch.enabled: Whether to accumulate the statistics and publish them in batches
+ *  - <prefix>.statistics.batch.capacity: Maximum number of samples waiting to be published (samples are dropped when full)
+ *  - <prefix>.statistics.batch.publish_rate: Rate (in Hz) at which the batches are published
+ * 
+ * The control loop (a single thread) calls sample(), fills the message and calls publish(). The batches are published by 
+ * the executor of the node, which may run in a different thread.
+ */
+template <typename MessageT>
+class StatisticsPublisher {
+
+public:
+
+    using UniquePtr = std::unique_ptr<StatisticsPublisher>;
+
+    /**
+     * @brief Construct a new statistics publisher
+     * @param node The ROS 2 node used to create the publisher, the timer and read the parameters
+     * @param topic The topic where the statistics are published
+     * @param parameter_prefix The prefix of the parameters of the publisher (e.g. "autopilot.MellingerController")
+     */
+    StatisticsPublisher(const rclcpp::Node::SharedPtr & node, const std::string & topic, const std::string & parameter_prefix) : node_(node) {
+
+        // Read the configuration of the publisher
+        node_->declare_parameter<int>(parameter_prefix + ".statistics.decimation", 1);
+        node_->declare_parameter<bool>(parameter_prefix + ".statistics.batch.enabled", false);
+        node_->declare_parameter<int>(parameter_prefix + ".statistics.batch.capacity", 100);
+        node_->declare_parameter<double>(parameter_prefix + ".statistics.batch.publish_rate", 5.0);
+
+        decimation_ = std::max<std::int64_t>(1, node_->get_parameter(parameter_prefix + ".statistics.decimation").as_int());
+        const bool batch = node_->get_parameter(parameter_prefix + ".statistics.batch.enabled").as_bool();
+        const std::size_t capacity = static_cast<std::size_t>(std::max<std::int64_t>(1, node_->get_parameter(parameter_prefix + ".statistics.batch.capacity").as_int()));
+        const double publish_rate = node_->get_parameter(parameter_prefix + ".statistics.batch.publish_rate").as_double();
+
+        // Keep all the samples of a batch in the history of the publisher, such that they are not overwritten before being sent
+        publisher_ = node_->create_publisher<MessageT>(topic, rclcpp::QoS(batch ? capacity : 1));
+
+        // Preallocate the ring buffer and start publishing the batches
+        if (batch) {
+            if (publish_rate <= 0.0) throw std::runtime_error("The publish rate of the batches of statistics must be positive");
+            ring_.resize(capacity);
+            timer_ = node_->create_wall_timer(std::chrono::duration<double>(1.0 / publish_rate), std::bind(&StatisticsPublisher::flush, this));
+        }
+    }
+
+    /**
+     * @brief Must be called once per iteration of the control loop, before computing the statistics
+     * @return Whether the statistics should be computed (and published) in this iteration
+     */
+    inline bool sample() {
+
+        // Only compute the statistics once every "decimation" iterations
+        if (++iteration_ < decimation_) return false;
+        iteration_ = 0;
+
+        // Skip all the work if no one is listening
+        return publisher_->get_subscription_count() > 0;
+    }
+
+    /**
+     * @brief Get the message to be filled with the statistics of the current iteration
+     * @return MessageT& A reference to the message
+     */
+    inline MessageT & message() { return message_; }
+
+    /**
+     * @brief Publish the message filled with the statistics of the current iteration (or queue it to be published in the next batch)
+     * @param stamp The time at which the statistics were computed (used to stamp the message, if it has a header)
+     */
+    void publish(const rclcpp::Time & stamp) {
+
+        // Stamp the message, such that the samples can be plotted with the correct time even if they arrive in batches
+        if constexpr (requires (MessageT m, rclcpp::Time t) { m.header.stamp = t; }) message_.header.stamp = stamp;
+
+        // Publish the message right away
+        if (ring_.empty()) {
+            publisher_->publish(message_);
+            return;
+        }
+
+        // Otherwise, copy the message to the ring buffer (dropping the sample if the buffer is full)
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= ring_.size()) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ring_[head % ring_.size()] = message_;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+private:
+
+    /**
+     * @brief Publish all the samples accumulated in the ring buffer. Called periodically by the timer
+     */
+    void flush() {
+
+        // Publish the samples written by the control loop since the last batch
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        for (; tail != head; tail++) publisher_->publish(ring_[tail % ring_.size()]);
+        tail_.store(tail, std::memory_order_release);
+
+        // Warn if the buffer was not large enough to hold all the samples between batches
+        const std::uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            RCLCPP_WARN_STREAM_THROTTLE(node_->get_logger(), steady_clock_, 5000, "Dropped " << dropped << " samples of statistics. Increase the capacity or the publish rate of the batches");
+        }
+    }
+
+    // The ROS 2 node and publisher
+    rclcpp::Node::SharedPtr node_{nullptr};
+    typename rclcpp::Publisher<MessageT>::SharedPtr publisher_{nullptr};
+    rclcpp::TimerBase::SharedPtr timer_{nullptr};
+
+    // Clock used to throttle the warnings about the dropped samples
+    rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
+
+    // The message filled by the control loop
+    MessageT message_;
+
+    // Decimation of the statistics
+    std::int64_t decimation_{1};
+    std::int64_t iteration_{0};
+
+    // Ring buffer of the samples waiting to be published (empty if the batches are disabled). The control loop writes 
+    // the samples at the head and the timer publishes them from the tail
+    std::vector<MessageT> ring_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+} // namespace autopilot
@@ -0,0 +1,212 @@
+/*****************************************************************************
+ *
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this
+ * software must display the following acknowledgement: This product
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only.
+ * This includes, but is not limited to, academic research, personal
+ * projects, and non-profit organizations. Any commercial use of the
+ * Software is strictly prohibited without prior written permission
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for
+ * military purposes, including but not limited to the development
+ * of weapons, military simulations, or any other military applications.
+ * Any military use of the Software is strictly prohibited without
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes,
+ * with the condition that proper acknowledgment is given in all
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <chrono>
+#include "controller.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Controller that forwards every command to the controller loaded by the autopilot and accumulates the time spent in it.
+ * It is handed to the operation modes instead of the loaded controller, such that the autopilot can measure how much of each
+ * iteration of the control loop is spent in the controller, without requiring any changes to the controller plugins.
+ * It also keeps the first command rejected by the controller, such that the autopilot can enter the fallback mode
+ */
+class TimedController : public Controller {
+
+public:
+
+    explicit TimedController(Controller::SharedPtr controller) : controller_(controller) {}
+
+    /**
+     * @brief Get the time spent in the controller since the last call to reset_elapsed()
+     * @return The accumulated time
+     */
+    inline std::chrono::nanoseconds elapsed() const { return elapsed_; }
+    inline void reset_elapsed() { elapsed_ = std::chrono::nanoseconds::zero(); }
+
+    /**
+     * @brief Get the first command rejected by the controller since the last call to reset_status()
+     * @return ControlStatus::OK if every command was accepted, or the status of the first one that was not
+     */
+    inline ControlStatus status() const { return status_; }
+    inline void reset_status() { status_ = ControlStatus::OK; }
+
+    void initialize() override {}
+    void reset_controller() override {
+        const auto start = std::chrono::steady_clock::now();
+        controller_->reset_controller();
+        elapsed_ += std::chrono::steady_clock::now() - start;
+    }
+
+    Capabilities capabilities() const override { return controller_->capabilities(); }
+
+    ControlStatus set_position(const Eigen::Vector3d & position, double yaw, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, yaw, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, double yaw, double yaw_rate, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, yaw, yaw_rate, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, double yaw, double yaw_rate, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, yaw, yaw_rate, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, double yaw, double yaw_rate, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, yaw, yaw_rate, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, double yaw, double yaw_rate, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, jerk, yaw, yaw_rate, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, dt); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d & position, double yaw, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, yaw, ctx); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, double yaw, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, yaw, yaw_rate, ctx); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, double yaw, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, yaw, yaw_rate, ctx); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, double yaw, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, yaw, yaw_rate, ctx); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, double yaw, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, jerk, yaw, yaw_rate, ctx); });
+    }
+
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, ctx); });
+    }
+
+    void set_trajectory_preview(const std::shared_ptr<TrajectoryManager> & trajectory_manager, double gamma) noexcept override {
+        controller_->set_trajectory_preview(trajectory_manager, gamma);
+    }
+
+    ControlStatus set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_inertial_velocity(velocity, yaw, dt); });
+    }
+
+    ControlStatus set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_body_velocity(velocity, yaw_rate, dt); });
+    }
+
+    ControlStatus set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_inertial_acceleration(acceleration, dt); });
+    }
+
+    ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_attitude(attitude, thrust_force, dt); });
+    }
+
+    ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_attitude_rate(attitude_rate, thrust_force, dt); });
+    }
+
+    ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, double dt=0) noexcept override {
+        return timed([&] { return controller_->set_motor_speed(motor_velocity, dt); });
+    }
+
+    ControlStatus set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_inertial_velocity(velocity, yaw, ctx); });
+    }
+
+    ControlStatus set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_body_velocity(velocity, yaw_rate, ctx); });
+    }
+
+    ControlStatus set_inertial_acceleration(const Eigen::Vector3d& acceleration, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_inertial_acceleration(acceleration, ctx); });
+    }
+
+    ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_attitude(attitude, thrust_force, ctx); });
+    }
+
+    ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_attitude_rate(attitude_rate, thrust_force, ctx); });
+    }
+
+    ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, const TickContext & ctx) noexcept override {
+        return timed([&] { return controller_->set_motor_speed(motor_velocity, ctx); });
+    }
+
+protected:
+
+    // Run a command of the controller, accumulate the time it took and keep its status if it is the first one rejected
+    template <typename F>
+    inline ControlStatus timed(F && call) noexcept {
+        const auto start = std::chrono::steady_clock::now();
+        const ControlStatus status = call();
+        elapsed_ += std::chrono::steady_clock::now() - start;
+        if (status != ControlStatus::OK && status_ == ControlStatus::OK) status_ = status;
+        return status;
+    }
+
+    // The controller loaded by the autopilot
+    Controller::SharedPtr controller_{nullptr};
+
+    // Time spent in the controller since the last reset
+    std::chrono::nanoseconds elapsed_{0};
+
+    // First command rejected by the controller since the last reset
+    ControlStatus status_{ControlStatus::OK};
+};
+
+} // namespace autopilot
@@ -47,10 +47,13 @@
  ****************************************************************************/
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <Eigen/Core>
 
 #include "state.hpp"
+#include "capabilities.hpp"
+#include "trajectory_sample.hpp"
 
 // ROS imports
 #include "rclcpp/rclcpp.hpp"
@@ -73,7 +76,7 @@ public:
         rclcpp::Node::SharedPtr node;                                           // ROS 2 node ptr (in case the mode needs to create publishers, subscribers, etc.)
         std::function<State()> get_vehicle_state;                               // Function pointer to get the current state of the vehicle      
         std::function<VehicleStatus()> get_vehicle_status;                      // Function pointer to get the current status of the vehicle  
-        std::function<VehicleConstants()> get_vehicle_constants;                // Function pointer to get the current dynamical constants of the vehicle    
+        std::function<const VehicleConstants &()> get_vehicle_constants;        // Function pointer to get the current dynamical constants of the vehicle    
     };
 
     
@@ -91,13 +94,22 @@ public:
 
     virtual void initialize() = 0;
 
+    /**
+     * @brief Method called by the autopilot when the trajectory manager is loaded, to check that it can answer the queries of
+     * every operation mode before the control loop starts. If not implemented, the trajectory manager is assumed to answer all of them.
+     * The queries below are called in the control loop, so they must not throw. The ones that are not implemented return NaN 
+     * (and empty() returns true), so they must not be called unless the corresponding capability is reported
+     * @return The bitmask of TrajectoryCapability flags with the queries implemented by the trajectory manager
+     */
+    virtual Capabilities capabilities() const { return TRAJECTORY_ALL; }
+
     /**
      * @brief This function returns the desired position of the vehicle at a given time
      * provided the parameter gamma which paramaterizes the trajectory
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired position of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d pd(const double gamma) const { throw std::runtime_error("pd() not implemented in TrajectoryManager"); }
+    virtual Eigen::Vector3d pd(const double gamma) const noexcept { return Eigen::Vector3d::Constant(std::numeric_limits<double>::quiet_NaN()); }
 
     /**
      * @brief This function returns the desired velocity of the vehicle at a given time
@@ -105,7 +117,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired velocity of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d_pd(const double gamma) const { return Eigen::Vector3d::Zero(); }
+    virtual Eigen::Vector3d d_pd(const double gamma) const noexcept { return Eigen::Vector3d::Zero(); }
 
     /**
      * @brief This function returns the desired acceleration of the vehicle at a given time
@@ -113,7 +125,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired acceleration of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d2_pd(const double gamma) const { return Eigen::Vector3d::Zero(); }
+    virtual Eigen::Vector3d d2_pd(const double gamma) const noexcept { return Eigen::Vector3d::Zero(); }
 
     /**
      * @brief This function returns the desired jerk of the vehicle at a given time
@@ -121,7 +133,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired jerk of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d3_pd(const double gamma) const { return Eigen::Vector3d::Zero(); }
+    virtual Eigen::Vector3d d3_pd(const double gamma) const noexcept { return Eigen::Vector3d::Zero(); }
 
     /**
      * @brief This function returns the desired snap of the vehicle at a given time
@@ -129,7 +141,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired snap of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d4_pd(const double gamma) const { return Eigen::Vector3d::Zero(); }
+    virtual Eigen::Vector3d d4_pd(const double gamma) const noexcept { return Eigen::Vector3d::Zero(); }
 
     /**
      * @brief This function returns the desired position of the vehicle at any given time
@@ -137,7 +149,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return Eigen::Vector3d The desired position in NED of the vehicle in the inertial frame (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d position(const double gamma) const { 
+    virtual Eigen::Vector3d position(const double gamma) const noexcept { 
         return pd(gamma); 
     }
 
@@ -148,7 +160,7 @@ public:
      * @param d_gamma The first time derivative of the path parameter
      * @return Eigen::Vector3d The desired velocity in NED of the vehicle in the inertial frame (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d velocity(const double gamma, const double d_gamma) const {
+    virtual Eigen::Vector3d velocity(const double gamma, const double d_gamma) const noexcept {
         return d_pd(gamma) * d_gamma;
     }
 
@@ -160,7 +172,7 @@ public:
      * @param d2_gamma The second time derivative of the path parameter
      * @return Eigen::Vector3d The desired acceleration in NED of the vehicle in the inertial frame (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d acceleration(const double gamma, const double d_gamma, const double d2_gamma=0) const {
+    virtual Eigen::Vector3d acceleration(const double gamma, const double d_gamma, const double d2_gamma=0) const noexcept {
         return (d2_pd(gamma) * std::pow(d_gamma, 2)) + (d_pd(gamma) * std::pow(d2_gamma, 2));
     }
 
@@ -173,7 +185,7 @@ public:
      * @param d3_gamma The third time derivative of the path parameter
      * @return Eigen::Vector3d The desired jerk in NED of the vehicle in the inertial frame (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d jerk(const double gamma, const double d_gamma, const double d2_gamma=0, const double d3_gamma=0) const {
+    virtual Eigen::Vector3d jerk(const double gamma, const double d_gamma, const double d2_gamma=0, const double d3_gamma=0) const noexcept {
         return (d3_pd(gamma) * std::pow(d_gamma, 3)) + (3 * d2_pd(gamma) * d_gamma * d2_gamma) + (d_pd(gamma) * d3_gamma);
     }
 
@@ -183,7 +195,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired yaw angle of the vehicle at a given time (radians)
      */
-    virtual double yaw(const double gamma) const { return 0.0; }
+    virtual double yaw(const double gamma) const noexcept { return 0.0; }
 
     /**
      * @brief This function returns the desired yaw rate (in radians/s) of the vehicle at a given time
@@ -191,15 +203,15 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired yaw rate of the vehicle at a given time (radians/s)
      */
-    virtual double d_yaw(const double gamma) const { return 0.0; }
+    virtual double d_yaw(const double gamma) const noexcept { return 0.0; }
 
     /**
      * @brief This function returns the vehicle speed in m/s at any given position in the trajectory
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired speed of the vehicle at a given time (double)
      */
-    virtual double vehicle_speed(const double gamma) const {
-        throw std::runtime_error("vehicle_speed() not implemented in TrajectoryManager");
+    virtual double vehicle_speed(const double gamma) const noexcept {
+        return std::numeric_limits<double>::quiet_NaN();
     }
     
     /**
@@ -208,8 +220,8 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired speed of the vehicle at a given time (double)
      */
-    virtual double vd(const double gamma) const {
-        throw std::runtime_error("vd() not implemented in TrajectoryManager");
+    virtual double vd(const double gamma) const noexcept {
+        return std::numeric_limits<double>::quiet_NaN();
     }
 
     /**
@@ -218,7 +230,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired acceleration of the vehicle at a given time (double)
      */
-    virtual double d_vd(const double gamma) const { return 0.0; }
+    virtual double d_vd(const double gamma) const noexcept { return 0.0; }
 
     /**
      * @brief This function returns the desired vehicle jerk in the trajectory frame
@@ -226,32 +238,62 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired jerk of the vehicle at a given time (double)
      */
-    virtual double d2_vd(const double gamma) const { return 0.0; }
+    virtual double d2_vd(const double gamma) const noexcept { return 0.0; }
+
+    /**
+     * @brief This function returns every quantity of the trajectory at a given value of gamma at once. Trajectory managers
+     * should override it to look up the trajectory section only once per call (the default implementation calls each query)
+     * @param gamma The parameter that paramaterizes the trajectory
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    virtual TrajectorySample sample(const double gamma, const int derivative_order=4) const noexcept {
+        TrajectorySample sample;
+        sample.pd = pd(gamma);
+        if (derivative_order >= 1) sample.d_pd = d_pd(gamma);
+        if (derivative_order >= 2) sample.d2_pd = d2_pd(gamma);
+        if (derivative_order >= 3) sample.d3_pd = d3_pd(gamma);
+        if (derivative_order >= 4) sample.d4_pd = d4_pd(gamma);
+        sample.yaw = yaw(gamma);
+        sample.d_yaw = d_yaw(gamma);
+        sample.vehicle_speed = vehicle_speed(gamma);
+        sample.vd = vd(gamma);
+        sample.d_vd = d_vd(gamma);
+        sample.d2_vd = d2_vd(gamma);
+        return sample;
+    }
 
     /**
      * @brief This function returns the minimum value of the trajectory parameter gamma
      * @return The minimum value of the trajectory parameter gamma (double)
      */
-    virtual double min_gamma() const {
-        throw std::runtime_error("min_gamma() not implemented in TrajectoryManager");
+    virtual double min_gamma() const noexcept {
+        return std::numeric_limits<double>::quiet_NaN();
     }
 
     /**
      * @brief This function returns the maximum value of the trajectory parameter gamma
      * @return The maximum value of the trajectory parameter gamma (double)
      */
-    virtual double max_gamma() const {
-        throw std::runtime_error("max_gamma() not implemented in TrajectoryManager");
+    virtual double max_gamma() const noexcept {
+        return std::numeric_limits<double>::quiet_NaN();
     }
 
     /**
      * @brief This functions returns whether the trajectory is empty or not
      * @return True if the trajectory is empty, false otherwise
      */
-    virtual bool empty() const {
-        throw std::runtime_error("is_empty() not implemented in TrajectoryManager");
+    virtual bool empty() const noexcept {
+        return true;
     }
 
+    /**
+     * @brief Method called by the autopilot once per iteration of the control loop, before the operation mode is updated and
+     * regardless of which mode is active (or whether it uses the trajectory). Runs in the control loop, so it must not block.
+     * Can be used to let the writers know which data is still in use by the control loop (e.g. to free the old trajectories)
+     */
+    virtual void tick() noexcept {}
+
 protected:
 
     // The ROS2 node
@@ -260,7 +302,7 @@ protected:
     // Function pointer to get the current state of the vehicle
     std::function<State()> get_vehicle_state{nullptr};
     std::function<VehicleStatus()> get_vehicle_status{nullptr};
-    std::function<VehicleConstants()> get_vehicle_constants{nullptr};
+    std::function<const VehicleConstants &()> get_vehicle_constants{nullptr};
 };
 
 } // namespace autopilot
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <Eigen/Core>
+
+namespace autopilot {
+
+/**
+ * @brief Every quantity of a trajectory at a given value of the parameter gamma, computed with a single lookup of the
+ * trajectory section (instead of one query per quantity). The derivatives of the position above the requested order are zero
+ */
+struct TrajectorySample {
+    Eigen::Vector3d pd{Eigen::Vector3d::Zero()};        // Desired position (NED)
+    Eigen::Vector3d d_pd{Eigen::Vector3d::Zero()};      // First derivative of the position with respect to gamma
+    Eigen::Vector3d d2_pd{Eigen::Vector3d::Zero()};     // Second derivative of the position with respect to gamma
+    Eigen::Vector3d d3_pd{Eigen::Vector3d::Zero()};     // Third derivative of the position with respect to gamma
+    Eigen::Vector3d d4_pd{Eigen::Vector3d::Zero()};     // Fourth derivative of the position with respect to gamma
+    double yaw{0.0};                                    // Desired yaw angle (radians)
+    double d_yaw{0.0};                                  // Desired yaw rate (radians/s)
+    double vehicle_speed{0.0};                          // Desired speed of the vehicle (m/s)
+    double vd{0.0};                                     // Desired speed in the trajectory frame (d_gamma)
+    double d_vd{0.0};                                   // Desired acceleration in the trajectory frame (d2_gamma)
+    double d2_vd{0.0};                                  // Desired jerk in the trajectory frame (d3_gamma)
+
+    /**
+     * @brief The desired position of the vehicle in the inertial frame (the same as TrajectoryManager::position)
+     */
+    inline const Eigen::Vector3d & position() const { return pd; }
+
+    /**
+     * @brief The desired velocity of the vehicle in the inertial frame (the same as TrajectoryManager::velocity)
+     * @param d_gamma The first time derivative of the path parameter
+     */
+    inline Eigen::Vector3d velocity(const double d_gamma) const {
+        return d_pd * d_gamma;
+    }
+
+    /**
+     * @brief The desired acceleration of the vehicle in the inertial frame (the same as TrajectoryManager::acceleration)
+     * @param d_gamma The first time derivative of the path parameter
+     * @param d2_gamma The second time derivative of the path parameter
+     */
+    inline Eigen::Vector3d acceleration(const double d_gamma, const double d2_gamma=0) const {
+        return (d2_pd * std::pow(d_gamma, 2)) + (d_pd * std::pow(d2_gamma, 2));
+    }
+
+    /**
+     * @brief The desired jerk of the vehicle in the inertial frame (the same as TrajectoryManager::jerk)
+     * @param d_gamma The first time derivative of the path parameter
+     * @param d2_gamma The second time derivative of the path parameter
+     * @param d3_gamma The third time derivative of the path parameter
+     */
+    inline Eigen::Vector3d jerk(const double d_gamma, const double d2_gamma=0, const double d3_gamma=0) const {
+        return (d3_pd * std::pow(d_gamma, 3)) + (3 * d2_pd * d_gamma * d2_gamma) + (d_pd * d3_gamma);
+    }
+};
+
+} // namespace autopilot
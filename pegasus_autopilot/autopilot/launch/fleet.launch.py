@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+import os
+from ament_index_python.packages import get_package_share_directory
+
+from launch import LaunchDescription
+from launch.substitutions import LaunchConfiguration
+from launch.actions import DeclareLaunchArgument
+from launch_ros.actions import Node
+
+def generate_launch_description():
+    
+    # ----------------------------------------
+    # ---- DECLARE THE LAUNCH ARGUMENTS ------
+    # ----------------------------------------
+
+    # Get the name of the .yaml configuration file either from the package or an external source
+    autopilot_yaml_arg = DeclareLaunchArgument(
+        'autopilot_yaml', 
+        default_value=os.path.join(get_package_share_directory('autopilot'), 'config', 'autopilot.yaml'),
+        description='The configurations for the autopilot to run (shared by all the vehicles)')
+    
+    # Get the name of the .yaml file with the vehicles of the fleet (and vehicle specific overrides)
+    fleet_yaml_arg = DeclareLaunchArgument(
+        'fleet_yaml', 
+        default_value=os.path.join(get_package_share_directory('autopilot'), 'config', 'fleet.yaml'),
+        description='The vehicles of the fleet and the parameters specific to each vehicle')
+
+    # Create the process that runs one autopilot per vehicle. The parameter files are passed as global
+    # arguments, such that they apply to all the autopilots created inside the process
+    fleet_node = Node(
+        package='autopilot',
+        executable='autopilot_fleet',
+        output="screen",
+        emulate_tty=True,
+        arguments=[
+            '--ros-args',
+            '--params-file', LaunchConfiguration('autopilot_yaml'),
+            '--params-file', LaunchConfiguration('fleet_yaml')
+        ]
+    )
+        
+    # Return the node to be launched by ROS2
+    return LaunchDescription([
+        # Launch arguments
+        autopilot_yaml_arg,
+        fleet_yaml_arg,
+        # Launch files
+        fleet_node])
@@ -45,12 +45,48 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
+#include <ctime>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <pthread.h>
+#include <sys/mman.h>
+
 #include "autopilot/autopilot.hpp"
 #include "autopilot/mode.hpp"
 
 namespace autopilot {
 
-Autopilot::Autopilot() : Node("pegasus_autopilot") {}
+// Names of the metrics in the performance summary (in the same order as the PerfMetric enum)
+static constexpr const char * PERF_METRIC_NAMES[] = {"tick", "mode", "controller", "geofencing", "publish", "period", "jitter", "state_age", "state_stamp_age"};
+
+// Converts a duration of the steady clock to (non-negative) nanoseconds, to be recorded in the performance histograms
+static inline std::uint64_t to_nanoseconds(std::chrono::steady_clock::duration duration) {
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+}
+
+// Error in the configuration of the autopilot. It stops the initialization of the autopilot (instead of exiting the process, which
+// would also stop the other autopilots loaded in the same process), while the errors of a single mode only skip that mode
+struct ConfigurationError : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+Autopilot::Autopilot(const rclcpp::NodeOptions & options) : Autopilot(options, std::make_shared<PluginLoaders>()) {}
+
+Autopilot::Autopilot(const rclcpp::NodeOptions & options, PluginLoaders::SharedPtr plugin_loaders) :
+    Node("pegasus_autopilot", options), plugin_loaders_(plugin_loaders) {
+
+    // Initialize the ROS 2 interface (the rest of the autopilot is initialized after receiving the vehicle constants)
+    initialize();
+}
+
+Autopilot::~Autopilot() {
+
+    // Stop the real-time control thread (if running) and wait for the last iteration to finish
+    control_thread_running_ = false;
+    if (control_thread_.joinable()) control_thread_.join();
+}
 
 void Autopilot::initialize() {
     
@@ -86,9 +122,6 @@ void Autopilot::initialize_controller() {
     this->declare_parameter<std::string>("autopilot.controller", "");
     rclcpp::Parameter controller_name = this->get_parameter("autopilot.controller");
 
-    // Load the base class that defines the interface for all the controllers
-    controller_loader_ = std::make_unique<pluginlib::ClassLoader<autopilot::Controller>>("autopilot", "autopilot::Controller");
-
     // Setup the configurations for the controller
     controller_config_.node = this->shared_from_this();
     controller_config_.get_vehicle_state = std::bind(&Autopilot::get_state, this);
@@ -101,11 +134,19 @@ void Autopilot::initialize_controller() {
     // Attempt to load the controller
     try {
         // Load the controller and initialize it
-        controller_ = controller_loader_->createSharedInstance("autopilot::" + controller_name.as_string());
+        {
+            std::lock_guard<std::mutex> lock(plugin_loaders_->mutex);
+            controller_ = plugin_loaders_->controller->createSharedInstance("autopilot::" + controller_name.as_string());
+        }
         controller_->initialize_controller(controller_config_);
+
+        // Wrap the controller, such that we can measure the time spent in it by the operation modes
+        timed_controller_ = std::make_shared<TimedController>(controller_);
+
+        // Log the commands that the controller can track
+        RCLCPP_INFO_STREAM(this->get_logger(), "Controller capabilities: " << controller_capability_names(controller_->capabilities()));
     } catch (const std::exception & e) {
-        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while loading controller: " << e.what() << ". Controller: " << controller_name.as_string());
-        std::exit(EXIT_FAILURE);
+        throw ConfigurationError("Exception while loading controller: " + std::string(e.what()) + ". Controller: " + controller_name.as_string());
     }
 }
 
@@ -115,9 +156,6 @@ void Autopilot::initialize_geofencing() {
     this->declare_parameter<std::string>("autopilot.geofencing", "");
     rclcpp::Parameter geofencing_name = this->get_parameter("autopilot.geofencing");
 
-    // Load the base class that defines the interface for all the geofencing mechanisms
-    geofencing_loader_ = std::make_unique<pluginlib::ClassLoader<autopilot::Geofencing>>("autopilot", "autopilot::Geofencing");
-
     // Check if the geofencing mechanism is set to none. If so, do not load any geofencing mechanism
     if (geofencing_name.as_string() != std::string("")) {
 
@@ -133,11 +171,13 @@ void Autopilot::initialize_geofencing() {
         // Attempt to load the geofencing mechanism
         try {
             // Load the geofencing mechanism and initialize it
-            geofencing_ = autopilot::Geofencing::UniquePtr(geofencing_loader_->createUnmanagedInstance("autopilot::" + geofencing_name.as_string()));
+            {
+                std::lock_guard<std::mutex> lock(plugin_loaders_->mutex);
+                geofencing_ = autopilot::Geofencing::UniquePtr(plugin_loaders_->geofencing->createUnmanagedInstance("autopilot::" + geofencing_name.as_string()));
+            }
             geofencing_->initialize_geofencing(geofencing_config_);
         } catch (const std::exception & e) {
-            RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while loading geofencing mechanism: " << e.what() << ". Geofencing mechanism: " << geofencing_name.as_string());
-            std::exit(EXIT_FAILURE);
+            throw ConfigurationError("Exception while loading geofencing mechanism: " + std::string(e.what()) + ". Geofencing mechanism: " + geofencing_name.as_string());
         }
     }
 }
@@ -148,9 +188,6 @@ void Autopilot::initialize_trajectory_manager() {
     this->declare_parameter<std::string>("autopilot.trajectory_manager", "");
     rclcpp::Parameter trajectory_manager_name = this->get_parameter("autopilot.trajectory_manager");
 
-    // Load the base class that defines the interface for all the trajectory managers
-    trajectory_manager_loader_ = std::make_unique<pluginlib::ClassLoader<autopilot::TrajectoryManager>>("autopilot", "autopilot::TrajectoryManager");
-
     // Setup the configurations for the trajectory manager
     trajectory_manager_config_.node = this->shared_from_this();
     trajectory_manager_config_.get_vehicle_state = std::bind(&Autopilot::get_state, this);
@@ -163,11 +200,16 @@ void Autopilot::initialize_trajectory_manager() {
     // Attempt to load the trajectory manager
     try {
         // Load the trajectory manager and initialize it
-        trajectory_manager_ = trajectory_manager_loader_->createSharedInstance("autopilot::" + trajectory_manager_name.as_string());
+        {
+            std::lock_guard<std::mutex> lock(plugin_loaders_->mutex);
+            trajectory_manager_ = plugin_loaders_->trajectory_manager->createSharedInstance("autopilot::" + trajectory_manager_name.as_string());
+        }
         trajectory_manager_->initialize_trajectory_manager(trajectory_manager_config_);
+
+        // Log the queries that the trajectory manager can answer
+        RCLCPP_INFO_STREAM(this->get_logger(), "Trajectory manager capabilities: " << trajectory_capability_names(trajectory_manager_->capabilities()));
     } catch (const std::exception & e) {
-        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while loading trajectory manager: " << e.what() << ". Trajectory manager: " << trajectory_manager_name.as_string());
-        std::exit(EXIT_FAILURE);
+        throw ConfigurationError("Exception while loading trajectory manager: " + std::string(e.what()) + ". Trajectory manager: " + trajectory_manager_name.as_string());
     }
 }
 
@@ -177,98 +219,333 @@ void Autopilot::initialize_operating_modes() {
     this->declare_parameter<std::vector<std::string>>("autopilot.modes", std::vector<std::string>());
     rclcpp::Parameter modes = this->get_parameter("autopilot.modes");
 
-    // Load the base class that defines the interface for all the operation modes
-    mode_loader_ = std::make_unique<pluginlib::ClassLoader<autopilot::Mode>>("autopilot", "autopilot::Mode");
-
     // Setup the operation mode configurations
     mode_config_.node = this->shared_from_this();
     mode_config_.get_vehicle_state = std::bind(&Autopilot::get_state, this);
     mode_config_.get_vehicle_status = std::bind(&Autopilot::get_status, this);
     mode_config_.get_vehicle_constants = std::bind(&Autopilot::get_vehicle_constants, this);
     mode_config_.signal_mode_finished = std::bind(&Autopilot::signal_mode_finished, this);
-    mode_config_.controller = controller_;
+    mode_config_.controller = timed_controller_;
     mode_config_.trajectory_manager = trajectory_manager_;
 
+    // Names of the modes each mode points to, as read from the parameter server. These are only resolved into
+    // mode ids after all the modes are loaded, as a mode can reference another mode that is loaded after it
+    std::vector<std::vector<std::string>> valid_transitions;
+    std::vector<std::string> fallback_modes;
+    std::vector<std::string> on_finish_modes;
+    std::vector<std::string> geofencing_violation_fallback;
+
     // Log all the modes that are to be loaded dynamically
     for (const std::string & mode : modes.as_string_array()) {
         
         // Log the mode that is about to be loaded
         RCLCPP_INFO(this->get_logger(), "Loading mode: %s", mode.c_str());
 
+        // Check if we can still fit another mode in the transition matrix
+        if (operating_modes_.size() >= MAX_MODES) {
+            RCLCPP_ERROR_STREAM(this->get_logger(), "Maximum number of modes (" << MAX_MODES << ") reached. Mode: " << mode << " will not be loaded");
+            break;
+        }
+
         // Attempt to load the mode
         try {
             // Load the mode and initialize it
-            operating_modes_[mode] = autopilot::Mode::UniquePtr(mode_loader_->createUnmanagedInstance("autopilot::" + mode));
+            autopilot::Mode::UniquePtr operating_mode;
+            {
+                std::lock_guard<std::mutex> lock(plugin_loaders_->mutex);
+                operating_mode.reset(plugin_loaders_->mode->createUnmanagedInstance("autopilot::" + mode));
+            }
 
             // Initialize the mode
-            operating_modes_[mode]->initialize_mode(mode_config_);
+            operating_mode->initialize_mode(mode_config_);
+
+            // Check that the controller and the trajectory manager provide everything the mode requires, such that
+            // the mode never sends a command (or queries a trajectory) that is not supported during the control loop
+            const Capabilities missing_controller = operating_mode->required_controller_capabilities() & ~controller_->capabilities();
+            if (missing_controller != 0) {
+                throw ConfigurationError("Mode: " + mode + " requires commands not supported by the controller: " + controller_capability_names(missing_controller));
+            }
+
+            const Capabilities missing_trajectory = operating_mode->required_trajectory_capabilities() & ~trajectory_manager_->capabilities();
+            if (missing_trajectory != 0) {
+                throw ConfigurationError("Mode: " + mode + " requires queries not supported by the trajectory manager: " + trajectory_capability_names(missing_trajectory));
+            }
 
             // Load the valid transitions for this mode
             this->declare_parameter<std::vector<std::string>>("autopilot." + mode + ".valid_transitions", std::vector<std::string>());
-            rclcpp::Parameter valid_transitions = this->get_parameter("autopilot." + mode + ".valid_transitions");
-            valid_transitions_[mode] = valid_transitions.as_string_array();
+            rclcpp::Parameter mode_valid_transitions = this->get_parameter("autopilot." + mode + ".valid_transitions");
 
             // Load the fallback mode for this mode
             this->declare_parameter<std::string>("autopilot." + mode + ".fallback", "");
-            fallback_modes_[mode] = this->get_parameter("autopilot." + mode + ".fallback").as_string();
+            std::string fallback_mode = this->get_parameter("autopilot." + mode + ".fallback").as_string();
 
             // Load the on_finish mode for this mode
             this->declare_parameter<std::string>("autopilot." + mode + ".on_finish", "");
-            on_finish_modes_[mode] = this->get_parameter("autopilot." + mode + ".on_finish").as_string();
+            std::string on_finish_mode = this->get_parameter("autopilot." + mode + ".on_finish").as_string();
 
             // Load the geofencing violation fallback mode for this mode
             this->declare_parameter<std::string>("autopilot." + mode + ".geofencing_violation_fallback", "");
-            geofencing_violation_fallback_[mode] = this->get_parameter("autopilot." + mode + ".geofencing_violation_fallback").as_string();
-
+            std::string geofencing_fallback_mode = this->get_parameter("autopilot." + mode + ".geofencing_violation_fallback").as_string();
+
+            // Load the maximum time (in seconds) that this mode can take to be entered
+            this->declare_parameter<double>("autopilot." + mode + ".enter_timeout", 5.0);
+            double enter_timeout = this->get_parameter("autopilot." + mode + ".enter_timeout").as_double();
+
+            // Register the mode under the next available id
+            mode_ids_[mode] = static_cast<ModeId>(operating_modes_.size());
+            mode_names_.push_back(mode);
+            operating_modes_.push_back(std::move(operating_mode));
+            valid_transitions.push_back(mode_valid_transitions.as_string_array());
+            fallback_modes.push_back(fallback_mode);
+            on_finish_modes.push_back(on_finish_mode);
+            geofencing_violation_fallback.push_back(geofencing_fallback_mode);
+            enter_timeouts_.push_back(enter_timeout);
+
+        } catch (const ConfigurationError &) {
+            throw;
         } catch (const std::exception & e) {
             RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while loading mode: " << e.what() << ". Mode: " << mode);
         }
     }
 
-    // Log all the geofencing violation fallback modes
-    for (const auto & [mode, fallback_mode] : geofencing_violation_fallback_) {
-        RCLCPP_INFO_STREAM(this->get_logger(), "Geofencing fallback for " << mode << " is: " << fallback_mode);
-    }
+    // Compile the mode graph into flat arrays indexed by the mode id
+    valid_transitions_.resize(operating_modes_.size());
+    fallback_modes_.resize(operating_modes_.size(), INVALID_MODE);
+    on_finish_modes_.resize(operating_modes_.size(), INVALID_MODE);
+    geofencing_violation_fallback_.resize(operating_modes_.size(), INVALID_MODE);
+
+    for (ModeId id = 0; id < static_cast<ModeId>(operating_modes_.size()); id++) {
+
+        const std::string & mode = mode_names_[id];
 
-    // Validate that all fallback modes exist
-    for (const auto & [mode, fallback_mode] : fallback_modes_) {
-        if (!operating_modes_.contains(fallback_mode)) {
-            RCLCPP_ERROR_STREAM(this->get_logger(), "Fallback mode: " << fallback_mode << " was not loaded. Required by " << mode);
-            std::exit(EXIT_FAILURE);
+        // Build the row of the transition matrix for this mode
+        for (const std::string & transition : valid_transitions[id]) {
+            ModeId transition_id = get_mode_id(transition);
+            if (transition_id == INVALID_MODE) {
+                RCLCPP_WARN_STREAM(this->get_logger(), "Valid transition: " << transition << " from mode: " << mode << " was not loaded. Ignoring it");
+                continue;
+            }
+            valid_transitions_[id].set(transition_id);
+        }
+
+        // Validate that the fallback mode exists
+        fallback_modes_[id] = get_mode_id(fallback_modes[id]);
+        if (fallback_modes_[id] == INVALID_MODE) {
+            throw ConfigurationError("Fallback mode: " + fallback_modes[id] + " was not loaded. Required by " + mode);
+        }
+
+        // Validate that the on_finish mode exists (if one is set)
+        on_finish_modes_[id] = get_mode_id(on_finish_modes[id]);
+        if (on_finish_modes_[id] == INVALID_MODE && on_finish_modes[id] != "") {
+            RCLCPP_WARN_STREAM(this->get_logger(), "On finish mode: " << on_finish_modes[id] << " was not loaded. Required by " << mode);
         }
-    }
 
-    // Validate that all geoefncing violation fallback modes exist
-    for (const auto & [mode, fallback_mode] : geofencing_violation_fallback_) {
-        if (!operating_modes_.contains(fallback_mode) && fallback_mode != "") {
-            RCLCPP_ERROR_STREAM(this->get_logger(), "Geofencing fallback mode: " << fallback_mode << " was not loaded. Required by " << mode);
-            std::exit(EXIT_FAILURE);
+        // Validate that the geofencing violation fallback mode exists (if one is set)
+        geofencing_violation_fallback_[id] = get_mode_id(geofencing_violation_fallback[id]);
+        if (geofencing_violation_fallback_[id] == INVALID_MODE && geofencing_violation_fallback[id] != "") {
+            throw ConfigurationError("Geofencing fallback mode: " + geofencing_violation_fallback[id] + " was not loaded. Required by " + mode);
         }
+
+        // Log the geofencing violation fallback mode
+        RCLCPP_INFO_STREAM(this->get_logger(), "Geofencing fallback for " << mode << " is: " << geofencing_violation_fallback[id]);
     }
 
+    // Resolve the modes that can be forced by the status of the vehicle
+    disarm_mode_ = get_mode_id("DisarmMode");
+    hold_mode_ = get_mode_id("HoldMode");
+
     // Set the default/initial operating mode
     this->declare_parameter<std::string>("autopilot.default_mode", "DisarmMode");
     rclcpp::Parameter default_mode = this->get_parameter("autopilot.default_mode");
-    current_mode_ = default_mode.as_string();
+    if (get_mode_id(default_mode.as_string()) == INVALID_MODE) {
+        throw ConfigurationError("Default mode: " + default_mode.as_string() + " was not loaded");
+    }
 
     // Log the default mode
-    RCLCPP_INFO(this->get_logger(), "Default mode: %s", current_mode_.c_str());
+    RCLCPP_INFO(this->get_logger(), "Default mode: %s", default_mode.as_string().c_str());
+
+    // Publish the default mode, before the control loop starts running it
+    {
+        std::lock_guard<std::mutex> lock(update_mutex_);
+        current_mode_ = get_mode_id(default_mode.as_string());
+        status_msg_.header.stamp = this->get_clock()->now();
+        status_msg_.mode = mode_names_[current_mode_];
+        status_publisher_->publish(status_msg_);
+    }
+
+    // Start running the control loop
+    initialize_control_loop();
+}
 
-    // Initialize the timer running at the control rate defined in the configuration file
+void Autopilot::initialize_control_loop() {
+
+    // Read the control rate defined in the configuration file
     this->declare_parameter<double>("autopilot.rate", 50.0);
     double rate = this->get_parameter("autopilot.rate").as_double();
 
+    // Read the configurations for running the control loop on a dedicated real-time thread
+    this->declare_parameter<bool>("autopilot.realtime.enabled", false);
+    this->declare_parameter<int>("autopilot.realtime.priority", 0);
+    this->declare_parameter<std::vector<long int>>("autopilot.realtime.cpu_affinity", std::vector<long int>());
+    this->declare_parameter<bool>("autopilot.realtime.mlockall", false);
+    bool realtime_enabled = this->get_parameter("autopilot.realtime.enabled").as_bool();
+    realtime_priority_ = this->get_parameter("autopilot.realtime.priority").as_int();
+    for (const long int cpu : this->get_parameter("autopilot.realtime.cpu_affinity").as_integer_array()) {
+        if (cpu >= 0) realtime_cpu_affinity_.push_back(cpu);
+    }
+
+    // Read the configurations for triggering the control loop when a new state of the vehicle arrives
+    this->declare_parameter<std::string>("autopilot.trigger", "timer");
+    this->declare_parameter<double>("autopilot.state_trigger.max_rate", 250.0);
+    this->declare_parameter<double>("autopilot.state_trigger.watchdog_timeout", 0.1);
+    std::string trigger = this->get_parameter("autopilot.trigger").as_string();
+    trigger_max_rate_ = this->get_parameter("autopilot.state_trigger.max_rate").as_double();
+    watchdog_timeout_ = this->get_parameter("autopilot.state_trigger.watchdog_timeout").as_double();
+
+    if (trigger != "timer" && trigger != "state" && trigger != "external") {
+        throw ConfigurationError("Invalid trigger: " + trigger + ". Valid options are: timer, state, external");
+    }
+
     last_time_ = this->get_clock()->now();
-    timer_ = this->create_wall_timer(std::chrono::duration<double>(1.0 / rate), std::bind(&Autopilot::update, this));
-    RCLCPP_INFO(this->get_logger(), "Autopilot is initialized and will run at %.2f Hz", rate);
+    last_state_trigger_ = last_time_;
+    last_trigger_stamp_ = last_time_;
+
+    // If the control loop is stepped by the owner of the node (e.g. a simulator running in lockstep), do not create any timer
+    if (trigger == "external") {
+        if (realtime_enabled) RCLCPP_WARN(this->get_logger(), "The real-time thread is not used when the control loop is stepped externally");
+        RCLCPP_INFO(this->get_logger(), "Autopilot is initialized and will run when stepped externally (nominal rate %.2f Hz)", rate);
+        return;
+    }
+
+    // If the control loop is triggered by the state, use the timer (at the nominal rate) only as a watchdog
+    if (trigger == "state") {
+        if (realtime_enabled) RCLCPP_WARN(this->get_logger(), "The real-time thread is not used when the control loop is triggered by the state");
+        timer_ = this->create_wall_timer(std::chrono::duration<double>(1.0 / rate), std::bind(&Autopilot::watchdog_callback, this));
+        trigger_on_state_ = true;
+        RCLCPP_INFO(this->get_logger(), "Autopilot is initialized and will run on each new state (up to %.2f Hz, watchdog at %.2f Hz)", trigger_max_rate_, rate);
+        return;
+    }
+
+    // If the real-time thread is not enabled, run the control loop on the ROS 2 executor using a wall timer
+    if (!realtime_enabled) {
+        timer_ = this->create_wall_timer(std::chrono::duration<double>(1.0 / rate), [this]() { update(); });
+        RCLCPP_INFO(this->get_logger(), "Autopilot is initialized and will run at %.2f Hz", rate);
+        return;
+    }
+
+    // Lock all the current and future pages of the process in RAM, such that the control loop does not suffer from page faults
+    if (this->get_parameter("autopilot.realtime.mlockall").as_bool() && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        RCLCPP_WARN_STREAM(this->get_logger(), "Failed to lock the process memory with mlockall: " << std::strerror(errno));
+    }
+
+    // Start the dedicated thread that will run the control loop
+    control_thread_running_ = true;
+    control_thread_ = std::thread(&Autopilot::realtime_control_loop, this, rate);
+    RCLCPP_INFO(this->get_logger(), "Autopilot is initialized and will run at %.2f Hz on a dedicated real-time thread", rate);
+}
+
+void Autopilot::realtime_control_loop(double rate) {
+
+    // Set the scheduling policy of this thread to SCHED_FIFO with the requested priority
+    if (realtime_priority_ > 0) {
+        sched_param param{};
+        param.sched_priority = realtime_priority_;
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0) RCLCPP_WARN_STREAM(this->get_logger(), "Failed to set SCHED_FIFO priority " << realtime_priority_ << ": " << std::strerror(result));
+    }
+
+    // Pin this thread to the requested CPU cores
+    if (!realtime_cpu_affinity_.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (const long int cpu : realtime_cpu_affinity_) CPU_SET(cpu, &cpu_set);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+        if (result != 0) RCLCPP_WARN_STREAM(this->get_logger(), "Failed to set the CPU affinity of the control thread: " << std::strerror(result));
+    }
+
+    // Period of the control loop in nanoseconds
+    const int64_t period = static_cast<int64_t>(1.0e9 / rate);
+
+    // Get the first deadline of the control loop
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    int64_t deadline_ns = deadline.tv_sec * 1000000000LL + deadline.tv_nsec;
+
+    while (control_thread_running_ && rclcpp::ok()) {
+
+        // Sleep until the next absolute deadline, such that the period does not drift with the time spent on each iteration
+        deadline_ns += period;
+        deadline.tv_sec = deadline_ns / 1000000000LL;
+        deadline.tv_nsec = deadline_ns % 1000000000LL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR) {}
+
+        // Perform one iteration of the control loop
+        {
+            std::lock_guard<std::mutex> lock(update_mutex_);
+            update();
+        }
+
+        // Check if the iteration finished after the next deadline. If so, skip the missed periods instead of running them back-to-back
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t now_ns = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+        if (now_ns > deadline_ns + period) {
+            deadline_ns += ((now_ns - deadline_ns) / period) * period;
+
+            // Publish the number of deadline overruns
+            deadline_overruns_++;
+            overruns_msg_.data = deadline_overruns_;
+            overruns_publisher_->publish(overruns_msg_);
+        }
+    }
 }
 
 void Autopilot::initialize_publishers() {
 
-    // Initialize the publisher for the status of the vehicle
+    // Initialize the publisher for the status of the vehicle. The intra-process communication does not support latched topics,
+    // so this publisher always goes through the middleware (even if the node enables the intra-process communication)
+    rclcpp::PublisherOptions status_publisher_options;
+    status_publisher_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
     this->declare_parameter<std::string>("autopilot.publishers.status", "autopilot/status");
     status_publisher_ = this->create_publisher<pegasus_msgs::msg::AutopilotStatus>(
-        this->get_parameter("autopilot.publishers.status").as_string(), rclcpp::SensorDataQoS());
+        this->get_parameter("autopilot.publishers.status").as_string(), rclcpp::QoS(1).reliable().transient_local(), status_publisher_options);
+
+    // Initialize the publisher for the id of the current mode of the autopilot
+    this->declare_parameter<std::string>("autopilot.publishers.mode_id", "autopilot/status/mode_id");
+    mode_id_publisher_ = this->create_publisher<std_msgs::msg::UInt8>(
+        this->get_parameter("autopilot.publishers.mode_id").as_string(), rclcpp::SensorDataQoS());
+
+    // Initialize the publisher for the number of deadline overruns of the control loop
+    this->declare_parameter<std::string>("autopilot.publishers.overruns", "autopilot/statistics/overruns");
+    overruns_publisher_ = this->create_publisher<std_msgs::msg::UInt64>(
+        this->get_parameter("autopilot.publishers.overruns").as_string(), rclcpp::QoS(1));
+
+    // Initialize the publisher for the age of the state used at each iteration of the control loop
+    this->declare_parameter<std::string>("autopilot.publishers.state_age", "autopilot/statistics/state_age");
+    state_age_publisher_ = this->create_publisher<std_msgs::msg::Float64>(
+        this->get_parameter("autopilot.publishers.state_age").as_string(), rclcpp::SensorDataQoS());
+
+    // Initialize the publisher for the summary of the performance of the control loop
+    this->declare_parameter<std::string>("autopilot.publishers.perf", "autopilot/perf");
+    perf_publisher_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+        this->get_parameter("autopilot.publishers.perf").as_string(), rclcpp::QoS(1));
+
+    // Pre-allocate the summary message (one status per metric with the number of samples, the p50, p99 and max in microseconds)
+    perf_msg_.status.resize(NUM_PERF_METRICS);
+    for (int i = 0; i < NUM_PERF_METRICS; i++) {
+        perf_msg_.status[i].name = std::string("autopilot/perf/") + PERF_METRIC_NAMES[i];
+        perf_msg_.status[i].values.resize(4);
+        perf_msg_.status[i].values[0].key = "count";
+        perf_msg_.status[i].values[1].key = "p50_us";
+        perf_msg_.status[i].values[2].key = "p99_us";
+        perf_msg_.status[i].values[3].key = "max_us";
+    }
+
+    // Publish the summary periodically (a rate of 0 disables it, but the histograms are always recorded)
+    this->declare_parameter<double>("autopilot.perf.publish_rate", 1.0);
+    double perf_rate = this->get_parameter("autopilot.perf.publish_rate").as_double();
+    if (perf_rate > 0.0) perf_timer_ = this->create_wall_timer(std::chrono::duration<double>(1.0 / perf_rate), std::bind(&Autopilot::perf_callback, this));
 }
 
 void Autopilot::initialize_subscribers() {
@@ -278,6 +555,14 @@ void Autopilot::initialize_subscribers() {
     state_subscriber_ = this->create_subscription<nav_msgs::msg::Odometry>(
         this->get_parameter("autopilot.subscribers.state").as_string(), rclcpp::SensorDataQoS(), std::bind(&Autopilot::state_callback, this, std::placeholders::_1));
 
+    // Read the configuration to compensate for the latency of the state
+    this->declare_parameter<bool>("autopilot.state_prediction.enabled", false);
+    this->declare_parameter<double>("autopilot.state_prediction.max_horizon", 0.1);
+    this->declare_parameter<double>("autopilot.state_prediction.latency_offset", 0.0);
+    state_prediction_enabled_ = this->get_parameter("autopilot.state_prediction.enabled").as_bool();
+    state_prediction_max_horizon_ = this->get_parameter("autopilot.state_prediction.max_horizon").as_double();
+    state_latency_offset_ = this->get_parameter("autopilot.state_prediction.latency_offset").as_double();
+
     // Subscribe to the status of the vehicle
     this->declare_parameter<std::string>("autopilot.subscribers.status", "status");
     status_subscriber_ = this->create_subscription<pegasus_msgs::msg::Status>(
@@ -295,20 +580,103 @@ void Autopilot::initialize_services() {
     this->declare_parameter<std::string>("autopilot.services.set_mode", "set_mode");
     change_mode_service_ = this->create_service<pegasus_msgs::srv::SetMode>(
         this->get_parameter("autopilot.services.set_mode").as_string(), std::bind(&Autopilot::change_mode_callback, this, std::placeholders::_1, std::placeholders::_2));
+
+    // Initialize the Service server to reset the performance histograms
+    this->declare_parameter<std::string>("autopilot.services.reset_perf", "autopilot/perf/reset");
+    reset_perf_service_ = this->create_service<std_srvs::srv::Trigger>(
+        this->get_parameter("autopilot.services.reset_perf").as_string(), std::bind(&Autopilot::reset_perf_callback, this, std::placeholders::_1, std::placeholders::_2));
+}
+
+Autopilot::ModeId Autopilot::get_mode_id(const std::string & mode) const {
+    auto it = mode_ids_.find(mode);
+    return (it != mode_ids_.end()) ? it->second : INVALID_MODE;
+}
+
+void Autopilot::watchdog_callback() {
+
+    // Check if the state of the vehicle stopped arriving. If not, the control loop is already running on each new state
+    auto now = this->get_clock()->now();
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    if ((now - last_state_trigger_).seconds() < watchdog_timeout_) return;
+
+    // Log the incident
+    RCLCPP_WARN_THROTTLE(this->get_logger(), steady_clock_, 1000, "No state received for more than %.3fs. Running the control loop on the watchdog timer", watchdog_timeout_);
+
+    update(now);
 }
 
 // Function that executes periodically the control loop of each operation mode
 void Autopilot::update() {
+    update(this->get_clock()->now());
+}
 
-    // Get the current time and compute the time difference
-    auto now = this->get_clock()->now();
-    double dt = (now - last_time_).seconds();
+void Autopilot::update(const rclcpp::Time & now) {
+
+    // Reset the performance histograms if requested (here, as the control loop is the only one writing to them)
+    if (perf_reset_requested_.exchange(false)) {
+        for (LatencyHistogram & histogram : perf_histograms_) histogram.reset();
+        last_tick_period_ = -1;
+    }
+
+    // Measure the period of the control loop, its jitter and the age of the state
+    const auto tick_start = std::chrono::steady_clock::now();
+    if (last_tick_start_ != std::chrono::steady_clock::time_point{}) {
+        const std::int64_t period = to_nanoseconds(tick_start - last_tick_start_);
+        perf_histograms_[PERF_PERIOD].record(period);
+        if (last_tick_period_ >= 0) perf_histograms_[PERF_JITTER].record(std::abs(period - last_tick_period_));
+        last_tick_period_ = period;
+    }
+    last_tick_start_ = tick_start;
+
+    const std::int64_t last_state_arrival = last_state_arrival_.load(std::memory_order_relaxed);
+    if (last_state_arrival > 0) perf_histograms_[PERF_STATE_AGE].record(to_nanoseconds(tick_start.time_since_epoch() - std::chrono::nanoseconds(last_state_arrival)));
+
+    // Compute the time difference (the first iteration triggered by a state after running on the watchdog can have a stamp
+    // older than the clock of the node used by the watchdog)
+    double dt = std::max((now - last_time_).seconds(), 0.0);
+
+    // Measure how old the state is at this instant and, if enabled, predict it forward to compensate for that latency
+    State state = get_state();
+    double state_age = 0.0;
+    if (state.stamp != 0) {
+        state_age = (now.nanoseconds() - state.stamp) * 1.0e-9 + state_latency_offset_;
+        if (state_prediction_enabled_ && state_age > 0.0) state = predict_state(state, std::min(state_age, state_prediction_max_horizon_));
+        perf_histograms_[PERF_STATE_STAMP_AGE].record(static_cast<std::uint64_t>(std::max(state_age, 0.0) * 1.0e9));
+    }
+
+    // Capture the state of the vehicle once, such that the mode, controller and geofencing all use the same sample
+    TickContext ctx{state, get_status(), get_vehicle_constants(), dt, now, state_age};
+
+    // Let the trajectory manager know that the control loop is running (even if the current mode does not sample the trajectory)
+    trajectory_manager_->tick();
+
+    // Check if the mode that is being entered asynchronously (if any) is ready to take over
+    update_pending_mode(ctx);
+    ctx.mode_change_pending = (pending_mode_ != INVALID_MODE);
 
     // Execute the control loop of the current mode
     try {
 
-        // Perform an update of the current mode
-        operating_modes_.at(current_mode_)->update(dt);
+        // Perform an update of the current mode (and measure the time spent in the mode itself and in the controller)
+        timed_controller_->reset_elapsed();
+        timed_controller_->reset_status();
+        const auto mode_start = std::chrono::steady_clock::now();
+        operating_modes_[current_mode_]->update(ctx);
+        const auto mode_duration = std::chrono::steady_clock::now() - mode_start;
+        perf_histograms_[PERF_CONTROLLER].record(to_nanoseconds(timed_controller_->elapsed()));
+        perf_histograms_[PERF_MODE].record(to_nanoseconds(mode_duration - timed_controller_->elapsed()));
+
+        // Check if the controller rejected any of the commands of the mode. If so, enter the fallback mode imediately
+        const ControlStatus control_status = timed_controller_->status();
+        if (control_status != ControlStatus::OK) {
+
+            // Log the incident for future debugging
+            RCLCPP_ERROR_THROTTLE(this->get_logger(), steady_clock_, 1000, "Controller rejected a command (%s). Mode: %s", to_string(control_status), mode_names_[current_mode_].c_str());
+
+            // The mode is left before it finishes
+            mode_finished_ = false;
+            change_mode(fallback_modes_[current_mode_]);
+        }
 
         // Check if the mode has finished
         if (mode_finished_) {
@@ -317,18 +685,21 @@ void Autopilot::update() {
             mode_finished_ = false;
 
             // Log that the current mode has finished and we are transitioning to the next mode
-            RCLCPP_WARN_STREAM(this->get_logger(), "Mode: " << current_mode_ << " has finished its operation. Transitioning to mode: " << on_finish_modes_[current_mode_]);
+            RCLCPP_WARN_STREAM(this->get_logger(), "Mode: " << mode_names_[current_mode_] << " has finished its operation. Transitioning to mode: " << get_mode_name(on_finish_modes_[current_mode_]));
 
             // Signal that the current mode has finished its operation and should transition to the fallback mode
-            if (on_finish_modes_[current_mode_] != "") change_mode(on_finish_modes_[current_mode_]);
+            if (on_finish_modes_[current_mode_] != INVALID_MODE) change_mode(on_finish_modes_[current_mode_]);
         }
 
         // Check if a geofencing violation has occured. If so, and the geofencing violation fallback mode is not empty, transition to the fallback mode
-        if (geofencing_ && geofencing_->check_geofencing_violation() && geofencing_violation_fallback_[current_mode_] != "") {
+        const auto geofencing_start = std::chrono::steady_clock::now();
+        const bool geofencing_violation = geofencing_ && geofencing_->check_geofencing_violation(ctx);
+        perf_histograms_[PERF_GEOFENCING].record(to_nanoseconds(std::chrono::steady_clock::now() - geofencing_start));
+
+        if (geofencing_violation && geofencing_violation_fallback_[current_mode_] != INVALID_MODE) {
             
             // Log the incident
-            auto steady_clock = rclcpp::Clock();
-            RCLCPP_WARN_STREAM_THROTTLE(this->get_logger(), steady_clock, 1000, "Geofencing violation has occured. Transitioning to mode: " << geofencing_violation_fallback_[current_mode_]);
+            RCLCPP_WARN_THROTTLE(this->get_logger(), steady_clock_, 1000, "Geofencing violation has occured. Transitioning to mode: %s", mode_names_[geofencing_violation_fallback_[current_mode_]].c_str());
             change_mode(geofencing_violation_fallback_[current_mode_]);
         }
 
@@ -338,70 +709,172 @@ void Autopilot::update() {
         change_mode(fallback_modes_[current_mode_]);
 
         // Log the incident for future debugging
-        auto steady_clock = rclcpp::Clock();
-        RCLCPP_ERROR_STREAM_THROTTLE(this->get_logger(), steady_clock, 1000, "Exception while executing update: " << e.what() << ". Mode: " << current_mode_);
+        RCLCPP_ERROR_THROTTLE(this->get_logger(), steady_clock_, 1000, "Exception while executing update: %s. Mode: %s", e.what(), mode_names_[current_mode_].c_str());
     }
 
     // Update the last time
     last_time_ = now;
 
-    // Publish the current status of the autopilot
-    status_msg_.header.stamp = now;
-    status_msg_.mode = current_mode_;
-    status_publisher_->publish(status_msg_);
+    // Publish the id of the current mode of the autopilot (the full status is only published when the mode changes)
+    const auto publish_start = std::chrono::steady_clock::now();
+    mode_id_msg_.data = static_cast<std::uint8_t>(current_mode_);
+    mode_id_publisher_->publish(mode_id_msg_);
+
+    // Publish the age of the state used in this iteration
+    state_age_msg_.data = state_age;
+    state_age_publisher_->publish(state_age_msg_);
+
+    // Measure the time spent publishing and in the whole iteration
+    const auto tick_end = std::chrono::steady_clock::now();
+    perf_histograms_[PERF_PUBLISH].record(to_nanoseconds(tick_end - publish_start));
+    perf_histograms_[PERF_TICK].record(to_nanoseconds(tick_end - tick_start));
 }
 
 // Function that establishes the state machine to transition between operating modes
 bool Autopilot::change_mode(const std::string new_mode, bool force) {
 
-    // Check if the requested mode exists in the dictionary. If not return false
-    if (!operating_modes_.contains(new_mode)) {
-        RCLCPP_ERROR_STREAM(this->get_logger(), "Requested mode: " << new_mode << " does not exist. Keeping the operating mode: " << current_mode_);
+    // Check if the requested mode exists. If not return false
+    ModeId new_mode_id = get_mode_id(new_mode);
+    if (new_mode_id == INVALID_MODE) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Requested mode: " << new_mode << " does not exist. Keeping the operating mode: " << get_mode());
+        return false;
+    }
+
+    return change_mode(new_mode_id, force);
+}
+
+bool Autopilot::change_mode(ModeId new_mode, bool force) {
+
+    // Check if the requested mode exists. If not return false
+    if (new_mode < 0 || new_mode >= static_cast<ModeId>(operating_modes_.size())) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Requested mode id: " << new_mode << " does not exist. Keeping the operating mode: " << get_mode());
         return false;
     } else if (new_mode == current_mode_ && !force) {
-        RCLCPP_WARN_STREAM(this->get_logger(), "Requested mode: " << new_mode << " is the same as the current mode. Keeping the operating mode: " << current_mode_);
+
+        // Requesting the current mode cancels any other mode still being entered
+        if (pending_mode_ != INVALID_MODE) {
+            RCLCPP_WARN_STREAM(this->get_logger(), "Requested mode: " << mode_names_[new_mode] << " is the current mode. Cancelling the transition to mode: " << mode_names_[pending_mode_]);
+            abort_pending_mode();
+            return true;
+        }
+
+        RCLCPP_WARN_STREAM(this->get_logger(), "Requested mode: " << mode_names_[new_mode] << " is the same as the current mode. Keeping the operating mode: " << get_mode());
         return false;
     }
 
     // Check if the request mode is a valid transition from the current mode. If not return false
-    if (!std::count(valid_transitions_[current_mode_].begin(), valid_transitions_[current_mode_].end(), new_mode) && !force) {
-            RCLCPP_ERROR_STREAM(this->get_logger(), "Requested mode: " << new_mode << " is not a valid transition from the current mode: " << current_mode_ << ". Keeping the operating mode: " << current_mode_);
+    if (!force && (current_mode_ == INVALID_MODE || !valid_transitions_[current_mode_].test(new_mode))) {
+            RCLCPP_ERROR_STREAM(this->get_logger(), "Requested mode: " << mode_names_[new_mode] << " is not a valid transition from the current mode: " << get_mode() << ". Keeping the operating mode: " << get_mode());
             return false;
     }
 
+    // Check if the requested mode is already being entered
+    if (new_mode == pending_mode_) {
+        RCLCPP_WARN_STREAM(this->get_logger(), "Requested mode: " << mode_names_[new_mode] << " is already being entered. Keeping the operating mode: " << get_mode());
+        return false;
+    }
+
+    // If another mode is still being entered, abort it as this request replaces it
+    if (pending_mode_ != INVALID_MODE) abort_pending_mode();
+
     // Attemp to enter the new mode (but do not change the current mode yet, as we still need to exit the current mode)
+    Mode::EnterResult result;
     try {
 
         // Attempt to enter the new mode
-        bool new_mode_success = operating_modes_[new_mode]->enter();
+        result = operating_modes_[new_mode]->begin_enter();
 
         // If the new mode was not entered successfully, return false
-        if (!new_mode_success) {
-            RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to enter mode: " << new_mode << ". Keeping the operating mode: " << current_mode_);
+        if (result == Mode::EnterResult::FAILED) {
+            RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to enter mode: " << mode_names_[new_mode] << ". Keeping the operating mode: " << get_mode());
             return false;
         }
 
     } catch (const std::exception & e) {
-        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while entering mode: " << e.what() << ". Mode: " << new_mode << ". Keeping the operating mode: " << current_mode_);
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while entering mode: " << e.what() << ". Mode: " << mode_names_[new_mode] << ". Keeping the operating mode: " << get_mode());
         return false;
     }
 
+    // If the new mode is waiting on something (e.g. a service response), keep running the current mode until it is ready
+    if (result == Mode::EnterResult::PENDING) {
+        pending_mode_ = new_mode;
+        pending_mode_start_ = last_time_;
+        RCLCPP_INFO_STREAM(this->get_logger(), "Entering mode: " << mode_names_[new_mode] << ". Keeping the operating mode: " << get_mode() << " until it is ready");
+        return true;
+    }
+
+    // Otherwise, the transition can be completed imediately
+    complete_mode_change(new_mode);
+    return true;
+}
+
+void Autopilot::complete_mode_change(ModeId new_mode) {
+
     // Update the new operating mode
-    std::string old_mode = current_mode_;
+    ModeId old_mode = current_mode_;
     current_mode_ = new_mode;
 
     // Attemp to exit the current mode
     try {
         // Reset the previous operating mode
-        operating_modes_[old_mode]->exit();
+        if (old_mode != INVALID_MODE) operating_modes_[old_mode]->exit();
     } catch (const std::exception & e) {
-        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while exiting mode: " << e.what() << ". Mode: " << current_mode_ << ". Transitioned to operating mode: " << new_mode << ". Consider Landing for safety.");
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while exiting mode: " << e.what() << ". Mode: " << mode_names_[old_mode] << ". Transitioned to operating mode: " << mode_names_[new_mode] << ". Consider Landing for safety.");
     }
 
-    // Update the current mode in the status message
-    status_msg_.mode = current_mode_;
-    RCLCPP_INFO_STREAM(this->get_logger(), "Transitioned from mode: " << old_mode << " to mode: " << current_mode_);
-    return true;
+    // Publish the new mode in the status message. The mode name is only sent when it changes
+    status_msg_.header.stamp = this->get_clock()->now();
+    status_msg_.mode = mode_names_[current_mode_];
+    status_publisher_->publish(status_msg_);
+    RCLCPP_INFO_STREAM(this->get_logger(), "Transitioned from mode: " << get_mode_name(old_mode) << " to mode: " << mode_names_[current_mode_]);
+}
+
+void Autopilot::update_pending_mode(const TickContext & ctx) {
+
+    // Check if there is a mode being entered
+    if (pending_mode_ == INVALID_MODE) return;
+
+    // Check if the mode is ready to be entered
+    Mode::EnterResult result;
+    try {
+        result = operating_modes_[pending_mode_]->poll_enter(ctx);
+    } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while entering mode: " << e.what() << ". Mode: " << mode_names_[pending_mode_]);
+        result = Mode::EnterResult::FAILED;
+    }
+
+    // Complete the transition if the mode was entered successfully
+    if (result == Mode::EnterResult::SUCCESS) {
+        ModeId new_mode = pending_mode_;
+        pending_mode_ = INVALID_MODE;
+        complete_mode_change(new_mode);
+        return;
+    }
+
+    // Give up the transition if the mode failed to be entered
+    if (result == Mode::EnterResult::FAILED) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to enter mode: " << mode_names_[pending_mode_] << ". Keeping the operating mode: " << get_mode());
+        pending_mode_ = INVALID_MODE;
+        return;
+    }
+
+    // Abort the transition if the mode is taking too long to be entered
+    if ((ctx.timestamp - pending_mode_start_).seconds() > enter_timeouts_[pending_mode_]) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Timeout while entering mode: " << mode_names_[pending_mode_] << ". Keeping the operating mode: " << get_mode());
+        abort_pending_mode();
+    }
+}
+
+void Autopilot::abort_pending_mode() {
+
+    // Let the mode cancel whatever it was waiting on
+    try {
+        operating_modes_[pending_mode_]->abort_enter();
+    } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Exception while aborting the entry of mode: " << e.what() << ". Mode: " << mode_names_[pending_mode_]);
+    }
+
+    pending_mode_ = INVALID_MODE;
 }
 
 void Autopilot::signal_mode_finished() {
@@ -413,50 +886,114 @@ void Autopilot::signal_mode_finished() {
 void Autopilot::change_mode_callback(const std::shared_ptr<pegasus_msgs::srv::SetMode::Request> request, std::shared_ptr<pegasus_msgs::srv::SetMode::Response> response) {
     
     // Attemp to change the mode of operation of the autopilot - Return the current mode of operation of the autopilot
+    std::lock_guard<std::mutex> lock(update_mutex_);
     response->success = change_mode(request->mode);
 }
 
+void Autopilot::perf_callback() {
+
+    // Fill the summary of each histogram (the values are converted from nanoseconds to microseconds)
+    for (int i = 0; i < NUM_PERF_METRICS; i++) {
+        const LatencyHistogram & histogram = perf_histograms_[i];
+        perf_msg_.status[i].values[0].value = std::to_string(histogram.count());
+        perf_msg_.status[i].values[1].value = std::to_string(histogram.percentile(50.0) / 1000.0);
+        perf_msg_.status[i].values[2].value = std::to_string(histogram.percentile(99.0) / 1000.0);
+        perf_msg_.status[i].values[3].value = std::to_string(histogram.max() / 1000.0);
+    }
+
+    perf_msg_.header.stamp = this->get_clock()->now();
+    perf_publisher_->publish(perf_msg_);
+}
+
+void Autopilot::reset_perf_callback(const std::shared_ptr<std_srvs::srv::Trigger::Request>, std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+
+    // Request the control loop to reset the histograms at the beginning of the next iteration
+    perf_reset_requested_ = true;
+    response->success = true;
+}
+
 void Autopilot::state_callback(const nav_msgs::msg::Odometry::ConstSharedPtr msg) {
 
     // Update the state of the vehicle
-    state_.position[0] = msg->pose.pose.position.x;
-    state_.position[1] = msg->pose.pose.position.y;
-    state_.position[2] = msg->pose.pose.position.z;
+    State state;
+    state.stamp = rclcpp::Time(msg->header.stamp).nanoseconds();
+    state.position[0] = msg->pose.pose.position.x;
+    state.position[1] = msg->pose.pose.position.y;
+    state.position[2] = msg->pose.pose.position.z;
+
+    state.velocity[0] = msg->twist.twist.linear.x;
+    state.velocity[1] = msg->twist.twist.linear.y;
+    state.velocity[2] = msg->twist.twist.linear.z;
+
+    state.attitude.w() = msg->pose.pose.orientation.w;
+    state.attitude.x() = msg->pose.pose.orientation.x;
+    state.attitude.y() = msg->pose.pose.orientation.y;
+    state.attitude.z() = msg->pose.pose.orientation.z;
+
+    state.angular_velocity[0] = msg->twist.twist.angular.x;
+    state.angular_velocity[1] = msg->twist.twist.angular.y;
+    state.angular_velocity[2] = msg->twist.twist.angular.z;
+
+    set_state(state);
+}
+
+void Autopilot::set_state(const State & state) {
+
+    // Save the time at which the state arrived, to measure how old it is when used by the control loop
+    last_state_arrival_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+
+    // Publish the new state as a consistent snapshot
+    state_.store(state);
+
+    // Run the control loop on the new state (if enabled). The stamp of the message is used as the time of this iteration,
+    // such that dt is the time between the samples used. Samples that arrive too soon (or out of order) do not trigger it
+    if (!trigger_on_state_) return;
 
-    state_.velocity[0] = msg->twist.twist.linear.x;
-    state_.velocity[1] = msg->twist.twist.linear.y;
-    state_.velocity[2] = msg->twist.twist.linear.z;
+    rclcpp::Time stamp = (state.stamp != 0) ? rclcpp::Time(state.stamp, this->get_clock()->get_clock_type()) : this->get_clock()->now();
+    std::lock_guard<std::mutex> lock(update_mutex_);
 
-    state_.attitude.w() = msg->pose.pose.orientation.w;
-    state_.attitude.x() = msg->pose.pose.orientation.x;
-    state_.attitude.y() = msg->pose.pose.orientation.y;
-    state_.attitude.z() = msg->pose.pose.orientation.z;
+    // The rate is limited against the stamp of the last sample that triggered the loop (not the time of the last iteration, which
+    // is taken from the clock of the node when running on the watchdog). A stamp that goes back by more than the watchdog timeout
+    // means that the source of the state restarted, so it triggers the loop again instead of being dropped as out of order
+    const double elapsed = (stamp - last_trigger_stamp_).seconds();
+    if (elapsed < 1.0 / trigger_max_rate_ && elapsed > -watchdog_timeout_) return;
 
-    state_.angular_velocity[0] = msg->twist.twist.angular.x;
-    state_.angular_velocity[1] = msg->twist.twist.angular.y;
-    state_.angular_velocity[2] = msg->twist.twist.angular.z;
+    last_trigger_stamp_ = stamp;
+    last_state_trigger_ = this->get_clock()->now();
+    update(stamp);
 }
 
 void Autopilot::status_callback(const pegasus_msgs::msg::Status::ConstSharedPtr msg) {
 
     // Update the operation status of the vehicle
-    status_.armed = msg->armed;
-    status_.flying = (msg->landed_state == pegasus_msgs::msg::Status::IN_AIR) ? true : false;
-    status_.offboard = (msg->flight_mode == pegasus_msgs::msg::Status::OFFBOARD) ? true : false;
+    VehicleStatus status;
+    status.armed = msg->armed;
+    status.flying = (msg->landed_state == pegasus_msgs::msg::Status::IN_AIR) ? true : false;
+    status.offboard = (msg->flight_mode == pegasus_msgs::msg::Status::OFFBOARD) ? true : false;
+    set_status(status);
+}
+
+void Autopilot::set_status(const VehicleStatus & status) {
+
+    // Update the operation status of the vehicle
+    status_.store(status);
+
+    // The remaining logic can force mode changes, so it must not run in parallel with the control loop
+    std::lock_guard<std::mutex> lock(update_mutex_);
 
     // If the autopilot is not initialized yet, return
-    if (current_mode_ == "Uninitialized") return;
+    if (current_mode_ == INVALID_MODE) return;
 
     // Check if the vehicle is disarmed and the current mode is not armed mode or disarmed mode - if so, force a transition to disarmed mode
     // TODO - improve this logic
-    if (!status_.armed && current_mode_ != "DisarmMode") {
+    if (!status.armed && current_mode_ != disarm_mode_) {
         
         // Increment the counter for forcing a transition - this is done to prevent the autopilot from forcing a transition to DisarmMode
         force_change_counter_++;
 
         if (force_change_counter_ > 10) {
             RCLCPP_WARN(this->get_logger(), "Vehicle is disarmed by FMU. Autopilot forcing a transition to DisarmMode");
-            change_mode("DisarmMode", true);
+            change_mode(disarm_mode_, true);
         }
         return;
     }
@@ -464,14 +1001,14 @@ void Autopilot::status_callback(const pegasus_msgs::msg::Status::ConstSharedPtr
     // Check if the vehicle is ON_AIR, armed and in offboard mode. If so, it means something has died and we reconnected. In this case we should transition
     // to HoldMode and try to prevent the vehicle from crashing
     // TODO - improve this logic later on
-    if (status_.flying && status_.armed && status_.offboard && current_mode_ == "DisarmMode") {
+    if (status.flying && status.armed && status.offboard && current_mode_ == disarm_mode_) {
 
         // Increment the counter for forcing a transition - this is done to prevent the autopilot from forcing a transition to HoldMode
         force_change_counter_++;
         
         if (force_change_counter_ > 10) {
             RCLCPP_WARN(this->get_logger(), "Vehicle is ON_AIR, armed and in offboard mode. Autopilot forcing a transition to HoldMode");
-            change_mode("HoldMode", true);
+            change_mode(hold_mode_, true);
         }
         return;
     }
@@ -484,22 +1021,45 @@ void Autopilot::status_callback(const pegasus_msgs::msg::Status::ConstSharedPtr
 
 void Autopilot::vehicle_constants_callback(const pegasus_msgs::msg::VehicleConstants::ConstSharedPtr msg) {
 
-    // Save the parameters of the vehicle
-    vehicle_constants_.id = msg->id;
-    vehicle_constants_.mass = msg->mass;
-    vehicle_constants_.thrust_curve_id = msg->thrust_curve.identifier;
-    vehicle_constants_.thurst_curve_params = msg->thrust_curve.parameters;
-    vehicle_constants_.thrust_curve_values = msg->thrust_curve.values;
+    // Get the parameters of the vehicle
+    VehicleConstants vehicle_constants;
+    vehicle_constants.id = msg->id;
+    vehicle_constants.mass = msg->mass;
+    vehicle_constants.thrust_curve_id = msg->thrust_curve.identifier;
+    vehicle_constants.thurst_curve_params = msg->thrust_curve.parameters;
+    vehicle_constants.thrust_curve_values = msg->thrust_curve.values;
 
     // Unsubscribe from the vehicle constants topic (as we assume they do not change over time)
     vehicle_constants_subscriber_.reset();
 
+    // An invalid configuration leaves this autopilot uninitialized, without stopping the executor (and the other autopilots in it),
+    // unless the process that owns the autopilot decides otherwise
+    try {
+        set_vehicle_constants(vehicle_constants);
+    } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to initialize the autopilot: " << e.what() << ". The autopilot will not run");
+        if (configuration_error_callback_) configuration_error_callback_(e);
+    }
+}
+
+void Autopilot::set_vehicle_constants(const VehicleConstants & constants) {
+
+    // The autopilot is initialized only once, with the first constants received (its parameters cannot be declared again)
+    if (vehicle_constants_received_.exchange(true)) {
+        RCLCPP_WARN(this->get_logger(), "Vehicle constants were already received. Ignoring the new ones");
+        return;
+    }
+
+    // Save the parameters of the vehicle and publish them to the readers
+    VehicleConstants & vehicle_constants = vehicle_constants_history_.emplace_back(constants);
+    vehicle_constants_.store(&vehicle_constants, std::memory_order_release);
+
     // Log the vehicle constants for debugging
-    RCLCPP_INFO(this->get_logger(), "Vehicle constants: id: %d", vehicle_constants_.id);
-    RCLCPP_INFO(this->get_logger(), "Vehicle constants: mass: %.2f", vehicle_constants_.mass);
-    RCLCPP_INFO(this->get_logger(), "Vehicle constants: thrust_curve_id: %s", vehicle_constants_.thrust_curve_id.c_str());
-    for(int i = 0; i < vehicle_constants_.thurst_curve_params.size(); i++) {
-        RCLCPP_INFO(this->get_logger(), "%s: %.4f", vehicle_constants_.thurst_curve_params[i].c_str(), vehicle_constants_.thrust_curve_values[i]);
+    RCLCPP_INFO(this->get_logger(), "Vehicle constants: id: %d", vehicle_constants.id);
+    RCLCPP_INFO(this->get_logger(), "Vehicle constants: mass: %.2f", vehicle_constants.mass);
+    RCLCPP_INFO(this->get_logger(), "Vehicle constants: thrust_curve_id: %s", vehicle_constants.thrust_curve_id.c_str());
+    for(int i = 0; i < vehicle_constants.thurst_curve_params.size(); i++) {
+        RCLCPP_INFO(this->get_logger(), "%s: %.4f", vehicle_constants.thurst_curve_params[i].c_str(), vehicle_constants.thrust_curve_values[i]);
     }
 
     // After getting the vehicle constants, we are ready to initialize the parameters of the operation modes
@@ -507,4 +1067,8 @@ void Autopilot::vehicle_constants_callback(const pegasus_msgs::msg::VehicleConst
     initialize_autopilot();
 }
 
-} // namespace autopilot
\ No newline at end of file
+} // namespace autopilot
+
+// Register the autopilot as a ROS 2 component, such that it can be loaded into a component container
+#include "rclcpp_components/register_node_macro.hpp"
+RCLCPP_COMPONENTS_REGISTER_NODE(autopilot::Autopilot)
\ No newline at end of file
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "rclcpp/rclcpp.hpp"
+#include "autopilot/autopilot.hpp"
+
+/**
+ * @brief Runs one autopilot per vehicle in the same process. The vehicle namespaces are read from the "vehicles" parameter
+ * of the "autopilot_fleet" node, and all the autopilots share the same plugin class loaders and a bounded pool of threads.
+ * The autopilot parameters are read from the parameter files passed with --ros-args --params-file, as for the single
+ * vehicle executable, so vehicle specific overrides can be set under /<vehicle_ns>/autopilot
+ */
+int main(int argc, char ** argv) {
+    
+    // Initialize ROS2
+    rclcpp::init(argc, argv);
+
+    // Create the node that holds the configuration of the fleet
+    auto fleet_node = std::make_shared<rclcpp::Node>("autopilot_fleet");
+    fleet_node->declare_parameter<std::vector<std::string>>("vehicles", std::vector<std::string>());
+    fleet_node->declare_parameter<int>("threads", 0);
+    std::vector<std::string> vehicles = fleet_node->get_parameter("vehicles").as_string_array();
+    int threads = fleet_node->get_parameter("threads").as_int();
+
+    if (vehicles.empty()) {
+        RCLCPP_ERROR(fleet_node->get_logger(), "No vehicles defined in the fleet configuration (parameter 'vehicles')");
+        rclcpp::shutdown();
+        return EXIT_FAILURE;
+    }
+
+    // By default, use one thread per vehicle, bounded by the number of cores available
+    if (threads <= 0) threads = static_cast<int>(std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), vehicles.size()));
+
+    // Load the plugin libraries only once and share them between all the autopilots
+    auto plugin_loaders = std::make_shared<autopilot::PluginLoaders>();
+
+    // Create one autopilot per vehicle, each under its own namespace
+    rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), static_cast<std::size_t>(threads));
+    std::vector<std::shared_ptr<autopilot::Autopilot>> autopilots;
+
+    for (const std::string & vehicle_ns : vehicles) {
+        RCLCPP_INFO_STREAM(fleet_node->get_logger(), "Creating the autopilot for vehicle: " << vehicle_ns);
+        auto options = rclcpp::NodeOptions().arguments({"--ros-args", "-r", "__node:=autopilot", "-r", "__ns:=/" + vehicle_ns});
+        autopilots.push_back(std::make_shared<autopilot::Autopilot>(options, plugin_loaders));
+        executor.add_node(autopilots.back());
+    }
+
+    RCLCPP_INFO_STREAM(fleet_node->get_logger(), "Running " << autopilots.size() << " autopilots on " << threads << " threads");
+
+    // Spin all the autopilots until shutdown
+    executor.add_node(fleet_node);
+    executor.spin();
+
+    rclcpp::shutdown();
+    return 0;
+}
@@ -46,6 +46,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
 #include <memory>
+#include <cstdlib>
 #include "rclcpp/rclcpp.hpp"
 #include "autopilot/autopilot.hpp"
 
@@ -54,14 +55,18 @@ int main(int argc, char ** argv) {
     // Initialize ROS2
     rclcpp::init(argc, argv);
 
-    // Create the autopilot node
+    // Create the autopilot node (the node initializes itself on construction)
     auto autopilot_node = std::make_shared<autopilot::Autopilot>();
 
-    // Initialize the autopilot node
-    autopilot_node->initialize();
+    // The process only runs this autopilot, so stop it if the autopilot cannot be initialized with the vehicle constants
+    bool configuration_error = false;
+    autopilot_node->set_configuration_error_callback([&configuration_error](const std::exception &) {
+        configuration_error = true;
+        rclcpp::shutdown();
+    });
 
     // Spin the node until shutdown
     rclcpp::spin(autopilot_node);
     rclcpp::shutdown();
-    return 0;
+    return configuration_error ? EXIT_FAILURE : EXIT_SUCCESS;
 }
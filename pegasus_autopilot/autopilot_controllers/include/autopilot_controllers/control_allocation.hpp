@@ -0,0 +1,188 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+namespace autopilot {
+
+/**
+ * @brief Control allocation of a multirotor. Maps the total thrust and the torque to apply to the vehicle
+ * into the thrust of each rotor, using a mixer matrix (the pseudo-inverse of the effectiveness matrix of the
+ * airframe) that is computed only once, when the geometry of the vehicle is set. The rotors are described
+ * with the same convention as the CA_ROTORx parameters of PX4: the position of the rotor in the body frame (f.r.d)
+ * and the signed ratio between the yaw moment and the thrust of the rotor (positive for rotors spinning counter-clockwise,
+ * seen from above). All the vectors have a fixed maximum size, so allocating the thrusts does not touch the heap.
+ * The computations are performed in the precision of the template type T (float or double).
+ */
+template <typename T>
+class ControlAllocation {
+
+public:
+
+    // Maximum number of rotors supported (octocopters)
+    static constexpr int MAX_ROTORS = 8;
+
+    // Vector with the [thrust, torque_x, torque_y, torque_z] to apply to the vehicle (in N and Nm)
+    using Wrench = Eigen::Matrix<T, 4, 1>;
+    using Vector3 = Eigen::Matrix<T, 3, 1>;
+
+    // Thrust of each rotor (in N)
+    using Thrusts = Eigen::Matrix<T, Eigen::Dynamic, 1, Eigen::ColMajor, MAX_ROTORS, 1>;
+
+    // Effectiveness matrix (wrench = B * thrusts) and mixer matrix (thrusts = M * wrench)
+    using Effectiveness = Eigen::Matrix<T, 4, Eigen::Dynamic, Eigen::ColMajor, 4, MAX_ROTORS>;
+    using Mixer = Eigen::Matrix<T, Eigen::Dynamic, 4, Eigen::ColMajor, MAX_ROTORS, 4>;
+
+    /**
+     * @brief The geometry of a rotor of the vehicle
+     */
+    struct Rotor {
+        T x;    /**< @brief Position of the rotor along the forward axis of the body frame (m) */
+        T y;    /**< @brief Position of the rotor along the right axis of the body frame (m) */
+        T km;   /**< @brief Ratio between the yaw moment and the thrust of the rotor (positive if spinning counter-clockwise) */
+    };
+
+    ControlAllocation() = default;
+
+    /**
+     * @brief Construct the control allocation for a given airframe. Throws a std::runtime_error if the
+     * geometry is not valid, i.e. the thrust and the three torques cannot be controlled independently
+     * @param rotors The geometry of each rotor
+     * @param max_thrust The maximum thrust of each rotor (N)
+     */
+    ControlAllocation(const std::vector<Rotor> & rotors, const T max_thrust) : max_thrust_(max_thrust) {
+
+        // Validate the number of rotors and the thrust limit
+        if (rotors.size() < 4 || rotors.size() > static_cast<std::size_t>(MAX_ROTORS)) throw std::runtime_error("The control allocation requires between 4 and " + std::to_string(MAX_ROTORS) + " rotors");
+        if (!std::isfinite(max_thrust) || max_thrust <= T(0)) throw std::runtime_error("The maximum thrust of each rotor must be positive");
+
+        // Build the effectiveness matrix. Each rotor produces a thrust along -Z_B, a torque (r x F) and a yaw moment proportional to its thrust
+        const int n = static_cast<int>(rotors.size());
+        effectiveness_.resize(4, n);
+        for (int i = 0; i < n; i++) {
+            effectiveness_.col(i) << T(1), -rotors[i].y, rotors[i].x, rotors[i].km;
+        }
+        if (!effectiveness_.allFinite()) throw std::runtime_error("The geometry of the rotors must be finite");
+
+        // Compute the mixer as the pseudo-inverse of the effectiveness matrix, M = B^T (B B^T)^-1 (only done once at startup)
+        const Eigen::FullPivLU<Eigen::Matrix<T, 4, 4>> decomposition(effectiveness_ * effectiveness_.transpose());
+        if (decomposition.rank() < 4) throw std::runtime_error("The geometry of the rotors cannot produce independent thrust and torques");
+        mixer_ = effectiveness_.transpose() * decomposition.inverse();
+
+        // Preallocate the output
+        thrusts_ = Thrusts::Zero(n);
+    }
+
+    /**
+     * @brief Compute the thrust of each rotor to apply a given total thrust and torque. If a rotor saturates, the
+     * thrusts are first shifted along the direction that changes only the total thrust (such that the torque is kept),
+     * and only then clipped to the limits of the rotors
+     * @param thrust The total thrust to apply along -Z_B (N)
+     * @param torque The torque to apply in the body frame f.r.d (Nm)
+     * @return A reference to the thrust of each rotor (N), valid until the next call
+     */
+    const Thrusts & allocate(const T thrust, const Vector3 & torque) noexcept {
+
+        // Apply the mixer
+        Wrench wrench;
+        wrench << thrust, torque;
+        thrusts_.noalias() = mixer_ * wrench;
+
+        // Compute the shift along the thrust direction that brings the saturated rotors back to the limits
+        T k_min = T(0);
+        T k_max = T(0);
+        for (int i = 0; i < thrusts_.size(); i++) {
+            const T direction = mixer_(i, 0);
+            if (direction <= T(0)) continue;
+            T k = T(0);
+            if (thrusts_[i] < T(0)) k = -thrusts_[i] / direction;
+            else if (thrusts_[i] > max_thrust_) k = (max_thrust_ - thrusts_[i]) / direction;
+            k_min = std::min(k_min, k);
+            k_max = std::max(k_max, k);
+        }
+        thrusts_ += (k_min + k_max) * mixer_.col(0);
+
+        // Clip what is left to the limits of the rotors (when the torque alone is not feasible)
+        thrusts_ = thrusts_.cwiseMax(T(0)).cwiseMin(max_thrust_);
+        return thrusts_;
+    }
+
+    /**
+     * @brief Compute the total thrust and torque produced by a given thrust of each rotor
+     * @param thrusts The thrust of each rotor (N)
+     * @return The [thrust, torque_x, torque_y, torque_z] applied to the vehicle
+     */
+    Wrench wrench(const Thrusts & thrusts) const {
+        return effectiveness_ * thrusts;
+    }
+
+    inline int num_rotors() const { return static_cast<int>(effectiveness_.cols()); }
+    inline T max_thrust() const { return max_thrust_; }
+    inline const Effectiveness & effectiveness() const { return effectiveness_; }
+    inline const Mixer & mixer() const { return mixer_; }
+
+protected:
+
+    // The maximum thrust of each rotor (N)
+    T max_thrust_{0};
+
+    // The effectiveness and mixer matrices of the airframe
+    Effectiveness effectiveness_;
+    Mixer mixer_;
+
+    // The last thrusts computed
+    Thrusts thrusts_;
+};
+
+}
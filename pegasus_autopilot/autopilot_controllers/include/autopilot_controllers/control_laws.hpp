@@ -0,0 +1,165 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+namespace autopilot {
+
+/**
+ * @brief Method that given a desired acceleration to apply to the multirotor,
+ * its mass and desired yaw angle (in radian), computes the desired attitude to apply to the vehicle.
+ * It returns an Eigen::Matrix<T, 4, 1> object which contains [roll, pitch, yaw, thrust]
+ * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
+ * The computations are performed in the precision of the template type T (float or double).
+ * 
+ * @param u The desired acceleration to apply to the vehicle in m/s^2
+ * @param mass The mass of the vehicle in Kg
+ * @param yaw The desired yaw angle of the vehicle in radians
+ * @return Eigen::Matrix<T, 4, 1> object which contains [roll, pitch, yaw, thrust]
+ * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
+ */
+template <typename T>
+inline Eigen::Matrix<T, 4, 1> attitude_thrust_from_acceleration(const Eigen::Matrix<T, 3, 1> & u, const T mass, const T yaw) {
+
+    Eigen::Matrix<T, 3, 3> RzT;
+    Eigen::Matrix<T, 3, 1> r3d;
+    Eigen::Matrix<T, 4, 1> attitude_thrust;
+
+    /* Compute the normalized thrust and r3d vector */
+    const T thrust = mass * u.norm();
+
+    /* Compute the rotation matrix about the Z-axis */
+    RzT << std::cos(yaw), std::sin(yaw), T(0),
+          -std::sin(yaw), std::cos(yaw), T(0),
+                    T(0),          T(0), T(1);
+
+    /* Compute the normalized rotation */
+    r3d = -RzT * u / u.norm();
+
+    /* Compute the actual attitude and setup the desired thrust to apply to the vehicle */
+    attitude_thrust << std::asin(-r3d[1]), std::atan2(r3d[0], r3d[2]), yaw, thrust;
+    return attitude_thrust;
+}
+
+/**
+ * @brief The output of the geometric attitude law of the Mellinger controller
+ */
+template <typename T>
+struct GeometricAttitudeRate {
+    Eigen::Matrix<T, 3, 3> R_des;                   /**< @brief The desired attitude of the vehicle */
+    Eigen::Matrix<T, 3, 1> rotation_error;          /**< @brief The rotation error (vee map of the error in SO(3)) */
+    Eigen::Matrix<T, 3, 1> desired_angular_rate;    /**< @brief The feed-forward angular rate in rad/s */
+    Eigen::Matrix<T, 3, 1> attitude_rate;           /**< @brief The attitude rate to track in rad/s */
+    T thrust;                                       /**< @brief The total thrust to apply along the Z_B axis in Newton */
+};
+
+/**
+ * @brief Method that given the desired force to apply to the vehicle (in the inertial frame), computes
+ * the attitude rate and total thrust to track it, following the geometric control law described in
+ * [3] T. Lee, M. Leok and N. H. McClamroch, "Geometric Tracking Control of a Quadrotor UAV on SE(3)".
+ * The computations are performed in the precision of the template type T (float or double).
+ * 
+ * @param F_des The desired force to apply to the vehicle in Newton
+ * @param R The current attitude of the vehicle
+ * @param jerk The desired jerk in m/s^3 (used for the feed-forward angular rate)
+ * @param mass The mass of the vehicle in Kg
+ * @param yaw The desired yaw angle in radians
+ * @param yaw_rate The desired yaw rate in rad/s
+ * @param kr The gains of the attitude error
+ * @return GeometricAttitudeRate<T> The attitude rate and thrust to apply, with the intermediate errors
+ */
+template <typename T>
+inline GeometricAttitudeRate<T> geometric_attitude_rate(const Eigen::Matrix<T, 3, 1> & F_des, const Eigen::Matrix<T, 3, 3> & R, const Eigen::Matrix<T, 3, 1> & jerk, const T mass, const T yaw, const T yaw_rate, const Eigen::Matrix<T, 3, 3> & kr) {
+
+    GeometricAttitudeRate<T> out;
+
+    // Compute the desired body-frame axis Z_b (b3d)
+    // Check [3-eq.12] for more details
+    const Eigen::Matrix<T, 3, 1> Z_b_des = -F_des / F_des.norm();
+
+    // Compute Y_C
+    const Eigen::Matrix<T, 3, 1> Y_C(-std::sin(yaw), std::cos(yaw), T(0));
+
+    // Compute X_B_des
+    Eigen::Matrix<T, 3, 1> X_b_des = Y_C.cross(Z_b_des);
+    X_b_des = X_b_des / X_b_des.norm();
+
+    // Compute Y_B_des
+    Eigen::Matrix<T, 3, 1> Y_b_des = Z_b_des.cross(X_b_des);
+    Y_b_des = Y_b_des / Y_b_des.norm();
+
+    // Compute the desired rotation R_des = [X_b_des | Y_b_des | Z_b_des]
+    out.R_des.col(0) = X_b_des;
+    out.R_des.col(1) = Y_b_des;
+    out.R_des.col(2) = Z_b_des;
+
+    // Compute the rotation error
+    const Eigen::Matrix<T, 3, 3> R_error = (out.R_des.transpose() * R) - (R.transpose() * out.R_des);
+
+    // Compute the vee map of the rotation error and project into the coordinates of the manifold
+    out.rotation_error << -R_error(1,2), R_error(0, 2), -R_error(0,1);
+    out.rotation_error = T(0.5) * out.rotation_error;
+
+    // Get the desired total thrust (in Newtons) in Z_B direction (u_1)
+    const Eigen::Matrix<T, 3, 1> Z_B = R.col(2);
+    out.thrust = -F_des.dot(Z_B);
+
+    // Compute the desired angular velocity for the feed-forward terms
+    out.desired_angular_rate(0) =  mass / out.thrust * Y_b_des.dot(jerk);
+    out.desired_angular_rate(1) = -mass / out.thrust * X_b_des.dot(jerk);
+    out.desired_angular_rate(2) = yaw_rate * Z_b_des[2];
+
+    // Compute the target attitude rate
+    out.attitude_rate = out.desired_angular_rate - (kr * out.rotation_error);
+    return out;
+}
+
+} // namespace autopilot
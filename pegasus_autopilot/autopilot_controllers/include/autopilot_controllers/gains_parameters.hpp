@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <Eigen/Core>
+
+#include "pid/pid.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Reader of the gains of a controller from the parameters "<prefix>.gains.*" of the node. It is used both when the controller
+ * is initialized and when the gains are changed in flight. In the latter case, the parameters being set take precedence over the ones
+ * stored in the node (the callback that validates them runs before they are stored). The methods throw a std::runtime_error if a gain is not valid
+ */
+class GainsParameters {
+
+public:
+
+    /**
+     * @brief Construct a new reader of the gains
+     * @param node The ROS 2 node with the parameters
+     * @param prefix The prefix of the parameters of the controller (e.g. "autopilot.PIDController")
+     * @param changes The parameters being set, if the gains are being changed in flight
+     */
+    GainsParameters(const rclcpp::Node::SharedPtr & node, const std::string & prefix, const std::vector<rclcpp::Parameter> & changes = {}) : 
+        node_(node), prefix_(prefix + ".gains."), changes_(changes) {}
+
+    /**
+     * @brief Check if any of the parameters being set is a gain of the controller
+     */
+    bool changed() const {
+        return std::any_of(changes_.begin(), changes_.end(), [this](const rclcpp::Parameter & parameter) { return parameter.get_name().rfind(prefix_, 0) == 0; });
+    }
+
+    /**
+     * @brief Get a gain with one value per axis [x, y, z]
+     * @param name The name of the gain (e.g. "kp")
+     */
+    Eigen::Vector3d vector3(const std::string & name) const {
+        const std::vector<double> values = get(name).as_double_array();
+        if (values.size() != 3 || !std::all_of(values.begin(), values.end(), [](double value) { return std::isfinite(value); })) {
+            throw std::runtime_error("Gain " + prefix_ + name + " must have 3 finite values");
+        }
+        return Eigen::Vector3d(values[0], values[1], values[2]);
+    }
+
+    /**
+     * @brief Get a gain with one value per axis [x, y, z], which must not be negative
+     * @param name The name of the gain (e.g. "kp")
+     */
+    Eigen::Vector3d positive_vector3(const std::string & name) const {
+        const Eigen::Vector3d values = vector3(name);
+        if ((values.array() < 0.0).any()) throw std::runtime_error("Gain " + prefix_ + name + " must not be negative");
+        return values;
+    }
+
+    inline double scalar(const std::string & name) const { return get(name).as_double(); }
+    inline bool boolean(const std::string & name) const { return get(name).as_bool(); }
+    inline std::string string(const std::string & name) const { return get(name).as_string(); }
+
+    /**
+     * @brief Get the gains of the position PID of the controller (with a unitary feed-forward gain)
+     * @tparam Scalar The floating point type of the PID
+     */
+    template <typename Scalar>
+    typename Pegasus::Pid<3, Scalar>::Gains pid() const {
+
+        typename Pegasus::Pid<3, Scalar>::Gains gains;
+        gains.kp = positive_vector3("kp").array().cast<Scalar>();
+        gains.kd = positive_vector3("kd").array().cast<Scalar>();
+        gains.ki = positive_vector3("ki").array().cast<Scalar>();
+        gains.kff = Pegasus::Pid<3, Scalar>::Vector::Ones();
+        gains.min_output = vector3("min_output").array().cast<Scalar>();
+        gains.max_output = vector3("max_output").array().cast<Scalar>();
+        gains.anti_windup = Pegasus::Pid<3, Scalar>::anti_windup_from_string(string("anti_windup"));
+        gains.kb = positive_vector3("kb").array().cast<Scalar>();
+        gains.derivative_cutoff = static_cast<Scalar>(scalar("derivative_cutoff"));
+
+        if ((gains.min_output > gains.max_output).any()) throw std::runtime_error("Gain " + prefix_ + "min_output must not be greater than max_output");
+        if (!(gains.derivative_cutoff >= Scalar(0))) throw std::runtime_error("Gain " + prefix_ + "derivative_cutoff must not be negative");
+        return gains;
+    }
+
+protected:
+
+    // Get the value being set, or the one stored in the node if the parameter is not being changed
+    rclcpp::Parameter get(const std::string & name) const {
+        for (const rclcpp::Parameter & parameter : changes_) {
+            if (parameter.get_name() == prefix_ + name) return parameter;
+        }
+        return node_->get_parameter(prefix_ + name);
+    }
+
+    rclcpp::Node::SharedPtr node_;
+    std::string prefix_;
+    std::vector<rclcpp::Parameter> changes_;
+};
+
+}
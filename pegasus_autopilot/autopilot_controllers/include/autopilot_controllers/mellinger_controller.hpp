@@ -47,10 +47,11 @@
  ****************************************************************************/
 #pragma once
 
+#include <optional>
 #include <Eigen/Core>
 
 // Library that implements PID controllers
-#include "autopilot_controllers/pid.hpp"
+#include "pid/pid.hpp"
 
 // ROS libraries
 #include "rclcpp/rclcpp.hpp"
@@ -59,8 +60,17 @@
 #include "pegasus_msgs/msg/control_attitude.hpp"
 #include "pegasus_msgs/msg/control_position.hpp"
 #include "pegasus_msgs/msg/mellinger_statistics.hpp"
+#include "std_msgs/msg/float32_multi_array.hpp"
+
+// Thrust curve of the vehicle (to convert the thrust of each motor to a percentage)
+#include "thrust_curves/thrust_curve_variant.hpp"
 
 #include <autopilot/controller.hpp>
+#include <autopilot/statistics_publisher.hpp>
+#include <autopilot/rcu_cell.hpp>
+#include "autopilot_controllers/control_laws.hpp"
+#include "autopilot_controllers/control_allocation.hpp"
+#include "autopilot_controllers/gains_parameters.hpp"
 
 namespace autopilot {
 
@@ -77,6 +87,10 @@ namespace autopilot {
  * [3] T. Lee, M. Leok and N. H. McClamroch, "Geometric Tracking Control of a Quadrotor UAV on SE(3),"
  * 49th IEEE Conference on Decision and Control (CDC), Atlanta, GA, USA, 2010, 
  * pp. 5420-5425, doi: 10.1109/CDC.2010.5717652.
+ *
+ * The output of the controller is either the attitude rate and total thrust (tracked by the rate controller of the
+ * onboard micro-controller) or, with the "motors" output, the thrust of each motor, computed with an angular rate
+ * controller and the control allocation of the airframe (bypassing the attitude and rate controllers of the micro-controller).
  */
 class MellingerController : public autopilot::Controller {
 
@@ -86,33 +100,90 @@ public:
 
     void initialize() override;
     void reset_controller() override;
-    void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) override;
-    void set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) override;
-    void set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) override;
+    Capabilities capabilities() const override { return CONTROL_POSITION | CONTROL_ATTITUDE | CONTROL_ATTITUDE_RATE | CONTROL_MOTOR_SPEED; }
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) noexcept override;
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept override;
+    ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) noexcept override;
+    ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) noexcept override;
+    ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, double dt=0) noexcept override;
     
 protected:
 
-    // Update the statistics of the controller
-    void update_statistics(const Eigen::Vector3d & position_ref, const Eigen::Vector3d & rotation_error, const Eigen::Vector3d & desired_angular_rate, double thrust_reference, const Eigen::Vector3d & attitude_rate_reference, const Eigen::Vector3d & euler_angles, const Eigen::Vector3d & euler_angles_desired);
+    // Vectors and matrices in the precision of the control computations (float when built with AUTOPILOT_SINGLE_PRECISION)
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+    using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+
+    // Gains of the controller that can be changed in flight
+    struct Gains {
+        Pegasus::Pid<3, Scalar>::Gains pid;     // Gains of the position PID
+        Matrix3 kr{Matrix3::Identity()};        // Gains of the attitude error
+        Matrix3 kw{Matrix3::Identity()};        // Gains of the angular rate error (only used with the "motors" output)
+        std::string anti_windup;                // Name of the anti-windup mechanism of the PID (for logging)
+        bool bumpless_transfer{true};           // Keep the output of the PID continuous when the gains change
+    };
+
+    // Read and validate the gains of the controller (throws a std::runtime_error if they are not valid)
+    static Gains read_gains(const GainsParameters & parameters);
+    void log_gains(const Gains & gains) const;
+
+    // Validate the gains being set and publish them to the control loop (called by ROS 2 before the parameters are stored)
+    rcl_interfaces::msg::SetParametersResult on_set_parameters(const std::vector<rclcpp::Parameter> & parameters);
+
+    // Apply the gains published since the last iteration of the control loop
+    void update_gains();
+
+    // Read the inertia and the geometry of the rotors and precompute the control allocation (only used with the "motors" output)
+    void initialize_motors_output();
+
+    // Track the attitude rate (in rad/s) and total thrust (in N) with the thrust of each motor
+    ControlStatus set_attitude_rate_motors(const Vector3 & attitude_rate, Scalar thrust, const Vector3 & angular_velocity) noexcept;
+
+    // Update the statistics of the controller (only invoked in the iterations in which the statistics are published)
+    void update_statistics(const Eigen::Vector3d & position_ref, const GeometricAttitudeRate<Scalar> & control, const Eigen::Vector3d & attitude_rate_reference, const Matrix3 & R);
+
+    // Publish the statistics of the controller (virtual such that the publisher can be stubbed out, e.g. in benchmarks)
+    virtual void publish_statistics(const rclcpp::Time & stamp);
 
     // The mass of the vehicle
-    double mass_;
+    Scalar mass_;
 
-    // The PID controllers for position tracking
-    std::array<Pegasus::Pid::UniquePtr, 3> controllers_{nullptr};
+    // The PID controller for position tracking (on the x, y and z axis at once)
+    Pegasus::Pid<3, Scalar> pid_;
 
     // Gains for the attitude controller
-    Eigen::Matrix3d kr_;
+    Matrix3 kr_;
+
+    // Gains for the angular rate controller (only used with the "motors" output)
+    Matrix3 kw_;
+
+    // Send the thrust of each motor instead of the attitude rate and total thrust to the vehicle
+    bool output_motors_{false};
+
+    // The inertia of the vehicle, the control allocation of the airframe and the thrust curve of the motors (only used with the "motors" output)
+    Matrix3 inertia_{Matrix3::Identity()};
+    std::optional<ControlAllocation<Scalar>> allocation_;
+    std::optional<Pegasus::ThrustCurveVariant> thrust_curve_;
+
+    // The speed of each motor (0-100%), preallocated such that the control loop does not allocate memory
+    Eigen::VectorXd motor_speed_;
+
+    // Gains published by the parameters callback and the version of the ones applied to the controller
+    RcuCell<Gains> gains_;
+    std::uint64_t gains_version_{0};
+    rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr parameters_callback_{nullptr};
 
     // ROS2 messages
     pegasus_msgs::msg::ControlAttitude attitude_msg_;
     pegasus_msgs::msg::ControlAttitude attitude_rate_msg_;
-    pegasus_msgs::msg::MellingerStatistics statistics_msg_;
+    std_msgs::msg::Float32MultiArray motors_msg_;
 
     // ROS2 publishers
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_publisher_{nullptr};
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_rate_publisher_{nullptr};
-    rclcpp::Publisher<pegasus_msgs::msg::MellingerStatistics>::SharedPtr statistics_pub_{nullptr};
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr motors_publisher_{nullptr};
+
+    // Publisher of the statistics of the controller (only computed when someone is listening)
+    StatisticsPublisher<pegasus_msgs::msg::MellingerStatistics>::UniquePtr statistics_{nullptr};
 };
 
 }
\ No newline at end of file
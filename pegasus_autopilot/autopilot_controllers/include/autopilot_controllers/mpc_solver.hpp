@@ -0,0 +1,256 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+
+namespace autopilot {
+
+/**
+ * @brief Solver for the quadratic programs that arise in linear model predictive control with a horizon of N steps and NU inputs
+ * per step, where the constraints only couple the inputs of the same step:
+ * 
+ *      minimize    1/2 x' H x + f' x
+ *      subject to  l_k <= G x_k <= u_k,   k = 0, ..., N-1
+ * 
+ * The problem is solved with the alternating direction method of multipliers (ADMM), with the same iterations as OSQP. The matrix
+ * of the linear system solved at each iteration does not depend on the references, so it is only factorized when the problem is set up.
+ * All the storage has a size known at compile time, so solving a problem does not allocate memory. Consecutive problems are warm
+ * started from the previous solution, shifted by one step.
+ * @tparam N The number of steps in the horizon
+ * @tparam NU The number of inputs per step
+ * @tparam NG The number of constraints per step
+ * @tparam Scalar The floating point type used in the computations (the settings and the residuals are always in double)
+ */
+template <int N, int NU, int NG, typename Scalar = double>
+class StagewiseQpSolver {
+
+public:
+
+    static constexpr int NV = N * NU;   // Number of decision variables
+    static constexpr int NC = N * NG;   // Number of constraints
+
+    using VectorV = Eigen::Matrix<Scalar, NV, 1>;
+    using VectorC = Eigen::Matrix<Scalar, NC, 1>;
+    using MatrixV = Eigen::Matrix<Scalar, NV, NV>;
+    using MatrixG = Eigen::Matrix<Scalar, NG, NU>;
+
+    struct Settings {
+        double rho{1.0};                // Penalty of the constraints in the augmented lagrangian
+        double sigma{1e-6};             // Regularization of the decision variables (keeps the linear system positive definite)
+        double alpha{1.6};              // Relaxation parameter
+        double eps_abs{1e-3};           // Absolute tolerance of the primal and dual residuals
+        double eps_rel{1e-3};           // Relative tolerance of the primal and dual residuals
+        int max_iterations{50};         // Maximum number of iterations per solve
+        int check_interval{5};          // Number of iterations between checks of the termination criteria
+    };
+
+    struct Info {
+        int iterations{0};              // Number of iterations performed in the last solve
+        bool converged{false};          // Whether the last solve reached the tolerances before the maximum number of iterations
+        double primal_residual{0.0};    // Primal residual at the last check
+        double dual_residual{0.0};      // Dual residual at the last check
+    };
+
+    /**
+     * @brief Set up the cost and the constraints of the problem. Factorizes the matrix of the ADMM linear system
+     * @param H The hessian of the cost (symmetric positive semidefinite)
+     * @param G The matrix of the constraints of each step
+     * @param settings The settings of the solver
+     */
+    void setup(const MatrixV & H, const MatrixG & G, const Settings & settings) {
+
+        H_ = H;
+        G_ = G;
+        settings_ = settings;
+
+        // K = H + sigma * I + rho * C' C, where C is the block diagonal matrix with G in each step
+        MatrixV K = H_ + static_cast<Scalar>(settings_.sigma) * MatrixV::Identity();
+        const Eigen::Matrix<Scalar, NU, NU> GtG = static_cast<Scalar>(settings_.rho) * G_.transpose() * G_;
+        for (int k = 0; k < N; k++) K.template block<NU, NU>(k * NU, k * NU) += GtG;
+        llt_.compute(K);
+
+        reset();
+    }
+
+    /**
+     * @brief Clear the warm start of the solver
+     */
+    void reset() {
+        x_.setZero();
+        z_.setZero();
+        y_.setZero();
+        info_ = Info();
+    }
+
+    /**
+     * @brief Shift the last solution by one step, to be used as the initial guess of the next problem (the last step is repeated)
+     */
+    void shift() {
+        x_.template head<NV - NU>() = x_.template tail<NV - NU>().eval();
+        z_.template head<NC - NG>() = z_.template tail<NC - NG>().eval();
+        y_.template head<NC - NG>() = y_.template tail<NC - NG>().eval();
+    }
+
+    /**
+     * @brief Solve the problem with the linear cost f and the bounds l and u of the constraints, starting from the current
+     * warm start. Unbounded constraints can be set to +/- infinity
+     * @param f The linear term of the cost
+     * @param l The lower bounds of the constraints
+     * @param u The upper bounds of the constraints
+     * @return The information about the solve
+     */
+    const Info & solve(const VectorV & f, const VectorC & l, const VectorC & u) {
+
+        const Scalar rho = static_cast<Scalar>(settings_.rho);
+        const Scalar sigma = static_cast<Scalar>(settings_.sigma);
+        const Scalar alpha = static_cast<Scalar>(settings_.alpha);
+
+        info_.converged = false;
+        info_.iterations = 0;
+
+        // Project the warm start of the constraints to the new bounds
+        z_ = z_.cwiseMax(l).cwiseMin(u);
+
+        for (int i = 1; i <= settings_.max_iterations; i++) {
+
+            // Solve the linear system for the decision variables
+            rhs_ = sigma * x_ - f + apply_Ct(rho * z_ - y_);
+            x_tilde_ = llt_.solve(rhs_);
+            z_tilde_ = apply_C(x_tilde_);
+
+            // Relaxed update of the decision variables and projection of the constraints on the bounds
+            x_ = alpha * x_tilde_ + (Scalar(1) - alpha) * x_;
+            z_relaxed_ = alpha * z_tilde_ + (Scalar(1) - alpha) * z_;
+            z_ = (z_relaxed_ + y_ / rho).cwiseMax(l).cwiseMin(u);
+
+            // Update the lagrange multipliers
+            y_ += rho * (z_relaxed_ - z_);
+            info_.iterations = i;
+
+            // Check the termination criteria
+            if (i % settings_.check_interval == 0 || i == settings_.max_iterations) {
+                if (check_termination(f)) {
+                    info_.converged = true;
+                    break;
+                }
+            }
+        }
+
+        return info_;
+    }
+
+    /**
+     * @brief Get the solution of the last solve
+     */
+    inline const VectorV & solution() const { return x_; }
+
+    /**
+     * @brief Get the information about the last solve
+     */
+    inline const Info & info() const { return info_; }
+
+protected:
+
+    // Multiply by the block diagonal matrix of the constraints (and its transpose), without building it
+    inline VectorC apply_C(const VectorV & x) const {
+        VectorC c;
+        for (int k = 0; k < N; k++) c.template segment<NG>(k * NG) = G_ * x.template segment<NU>(k * NU);
+        return c;
+    }
+
+    inline VectorV apply_Ct(const VectorC & c) const {
+        VectorV x;
+        for (int k = 0; k < N; k++) x.template segment<NU>(k * NU) = G_.transpose() * c.template segment<NG>(k * NG);
+        return x;
+    }
+
+    bool check_termination(const VectorV & f) {
+
+        // Primal residual: || C x - z ||
+        const VectorC Cx = apply_C(x_);
+        info_.primal_residual = (Cx - z_).template lpNorm<Eigen::Infinity>();
+
+        // Dual residual: || H x + f + C' y ||
+        const VectorV Hx = H_ * x_;
+        const VectorV Cty = apply_Ct(y_);
+        info_.dual_residual = (Hx + f + Cty).template lpNorm<Eigen::Infinity>();
+
+        const double eps_primal = settings_.eps_abs + settings_.eps_rel * static_cast<double>(std::max(Cx.template lpNorm<Eigen::Infinity>(), z_.template lpNorm<Eigen::Infinity>()));
+        const double eps_dual = settings_.eps_abs + settings_.eps_rel * static_cast<double>(std::max({Hx.template lpNorm<Eigen::Infinity>(), f.template lpNorm<Eigen::Infinity>(), Cty.template lpNorm<Eigen::Infinity>()}));
+
+        return info_.primal_residual <= eps_primal && info_.dual_residual <= eps_dual;
+    }
+
+    // The problem and the settings of the solver
+    MatrixV H_{MatrixV::Zero()};
+    MatrixG G_{MatrixG::Zero()};
+    Settings settings_;
+
+    // Factorization of the matrix of the ADMM linear system
+    Eigen::LLT<MatrixV> llt_;
+
+    // Iterates of the solver (also used as warm start)
+    VectorV x_{VectorV::Zero()};
+    VectorC z_{VectorC::Zero()};
+    VectorC y_{VectorC::Zero()};
+
+    // Work vectors
+    VectorV rhs_;
+    VectorV x_tilde_;
+    VectorC z_tilde_;
+    VectorC z_relaxed_;
+
+    // Information about the last solve
+    Info info_;
+};
+
+} // namespace autopilot
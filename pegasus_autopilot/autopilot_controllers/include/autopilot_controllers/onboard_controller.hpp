@@ -57,6 +57,7 @@
 #include "pegasus_msgs/msg/control_position.hpp"
 #include "pegasus_msgs/msg/control_velocity.hpp"
 #include "pegasus_msgs/msg/control_acceleration.hpp"
+#include "std_msgs/msg/float32_multi_array.hpp"
 
 #include <autopilot/controller.hpp>
 
@@ -69,14 +70,16 @@ public:
     ~OnboardController();
 
     void initialize() override;
-    void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) override;
+    Capabilities capabilities() const override { return CONTROL_POSITION | CONTROL_INERTIAL_VELOCITY | CONTROL_BODY_VELOCITY | CONTROL_INERTIAL_ACCELERATION | CONTROL_ATTITUDE | CONTROL_ATTITUDE_RATE | CONTROL_MOTOR_SPEED; }
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) noexcept override;
     
-    void set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt=0) override;
-    void set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt=0) override;
-    void set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt=0) override;
+    ControlStatus set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt=0) noexcept override;
+    ControlStatus set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt=0) noexcept override;
+    ControlStatus set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt=0) noexcept override;
 
-    void set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) override;
-    void set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) override;
+    ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) noexcept override;
+    ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) noexcept override;
+    ControlStatus set_motor_speed(const Eigen::VectorXd& motor_velocity, double dt=0) noexcept override;
 
 protected:
 
@@ -87,6 +90,7 @@ protected:
     pegasus_msgs::msg::ControlAcceleration inertial_acceleration_msg_;
     pegasus_msgs::msg::ControlAttitude attitude_msg_;
     pegasus_msgs::msg::ControlAttitude attitude_rate_msg_;
+    std_msgs::msg::Float32MultiArray motors_msg_;
 
     // ROS2 publishers
     rclcpp::Publisher<pegasus_msgs::msg::ControlPosition>::SharedPtr position_publisher_;
@@ -95,6 +99,7 @@ protected:
     rclcpp::Publisher<pegasus_msgs::msg::ControlAcceleration>::SharedPtr inertial_acceleration_publisher_;
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_publisher_;
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_rate_publisher_;
+    rclcpp::Publisher<std_msgs::msg::Float32MultiArray>::SharedPtr motors_publisher_;
 };
 
 }
\ No newline at end of file
@@ -50,7 +50,7 @@
 #include <Eigen/Core>
 
 // Library that implements PID controllers
-#include "autopilot_controllers/pid.hpp"
+#include "pid/pid.hpp"
 
 // ROS libraries
 #include "rclcpp/rclcpp.hpp"
@@ -61,6 +61,10 @@
 #include "pegasus_msgs/msg/control_position.hpp"
 
 #include <autopilot/controller.hpp>
+#include <autopilot/statistics_publisher.hpp>
+#include <autopilot/rcu_cell.hpp>
+#include "autopilot_controllers/control_laws.hpp"
+#include "autopilot_controllers/gains_parameters.hpp"
 
 namespace autopilot {
 
@@ -72,44 +76,61 @@ public:
 
     void initialize() override;
     void reset_controller() override;
-    void set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) override;
-    void set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) override;
-    void set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) override;
+    Capabilities capabilities() const override { return CONTROL_POSITION | CONTROL_ATTITUDE | CONTROL_ATTITUDE_RATE; }
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate=0, double dt=0) noexcept override;
+    ControlStatus set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept override;
+    ControlStatus set_attitude(const Eigen::Vector3d& attitude, double thrust_force, double dt=0) noexcept override;
+    ControlStatus set_attitude_rate(const Eigen::Vector3d& attitude_rate, double thrust_force, double dt=0) noexcept override;
     
 protected:
 
-    /**
-     * @brief Method that given a desired acceleration to apply to the multirotor,
-     * its mass and desired yaw angle (in radian), computes the desired attitude to apply to the vehicle.
-     * It returns an Eigen::Vector4d object which contains [roll, pitch, yaw, thrust]
-     * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
-     * 
-     * @param u The desired acceleration to apply to the vehicle in m/s^2
-     * @param mass The mass of the vehicle in Kg
-     * @param yaw The desired yaw angle of the vehicle in radians
-     * @return Eigen::Vector4d object which contains [roll, pitch, yaw, thrust]
-     * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
-     */
-    Eigen::Vector4d get_attitude_thrust_from_acceleration(const Eigen::Vector3d & u, double mass, double yaw);
-    
-    // Update the statistics of the PID controllers
+    // Vectors in the precision of the control computations (float when built with AUTOPILOT_SINGLE_PRECISION)
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+
+    // Gains of the controller that can be changed in flight
+    struct Gains {
+        Pegasus::Pid<3, Scalar>::Gains pid;     // Gains of the position PID
+        std::string anti_windup;                // Name of the anti-windup mechanism of the PID (for logging)
+        bool bumpless_transfer{true};           // Keep the output of the PID continuous when the gains change
+    };
+
+    // Read and validate the gains of the controller (throws a std::runtime_error if they are not valid)
+    static Gains read_gains(const GainsParameters & parameters);
+    void log_gains(const Gains & gains) const;
+
+    // Validate the gains being set and publish them to the control loop (called by ROS 2 before the parameters are stored)
+    rcl_interfaces::msg::SetParametersResult on_set_parameters(const std::vector<rclcpp::Parameter> & parameters);
+
+    // Apply the gains published since the last iteration of the control loop
+    void update_gains();
+
+    // Update the statistics of the PID controllers (only invoked in the iterations in which the statistics are published)
     void update_statistics(const Eigen::Vector3d & position_ref);
 
+    // Publish the statistics of the controller (virtual such that the publisher can be stubbed out, e.g. in benchmarks)
+    virtual void publish_statistics(const rclcpp::Time & stamp);
+
     // The mass of the vehicle
-    double mass_;
+    Scalar mass_;
 
-    // The PID controllers for position tracking
-    std::array<Pegasus::Pid::UniquePtr, 3> controllers_{nullptr};
+    // The PID controller for position tracking (on the x, y and z axis at once)
+    Pegasus::Pid<3, Scalar> pid_;
+
+    // Gains published by the parameters callback and the version of the ones applied to the PID
+    RcuCell<Gains> gains_;
+    std::uint64_t gains_version_{0};
+    rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr parameters_callback_{nullptr};
 
     // ROS2 messages
     pegasus_msgs::msg::ControlAttitude attitude_msg_;
     pegasus_msgs::msg::ControlAttitude attitude_rate_msg_;
-    pegasus_msgs::msg::PidStatistics pid_statistics_msg_;
 
     // ROS2 publishers
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_publisher_{nullptr};
     rclcpp::Publisher<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_rate_publisher_{nullptr};
-    rclcpp::Publisher<pegasus_msgs::msg::PidStatistics>::SharedPtr statistics_pub_{nullptr};
+
+    // Publisher of the statistics of the controller (only computed when someone is listening)
+    StatisticsPublisher<pegasus_msgs::msg::PidStatistics>::UniquePtr statistics_{nullptr};
 };
 
 }
\ No newline at end of file
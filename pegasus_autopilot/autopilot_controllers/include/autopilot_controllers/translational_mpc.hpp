@@ -0,0 +1,242 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <Eigen/Core>
+
+#include "mpc_solver.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Linear model predictive controller for the translational dynamics of a multirotor, modelled as a double integrator
+ * on each axis (NED), where the input is the acceleration produced by the thrust:
+ * 
+ *      p(k+1) = p(k) + dt * v(k) + dt^2 / 2 * (u(k) + g * e3)
+ *      v(k+1) = v(k) + dt * (u(k) + g * e3)
+ * 
+ * The states are predicted over a horizon of N steps from the current state (condensed formulation), and the inputs are optimized
+ * relative to the feed-forward acceleration of the reference. The thrust is constrained between a minimum and a maximum value, and
+ * the tilt of the thrust vector is constrained with an inner polyhedral approximation of the cone with the maximum tilt angle.
+ * @tparam N The number of steps in the horizon
+ * @tparam Scalar The floating point type used in the computations (the configuration is always in double)
+ */
+template <int N, typename Scalar = double>
+class TranslationalMpc {
+
+public:
+
+    using Solver = StagewiseQpSolver<N, 3, 5, Scalar>;
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+
+    static constexpr double GRAVITY = 9.81;
+
+    struct Config {
+        double dt{0.05};                                    // Time step of the prediction model (s)
+        Eigen::Vector3d weight_position{10.0, 10.0, 10.0};  // Weight of the position error on each axis
+        Eigen::Vector3d weight_velocity{1.0, 1.0, 1.0};     // Weight of the velocity error on each axis
+        Eigen::Vector3d weight_input{0.1, 0.1, 0.1};        // Weight of the deviation from the reference acceleration on each axis
+        double terminal_weight{10.0};                       // Multiplier of the weights of the errors at the end of the horizon
+        double max_tilt{0.6};                               // Maximum tilt of the thrust vector (rad)
+        double min_acceleration{1.0};                       // Minimum acceleration produced by the thrust (m/s^2)
+        double max_acceleration{20.0};                      // Maximum acceleration produced by the thrust (m/s^2)
+        typename Solver::Settings solver;                   // Settings of the QP solver
+    };
+
+    // Position, velocity and acceleration references over the horizon (column k is the reference k steps ahead)
+    Eigen::Matrix<Scalar, 3, N + 1> position_reference{Eigen::Matrix<Scalar, 3, N + 1>::Zero()};
+    Eigen::Matrix<Scalar, 3, N + 1> velocity_reference{Eigen::Matrix<Scalar, 3, N + 1>::Zero()};
+    Eigen::Matrix<Scalar, 3, N> acceleration_reference{Eigen::Matrix<Scalar, 3, N>::Zero()};
+
+    /**
+     * @brief Build the prediction matrices, the cost and the constraints of the problem
+     * @param config The configuration of the controller
+     */
+    void setup(const Config & config) {
+
+        config_ = config;
+        const Scalar h = static_cast<Scalar>(config.dt);
+
+        Eigen::Matrix<Scalar, 2, 2> A;
+        A << Scalar(1), h,
+             Scalar(0), Scalar(1);
+        const Eigen::Matrix<Scalar, 2, 1> B(Scalar(0.5) * h * h, h);
+
+        // Prediction of the [position, velocity] of one axis over the horizon: X = Phi * x0 + Gamma * a
+        Eigen::Matrix<Scalar, 2, 2> Ak = Eigen::Matrix<Scalar, 2, 2>::Identity();
+        Gamma_.setZero();
+        for (int k = 0; k < N; k++) {
+            Ak = A * Ak;
+            Phi_.template block<2, 2>(2 * k, 0) = Ak;
+            Eigen::Matrix<Scalar, 2, 1> AjB = B;
+            for (int j = k; j >= 0; j--) {
+                Gamma_.template block<2, 1>(2 * k, j) = AjB;
+                AjB = A * AjB;
+            }
+        }
+
+        // Cost of each axis: sum of the weighted errors of the predicted states and of the inputs
+        Eigen::Matrix<Scalar, 3 * N, 3 * N> H = Eigen::Matrix<Scalar, 3 * N, 3 * N>::Zero();
+        for (int a = 0; a < 3; a++) {
+
+            Eigen::Matrix<Scalar, 2 * N, 1> Q;
+            for (int k = 0; k < N; k++) Q.template segment<2>(2 * k) << static_cast<Scalar>(config.weight_position[a]), static_cast<Scalar>(config.weight_velocity[a]);
+            Q.template tail<2>() *= static_cast<Scalar>(config.terminal_weight);
+
+            M_[a] = Gamma_.transpose() * Q.asDiagonal();
+            const Eigen::Matrix<Scalar, N, N> Ha = M_[a] * Gamma_ + static_cast<Scalar>(config.weight_input[a]) * Eigen::Matrix<Scalar, N, N>::Identity();
+
+            // The decision variables are ordered by step: [ux(0), uy(0), uz(0), ux(1), ...]
+            for (int i = 0; i < N; i++)
+                for (int j = 0; j < N; j++)
+                    H(3 * i + a, 3 * j + a) = Ha(i, j);
+        }
+
+        // Constraints of each step: thrust (-uz) between the limits and |ux|, |uy| <= c * (-uz), where c keeps the 
+        // diagonal of the pyramid inside the cone of the maximum tilt. The maximum vertical acceleration is reduced such
+        // that the norm of the thrust never exceeds its maximum when the vehicle is tilted
+        const Scalar c = static_cast<Scalar>(std::tan(config.max_tilt) / std::sqrt(2.0));
+        G_ <<  0,  0, -1,
+               1,  0,  c,
+              -1,  0,  c,
+               0,  1,  c,
+               0, -1,  c;
+        const Scalar infinity = std::numeric_limits<Scalar>::infinity();
+        lower_ << static_cast<Scalar>(config.min_acceleration), -infinity, -infinity, -infinity, -infinity;
+        upper_ << static_cast<Scalar>(config.max_acceleration * std::cos(config.max_tilt)), 0, 0, 0, 0;
+
+        solver_.setup(H, G_, config.solver);
+    }
+
+    /**
+     * @brief Solve the problem for the current state of the vehicle and the references over the horizon
+     * @param position The current position of the vehicle (NED)
+     * @param velocity The current velocity of the vehicle (NED)
+     * @param dt The time elapsed since the previous solve (s), used to shift the warm start by the steps of the horizon that passed
+     * @return The acceleration to be produced by the thrust in the first step (NED, without gravity)
+     */
+    Vector3 solve(const Vector3 & position, const Vector3 & velocity, double dt) {
+
+        // Linear term of the cost: the error of the states predicted with the reference accelerations
+        for (int a = 0; a < 3; a++) {
+            for (int k = 0; k < N; k++) {
+                error_.template segment<2>(2 * k) << position_reference(a, k + 1), velocity_reference(a, k + 1);
+            }
+            error_ = Phi_ * Eigen::Matrix<Scalar, 2, 1>(position[a], velocity[a]) + Gamma_ * acceleration_reference.row(a).transpose() - error_;
+            f_axis_ = M_[a] * error_;
+            for (int k = 0; k < N; k++) f_(3 * k + a) = f_axis_(k);
+        }
+
+        // Bounds of the constraints, relative to the reference input of each step
+        for (int k = 0; k < N; k++) {
+            const Vector3 u_ref = acceleration_reference.col(k) - gravity_;
+            const Eigen::Matrix<Scalar, 5, 1> Gu = G_ * u_ref;
+            l_.template segment<5>(5 * k) = lower_ - Gu;
+            u_.template segment<5>(5 * k) = upper_ - Gu;
+        }
+
+        // Solve the problem, starting from the solution of the previous iteration. The control loop usually runs faster than the
+        // time step of the horizon, so the previous solution is only shifted once a full step has passed since the last shift
+        elapsed_since_shift_ += dt;
+        for (int k = 0; k < N && elapsed_since_shift_ >= config_.dt; k++) {
+            solver_.shift();
+            elapsed_since_shift_ -= config_.dt;
+        }
+        if (elapsed_since_shift_ >= config_.dt) elapsed_since_shift_ = std::fmod(elapsed_since_shift_, config_.dt);
+        solver_.solve(f_, l_, u_);
+
+        return acceleration_reference.col(0) - gravity_ + solver_.solution().template head<3>();
+    }
+
+    /**
+     * @brief Clear the warm start of the solver
+     */
+    inline void reset() { 
+        solver_.reset(); 
+        elapsed_since_shift_ = 0.0;
+    }
+
+    /**
+     * @brief Get the information about the last solve (iterations, convergence and residuals)
+     */
+    inline const typename Solver::Info & info() const { return solver_.info(); }
+
+    /**
+     * @brief Get the configuration of the controller
+     */
+    inline const Config & config() const { return config_; }
+
+protected:
+
+    Config config_;
+    double elapsed_since_shift_{0.0};
+    Vector3 gravity_{Scalar(0), Scalar(0), static_cast<Scalar>(GRAVITY)};
+
+    // Prediction matrices of one axis and the weighted transpose of the input matrix of each axis
+    Eigen::Matrix<Scalar, 2 * N, 2> Phi_;
+    Eigen::Matrix<Scalar, 2 * N, N> Gamma_;
+    Eigen::Matrix<Scalar, N, 2 * N> M_[3];
+
+    // Constraints of each step
+    Eigen::Matrix<Scalar, 5, 3> G_;
+    Eigen::Matrix<Scalar, 5, 1> lower_;
+    Eigen::Matrix<Scalar, 5, 1> upper_;
+
+    // Work vectors
+    Eigen::Matrix<Scalar, 2 * N, 1> error_;
+    Eigen::Matrix<Scalar, N, 1> f_axis_;
+    typename Solver::VectorV f_;
+    typename Solver::VectorC l_;
+    typename Solver::VectorC u_;
+
+    Solver solver_;
+};
+
+} // namespace autopilot
@@ -45,6 +45,8 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
+#include <map>
+#include <algorithm>
 #include "autopilot_controllers/mellinger_controller.hpp"
 
 #include <pegasus_utils/rotations.hpp>
@@ -60,197 +62,302 @@ void MellingerController::initialize() {
     node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.kd", std::vector<double>());
     node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.ki", std::vector<double>());
     node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.kr", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.kw", std::vector<double>({20.0, 20.0, 10.0}));
     node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.min_output", std::vector<double>());
     node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.max_output", std::vector<double>());
-
-    auto kp = node_->get_parameter("autopilot.MellingerController.gains.kp").as_double_array();
-    auto kd = node_->get_parameter("autopilot.MellingerController.gains.kd").as_double_array();
-    auto ki = node_->get_parameter("autopilot.MellingerController.gains.ki").as_double_array();
-    auto kr = node_->get_parameter("autopilot.MellingerController.gains.kr").as_double_array();
-    auto min_output = node_->get_parameter("autopilot.MellingerController.gains.min_output").as_double_array();
-    auto max_output = node_->get_parameter("autopilot.MellingerController.gains.max_output").as_double_array();
-
-    // Safety check on the gains (make sure they are there)
-    if(kp.size() != 3 || kd.size() != 3 || ki.size() != 3 || kr.size() != 3 || min_output.size() != 3 || max_output.size() != 3) {
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not read MellingerController position controller gains correctly.");
-        throw std::runtime_error("Gains vector was empty");
+    node_->declare_parameter<std::string>("autopilot.MellingerController.gains.anti_windup", "clamping");
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.gains.kb", std::vector<double>({1.0, 1.0, 1.0}));
+    node_->declare_parameter<double>("autopilot.MellingerController.gains.derivative_cutoff", 0.0);
+    node_->declare_parameter<bool>("autopilot.MellingerController.gains.bumpless_transfer", true);
+
+    // Read the gains and check that they are valid (make sure they are there)
+    Gains gains;
+    try {
+        gains = read_gains(GainsParameters(node_, "autopilot.MellingerController"));
+    } catch (const std::runtime_error & e) {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not read MellingerController position controller gains correctly: " << e.what());
+        throw std::runtime_error("Invalid MellingerController gains");
     }
 
     // Log the gains
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kp = [" << kp[0] << ", " << kp[1] << ", " << kp[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kd = [" << kd[0] << ", " << kd[1] << ", " << kd[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: ki = [" << ki[0] << ", " << ki[1] << ", " << ki[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kr = [" << kr[0] << ", " << kr[1] << ", " << kr[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController min_output = [" << min_output[0] << ", " << min_output[1] << ", " << min_output[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController max_output = [" << max_output[0] << ", " << max_output[1] << ", " << max_output[2] << "]");
-
-    // Initialize the attitude rate gains
-    kr_ = Eigen::Matrix3d::Identity();
-    for(unsigned int i=0; i < 3; i++) kr_(i, i) = kr[i];
+    log_gains(gains);
 
-    // Create the 3 PID controllers for x, y and z axis with unitary feedforward gain for the acceleration
-    Eigen::Vector3d kff(1.0, 1.0, 1.0);
-    for(unsigned int i=0; i < 3; i++) controllers_[i] = std::make_unique<Pegasus::Pid>(kp[i], kd[i], ki[i], kff[i], min_output[i], max_output[i]);
+    // Create the PID controller for the x, y and z axis with unitary feedforward gain for the acceleration,
+    // initialize the attitude rate gains and publish the gains to the control loop
+    pid_ = Pegasus::Pid<3, Scalar>(gains.pid);
+    kr_ = gains.kr;
+    kw_ = gains.kw;
+    gains_.publish(gains);
 
     // Get the mass of the vehicle (used to get the thrust from the acceleration)
-    VehicleConstants vehicle_constansts = get_vehicle_constants();
-    mass_ = vehicle_constansts.mass;
+    mass_ = static_cast<Scalar>(get_vehicle_constants().mass);
+
+    // Check if the output of the controller is the attitude rate and thrust or the thrust of each motor
+    node_->declare_parameter<std::string>("autopilot.MellingerController.output", "attitude_rate");
+    const std::string output = node_->get_parameter("autopilot.MellingerController.output").as_string();
+    if (output != "attitude_rate" && output != "motors") {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "MellingerController output must be \"attitude_rate\" or \"motors\", got \"" << output << "\"");
+        throw std::runtime_error("Invalid MellingerController output");
+    }
+    output_motors_ = (output == "motors");
+
+    // Precompute the control allocation of the airframe (make sure the geometry of the vehicle is there)
+    if (output_motors_) {
+        try {
+            initialize_motors_output();
+        } catch (const std::runtime_error & e) {
+            RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not initialize the MellingerController motors output: " << e.what());
+            throw std::runtime_error("Invalid MellingerController motors configuration");
+        }
+    }
 
     // Initialize the ROS 2 subscribers to the control topics
     node_->declare_parameter<std::string>("autopilot.MellingerController.publishers.control_attitude", "control_attitude");
     node_->declare_parameter<std::string>("autopilot.MellingerController.publishers.control_attitude_rate", "control_attitude_rate");
+    node_->declare_parameter<std::string>("autopilot.MellingerController.publishers.control_motors", "control_motors");
     node_->declare_parameter<std::string>("autopilot.MellingerController.publishers.debug_topic", "statistics/mellinger");
 
     // Create the publishers
     attitude_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.MellingerController.publishers.control_attitude").as_string(), rclcpp::SensorDataQoS());
     attitude_rate_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.MellingerController.publishers.control_attitude_rate").as_string(), rclcpp::SensorDataQoS());
-    statistics_pub_ = node_->create_publisher<pegasus_msgs::msg::MellingerStatistics>(node_->get_parameter("autopilot.MellingerController.publishers.debug_topic").as_string(), 1);
+    motors_publisher_ = node_->create_publisher<std_msgs::msg::Float32MultiArray>(node_->get_parameter("autopilot.MellingerController.publishers.control_motors").as_string(), rclcpp::SensorDataQoS());
+    statistics_ = std::make_unique<StatisticsPublisher<pegasus_msgs::msg::MellingerStatistics>>(node_, node_->get_parameter("autopilot.MellingerController.publishers.debug_topic").as_string(), "autopilot.MellingerController");
+
+    // Validate and apply the new gains whenever they are changed in flight (e.g. with ros2 param set)
+    parameters_callback_ = node_->add_on_set_parameters_callback(std::bind(&MellingerController::on_set_parameters, this, std::placeholders::_1));
+
+    // Reserve the message with the speed of each motor, such that setting it in the control loop does not allocate memory
+    motors_msg_.data.reserve(ControlAllocation<Scalar>::MAX_ROTORS);
 
     // Log that the MellingerController was initialized
-    RCLCPP_INFO(node_->get_logger(), "MellingerController initialized");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController initialized (output: " << output << ")");
 }
 
-void MellingerController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) {
+void MellingerController::initialize_motors_output() {
+
+    // Load the inertia of the vehicle and the geometry of the rotors (with the same convention as the CA_ROTORx parameters of PX4)
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.motors.inertia", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.motors.positions_x", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.motors.positions_y", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MellingerController.motors.km", std::vector<double>());
+
+    const std::vector<double> inertia = node_->get_parameter("autopilot.MellingerController.motors.inertia").as_double_array();
+    const std::vector<double> positions_x = node_->get_parameter("autopilot.MellingerController.motors.positions_x").as_double_array();
+    const std::vector<double> positions_y = node_->get_parameter("autopilot.MellingerController.motors.positions_y").as_double_array();
+    const std::vector<double> km = node_->get_parameter("autopilot.MellingerController.motors.km").as_double_array();
+
+    if (inertia.size() != 3 || !std::all_of(inertia.begin(), inertia.end(), [](double value) { return std::isfinite(value) && value > 0.0; })) {
+        throw std::runtime_error("The inertia of the vehicle must have 3 positive values [Jxx, Jyy, Jzz]");
+    }
+    if (positions_y.size() != positions_x.size() || km.size() != positions_x.size()) {
+        throw std::runtime_error("positions_x, positions_y and km must have one value per motor");
+    }
+    inertia_ = Eigen::Vector3d(inertia[0], inertia[1], inertia[2]).cast<Scalar>().asDiagonal();
+
+    // Get the thrust curve of the vehicle. The curve maps the total force of the vehicle, so at a given percentage each motor produces a 1/N share of it
+    const VehicleConstants & constants = get_vehicle_constants();
+    std::map<std::string, double> thrust_curve_params;
+    for (unsigned int i = 0; i < constants.thrust_curve_values.size() && i < constants.thurst_curve_params.size(); i++) thrust_curve_params[constants.thurst_curve_params[i]] = constants.thrust_curve_values[i];
+    thrust_curve_.emplace(Pegasus::ThrustCurveVariant::create(constants.thrust_curve_id, thrust_curve_params));
+    const double max_thrust = thrust_curve_->get_max_force() / static_cast<double>(positions_x.size());
+
+    // Precompute the mixer matrix of the airframe
+    std::vector<typename ControlAllocation<Scalar>::Rotor> rotors;
+    for (unsigned int i = 0; i < positions_x.size(); i++) {
+        rotors.push_back({static_cast<Scalar>(positions_x[i]), static_cast<Scalar>(positions_y[i]), static_cast<Scalar>(km[i])});
+    }
+    allocation_.emplace(rotors, static_cast<Scalar>(max_thrust));
+
+    // Preallocate the speed of each motor
+    motor_speed_ = Eigen::VectorXd::Zero(allocation_->num_rotors());
+
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController motors output: " << allocation_->num_rotors() << " motors, max thrust per motor = " << max_thrust << " N");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController mixer matrix:\n" << allocation_->mixer());
+}
+
+ControlStatus MellingerController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept {
+
+    // Capture the current state of the vehicle and run the controller
+    return set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, make_tick_context(dt));
+}
+
+ControlStatus MellingerController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
 
     // Ignore snap references
     (void) snap;
 
-    // Get the current state of the vehicle
-    State state = get_vehicle_state();
+    // Get the current state of the vehicle and the time step (in the precision of the control computations)
+    const StateT<Scalar> state = ctx.state.cast<Scalar>();
+    const Scalar dt = static_cast<Scalar>(ctx.dt);
 
-    // Get the current attitude in quaternion and generate a rotation matrix
-    Eigen::Matrix3d R = state.attitude.toRotationMatrix();
+    // Apply the gains changed in flight since the last iteration
+    update_gains();
 
-    // Get the attitude but in euler angles (for debugging purposes only)
-    Eigen::Vector3d euler_angles = R.eulerAngles(2, 1, 0);
+    // Check if the statistics should be computed in this iteration (the PID only saves its statistics if so)
+    const bool compute_statistics = statistics_->sample();
+    pid_.set_statistics_enabled(compute_statistics);
+
+    // Get the current attitude in quaternion and generate a rotation matrix
+    Matrix3 R = state.attitude.toRotationMatrix();
 
     // Get the current yaw and yaw-rate from degrees to radians
-    double yaw_rad = Pegasus::Rotations::deg_to_rad(yaw);
-    double yaw_rate_rad = Pegasus::Rotations::deg_to_rad(yaw_rate);
+    Scalar yaw_rad = Pegasus::Rotations::deg_to_rad(static_cast<Scalar>(yaw));
+    Scalar yaw_rate_rad = Pegasus::Rotations::deg_to_rad(static_cast<Scalar>(yaw_rate));
     
     // Compute the position error and velocity error using the path desired position and velocity
-    Eigen::Vector3d pos_error = position - state.position;
-    Eigen::Vector3d vel_error = velocity - state.velocity;
+    Vector3 pos_error = position.cast<Scalar>() - state.position;
+    Vector3 vel_error = velocity.cast<Scalar>() - state.velocity;
 
-    Eigen::Vector3d external_force = Eigen::Vector3d(0.0, 0.0, 0.0);
-    external_force[0] = acceleration[0];
-    external_force[1] = acceleration[1];
-    external_force[2] = acceleration[2] - 9.81;
+    Vector3 external_force = acceleration.cast<Scalar>();
+    external_force[2] = external_force[2] - Scalar(9.81);
 
     // Compute the desired force output using a PID scheme
-    Eigen::Vector3d F_des;
-    for(unsigned int i=0; i < 3; i++) F_des[i] = mass_ * controllers_[i]->compute_output(pos_error[i], vel_error[i], external_force[i], dt);
+    Vector3 F_des = mass_ * pid_.compute_output(pos_error.array(), vel_error.array(), external_force.array(), dt).matrix();
 
-    // Compute the desired body-frame axis Z_b (b3d)
-    // Check [3-eq.12] for more details
-    Eigen::Vector3d Z_b_des = -F_des / F_des.norm();
+    // Compute the target attitude rate and thrust with the geometric attitude law
+    const GeometricAttitudeRate<Scalar> control = geometric_attitude_rate<Scalar>(F_des, R, jerk.cast<Scalar>(), mass_, yaw_rad, yaw_rate_rad, kr_);
 
-    // Compute Y_C
-    Eigen::Vector3d Y_C = Eigen::Vector3d(-sin(yaw_rad), cos(yaw_rad), 0.0);
+    // Do not send the output to the vehicle if it is not valid (e.g. the state or the references are not finite)
+    if (!control.attitude_rate.allFinite() || !std::isfinite(control.thrust)) return ControlStatus::FAILED;
 
-    // Compute X_B_des
-    Eigen::Vector3d X_b_des = Y_C.cross(Z_b_des);
-    X_b_des = X_b_des / X_b_des.norm();
+    // Convert the output to deg/s (back in double precision)
+    Eigen::Vector3d attitude_rate = Eigen::Vector3d(
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[0]), 
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[1]), 
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[2]));
 
-    // Compute Y_B_des
-    Eigen::Vector3d Y_b_des = Z_b_des.cross(X_b_des);
-    Y_b_des = Y_b_des / Y_b_des.norm();
+    // Send the attitude rate and thrust to the attitude-rate controller of the vehicle, or track them directly with the motors
+    const ControlStatus status = output_motors_ ? set_attitude_rate_motors(control.attitude_rate, control.thrust, state.angular_velocity) : set_attitude_rate(attitude_rate, control.thrust);
 
-    // Compute the desired rotation R_des = [X_b_des | Y_b_des | Z_b_des]
-    Eigen::Matrix3d R_des;
-    R_des.col(0) = X_b_des;
-    R_des.col(1) = Y_b_des;
-    R_des.col(2) = Z_b_des;
+    // Update and publish the statistics
+    if (compute_statistics) {
+        update_statistics(position, control, attitude_rate, R);
+        publish_statistics(ctx.timestamp);
+    }
 
-    // Get the desired Euler-angles (for debugging purposes only)
-    Eigen::Vector3d euler_angles_des = R_des.eulerAngles(2, 1, 0);
+    return status;
+}
 
-    // Compute the rotation error
-    Eigen::Matrix3d R_error = (R_des.transpose() * R) - (R.transpose() * R_des);
+MellingerController::Gains MellingerController::read_gains(const GainsParameters & parameters) {
+    Gains gains;
+    gains.pid = parameters.pid<Scalar>();
+    gains.kr = parameters.positive_vector3("kr").cast<Scalar>().asDiagonal();
+    gains.kw = parameters.positive_vector3("kw").cast<Scalar>().asDiagonal();
+    gains.anti_windup = parameters.string("anti_windup");
+    gains.bumpless_transfer = parameters.boolean("bumpless_transfer");
+    return gains;
+}
 
-    // Compute the vee map of the rotation error and project into the coordinates of the manifold
-    Eigen::Vector3d e_R;
-    e_R << -R_error(1,2), R_error(0, 2), -R_error(0,1);
-    e_R = 0.5 * e_R;
+void MellingerController::log_gains(const Gains & gains) const {
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kp = [" << gains.pid.kp[0] << ", " << gains.pid.kp[1] << ", " << gains.pid.kp[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kd = [" << gains.pid.kd[0] << ", " << gains.pid.kd[1] << ", " << gains.pid.kd[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: ki = [" << gains.pid.ki[0] << ", " << gains.pid.ki[1] << ", " << gains.pid.ki[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kr = [" << gains.kr(0, 0) << ", " << gains.kr(1, 1) << ", " << gains.kr(2, 2) << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains: kw = [" << gains.kw(0, 0) << ", " << gains.kw(1, 1) << ", " << gains.kw(2, 2) << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController min_output = [" << gains.pid.min_output[0] << ", " << gains.pid.min_output[1] << ", " << gains.pid.min_output[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController max_output = [" << gains.pid.max_output[0] << ", " << gains.pid.max_output[1] << ", " << gains.pid.max_output[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController anti_windup = " << gains.anti_windup << ", kb = [" << gains.pid.kb[0] << ", " << gains.pid.kb[1] << ", " << gains.pid.kb[2] << "]");
+}
 
-    // Get the desired total thrust (in Newtons) in Z_B direction (u_1)
-    Eigen::Vector3d Z_B = R.col(2);
-    double T = -F_des.dot(Z_B);
+rcl_interfaces::msg::SetParametersResult MellingerController::on_set_parameters(const std::vector<rclcpp::Parameter> & parameters) {
+
+    rcl_interfaces::msg::SetParametersResult result;
+    result.successful = true;
+
+    // Ignore the parameters that are not gains of this controller
+    const GainsParameters gains_parameters(node_, "autopilot.MellingerController", parameters);
+    if (!gains_parameters.changed()) return result;
+
+    // Build the new gains outside of the control loop and publish them (the parameters are rejected if the gains are not valid)
+    try {
+        const Gains gains = read_gains(gains_parameters);
+        gains_.publish(gains);
+        RCLCPP_INFO_STREAM(node_->get_logger(), "MellingerController gains changed in flight (bumpless transfer: " << (gains.bumpless_transfer ? "on" : "off") << ")");
+        log_gains(gains);
+    } catch (const std::exception & e) {
+        result.successful = false;
+        result.reason = e.what();
+        RCLCPP_WARN_STREAM(node_->get_logger(), "Rejected the new MellingerController gains: " << e.what());
+    }
+    return result;
+}
 
-    // Compute the desired angular velocity for the feed-forward terms
-    Eigen::Vector3d w_des;
-    w_des(0) =  mass_ / T * Y_b_des.dot(jerk);
-    w_des(1) = -mass_ / T * X_b_des.dot(jerk);
-    w_des(2) = yaw_rate_rad * Z_b_des[2];
+void MellingerController::update_gains() {
 
-    // Compute the target attitude rate
-    Eigen::Vector3d attitude_rate = w_des - (kr_ * e_R);
+    // Check if new gains were published since they were last applied (without blocking)
+    const Gains & gains = gains_.read();
+    if (gains_.read_version() == gains_version_) return;
+    gains_version_ = gains_.read_version();
 
-    // Convert the output to rad/s
-    attitude_rate = Eigen::Vector3d(
-        Pegasus::Rotations::rad_to_deg(attitude_rate[0]), 
-        Pegasus::Rotations::rad_to_deg(attitude_rate[1]), 
-        Pegasus::Rotations::rad_to_deg(attitude_rate[2]));
+    // Apply them, adjusting the integral such that the output does not jump (if enabled)
+    if (gains.bumpless_transfer) pid_.set_gains_bumpless(gains.pid);
+    else pid_.set_gains(gains.pid);
+    kr_ = gains.kr;
+    kw_ = gains.kw;
+}
 
-    // Send the attitude rate and thrust to the attitude-rate controller
-    set_attitude_rate(attitude_rate, T);
+void MellingerController::update_statistics(const Eigen::Vector3d & position_ref, const GeometricAttitudeRate<Scalar> & control, const Eigen::Vector3d & attitude_rate_reference, const Matrix3 & R) {
 
-    // Update and publish the statistics
-    update_statistics(position, e_R, w_des, T, attitude_rate, euler_angles, euler_angles_des);
-    statistics_pub_->publish(statistics_msg_);
-}
+    // Get the message to fill
+    pegasus_msgs::msg::MellingerStatistics & msg = statistics_->message();
 
-void MellingerController::update_statistics(const Eigen::Vector3d & position_ref, const Eigen::Vector3d & rotation_error, const Eigen::Vector3d & desired_angular_rate, double thrust_reference, const Eigen::Vector3d & attitude_rate_reference, const Eigen::Vector3d & euler_angles, const Eigen::Vector3d & euler_angles_desired) {
+    // Get the current and desired attitude in euler angles
+    const Vector3 euler_angles = R.eulerAngles(2, 1, 0);
+    const Vector3 euler_angles_desired = control.R_des.eulerAngles(2, 1, 0);
     
+    // Get the statistics from the controller object
+    const Pegasus::Pid<3, Scalar>::Statistics & stats = pid_.get_statistics();
+
     for(unsigned int i = 0; i < 3; i++) {
 
         // For each control axis [x, y, z]
-        // Get the statistics from the controller object
-        Pegasus::Pid::Statistics stats = controllers_[i]->get_statistics();
-
-        statistics_msg_.pid_statistics[i].dt = stats.dt;
-        statistics_msg_.pid_statistics[i].reference = position_ref[i];
+        msg.pid_statistics[i].dt = stats.dt;
+        msg.pid_statistics[i].reference = position_ref[i];
         // Fill the feedback errors
-        statistics_msg_.pid_statistics[i].error_p = stats.error_p;
-        statistics_msg_.pid_statistics[i].error_d = stats.error_d;
-        statistics_msg_.pid_statistics[i].integral = stats.integral;
-        statistics_msg_.pid_statistics[i].ff_ref = stats.ff_ref;
+        msg.pid_statistics[i].error_p = stats.error_p[i];
+        msg.pid_statistics[i].error_d = stats.error_d[i];
+        msg.pid_statistics[i].integral = stats.integral[i];
+        msg.pid_statistics[i].ff_ref = stats.ff_ref[i];
 
         // Fill the errors scaled by the gains
-        statistics_msg_.pid_statistics[i].p_term = stats.p_term;
-        statistics_msg_.pid_statistics[i].d_term = stats.d_term;
-        statistics_msg_.pid_statistics[i].i_term = stats.i_term;
-        statistics_msg_.pid_statistics[i].ff_term = stats.ff_term;
+        msg.pid_statistics[i].p_term = stats.p_term[i];
+        msg.pid_statistics[i].d_term = stats.d_term[i];
+        msg.pid_statistics[i].i_term = stats.i_term[i];
+        msg.pid_statistics[i].ff_term = stats.ff_term[i];
 
         // Fill the outputs of the controller
-        statistics_msg_.pid_statistics[i].anti_windup_discharge = stats.anti_windup_discharge;
-        statistics_msg_.pid_statistics[i].output_pre_sat = stats.output_pre_sat;
-        statistics_msg_.pid_statistics[i].output = stats.output;
+        msg.pid_statistics[i].anti_windup_discharge = stats.anti_windup_discharge[i];
+        msg.pid_statistics[i].output_pre_sat = stats.output_pre_sat[i];
+        msg.pid_statistics[i].output = stats.output[i];
 
         // For each rotation axis [x, y, z]
         // Fill in the nonlinear errors 
-        statistics_msg_.rotation_error[i] = rotation_error[i];
-        statistics_msg_.desired_angular_rate[i] = desired_angular_rate[i];
+        msg.rotation_error[i] = control.rotation_error[i];
+        msg.desired_angular_rate[i] = control.desired_angular_rate[i];
 
         // Fill in the attitude rate referenced sent to the inner-loop
-        statistics_msg_.attitude_rate_reference[i] = attitude_rate_reference[i];
+        msg.attitude_rate_reference[i] = attitude_rate_reference[i];
     }
 
     // Fill in the thrust reference
-    statistics_msg_.thrust_reference = thrust_reference;
+    msg.thrust_reference = control.thrust;
 
     // Fill in with the current attitude in degrees
-    statistics_msg_.state_roll = Pegasus::Rotations::rad_to_deg(euler_angles[2]);
-    statistics_msg_.state_pitch = Pegasus::Rotations::rad_to_deg(euler_angles[1]);
-    statistics_msg_.state_yaw = Pegasus::Rotations::rad_to_deg(euler_angles[0]);
+    msg.state_roll = Pegasus::Rotations::rad_to_deg(euler_angles[2]);
+    msg.state_pitch = Pegasus::Rotations::rad_to_deg(euler_angles[1]);
+    msg.state_yaw = Pegasus::Rotations::rad_to_deg(euler_angles[0]);
 
     // Fill in with the desired attitude in degrees
-    statistics_msg_.desired_roll = Pegasus::Rotations::rad_to_deg(euler_angles_desired[2]);
-    statistics_msg_.desired_pitch = Pegasus::Rotations::rad_to_deg(euler_angles_desired[1]);
-    statistics_msg_.desired_yaw = Pegasus::Rotations::rad_to_deg(euler_angles_desired[0]);
+    msg.desired_roll = Pegasus::Rotations::rad_to_deg(euler_angles_desired[2]);
+    msg.desired_pitch = Pegasus::Rotations::rad_to_deg(euler_angles_desired[1]);
+    msg.desired_yaw = Pegasus::Rotations::rad_to_deg(euler_angles_desired[0]);
 }
 
-void MellingerController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) {
+void MellingerController::publish_statistics(const rclcpp::Time & stamp) {
+    statistics_->publish(stamp);
+}
+
+ControlStatus MellingerController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -263,9 +370,11 @@ void MellingerController::set_attitude(const Eigen::Vector3d & attitude, double
 
     // Publish the attitude control message for the controller to track
     attitude_publisher_->publish(attitude_msg_);
+
+    return ControlStatus::OK;
 }
 
-void MellingerController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) {
+ControlStatus MellingerController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -278,11 +387,47 @@ void MellingerController::set_attitude_rate(const Eigen::Vector3d & attitude_rat
 
     // Publish the attitude rate control message for the controller to track
     attitude_rate_publisher_->publish(attitude_rate_msg_);
+
+    return ControlStatus::OK;
+}
+
+ControlStatus MellingerController::set_attitude_rate_motors(const Vector3 & attitude_rate, Scalar thrust, const Vector3 & angular_velocity) noexcept {
+
+    // Compute the torque to track the attitude rate, compensating for the gyroscopic effect: tau = J Kw (w_des - w) + w x J w
+    const Vector3 torque = inertia_ * (kw_ * (attitude_rate - angular_velocity)) + angular_velocity.cross(inertia_ * angular_velocity);
+    if (!torque.allFinite()) return ControlStatus::FAILED;
+
+    // Allocate the total thrust and torque to the motors (with the mixer precomputed at startup)
+    const typename ControlAllocation<Scalar>::Thrusts & thrusts = allocation_->allocate(thrust, torque);
+
+    // Convert the thrust of each motor to a percentage (the thrust curve maps the total force of the vehicle with all motors at the same speed)
+    const double num_motors = static_cast<double>(thrusts.size());
+    for (int i = 0; i < thrusts.size(); i++) motor_speed_[i] = thrust_curve_->force_to_percentage(num_motors * static_cast<double>(thrusts[i]));
+
+    return set_motor_speed(motor_speed_);
+}
+
+ControlStatus MellingerController::set_motor_speed(const Eigen::VectorXd & motor_velocity, double dt) noexcept {
+
+    // Ignore dt
+    (void) dt;
+
+    // Do not send the output to the vehicle if it is not valid
+    if (motor_velocity.size() > ControlAllocation<Scalar>::MAX_ROTORS || !motor_velocity.allFinite()) return ControlStatus::FAILED;
+
+    // Set the motors control message, with the speed of each motor between 0-100% (within the reserved capacity, so it does not allocate)
+    motors_msg_.data.resize(motor_velocity.size());
+    for (int i = 0; i < motor_velocity.size(); i++) motors_msg_.data[i] = static_cast<float>(std::clamp(motor_velocity[i], 0.0, 100.0));
+
+    // Publish the motors control message for the vehicle to apply
+    motors_publisher_->publish(motors_msg_);
+
+    return ControlStatus::OK;
 }
 
 void MellingerController::reset_controller() {
-    // Reset the controllers
-    for(unsigned int i=0; i < 3; i++) controllers_[i]->reset_controller();
+    // Reset the controller
+    pid_.reset_controller();
 }
 
 } // namespace autopilot
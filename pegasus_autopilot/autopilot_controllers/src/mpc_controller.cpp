@@ -0,0 +1,264 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <map>
+#include <string>
+#include "autopilot_controllers/mpc_controller.hpp"
+#include "thrust_curves/thrust_curve_variant.hpp"
+#include <pegasus_utils/rotations.hpp>
+
+namespace autopilot {
+
+MPCController::~MPCController() {}
+
+void MPCController::initialize() {
+
+    // Load the controller configuration from the parameter server
+    node_->declare_parameter<double>("autopilot.MPCController.horizon.dt", 0.05);
+    node_->declare_parameter<std::vector<double>>("autopilot.MPCController.weights.position", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MPCController.weights.velocity", std::vector<double>());
+    node_->declare_parameter<std::vector<double>>("autopilot.MPCController.weights.acceleration", std::vector<double>());
+    node_->declare_parameter<double>("autopilot.MPCController.weights.terminal", 10.0);
+    node_->declare_parameter<double>("autopilot.MPCController.constraints.max_tilt", 35.0);
+    node_->declare_parameter<std::vector<double>>("autopilot.MPCController.constraints.thrust", std::vector<double>({0.1, 0.9}));
+    node_->declare_parameter<int>("autopilot.MPCController.solver.max_iterations", 50);
+    node_->declare_parameter<double>("autopilot.MPCController.solver.rho", 1.0);
+    node_->declare_parameter<double>("autopilot.MPCController.solver.eps_abs", 1e-3);
+    node_->declare_parameter<double>("autopilot.MPCController.solver.eps_rel", 1e-3);
+
+    auto weight_position = node_->get_parameter("autopilot.MPCController.weights.position").as_double_array();
+    auto weight_velocity = node_->get_parameter("autopilot.MPCController.weights.velocity").as_double_array();
+    auto weight_acceleration = node_->get_parameter("autopilot.MPCController.weights.acceleration").as_double_array();
+    auto thrust_limits = node_->get_parameter("autopilot.MPCController.constraints.thrust").as_double_array();
+
+    // Safety check on the weights (make sure they are there)
+    if(weight_position.size() != 3 || weight_velocity.size() != 3 || weight_acceleration.size() != 3 || thrust_limits.size() != 2) {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not read MPC controller weights and constraints correctly.");
+        throw std::runtime_error("Weights vector was empty");
+    }
+
+    // Get the mass of the vehicle (used to get the thrust from the acceleration)
+    mass_ = get_vehicle_constants().mass;
+
+    // Get the maximum force that the vehicle can produce from its thrust curve
+    const VehicleConstants & constants = get_vehicle_constants();
+    std::map<std::string, double> thrust_curve_params;
+    for (unsigned int i = 0; i < constants.thrust_curve_values.size() && i < constants.thurst_curve_params.size(); i++) thrust_curve_params[constants.thurst_curve_params[i]] = constants.thrust_curve_values[i];
+    const double max_force = Pegasus::ThrustCurveVariant::create(constants.thrust_curve_id, thrust_curve_params).get_max_force();
+
+    // Setup the model predictive controller
+    TranslationalMpc<HORIZON, Scalar>::Config config;
+    config.dt = node_->get_parameter("autopilot.MPCController.horizon.dt").as_double();
+    config.weight_position = Eigen::Vector3d(weight_position[0], weight_position[1], weight_position[2]);
+    config.weight_velocity = Eigen::Vector3d(weight_velocity[0], weight_velocity[1], weight_velocity[2]);
+    config.weight_input = Eigen::Vector3d(weight_acceleration[0], weight_acceleration[1], weight_acceleration[2]);
+    config.terminal_weight = node_->get_parameter("autopilot.MPCController.weights.terminal").as_double();
+    config.max_tilt = Pegasus::Rotations::deg_to_rad(node_->get_parameter("autopilot.MPCController.constraints.max_tilt").as_double());
+    config.min_acceleration = thrust_limits[0] * max_force / mass_;
+    config.max_acceleration = thrust_limits[1] * max_force / mass_;
+    config.solver.max_iterations = node_->get_parameter("autopilot.MPCController.solver.max_iterations").as_int();
+    config.solver.rho = node_->get_parameter("autopilot.MPCController.solver.rho").as_double();
+    config.solver.eps_abs = node_->get_parameter("autopilot.MPCController.solver.eps_abs").as_double();
+    config.solver.eps_rel = node_->get_parameter("autopilot.MPCController.solver.eps_rel").as_double();
+
+    // Make sure that the vehicle can hover within the constraints
+    if (config.dt <= 0.0 || config.solver.max_iterations <= 0 || config.max_acceleration * std::cos(config.max_tilt) <= TranslationalMpc<HORIZON, Scalar>::GRAVITY || config.min_acceleration >= TranslationalMpc<HORIZON, Scalar>::GRAVITY) {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "Invalid MPC controller configuration: the vehicle cannot hover within the thrust limits [" << config.min_acceleration * mass_ << ", " << config.max_acceleration * mass_ << "] N and the maximum tilt");
+        throw std::runtime_error("Invalid MPC controller configuration");
+    }
+
+    mpc_.setup(config);
+
+    // Log the MPC configuration
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MPC horizon: " << HORIZON << " steps of " << config.dt << " s");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MPC weights: position = [" << weight_position[0] << ", " << weight_position[1] << ", " << weight_position[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MPC weights: velocity = [" << weight_velocity[0] << ", " << weight_velocity[1] << ", " << weight_velocity[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MPC weights: acceleration = [" << weight_acceleration[0] << ", " << weight_acceleration[1] << ", " << weight_acceleration[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "MPC constraints: thrust = [" << config.min_acceleration * mass_ << ", " << config.max_acceleration * mass_ << "] N, max_tilt = " << node_->get_parameter("autopilot.MPCController.constraints.max_tilt").as_double() << " deg");
+
+    // Initialize the ROS 2 publishers to the control topics
+    node_->declare_parameter<std::string>("autopilot.MPCController.publishers.control_attitude", "control_attitude");
+    node_->declare_parameter<std::string>("autopilot.MPCController.publishers.control_attitude_rate", "control_attitude_rate");
+
+    // Create the publishers
+    attitude_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.MPCController.publishers.control_attitude").as_string(), rclcpp::SensorDataQoS());
+    attitude_rate_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.MPCController.publishers.control_attitude_rate").as_string(), rclcpp::SensorDataQoS());
+
+    // Log that the MPCController was initialized
+    RCLCPP_INFO(node_->get_logger(), "MPCController initialized");
+}
+
+void MPCController::set_trajectory_preview(const std::shared_ptr<TrajectoryManager> & trajectory_manager, double gamma) noexcept {
+    preview_trajectory_ = trajectory_manager;
+    preview_gamma_ = gamma;
+}
+
+ControlStatus MPCController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept {
+
+    // Capture the current state of the vehicle and run the controller
+    return set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, make_tick_context(dt));
+}
+
+ControlStatus MPCController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
+
+    // Ignore jerk, snap and yaw_rate references
+    (void) jerk;
+    (void) snap;
+    (void) yaw_rate;
+
+    // Fill the references over the prediction horizon
+    update_references(position, velocity, acceleration);
+
+    // Solve the optimization problem to get the acceleration to apply in this iteration
+    const Eigen::Matrix<Scalar, 3, 1> u = mpc_.solve(ctx.state.position.cast<Scalar>(), ctx.state.velocity.cast<Scalar>(), ctx.dt);
+
+    // Warn if the solver did not reach the tolerances (the last iterate is still used, as it is close to the optimum)
+    if (!mpc_.info().converged) {
+        RCLCPP_WARN_THROTTLE(node_->get_logger(), steady_clock_, 1000, "MPC did not converge in %d iterations", mpc_.info().iterations);
+    }
+
+    // Convert the acceleration to attitude and thrust
+    Eigen::Matrix<Scalar, 4, 1> attitude_thrust = attitude_thrust_from_acceleration<Scalar>(u, static_cast<Scalar>(mass_), Pegasus::Rotations::deg_to_rad(static_cast<Scalar>(yaw)));
+
+    // Do not send the output to the vehicle if it is not valid (e.g. the state or the references are not finite)
+    if (!attitude_thrust.allFinite()) return ControlStatus::FAILED;
+
+    // Set the control output (back in double precision)
+    Eigen::Vector3d attitude_target = Eigen::Vector3d(
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[0]), 
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[1]), 
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[2]));
+
+    // Send the attitude and thrust to the attitude controller
+    return set_attitude(attitude_target, attitude_thrust[3]);
+}
+
+void MPCController::update_references(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration) {
+
+    const double h = mpc_.config().dt;
+
+    if (preview_trajectory_ != nullptr && !preview_trajectory_->empty()) {
+
+        // Sample the trajectory ahead of the current reference, integrating the parameter as the follow trajectory mode does
+        // (the parameter stops progressing at the end of the trajectory)
+        double gamma = preview_gamma_;
+        const double max_gamma = preview_trajectory_->max_gamma();
+
+        for (int k = 0; k <= HORIZON; k++) {
+            const TrajectorySample sample = preview_trajectory_->sample(gamma, 2);
+            const double d_gamma = gamma < max_gamma ? sample.vd : 0.0;
+            const double d2_gamma = gamma < max_gamma ? sample.d_vd : 0.0;
+
+            mpc_.position_reference.col(k) = sample.position().cast<Scalar>();
+            mpc_.velocity_reference.col(k) = sample.velocity(d_gamma).cast<Scalar>();
+            if (k < HORIZON) mpc_.acceleration_reference.col(k) = sample.acceleration(d_gamma, d2_gamma).cast<Scalar>();
+
+            gamma = std::min(gamma + d_gamma * h, max_gamma);
+        }
+    } else {
+
+        // Extrapolate the current reference with a constant acceleration
+        for (int k = 0; k <= HORIZON; k++) {
+            const double t = k * h;
+            mpc_.position_reference.col(k) = (position + velocity * t + 0.5 * acceleration * t * t).cast<Scalar>();
+            mpc_.velocity_reference.col(k) = (velocity + acceleration * t).cast<Scalar>();
+            if (k < HORIZON) mpc_.acceleration_reference.col(k) = acceleration.cast<Scalar>();
+        }
+    }
+
+    // The first reference is always the one requested in this iteration
+    mpc_.position_reference.col(0) = position.cast<Scalar>();
+    mpc_.velocity_reference.col(0) = velocity.cast<Scalar>();
+    mpc_.acceleration_reference.col(0) = acceleration.cast<Scalar>();
+
+    // The preview is only valid for the current iteration
+    preview_trajectory_.reset();
+}
+
+ControlStatus MPCController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) noexcept {
+
+    // Ignore dt
+    (void) dt;
+
+    // Set the attitude control message
+    attitude_msg_.attitude[0] = attitude[0];
+    attitude_msg_.attitude[1] = attitude[1];
+    attitude_msg_.attitude[2] = attitude[2];
+    attitude_msg_.thrust = thrust_force;
+
+    // Publish the attitude control message for the controller to track
+    attitude_publisher_->publish(attitude_msg_);
+
+    return ControlStatus::OK;
+}
+
+ControlStatus MPCController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) noexcept {
+
+    // Ignore dt
+    (void) dt;
+
+    // Set the attitude rate control message
+    attitude_rate_msg_.attitude[0] = attitude_rate[0];
+    attitude_rate_msg_.attitude[1] = attitude_rate[1];
+    attitude_rate_msg_.attitude[2] = attitude_rate[2];
+    attitude_rate_msg_.thrust = thrust_force;
+
+    // Publish the attitude rate control message for the controller to track
+    attitude_rate_publisher_->publish(attitude_rate_msg_);
+
+    return ControlStatus::OK;
+}
+
+void MPCController::reset_controller() {
+    // Clear the warm start of the solver
+    mpc_.reset();
+}
+
+} // namespace autopilot
+
+#include <pluginlib/class_list_macros.hpp>
+PLUGINLIB_EXPORT_CLASS(autopilot::MPCController, autopilot::Controller)
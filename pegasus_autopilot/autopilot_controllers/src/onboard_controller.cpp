@@ -45,6 +45,7 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
+#include <algorithm>
 #include "autopilot_controllers/onboard_controller.hpp"
 
 namespace autopilot {
@@ -60,6 +61,7 @@ void OnboardController::initialize() {
     node_->declare_parameter<std::string>("autopilot.OnboardController.publishers.control_inertial_acceleration", "control_inertial_acceleration");
     node_->declare_parameter<std::string>("autopilot.OnboardController.publishers.control_attitude", "control_attitude");
     node_->declare_parameter<std::string>("autopilot.OnboardController.publishers.control_attitude_rate", "control_attitude_rate");
+    node_->declare_parameter<std::string>("autopilot.OnboardController.publishers.control_motors", "control_motors");
 
     // Create the publishers
     position_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlPosition>(node_->get_parameter("autopilot.OnboardController.publishers.control_position").as_string(), rclcpp::SensorDataQoS());
@@ -68,12 +70,16 @@ void OnboardController::initialize() {
     inertial_acceleration_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAcceleration>(node_->get_parameter("autopilot.OnboardController.publishers.control_inertial_acceleration").as_string(), rclcpp::SensorDataQoS());
     attitude_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.OnboardController.publishers.control_attitude").as_string(), rclcpp::SensorDataQoS());
     attitude_rate_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.OnboardController.publishers.control_attitude_rate").as_string(), rclcpp::SensorDataQoS());
+    motors_publisher_ = node_->create_publisher<std_msgs::msg::Float32MultiArray>(node_->get_parameter("autopilot.OnboardController.publishers.control_motors").as_string(), rclcpp::SensorDataQoS());
+
+    // Reserve the message with the speed of each motor (up to an octocopter), such that setting it does not allocate memory
+    motors_msg_.data.reserve(8);
 
     // Log that the OnboardController was initialized
     RCLCPP_INFO(node_->get_logger(), "OnboardController initialized");
 }
 
-void OnboardController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) {
+ControlStatus OnboardController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept {
 
     // Ignore the velocity, acceleration, jerk, snap and yaw_rate references
     (void) velocity;
@@ -91,9 +97,11 @@ void OnboardController::set_position(const Eigen::Vector3d& position, const Eige
 
     // Publish the position control message for the controller to track
     position_publisher_->publish(position_msg_);
+
+    return ControlStatus::OK;
 }
 
-void OnboardController::set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt) {
+ControlStatus OnboardController::set_body_velocity(const Eigen::Vector3d& velocity, double yaw_rate, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -106,9 +114,11 @@ void OnboardController::set_body_velocity(const Eigen::Vector3d& velocity, doubl
 
     // Publish the body velocity control message for the controller to track
     body_velocity_publisher_->publish(body_velocity_msg_);
+
+    return ControlStatus::OK;
 }
 
-void OnboardController::set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt) {
+ControlStatus OnboardController::set_inertial_velocity(const Eigen::Vector3d& velocity, double yaw, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -121,9 +131,11 @@ void OnboardController::set_inertial_velocity(const Eigen::Vector3d& velocity, d
 
     // Publish the inertial velocity control message for the controller to track
     inertial_velocity_publisher_->publish(inertial_velocity_msg_);
+
+    return ControlStatus::OK;
 }
 
-void OnboardController::set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt) {
+ControlStatus OnboardController::set_inertial_acceleration(const Eigen::Vector3d& acceleration, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -135,9 +147,11 @@ void OnboardController::set_inertial_acceleration(const Eigen::Vector3d& acceler
 
     // Publish the inertial acceleration control message for the controller to track
     inertial_acceleration_publisher_->publish(inertial_acceleration_msg_);
+
+    return ControlStatus::OK;
 }
 
-void OnboardController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) {
+ControlStatus OnboardController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -150,9 +164,11 @@ void OnboardController::set_attitude(const Eigen::Vector3d & attitude, double th
 
     // Publish the attitude control message for the controller to track
     attitude_publisher_->publish(attitude_msg_);
+
+    return ControlStatus::OK;
 }
 
-void OnboardController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) {
+ControlStatus OnboardController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -165,6 +181,26 @@ void OnboardController::set_attitude_rate(const Eigen::Vector3d & attitude_rate,
 
     // Publish the attitude rate control message for the controller to track
     attitude_rate_publisher_->publish(attitude_rate_msg_);
+
+    return ControlStatus::OK;
+}
+
+ControlStatus OnboardController::set_motor_speed(const Eigen::VectorXd & motor_velocity, double dt) noexcept {
+
+    // Ignore dt
+    (void) dt;
+
+    // Do not send the output to the vehicle if it is not valid (or if the message would have to grow, allocating in the control loop)
+    if (!motor_velocity.allFinite() || static_cast<std::size_t>(motor_velocity.size()) > motors_msg_.data.capacity()) return ControlStatus::FAILED;
+
+    // Set the motors control message, with the speed of each motor between 0-100%
+    motors_msg_.data.resize(motor_velocity.size());
+    for (int i = 0; i < motor_velocity.size(); i++) motors_msg_.data[i] = static_cast<float>(std::clamp(motor_velocity[i], 0.0, 100.0));
+
+    // Publish the motors control message for the vehicle to apply
+    motors_publisher_->publish(motors_msg_);
+
+    return ControlStatus::OK;
 }
 
 } // namespace autopilot
@@ -60,33 +60,29 @@ void PIDController::initialize() {
     node_->declare_parameter<std::vector<double>>("autopilot.PIDController.gains.ki", std::vector<double>());
     node_->declare_parameter<std::vector<double>>("autopilot.PIDController.gains.min_output", std::vector<double>());
     node_->declare_parameter<std::vector<double>>("autopilot.PIDController.gains.max_output", std::vector<double>());
-
-    auto kp = node_->get_parameter("autopilot.PIDController.gains.kp").as_double_array();
-    auto kd = node_->get_parameter("autopilot.PIDController.gains.kd").as_double_array();
-    auto ki = node_->get_parameter("autopilot.PIDController.gains.ki").as_double_array();
-    auto min_output = node_->get_parameter("autopilot.PIDController.gains.min_output").as_double_array();
-    auto max_output = node_->get_parameter("autopilot.PIDController.gains.max_output").as_double_array();
-
-    // Safety check on the gains (make sure they are there)
-    if(kp.size() != 3 || kd.size() != 3 || ki.size() != 3 || min_output.size() != 3 || max_output.size() != 3) {
-        RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not read PID position controller gains correctly.");
-        throw std::runtime_error("Gains vector was empty");
+    node_->declare_parameter<std::string>("autopilot.PIDController.gains.anti_windup", "clamping");
+    node_->declare_parameter<std::vector<double>>("autopilot.PIDController.gains.kb", std::vector<double>({1.0, 1.0, 1.0}));
+    node_->declare_parameter<double>("autopilot.PIDController.gains.derivative_cutoff", 0.0);
+    node_->declare_parameter<bool>("autopilot.PIDController.gains.bumpless_transfer", true);
+
+    // Read the gains and check that they are valid (make sure they are there)
+    Gains gains;
+    try {
+        gains = read_gains(GainsParameters(node_, "autopilot.PIDController"));
+    } catch (const std::runtime_error & e) {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "Could not read PID position controller gains correctly: " << e.what());
+        throw std::runtime_error("Invalid PID position controller gains");
     }
 
     // Log the PID gains
-    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: kp = [" << kp[0] << ", " << kp[1] << ", " << kp[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: kd = [" << kd[0] << ", " << kd[1] << ", " << kd[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: ki = [" << ki[0] << ", " << ki[1] << ", " << ki[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "PID min_output = [" << min_output[0] << ", " << min_output[1] << ", " << min_output[2] << "]");
-    RCLCPP_INFO_STREAM(node_->get_logger(), "PID max_output = [" << max_output[0] << ", " << max_output[1] << ", " << max_output[2] << "]");
+    log_gains(gains);
 
-    // Create the 3 PID controllers for x, y and z axis
-    Eigen::Vector3d kff(1.0, 1.0, 1.0);
-    for(unsigned int i=0; i < 3; i++) controllers_[i] = std::make_unique<Pegasus::Pid>(kp[i], kd[i], ki[i], kff[i], min_output[i], max_output[i]);
+    // Create the PID controller for the x, y and z axis and publish the gains to the control loop
+    pid_ = Pegasus::Pid<3, Scalar>(gains.pid);
+    gains_.publish(gains);
 
     // Get the mass of the vehicle (used to get the thrust from the acceleration)
-    VehicleConstants vehicle_constansts = get_vehicle_constants();
-    mass_ = vehicle_constansts.mass;
+    mass_ = static_cast<Scalar>(get_vehicle_constants().mass);
 
     // Initialize the ROS 2 subscribers to the control topics
     node_->declare_parameter<std::string>("autopilot.PIDController.publishers.control_attitude", "control_attitude");
@@ -96,114 +92,158 @@ void PIDController::initialize() {
     // Create the publishers
     attitude_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.PIDController.publishers.control_attitude").as_string(), rclcpp::SensorDataQoS());
     attitude_rate_publisher_ = node_->create_publisher<pegasus_msgs::msg::ControlAttitude>(node_->get_parameter("autopilot.PIDController.publishers.control_attitude_rate").as_string(), rclcpp::SensorDataQoS());
-    statistics_pub_ = node_->create_publisher<pegasus_msgs::msg::PidStatistics>(node_->get_parameter("autopilot.PIDController.pid_debug_topic").as_string(), 1);
+    statistics_ = std::make_unique<StatisticsPublisher<pegasus_msgs::msg::PidStatistics>>(node_, node_->get_parameter("autopilot.PIDController.pid_debug_topic").as_string(), "autopilot.PIDController");
+
+    // Validate and apply the new gains whenever they are changed in flight (e.g. with ros2 param set)
+    parameters_callback_ = node_->add_on_set_parameters_callback(std::bind(&PIDController::on_set_parameters, this, std::placeholders::_1));
 
     // Log that the PIDController was initialized
     RCLCPP_INFO(node_->get_logger(), "PIDController initialized");
 }
 
-void PIDController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) {
+ControlStatus PIDController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, double dt) noexcept {
+
+    // Capture the current state of the vehicle and run the controller
+    return set_position(position, velocity, acceleration, jerk, snap, yaw, yaw_rate, make_tick_context(dt));
+}
+
+ControlStatus PIDController::set_position(const Eigen::Vector3d& position, const Eigen::Vector3d& velocity, const Eigen::Vector3d& acceleration, const Eigen::Vector3d& jerk, const Eigen::Vector3d& snap, double yaw, double yaw_rate, const TickContext & ctx) noexcept {
 
     // Ignore jerk, snap and yaw_rate references
     (void) jerk;
     (void) snap;
     (void) yaw_rate;
 
-    // Get the current state of the vehicle
-    State state = get_vehicle_state();
+    // Get the current state of the vehicle and the time step (in the precision of the control computations)
+    const StateT<Scalar> state = ctx.state.cast<Scalar>();
+    const Scalar dt = static_cast<Scalar>(ctx.dt);
+
+    // Apply the gains changed in flight since the last iteration
+    update_gains();
+
+    // Check if the statistics should be computed in this iteration (the PID only saves its statistics if so)
+    const bool compute_statistics = statistics_->sample();
+    pid_.set_statistics_enabled(compute_statistics);
     
     // Compute the position error and velocity error using the path desired position and velocity
-    Eigen::Vector3d pos_error = position - state.position;
-    Eigen::Vector3d vel_error = velocity - state.velocity;
+    Vector3 pos_error = position.cast<Scalar>() - state.position;
+    Vector3 vel_error = velocity.cast<Scalar>() - state.velocity;
 
-    // Compute the desired control output acceleration for each controller
-    Eigen::Vector3d u;
-    const Eigen::Vector3d g(0.0, 0.0, 9.81);
-    for(unsigned int i=0; i < 3; i++) u[i] = controllers_[i]->compute_output(pos_error[i], vel_error[i], acceleration[i], dt); // (acceleration[i] - g[i])* mass_
-    
-    u[2] = u[2] - 9.81;
+    // Compute the desired control output acceleration for the x, y and z axis at once
+    Vector3 u = pid_.compute_output(pos_error.array(), vel_error.array(), acceleration.cast<Scalar>().array(), dt).matrix();
+    u[2] = u[2] - Scalar(9.81);
 
     // Convert the acceleration to attitude and thrust
-    Eigen::Vector4d attitude_thrust = get_attitude_thrust_from_acceleration(u, mass_, Pegasus::Rotations::deg_to_rad(yaw));
+    Eigen::Matrix<Scalar, 4, 1> attitude_thrust = attitude_thrust_from_acceleration<Scalar>(u, mass_, Pegasus::Rotations::deg_to_rad(static_cast<Scalar>(yaw)));
 
-    // Set the control output
+    // Do not send the output to the vehicle if it is not valid (e.g. the state or the references are not finite)
+    if (!attitude_thrust.allFinite()) return ControlStatus::FAILED;
+
+    // Set the control output (back in double precision)
     Eigen::Vector3d attitude_target = Eigen::Vector3d(
         Pegasus::Rotations::rad_to_deg(attitude_thrust[0]), 
         Pegasus::Rotations::rad_to_deg(attitude_thrust[1]), 
         Pegasus::Rotations::rad_to_deg(attitude_thrust[2]));
 
     // Send the attitude and thrust to the attitude controller
-    set_attitude(attitude_target, attitude_thrust[3]);
+    const ControlStatus status = set_attitude(attitude_target, attitude_thrust[3]);
 
     // Update and publish the PID statistics
-    update_statistics(position);
-    statistics_pub_->publish(pid_statistics_msg_);
+    if (compute_statistics) {
+        update_statistics(position);
+        publish_statistics(ctx.timestamp);
+    }
+
+    return status;
 }
 
-/**
- * @brief Method that given a desired acceleration to apply to the multirotor,
- * its mass and desired yaw angle (in radian), computes the desired attitude to apply to the vehicle.
- * It returns an Eigen::Vector4d object which contains [roll, pitch, yaw, thrust]
- * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
- * 
- * @param u The desired acceleration to apply to the vehicle in m/s^2
- * @param mass The mass of the vehicle in Kg
- * @param yaw The desired yaw angle of the vehicle in radians
- * @return Eigen::Vector4d object which contains [roll, pitch, yaw, thrust]
- * with each element expressed in the following units [rad, rad, rad, Newton] respectively.
- */
-Eigen::Vector4d PIDController::get_attitude_thrust_from_acceleration(const Eigen::Vector3d & u, double mass, double yaw) {
-
-    Eigen::Matrix3d RzT;
-    Eigen::Vector3d r3d;
-    Eigen::Vector4d attitude_thrust;
-
-    /* Compute the normalized thrust and r3d vector */
-    double T = mass * u.norm();
-
-    /* Compute the rotation matrix about the Z-axis */
-    RzT << cos(yaw), sin(yaw), 0.0,
-          -sin(yaw), cos(yaw), 0.0,
-                0.0,      0.0, 1.0;
-
-    /* Compute the normalized rotation */
-    r3d = -RzT * u / u.norm();
-
-    /* Compute the actual attitude and setup the desired thrust to apply to the vehicle */
-    attitude_thrust << asin(-r3d[1]), atan2(r3d[0], r3d[2]), yaw, T;
-    return attitude_thrust;
+PIDController::Gains PIDController::read_gains(const GainsParameters & parameters) {
+    Gains gains;
+    gains.pid = parameters.pid<Scalar>();
+    gains.anti_windup = parameters.string("anti_windup");
+    gains.bumpless_transfer = parameters.boolean("bumpless_transfer");
+    return gains;
+}
+
+void PIDController::log_gains(const Gains & gains) const {
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: kp = [" << gains.pid.kp[0] << ", " << gains.pid.kp[1] << ", " << gains.pid.kp[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: kd = [" << gains.pid.kd[0] << ", " << gains.pid.kd[1] << ", " << gains.pid.kd[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID gains: ki = [" << gains.pid.ki[0] << ", " << gains.pid.ki[1] << ", " << gains.pid.ki[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID min_output = [" << gains.pid.min_output[0] << ", " << gains.pid.min_output[1] << ", " << gains.pid.min_output[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID max_output = [" << gains.pid.max_output[0] << ", " << gains.pid.max_output[1] << ", " << gains.pid.max_output[2] << "]");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "PID anti_windup = " << gains.anti_windup << ", kb = [" << gains.pid.kb[0] << ", " << gains.pid.kb[1] << ", " << gains.pid.kb[2] << "]");
+}
+
+rcl_interfaces::msg::SetParametersResult PIDController::on_set_parameters(const std::vector<rclcpp::Parameter> & parameters) {
+
+    rcl_interfaces::msg::SetParametersResult result;
+    result.successful = true;
+
+    // Ignore the parameters that are not gains of this controller
+    const GainsParameters gains_parameters(node_, "autopilot.PIDController", parameters);
+    if (!gains_parameters.changed()) return result;
+
+    // Build the new gains outside of the control loop and publish them (the parameters are rejected if the gains are not valid)
+    try {
+        const Gains gains = read_gains(gains_parameters);
+        gains_.publish(gains);
+        RCLCPP_INFO_STREAM(node_->get_logger(), "PIDController gains changed in flight (bumpless transfer: " << (gains.bumpless_transfer ? "on" : "off") << ")");
+        log_gains(gains);
+    } catch (const std::exception & e) {
+        result.successful = false;
+        result.reason = e.what();
+        RCLCPP_WARN_STREAM(node_->get_logger(), "Rejected the new PIDController gains: " << e.what());
+    }
+    return result;
+}
+
+void PIDController::update_gains() {
+
+    // Check if new gains were published since they were last applied (without blocking)
+    const Gains & gains = gains_.read();
+    if (gains_.read_version() == gains_version_) return;
+    gains_version_ = gains_.read_version();
+
+    // Apply them, adjusting the integral such that the output does not jump (if enabled)
+    if (gains.bumpless_transfer) pid_.set_gains_bumpless(gains.pid);
+    else pid_.set_gains(gains.pid);
 }
 
 void PIDController::update_statistics(const Eigen::Vector3d & position_ref) {
     
+    // Get the message to fill and the statistics from the controller object
+    pegasus_msgs::msg::PidStatistics & msg = statistics_->message();
+    const Pegasus::Pid<3, Scalar>::Statistics & stats = pid_.get_statistics();
+
     // For each PID control [x, y, z]
     for(unsigned int i = 0; i < 3; i++) {
 
-        // Get the statistics from the controller object
-        Pegasus::Pid::Statistics stats = controllers_[i]->get_statistics();
-
-        pid_statistics_msg_.statistics[i].dt = stats.dt;
-        pid_statistics_msg_.statistics[i].reference = position_ref[i];
+        msg.statistics[i].dt = stats.dt;
+        msg.statistics[i].reference = position_ref[i];
         // Fill the feedback errors
-        pid_statistics_msg_.statistics[i].error_p = stats.error_p;
-        pid_statistics_msg_.statistics[i].error_d = stats.error_d;
-        pid_statistics_msg_.statistics[i].integral = stats.integral;
-        pid_statistics_msg_.statistics[i].ff_ref = stats.ff_ref;
+        msg.statistics[i].error_p = stats.error_p[i];
+        msg.statistics[i].error_d = stats.error_d[i];
+        msg.statistics[i].integral = stats.integral[i];
+        msg.statistics[i].ff_ref = stats.ff_ref[i];
 
         // Fill the errors scaled by the gains
-        pid_statistics_msg_.statistics[i].p_term = stats.p_term;
-        pid_statistics_msg_.statistics[i].d_term = stats.d_term;
-        pid_statistics_msg_.statistics[i].i_term = stats.i_term;
-        pid_statistics_msg_.statistics[i].ff_term = stats.ff_term;
+        msg.statistics[i].p_term = stats.p_term[i];
+        msg.statistics[i].d_term = stats.d_term[i];
+        msg.statistics[i].i_term = stats.i_term[i];
+        msg.statistics[i].ff_term = stats.ff_term[i];
 
         // Fill the outputs of the controller
-        pid_statistics_msg_.statistics[i].anti_windup_discharge = stats.anti_windup_discharge;
-        pid_statistics_msg_.statistics[i].output_pre_sat = stats.output_pre_sat;
-        pid_statistics_msg_.statistics[i].output = stats.output;
+        msg.statistics[i].anti_windup_discharge = stats.anti_windup_discharge[i];
+        msg.statistics[i].output_pre_sat = stats.output_pre_sat[i];
+        msg.statistics[i].output = stats.output[i];
     }
 }
 
-void PIDController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) {
+void PIDController::publish_statistics(const rclcpp::Time & stamp) {
+    statistics_->publish(stamp);
+}
+
+ControlStatus PIDController::set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -216,9 +256,11 @@ void PIDController::set_attitude(const Eigen::Vector3d & attitude, double thrust
 
     // Publish the attitude control message for the controller to track
     attitude_publisher_->publish(attitude_msg_);
+
+    return ControlStatus::OK;
 }
 
-void PIDController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) {
+ControlStatus PIDController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt) noexcept {
 
     // Ignore dt
     (void) dt;
@@ -231,11 +273,13 @@ void PIDController::set_attitude_rate(const Eigen::Vector3d & attitude_rate, dou
 
     // Publish the attitude rate control message for the controller to track
     attitude_rate_publisher_->publish(attitude_rate_msg_);
+
+    return ControlStatus::OK;
 }
 
 void PIDController::reset_controller() {
-    // Reset the controllers
-    for(unsigned int i=0; i < 3; i++) controllers_[i]->reset_controller();
+    // Reset the controller
+    pid_.reset_controller();
 }
 
 } // namespace autopilot
@@ -0,0 +1,228 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include "pid/pid.hpp"
+#include "autopilot_controllers/control_laws.hpp"
+#include "autopilot_controllers/translational_mpc.hpp"
+#include "pegasus_utils/rotations.hpp"
+
+/**
+ * Tests of the control laws computed in single precision (AUTOPILOT_SCALAR float). The same sequence of inputs is run through
+ * the single and double precision versions, and the maximum deviation of the outputs sent to the vehicle must stay within the bounds below
+ */
+namespace {
+
+// Bounds on the deviation of the single precision outputs from the double precision ones
+constexpr double MAX_ATTITUDE_DEVIATION = 1e-3;         // deg
+constexpr double MAX_ATTITUDE_RATE_DEVIATION = 1e-3;    // deg/s
+constexpr double MAX_THRUST_DEVIATION = 1e-4;           // N
+constexpr double MAX_ACCELERATION_DEVIATION = 1e-3;     // m/s^2 (within the tolerances of the solver)
+
+// Mass of the iris used in simulation
+constexpr double MASS = 1.5;
+
+// Time step of the control loop
+constexpr double DT = 0.02;
+
+// References and state of the vehicle in one iteration of the control loop
+struct Sample {
+    Eigen::Vector3d position;
+    Eigen::Vector3d velocity;
+    Eigen::Vector3d acceleration;
+    Eigen::Vector3d jerk;
+    double yaw;
+    Eigen::Vector3d state_position;
+    Eigen::Vector3d state_velocity;
+    Eigen::Quaterniond state_attitude;
+};
+
+// 20 s of a circle with 2 m of radius at 1 rad/s, with the vehicle lagging behind the reference
+std::vector<Sample> make_samples() {
+
+    std::vector<Sample> samples;
+    for (int i = 0; i < 1000; i++) {
+        const double t = i * DT;
+        Sample s;
+        s.position = Eigen::Vector3d(2.0 * std::cos(t), 2.0 * std::sin(t), -1.5);
+        s.velocity = Eigen::Vector3d(-2.0 * std::sin(t), 2.0 * std::cos(t), 0.0);
+        s.acceleration = Eigen::Vector3d(-2.0 * std::cos(t), -2.0 * std::sin(t), 0.0);
+        s.jerk = Eigen::Vector3d(2.0 * std::sin(t), -2.0 * std::cos(t), 0.0);
+        s.yaw = 30.0;
+        s.state_position = Eigen::Vector3d(2.0 * std::cos(t - 0.1), 2.0 * std::sin(t - 0.1), -1.5 + 0.05 * std::sin(3.0 * t));
+        s.state_velocity = Eigen::Vector3d(-2.0 * std::sin(t - 0.1), 2.0 * std::cos(t - 0.1), 0.15 * std::cos(3.0 * t));
+        s.state_attitude = Eigen::AngleAxisd(0.5, Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(0.1 * std::cos(t), Eigen::Vector3d::UnitY()) * Eigen::AngleAxisd(0.1 * std::sin(t), Eigen::Vector3d::UnitX());
+        samples.push_back(s);
+    }
+    return samples;
+}
+
+// Gains of the position PID in the default autopilot configuration
+template <typename T>
+Pegasus::Pid<3, T> make_pid() {
+    typename Pegasus::Pid<3, T>::Gains gains;
+    gains.kp = Eigen::Array3d(8.0, 8.0, 8.0).cast<T>();
+    gains.kd = Eigen::Array3d(3.0, 3.0, 3.0).cast<T>();
+    gains.ki = Eigen::Array3d(0.2, 0.2, 0.1).cast<T>();
+    gains.kff = Pegasus::Pid<3, T>::Vector::Ones();
+    gains.min_output = Pegasus::Pid<3, T>::Vector::Constant(T(-20));
+    gains.max_output = Pegasus::Pid<3, T>::Vector::Constant(T(20));
+    return Pegasus::Pid<3, T>(gains);
+}
+
+// One iteration of the PIDController, returning the [roll, pitch, yaw] (deg) and thrust (N) sent to the vehicle
+template <typename T>
+Eigen::Vector4d pid_controller_step(Pegasus::Pid<3, T> & pid, const Sample & s) {
+
+    const Eigen::Matrix<T, 3, 1> pos_error = s.position.cast<T>() - s.state_position.cast<T>();
+    const Eigen::Matrix<T, 3, 1> vel_error = s.velocity.cast<T>() - s.state_velocity.cast<T>();
+
+    Eigen::Matrix<T, 3, 1> u = pid.compute_output(pos_error.array(), vel_error.array(), s.acceleration.cast<T>().array(), T(DT)).matrix();
+    u[2] = u[2] - T(9.81);
+
+    const Eigen::Matrix<T, 4, 1> attitude_thrust = autopilot::attitude_thrust_from_acceleration<T>(u, T(MASS), Pegasus::Rotations::deg_to_rad(static_cast<T>(s.yaw)));
+    return Eigen::Vector4d(
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[0]), 
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[1]), 
+        Pegasus::Rotations::rad_to_deg(attitude_thrust[2]), 
+        attitude_thrust[3]);
+}
+
+// One iteration of the MellingerController, returning the attitude rate (deg/s) and thrust (N) sent to the vehicle
+template <typename T>
+Eigen::Vector4d mellinger_controller_step(Pegasus::Pid<3, T> & pid, const Sample & s) {
+
+    const Eigen::Matrix<T, 3, 3> kr = Eigen::Matrix<T, 3, 3>::Identity() * T(5);
+    const Eigen::Matrix<T, 3, 3> R = s.state_attitude.cast<T>().toRotationMatrix();
+
+    const Eigen::Matrix<T, 3, 1> pos_error = s.position.cast<T>() - s.state_position.cast<T>();
+    const Eigen::Matrix<T, 3, 1> vel_error = s.velocity.cast<T>() - s.state_velocity.cast<T>();
+
+    Eigen::Matrix<T, 3, 1> external_force = s.acceleration.cast<T>();
+    external_force[2] = external_force[2] - T(9.81);
+
+    const Eigen::Matrix<T, 3, 1> F_des = T(MASS) * pid.compute_output(pos_error.array(), vel_error.array(), external_force.array(), T(DT)).matrix();
+    const autopilot::GeometricAttitudeRate<T> control = autopilot::geometric_attitude_rate<T>(F_des, R, s.jerk.cast<T>(), T(MASS), Pegasus::Rotations::deg_to_rad(static_cast<T>(s.yaw)), T(0), kr);
+    return Eigen::Vector4d(
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[0]), 
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[1]), 
+        Pegasus::Rotations::rad_to_deg(control.attitude_rate[2]), 
+        control.thrust);
+}
+
+// The MPC with the default autopilot configuration
+template <typename T>
+autopilot::TranslationalMpc<20, T> make_mpc() {
+    typename autopilot::TranslationalMpc<20, T>::Config config;
+    config.max_tilt = Pegasus::Rotations::deg_to_rad(35.0);
+    autopilot::TranslationalMpc<20, T> mpc;
+    mpc.setup(config);
+    return mpc;
+}
+
+// One iteration of the MPCController (with the references extrapolated with a constant acceleration), returning the acceleration to apply
+template <typename T>
+Eigen::Vector3d mpc_controller_step(autopilot::TranslationalMpc<20, T> & mpc, const Sample & s) {
+
+    const double h = mpc.config().dt;
+    for (int k = 0; k <= 20; k++) {
+        const double t = k * h;
+        mpc.position_reference.col(k) = (s.position + s.velocity * t + 0.5 * s.acceleration * t * t).cast<T>();
+        mpc.velocity_reference.col(k) = (s.velocity + s.acceleration * t).cast<T>();
+        if (k < 20) mpc.acceleration_reference.col(k) = s.acceleration.cast<T>();
+    }
+    return mpc.solve(s.state_position.cast<T>(), s.state_velocity.cast<T>(), h).template cast<double>();
+}
+
+} // namespace
+
+// The integral of the PID accumulates the deviations along the whole trajectory
+TEST(PrecisionTest, PIDControllerFloatMatchesDouble) {
+
+    Pegasus::Pid<3, float> pid = make_pid<float>();
+    Pegasus::Pid<3, double> pid_double = make_pid<double>();
+    double max_attitude = 0.0, max_thrust = 0.0;
+    for (const Sample & s : make_samples()) {
+        const Eigen::Vector4d error = (pid_controller_step<float>(pid, s) - pid_controller_step<double>(pid_double, s)).cwiseAbs();
+        max_attitude = std::max(max_attitude, error.head<3>().maxCoeff());
+        max_thrust = std::max(max_thrust, error[3]);
+    }
+    EXPECT_LE(max_attitude, MAX_ATTITUDE_DEVIATION);
+    EXPECT_LE(max_thrust, MAX_THRUST_DEVIATION);
+}
+
+TEST(PrecisionTest, MellingerControllerFloatMatchesDouble) {
+
+    Pegasus::Pid<3, float> pid = make_pid<float>();
+    Pegasus::Pid<3, double> pid_double = make_pid<double>();
+    double max_attitude_rate = 0.0, max_thrust = 0.0;
+    for (const Sample & s : make_samples()) {
+        const Eigen::Vector4d error = (mellinger_controller_step<float>(pid, s) - mellinger_controller_step<double>(pid_double, s)).cwiseAbs();
+        max_attitude_rate = std::max(max_attitude_rate, error.head<3>().maxCoeff());
+        max_thrust = std::max(max_thrust, error[3]);
+    }
+    EXPECT_LE(max_attitude_rate, MAX_ATTITUDE_RATE_DEVIATION);
+    EXPECT_LE(max_thrust, MAX_THRUST_DEVIATION);
+}
+
+// Both solvers are warm started with their previous solutions
+TEST(PrecisionTest, TranslationalMpcFloatMatchesDouble) {
+
+    autopilot::TranslationalMpc<20, float> mpc = make_mpc<float>();
+    autopilot::TranslationalMpc<20, double> mpc_double = make_mpc<double>();
+    double max_acceleration = 0.0;
+    for (const Sample & s : make_samples()) {
+        max_acceleration = std::max(max_acceleration, (mpc_controller_step<float>(mpc, s) - mpc_controller_step<double>(mpc_double, s)).cwiseAbs().maxCoeff());
+    }
+    EXPECT_LE(max_acceleration, MAX_ACCELERATION_DEVIATION);
+}
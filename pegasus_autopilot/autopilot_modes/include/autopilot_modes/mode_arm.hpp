@@ -47,6 +47,7 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include "rclcpp/rclcpp.hpp"
 #include "pegasus_msgs/srv/arm.hpp"
 #include "pegasus_msgs/srv/offboard.hpp"
@@ -65,26 +66,44 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_ATTITUDE; }
+
+    // Arming is performed asynchronously, such that the control loop is never blocked waiting for the services
+    Mode::EnterResult begin_enter() override;
+    Mode::EnterResult poll_enter(const TickContext & ctx) override;
+    void abort_enter() override;
 
 protected:
 
+    // Steps performed (in order) when entering the mode
+    enum class ArmStep { ARM, STREAM_SETPOINTS, OFFBOARD };
+
+    // State of the last service request sent
+    enum class RequestState { IDLE, WAITING, SUCCEEDED, FAILED };
+
+    void arm();
+    void offboard();
+    void send_no_thrust_commands(const TickContext & ctx);
 
-    bool arm();
-    bool offboard();
-    void send_no_thrust_commands();
+    // State of the current request, if any. The responses are handled by the executor of the node, so each request
+    // keeps its own state, which is dropped (such that a response that arrives after the request is aborted is ignored)
+    RequestState request_state() const { return request_ ? request_->load() : RequestState::IDLE; }
+
+    // Current step of the arming procedure and the state of its service request
+    ArmStep step_{ArmStep::ARM};
+    std::shared_ptr<std::atomic<RequestState>> request_{nullptr};
+
+    // Time at which we started streaming setpoints, and for how long to stream them before requesting offboard mode
+    rclcpp::Time stream_start_;
+    static constexpr double stream_duration_{1.0};
 
     // ROS2 service clients
     rclcpp::Client<pegasus_msgs::srv::Arm>::SharedPtr arm_client_;
     rclcpp::Client<pegasus_msgs::srv::Offboard>::SharedPtr offboard_client_;
 
-    // ----- THIS CODE WILL REPLACE THE CODE BELLOW WHEN WE SWITCH TO ROS HUMBLE IN THE VEHICLES ------
-    // Create a callback group such that the service callbacks are executed in a separate thread
-    // rclcpp::CallbackGroup::SharedPtr callback_group_;
-    // rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
-
-    // ----- THIS CODE IS ONLY USED IN ROS FOXY --------
-    rclcpp::Node::SharedPtr sub_node_;
+    // Clock used to throttle the logs in the control loop
+    rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
 };
 
 }
\ No newline at end of file
@@ -47,6 +47,7 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <autopilot/mode.hpp>
 #include "pegasus_msgs/srv/kill_switch.hpp"
 
@@ -61,22 +62,28 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
 
 protected:
 
+    // State of the last service request sent
+    enum class RequestState { IDLE, WAITING, SUCCEEDED, FAILED };
+
+    // Send the disarm request. Returns false if the service is not available yet (nothing was sent)
     bool disarm();
 
+    // This mode is entered immediately (such that the previous mode stops commanding the vehicle), and a single disarm request
+    // is sent from the first update after entering it. The response is handled by the executor of the node, so each request
+    // keeps its own state, which is dropped (such that a response that arrives after leaving the mode is ignored)
+    RequestState request_state() const { return request_ ? request_->load() : RequestState::IDLE; }
+    std::shared_ptr<std::atomic<RequestState>> request_{nullptr};
+    bool disarm_requested_{false};
+
     // ROS2 service clients
     rclcpp::Client<pegasus_msgs::srv::KillSwitch>::SharedPtr disarm_client_;
 
-    // ----- THIS CODE WILL REPLACE THE CODE BELLOW WHEN WE SWITCH TO ROS HUMBLE IN THE VEHICLES ------
-    // // Create a callback group such that the service callbacks are executed in a separate thread
-    // rclcpp::CallbackGroup::SharedPtr callback_group_;
-    // rclcpp::executors::SingleThreadedExecutor callback_group_executor_;
-
-    // ----- THIS CODE IS ONLY USED IN ROS FOXY --------
-    rclcpp::Node::SharedPtr sub_node_;
+    // Clock used to throttle the logs in the control loop
+    rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
 };
 
 }
\ No newline at end of file
@@ -60,13 +60,15 @@ public:
     void initialize() override;
     virtual bool enter();
     virtual bool exit() override;
-    virtual void update(double dt);
+    virtual void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_POSITION; }
+    Capabilities required_trajectory_capabilities() const override { return TRAJECTORY_PATH | TRAJECTORY_PARAMETER_SPEED; }
 
 protected:
 
     // Get the desired position, velocity and acceleration from the path
-    void update_reference(double dt);
-    bool check_finished();
+    void update_reference(const TickContext & ctx);
+    bool check_finished(const TickContext & ctx);
 
     // Set the progression speed of the parametric variable
     double gamma_{0.0};
@@ -61,7 +61,8 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_POSITION; }
 
 protected:
 
@@ -47,6 +47,7 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <autopilot/mode.hpp>
 #include "pegasus_msgs/srv/land.hpp"
 
@@ -61,18 +62,25 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_POSITION; }
 
-    // Method used to request the landing service (in a separate thread)
+    // Method used to request the landing service (the response is handled asynchronously in update)
     void request_landing();
 
 private:
 
+    // State of the land request, if any. The response is handled by the executor of the node, so each request keeps its
+    // own state, which is dropped (such that a response to a request sent before re-entering the mode is ignored)
+    enum class RequestState { IDLE, WAITING, SUCCEEDED, FAILED };
+    RequestState request_state() const { return request_ ? request_->load() : RequestState::IDLE; }
+    std::shared_ptr<std::atomic<RequestState>> request_{nullptr};
+
     // ROS2 service clients
     rclcpp::Client<pegasus_msgs::srv::Land>::SharedPtr land_client_;
 
-    // ----- THIS CODE IS ONLY USED IN ROS FOXY --------
-    rclcpp::Node::SharedPtr sub_node_;
+    // Clock used to throttle the logs in the control loop
+    rclcpp::Clock steady_clock_{RCL_STEADY_TIME};
 
     // The target position and attitude for the vehicle to hold to
     Eigen::Vector3d target_pos{Eigen::Vector3d::Zero()};
@@ -60,7 +60,7 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
 };
 
 }
\ No newline at end of file
@@ -47,6 +47,7 @@
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <autopilot/mode.hpp>
 #include "pegasus_msgs/srv/takeoff.hpp"
 
@@ -61,15 +62,16 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_POSITION; }
 
 protected:
 
     // The altitude service callback
     void altitude_callback(const pegasus_msgs::srv::Takeoff::Request::SharedPtr request, const pegasus_msgs::srv::Takeoff::Response::SharedPtr response);
 
-    // The target altitude to takeoff to
-    float target_altitude;
+    // The target altitude to takeoff to (set by the service callback and read by the control loop, which may run on a separate real-time thread)
+    std::atomic<float> target_altitude{-1.0f};
 
     // The target position for the vehicle to take off to
     Eigen::Vector3d takeoff_pos{Eigen::Vector3d::Zero()};
@@ -48,6 +48,7 @@
 #pragma once
 
 #include <autopilot/mode.hpp>
+#include <autopilot/rcu_cell.hpp>
 #include "pegasus_msgs/srv/waypoint.hpp"
 
 namespace autopilot {
@@ -61,17 +62,26 @@ public:
     void initialize() override;
     bool enter() override;
     bool exit() override;
-    void update(double dt) override;
+    void update(const TickContext & ctx) override;
+    Capabilities required_controller_capabilities() const override { return CONTROL_POSITION; }
 
 protected:
 
     // The waypoint service callback
     void waypoint_callback(const pegasus_msgs::srv::Waypoint::Request::SharedPtr request, const pegasus_msgs::srv::Waypoint::Response::SharedPtr response);
 
-    // Check if the waypoint is already set
-    bool waypoint_set_{false};
+    // Position and attitude waypoint received by the service
+    struct Waypoint {
+        Eigen::Vector3d position{Eigen::Vector3d::Zero()};
+        float yaw{0.0f};
+    };
 
-    // The target position and attitude waypoint to be at
+    // The last waypoint received, handed over from the service callback to the control loop (which may run on a
+    // separate real-time thread), and the version of the waypoint being tracked (the initial value is not a waypoint)
+    RcuCell<Waypoint> waypoint_;
+    std::uint64_t waypoint_version_{1};
+
+    // The target position and attitude waypoint to be at (only accessed by the control loop)
     Eigen::Vector3d target_pos{Eigen::Vector3d::Zero()};
     float target_yaw{0.0f};
 
@@ -59,118 +59,128 @@ void ArmMode::initialize() {
     node_->declare_parameter<std::string>("autopilot.ArmMode.arm_service", "arm");
     node_->declare_parameter<std::string>("autopilot.ArmMode.offboard_service", "offboard");
 
-    // ----- THIS CODE WILL REPLACE THE CODE BELLOW WHEN WE SWITCH TO ROS HUMBLE IN THE VEHICLES ------
-    // Create the callback group and executor for the service clients
-    // callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive, false);
-    // callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface());
-
-    // arm_client_ = node_->create_client<pegasus_msgs::srv::Arm>(node_->get_parameter("autopilot.ArmMode.arm_service").as_string(), rmw_qos_profile_system_default, callback_group_);
-    // offboard_client_ = node_->create_client<pegasus_msgs::srv::Offboard>(node_->get_parameter("autopilot.ArmMode.offboard_service").as_string(), rmw_qos_profile_system_default, callback_group_);
-
-    // ----- THIS CODE IS ONLY USED IN ROS FOXY --------
-    std::string sub_node_name = "autopilot_arm_client";
-    auto options = rclcpp::NodeOptions()
-        .start_parameter_services(false)
-        .start_parameter_event_publisher(false)
-        .arguments({"--ros-args", "-r", "__node:=" + sub_node_name, "--"});
-
-    sub_node_ = rclcpp::Node::make_shared("_", options);
-
-    arm_client_ = sub_node_->create_client<pegasus_msgs::srv::Arm>(node_->get_parameter("autopilot.ArmMode.arm_service").as_string(), rmw_qos_profile_system_default);
-    offboard_client_ = sub_node_->create_client<pegasus_msgs::srv::Offboard>(node_->get_parameter("autopilot.ArmMode.offboard_service").as_string(), rmw_qos_profile_system_default);
+    // The clients live in the autopilot node, such that the responses are handled by its executor (and the control loop never spins)
+    arm_client_ = node_->create_client<pegasus_msgs::srv::Arm>(node_->get_parameter("autopilot.ArmMode.arm_service").as_string(), rmw_qos_profile_system_default);
+    offboard_client_ = node_->create_client<pegasus_msgs::srv::Offboard>(node_->get_parameter("autopilot.ArmMode.offboard_service").as_string(), rmw_qos_profile_system_default);
 
     // Log that the ArmMode has been initialized successfully 
     RCLCPP_INFO(this->node_->get_logger(), "ArmMode initialized");
 }
 
-bool ArmMode::arm() {
-    
-    // Check if the vehicle is already armed
-    if (get_vehicle_status().armed) {
-        RCLCPP_WARN(this->node_->get_logger(), "Vehicle is already armed");
-        return true;
-    } 
+void ArmMode::arm() {
+
+    // Wait until the service is available (without blocking the control loop)
+    if (!arm_client_->service_is_ready()) {
+        RCLCPP_INFO_THROTTLE(this->node_->get_logger(), steady_clock_, 1000, "arm service not available, waiting again...");
+        return;
+    }
 
     // Arm the vehicle by invoking the service 
     auto arm_request = std::make_shared<pegasus_msgs::srv::Arm::Request>();
     arm_request->arm = true;
 
-    // Wait until the service is available
-    while (!arm_client_->wait_for_service(std::chrono::seconds(1))) {
-        if (!rclcpp::ok()) {
-            RCLCPP_ERROR(this->node_->get_logger(), "Interrupted while waiting for the service. Exiting.");
-            return false;
-        }
-        RCLCPP_INFO(this->node_->get_logger(), "service not available, waiting again...");
-    }
-
-    // Send the arm request asynchronously
-    auto result = arm_client_->async_send_request(arm_request);
-    
-    // Wait for the result.
-    auto timeout = std::chrono::seconds(5);
-    // if (callback_group_executor_.spin_until_future_complete(result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    if(rclcpp::spin_until_future_complete(sub_node_, result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    
-    // Check if the vehicle was armed successfully
-    return result.get()->success == pegasus_msgs::srv::Arm::Response::SUCCESS ? true : false;
+    // Send the arm request asynchronously. The response is stored in the state of this request by the executor of the node
+    auto request = std::make_shared<std::atomic<RequestState>>(RequestState::WAITING);
+    request_ = request;
+    arm_client_->async_send_request(arm_request, [request](rclcpp::Client<pegasus_msgs::srv::Arm>::SharedFuture result) {
+        request->store(result.get()->success == pegasus_msgs::srv::Arm::Response::SUCCESS ? RequestState::SUCCEEDED : RequestState::FAILED);
+    });
 }
 
-bool ArmMode::offboard() {
-    
-    // Check if the vehicle is already in offboard mode
-    if (get_vehicle_status().offboard) return true;
+void ArmMode::offboard() {
+
+    // Wait until the service is available (without blocking the control loop)
+    if (!offboard_client_->service_is_ready()) {
+        RCLCPP_INFO_THROTTLE(this->node_->get_logger(), steady_clock_, 1000, "offboard service not available, waiting again...");
+        return;
+    }
 
     // Set the vehicle to offboard mode by invoking the service 
     auto offboard_request = std::make_shared<pegasus_msgs::srv::Offboard::Request>();
 
-    // Wait until the service is available
-    while (!offboard_client_->wait_for_service(std::chrono::seconds(1))) {
-        if (!rclcpp::ok()) {
-            RCLCPP_ERROR(this->node_->get_logger(), "Interrupted while waiting for the service. Exiting.");
-            return false;
-        }
-        RCLCPP_INFO(this->node_->get_logger(), "service not available, waiting again...");
-    }
-
-    // Send the offboard request asynchronously
-    auto result = offboard_client_->async_send_request(offboard_request);
-    
-    // Wait for the result.
-    auto timeout = std::chrono::seconds(5);
-    // if (callback_group_executor_.spin_until_future_complete(result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    if(rclcpp::spin_until_future_complete(sub_node_, result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    
-    // Check if the vehicle was set to offboard mode successfully
-    return result.get()->success == pegasus_msgs::srv::Offboard::Response::SUCCESS ? true : false;
+    // Send the offboard request asynchronously. The response is stored in the state of this request by the executor of the node
+    auto request = std::make_shared<std::atomic<RequestState>>(RequestState::WAITING);
+    request_ = request;
+    offboard_client_->async_send_request(offboard_request, [request](rclcpp::Client<pegasus_msgs::srv::Offboard>::SharedFuture result) {
+        request->store(result.get()->success == pegasus_msgs::srv::Offboard::Response::SUCCESS ? RequestState::SUCCEEDED : RequestState::FAILED);
+    });
 }
 
-void ArmMode::send_no_thrust_commands() {
-    // Get the current state of the vehicle
-    State state = get_vehicle_state();
+void ArmMode::send_no_thrust_commands(const TickContext & ctx) {
 
     // Set the target attitude and thrust force to the vehicle
-    Eigen::Vector3d target_attitude = Pegasus::Rotations::quaternion_to_euler(state.attitude);
+    Eigen::Vector3d target_attitude = Pegasus::Rotations::quaternion_to_euler(ctx.state.attitude);
 
     // Set the target attitude and thrust force to the vehicle (0.4 Newtons of thrust)
-    this->controller_->set_attitude(target_attitude, 0.4);
+    this->controller_->set_attitude(target_attitude, 0.4, ctx);
 }
 
 bool ArmMode::enter() {
 
-    // Attempt to arm the vehicle
-    if (!arm()) return false;
+    // The autopilot enters this mode through begin_enter and poll_enter. Without waiting on the services, the mode
+    // can only be entered if the vehicle is already armed and in offboard mode
+    const VehicleStatus status = get_vehicle_status();
+    return status.armed && status.offboard;
+}
 
-    // Send a few offboard commands to put the vehicle in offboard mode automatically
-    for (int i = 0; i < 10; i++) {
-        send_no_thrust_commands();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+Mode::EnterResult ArmMode::begin_enter() {
+
+    // Start the arming procedure from the beginning. The services are only invoked from poll_enter
+    step_ = ArmStep::ARM;
+    request_.reset();
+    return Mode::EnterResult::PENDING;
+}
+
+Mode::EnterResult ArmMode::poll_enter(const TickContext & ctx) {
+
+    // Check the state of the last service request (the responses are received by the executor of the node)
+    const RequestState request_state = this->request_state();
+
+    switch (step_) {
+
+        case ArmStep::ARM:
+
+            // Check if the vehicle is already armed
+            if (ctx.status.armed || request_state == RequestState::SUCCEEDED) {
+                if (request_state == RequestState::IDLE) RCLCPP_WARN(this->node_->get_logger(), "Vehicle is already armed");
+                step_ = ArmStep::STREAM_SETPOINTS;
+                stream_start_ = ctx.timestamp;
+                request_.reset();
+            } else if (request_state == RequestState::FAILED) {
+                return Mode::EnterResult::FAILED;
+            } else if (request_state == RequestState::IDLE) {
+                arm();
+            }
+            return Mode::EnterResult::PENDING;
+
+        case ArmStep::STREAM_SETPOINTS:
+
+            // Send a few offboard commands to put the vehicle in offboard mode automatically
+            send_no_thrust_commands(ctx);
+            if ((ctx.timestamp - stream_start_).seconds() >= stream_duration_) step_ = ArmStep::OFFBOARD;
+            return Mode::EnterResult::PENDING;
+
+        case ArmStep::OFFBOARD:
+
+            // Keep sending commands while waiting for the vehicle to switch to offboard mode
+            send_no_thrust_commands(ctx);
+            if (ctx.status.offboard || request_state == RequestState::SUCCEEDED) {
+                return Mode::EnterResult::SUCCESS;
+            } else if (request_state == RequestState::FAILED) {
+                return Mode::EnterResult::FAILED;
+            } else if (request_state == RequestState::IDLE) {
+                offboard();
+            }
+            return Mode::EnterResult::PENDING;
     }
 
-    // Attempt to set the vehicle to offboard mode
-    if (!offboard()) return false;
+    return Mode::EnterResult::FAILED;
+}
+
+void ArmMode::abort_enter() {
 
-    return true;
+    // Ignore the responses of any service request still in flight
+    request_.reset();
 }
 
 bool ArmMode::exit() {
@@ -178,13 +188,13 @@ bool ArmMode::exit() {
     return true;
 }
 
-void ArmMode::update(double) {
+void ArmMode::update(const TickContext & ctx) {
 
     // Set the vehicle to spin the motors at zero thrust
-    send_no_thrust_commands();
+    send_no_thrust_commands(ctx);
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::ArmMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::ArmMode)
\ No newline at end of file
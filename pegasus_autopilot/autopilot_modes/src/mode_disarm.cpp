@@ -56,77 +56,72 @@ void DisarmMode::initialize() {
     // Initialize the ROS 2 service clients
     node_->declare_parameter<std::string>("autopilot.DisarmMode.disarm_service", "disarm");
 
-    // ----- THIS CODE WILL REPLACE THE CODE BELLOW WHEN WE SWITCH TO ROS HUMBLE IN THE VEHICLES ------
-    // // Create the callback group and executor for the service clients
-    // callback_group_ = node_->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
-    // callback_group_executor_.add_callback_group(callback_group_, node_->get_node_base_interface(), false);
-    // disarm_client_ = node_->create_client<pegasus_msgs::srv::KillSwitch>(node_->get_parameter("autopilot.DisarmMode.disarm_service").as_string(), rmw_qos_profile_system_default, callback_group_);
-    
-    // ----- THIS CODE IS ONLY USED IN ROS FOXY --------
-    std::string sub_node_name = "autopilot_disarm_client";
-    auto options = rclcpp::NodeOptions()
-        .start_parameter_services(false)
-        .start_parameter_event_publisher(false)
-        .arguments({"--ros-args", "-r", "__node:=" + sub_node_name, "--"});
-    sub_node_ = rclcpp::Node::make_shared("_", options);
-    disarm_client_ = sub_node_->create_client<pegasus_msgs::srv::KillSwitch>(node_->get_parameter("autopilot.DisarmMode.disarm_service").as_string(), rmw_qos_profile_system_default);
+    // The client lives in the autopilot node, such that the response is handled by its executor (and the control loop never spins)
+    disarm_client_ = node_->create_client<pegasus_msgs::srv::KillSwitch>(node_->get_parameter("autopilot.DisarmMode.disarm_service").as_string(), rmw_qos_profile_system_default);
 
     // Log that the DisarmMode has been initialized successfully
     RCLCPP_INFO(this->node_->get_logger(), "DisarmMode initialized");
 }
 
 bool DisarmMode::disarm() {
-    
-    // Check if the vehicle is already armed
-    if (!get_vehicle_status().armed) {
-        return true;
-    } 
 
-    // Arm the vehicle by invoking the service 
+    // Wait until the service is available (without blocking the control loop)
+    if (!disarm_client_->service_is_ready()) {
+        RCLCPP_INFO_THROTTLE(this->node_->get_logger(), steady_clock_, 1000, "disarm service not available, waiting again...");
+        return false;
+    }
+
+    // Disarm the vehicle by invoking the service 
     auto arm_request = std::make_shared<pegasus_msgs::srv::KillSwitch::Request>();
     arm_request->kill = true;
 
-    // Wait until the service is available
-    while (!disarm_client_->wait_for_service(std::chrono::seconds(1))) {
-        if (!rclcpp::ok()) {
-            RCLCPP_ERROR(this->node_->get_logger(), "Interrupted while waiting for the service. Exiting.");
-            return false;
-        }
-        RCLCPP_INFO(this->node_->get_logger(), "service not available, waiting again...");
-    }
-
-    // Send the arm request asynchronously
-    auto result = disarm_client_->async_send_request(arm_request);
-    
-    // Wait for the result.
-    auto timeout = std::chrono::seconds(5);
-    //if (callback_group_executor_.spin_until_future_complete(result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    if(rclcpp::spin_until_future_complete(sub_node_, result, timeout) != rclcpp::FutureReturnCode::SUCCESS) return false;
-    
-    // Check if the vehicle was disarmed successfully
-    return result.get()->success == pegasus_msgs::srv::KillSwitch::Response::SUCCESS ? true : false;
+    // Send the disarm request asynchronously. The response is stored in the state of this request by the executor of the node
+    auto request = std::make_shared<std::atomic<RequestState>>(RequestState::WAITING);
+    request_ = request;
+    disarm_client_->async_send_request(arm_request, [request](rclcpp::Client<pegasus_msgs::srv::KillSwitch>::SharedFuture result) {
+        request->store(result.get()->success == pegasus_msgs::srv::KillSwitch::Response::SUCCESS ? RequestState::SUCCEEDED : RequestState::FAILED);
+    });
+    return true;
 }
 
 bool DisarmMode::enter() {
 
-    // Attempt to disarm the vehicle
-    disarm();
-
-    // Fow now, just return true, but improve this later on
+    // Enter the mode immediately, even if the vehicle is still armed, such that the previous mode stops commanding
+    // the vehicle. A single disarm request is sent from update, which never blocks the control loop
+    request_.reset();
+    disarm_requested_ = true;
     return true;
 }
 
 bool DisarmMode::exit() {
-    // Do nothing, just return true
+
+    // Ignore the response of the service request if still in flight
+    request_.reset();
+    disarm_requested_ = false;
     return true;
 }
 
-void DisarmMode::update(double) {
-    // Do nothing, just idle
-    return;
+void DisarmMode::update(const TickContext & ctx) {
+
+    // Report the response of the disarm request sent when the mode was entered (if any)
+    if (request_state() == RequestState::FAILED) {
+        RCLCPP_ERROR(this->node_->get_logger(), "Disarm request was rejected by the vehicle");
+        request_.reset();
+    }
+
+    // Only send the disarm request once per entry into the mode. Nothing is sent while the vehicle is already disarmed,
+    // while another mode is being entered (e.g. ArmMode arming the vehicle) or when running as the default mode at startup
+    if (!disarm_requested_) return;
+    if (!ctx.status.armed || ctx.mode_change_pending) {
+        disarm_requested_ = false;
+        return;
+    }
+
+    // Send the disarm request (it is only consumed once the service is available)
+    if (disarm()) disarm_requested_ = false;
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::DisarmMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::DisarmMode)
\ No newline at end of file
@@ -82,25 +82,25 @@ bool FollowTrajectoryMode::enter() {
     return true;
 }
 
-void FollowTrajectoryMode::update(double dt) {
+void FollowTrajectoryMode::update(const TickContext & ctx) {
 
     // Update the current reference on the path to follow
-    update_reference(dt);
+    update_reference(ctx);
 
     // Call the controller
-    controller_->set_position(desired_position_, desired_velocity_, desired_acceleration_, desired_jerk_, desired_yaw_, desired_yaw_rate_, dt);
+    controller_->set_position(desired_position_, desired_velocity_, desired_acceleration_, desired_jerk_, desired_yaw_, desired_yaw_rate_, ctx);
 
     // Check if we have reached the end of the path
-    check_finished();
+    check_finished(ctx);
 }
 
-void FollowTrajectoryMode::update_reference(double dt) {
+void FollowTrajectoryMode::update_reference(const TickContext & ctx) {
 
     // Check if the trajectory is empty.
     if(trajectory_manager_->empty()) {
 
         // Get the vehicle state
-        State curr_state = get_vehicle_state();
+        const State & curr_state = ctx.state;
 
         // Set the desired position to the current position
         desired_position_ = curr_state.position;
@@ -118,30 +118,36 @@ void FollowTrajectoryMode::update_reference(double dt) {
         return;
     }
 
+    // Sample the trajectory once (up to the jerk) at the current value of the virtual target
+    const TrajectorySample sample = trajectory_manager_->sample(gamma_, 3);
+
     // Update the desired position, velocity, acceleration and jerk from the trajectory
-    desired_position_ = trajectory_manager_->position(gamma_);
-    desired_velocity_ = trajectory_manager_->velocity(gamma_, d_gamma_);
-    desired_acceleration_ = trajectory_manager_->acceleration(gamma_, d_gamma_, d2_gamma_);
-    desired_jerk_ = trajectory_manager_->jerk(gamma_, d_gamma_, d2_gamma_, d3_gamma_);
+    desired_position_ = sample.position();
+    desired_velocity_ = sample.velocity(d_gamma_);
+    desired_acceleration_ = sample.acceleration(d_gamma_, d2_gamma_);
+    desired_jerk_ = sample.jerk(d_gamma_, d2_gamma_, d3_gamma_);
 
     // Get the desired yaw and yaw_rate from the trajectory
-    desired_yaw_ = Pegasus::Rotations::rad_to_deg(trajectory_manager_->yaw(gamma_));
-    desired_yaw_rate_ = Pegasus::Rotations::rad_to_deg(trajectory_manager_->d_yaw(gamma_));
+    desired_yaw_ = Pegasus::Rotations::rad_to_deg(sample.yaw);
+    desired_yaw_rate_ = Pegasus::Rotations::rad_to_deg(sample.d_yaw);
+
+    // Share the trajectory with the controller, in case it predicts the references ahead of the current one
+    controller_->set_trajectory_preview(trajectory_manager_, gamma_);
 
     // Integrate the virtual target position over time
-    d3_gamma_ = trajectory_manager_->d2_vd(gamma_);
-    d2_gamma_ = trajectory_manager_->d_vd(gamma_);
-    d_gamma_ = trajectory_manager_->vd(gamma_);
-    gamma_ += d_gamma_ * dt;
+    d3_gamma_ = sample.d2_vd;
+    d2_gamma_ = sample.d_vd;
+    d_gamma_ = sample.vd;
+    gamma_ += d_gamma_ * ctx.dt;
 }
 
-bool FollowTrajectoryMode::check_finished() {
+bool FollowTrajectoryMode::check_finished(const TickContext & ctx) {
 
     // Check if the virtual target is already at the end of the trajectory
     if(gamma_ < trajectory_manager_->max_gamma()) return false;
 
     // Check if the vehicle is close to the final position already
-    Eigen::Vector3d position = get_vehicle_state().position;
+    const Eigen::Vector3d & position = ctx.state.position;
 
     // Compute the position error
     Eigen::Vector3d pos_error = desired_position_ - position;
@@ -178,4 +184,4 @@ bool FollowTrajectoryMode::exit() {
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::FollowTrajectoryMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::FollowTrajectoryMode)
\ No newline at end of file
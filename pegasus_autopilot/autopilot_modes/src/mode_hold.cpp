@@ -84,13 +84,13 @@ bool HoldMode::exit() {
     return true;   // Return true to indicate that the mode has been exited successfully
 }
 
-void HoldMode::update(double dt) {
+void HoldMode::update(const TickContext & ctx) {
 
     // Set the controller to track the target position and attitude
-    this->controller_->set_position(this->target_pos, this->target_yaw_, dt);
+    this->controller_->set_position(this->target_pos, this->target_yaw_, ctx);
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::HoldMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::HoldMode)
\ No newline at end of file
@@ -108,22 +108,19 @@ bool LandMode::check_land_complete(double velocity_z, double dt) {
     return this->land_counter_ <= 0.0 ? true : false;
 }
 
-void LandMode::update(double dt) {
-
-    // Get the current state of the drone
-    State curr_state = this->get_vehicle_state();
+void LandMode::update(const TickContext & ctx) {
 
     // Update the target Z position based on the current land speed
-    this->target_pos_[2] += this->land_speed_ * dt;
+    this->target_pos_[2] += this->land_speed_ * ctx.dt;
 
     // Set the controller to track the position which is slighlty bellow the vehicle, but keep the original orientation
-    this->controller_->set_position(this->target_pos_, this->target_yaw_, dt);
+    this->controller_->set_position(this->target_pos_, this->target_yaw_, ctx);
 
     // Check if the position is no longer changing - if so, it means that the drone has landed and we should signal the mode as finished
-    if (check_land_complete(curr_state.velocity[2], dt)) signal_mode_finished();
+    if (check_land_complete(ctx.state.velocity[2], ctx.dt)) signal_mode_finished();
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::LandMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::LandMode)
\ No newline at end of file
@@ -45,7 +45,6 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
-#include <thread>
 #include "autopilot_modes/mode_onboard_land.hpp"
 #include "pegasus_utils/rotations.hpp"
 
@@ -57,17 +56,9 @@ void OnboardLandMode::initialize() {
     // Initialize the ROS 2 service clients
     node_->declare_parameter<std::string>("autopilot.OnboardLandMode.land_service", "land");
 
-    /* ----- THIS CODE IS ONLY USED IN ROS FOXY --------*/
-    std::string sub_node_name = "autopilot_land_client";
-    auto options = rclcpp::NodeOptions()
-        .start_parameter_services(false)
-        .start_parameter_event_publisher(false)
-        .arguments({"--ros-args", "-r", "__node:=" + sub_node_name, "--"});
+    // The client lives in the autopilot node, such that the response is handled by its executor (and the control loop never spins)
+    land_client_ = node_->create_client<pegasus_msgs::srv::Land>(node_->get_parameter("autopilot.OnboardLandMode.land_service").as_string(), rmw_qos_profile_system_default);
 
-    sub_node_ = rclcpp::Node::make_shared("_", options);
-
-    land_client_ = sub_node_->create_client<pegasus_msgs::srv::Land>(node_->get_parameter("autopilot.OnboardLandMode.land_service").as_string(), rmw_qos_profile_system_default);
-   
     // Log that the ArmMode has been initialized successfully 
     RCLCPP_INFO(this->node_->get_logger(), "OnboardLandMode initialized");
 }
@@ -85,52 +76,50 @@ bool OnboardLandMode::enter() {
     // Set the target yaw to the current yaw of the drone (in degrees)
     this->target_yaw_ = Pegasus::Rotations::rad_to_deg(Pegasus::Rotations::yaw_from_quaternion(curr_state.attitude));
 
-    // Send the Land request in a separate thread
-    std::thread t(&OnboardLandMode::request_landing, this);
-    t.detach();
-    
-    RCLCPP_INFO_STREAM(this->node_->get_logger(), "OnboardLandMode: Land request sent");
+    // The Land request is sent from update, such that entering this mode never blocks the control loop
+    request_.reset();
 
     return true;
 }
 
 void OnboardLandMode::request_landing() {
-    
-    // Prepare the request to invoke the land service from the onboard microcontroller
-    auto land_request = std::make_shared<pegasus_msgs::srv::Land::Request>();
 
-    // Wait until the service is available
-    while (!land_client_->wait_for_service(std::chrono::seconds(1))) {
-        if (!rclcpp::ok()) {
-            RCLCPP_ERROR(this->node_->get_logger(), "Interrupted while waiting for the land service. Exiting.");
-            return;
-        }
-        RCLCPP_INFO(this->node_->get_logger(), "landing service not available, waiting again...");
+    // Wait until the service is available (without blocking the control loop)
+    if (!land_client_->service_is_ready()) {
+        RCLCPP_INFO_THROTTLE(this->node_->get_logger(), steady_clock_, 1000, "landing service not available, waiting again...");
+        return;
     }
 
+    // Prepare the request to invoke the land service from the onboard microcontroller
+    auto land_request = std::make_shared<pegasus_msgs::srv::Land::Request>();
+
     // Send the land request asynchronously (with a callback binding to check the response)
-    auto result = land_client_->async_send_request(land_request);
+    auto request = std::make_shared<std::atomic<RequestState>>(RequestState::WAITING);
+    request_ = request;
+    land_client_->async_send_request(land_request, [request, logger = this->node_->get_logger()](rclcpp::Client<pegasus_msgs::srv::Land>::SharedFuture result) {
 
-    if(rclcpp::spin_until_future_complete(sub_node_, result, std::chrono::seconds(3)) != rclcpp::FutureReturnCode::SUCCESS) {
-        RCLCPP_ERROR(this->node_->get_logger(), "Error while waiting for result from Land service request");
-        return;
-    }
-    
-    // Check if the vehicle was set to land mode successfully
-    bool land_approved = result.get()->success == pegasus_msgs::srv::Land::Response::SUCCESS ? true : false;
+        // Check if the vehicle was set to land mode successfully
+        bool land_approved = result.get()->success == pegasus_msgs::srv::Land::Response::SUCCESS ? true : false;
+        request->store(land_approved ? RequestState::SUCCEEDED : RequestState::FAILED);
 
-    // Log the output of the service
-    RCLCPP_INFO_STREAM(this->node_->get_logger(), "Landing aproval: " << land_approved);
+        // Log the output of the service
+        RCLCPP_INFO_STREAM(logger, "Landing aproval: " << land_approved);
+    });
+
+    RCLCPP_INFO_STREAM(this->node_->get_logger(), "OnboardLandMode: Land request sent");
 }
 
 
-void OnboardLandMode::update(double dt) {
+void OnboardLandMode::update(const TickContext & ctx) {
+
+    // Send the land request (if not sent yet). Its response is received by the executor of the node
+    if (request_state() == RequestState::IDLE) request_landing();
 
     // Ask the microcontroller to keep the position that we had when entering this mode
     // Set the controller to track the target position and attitude
     // If the land service is successfull, these controls are ignore. If not, this 
     // line may prevent the drone from falling mid-air
-    this->controller_->set_position(this->target_pos, this->target_yaw_, dt);
+    this->controller_->set_position(this->target_pos, this->target_yaw_, ctx);
 }
 
 bool OnboardLandMode::exit() {
@@ -142,4 +131,4 @@ bool OnboardLandMode::exit() {
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::OnboardLandMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::OnboardLandMode)
\ No newline at end of file
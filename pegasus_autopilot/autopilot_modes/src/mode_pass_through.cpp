@@ -67,7 +67,7 @@ bool PassThroughMode::exit() {
     return true;
 }
 
-void PassThroughMode::update(double) {
+void PassThroughMode::update(const TickContext &) {
     // Do nothing and just return
     return;
 }
@@ -75,4 +75,4 @@ void PassThroughMode::update(double) {
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::PassThroughMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::PassThroughMode)
\ No newline at end of file
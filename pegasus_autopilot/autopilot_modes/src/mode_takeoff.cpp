@@ -59,7 +59,7 @@ void TakeoffMode::initialize() {
     target_altitude = node_->get_parameter("autopilot.TakeoffMode.takeoff_altitude").as_double();
 
     // Log the default takeoff altitude
-    RCLCPP_INFO(this->node_->get_logger(), "Takeoff altitude set to %.2f m.", this->target_altitude);
+    RCLCPP_INFO(this->node_->get_logger(), "Takeoff altitude set to %.2f m.", this->target_altitude.load());
 
     // Initialize the service server for setting the takeoff altitude
     node_->declare_parameter<std::string>("autopilot.TakeoffMode.set_takeoff_altitude_service", "set_takeoff_altitude");
@@ -91,10 +91,10 @@ bool TakeoffMode::exit() {
     return true;   // Return true to indicate that the mode has been exited successfully
 }
 
-void TakeoffMode::update(double dt) {
+void TakeoffMode::update(const TickContext & ctx) {
 
     // Set the controller to track the target position and attitude
-    this->controller_->set_position(this->takeoff_pos, this->takeoff_yaw, dt);
+    this->controller_->set_position(this->takeoff_pos, this->takeoff_yaw, ctx);
 }
 
 void TakeoffMode::altitude_callback(const pegasus_msgs::srv::Takeoff::Request::SharedPtr request, const pegasus_msgs::srv::Takeoff::Response::SharedPtr response) {
@@ -103,10 +103,10 @@ void TakeoffMode::altitude_callback(const pegasus_msgs::srv::Takeoff::Request::S
     this->target_altitude = request->height;
     response->success = pegasus_msgs::srv::Takeoff::Response::TRUE;
 
-    RCLCPP_WARN(this->node_->get_logger(), "Takeoff altitude set to %.2f", this->target_altitude);
+    RCLCPP_WARN(this->node_->get_logger(), "Takeoff altitude set to %.2f", this->target_altitude.load());
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::TakeoffMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::TakeoffMode)
\ No newline at end of file
@@ -64,14 +64,18 @@ void WaypointMode::initialize() {
 
 bool WaypointMode::enter() {
 
-    // Check if the waypoint was already set - if not, then do not enter the waypoint mode
-    if (!this->waypoint_set_) {
+    // Check if a new waypoint was set - if not, then do not enter the waypoint mode
+    // (to make sure we do not enter twice in this mode without setting a new waypoint)
+    const Waypoint & waypoint = this->waypoint_.read();
+    if (this->waypoint_.read_version() == this->waypoint_version_) {
         RCLCPP_ERROR(this->node_->get_logger(), "Waypoint not set - cannot enter waypoint mode.");
         return false;
     }
 
-    // Reset the waypoint flag (to make sure we do not enter twice in this mode without setting a new waypoint)
-    this->waypoint_set_ = false;
+    // Track the new waypoint
+    this->waypoint_version_ = this->waypoint_.read_version();
+    this->target_pos = waypoint.position;
+    this->target_yaw = waypoint.yaw;
 
     // Return true to indicate that the mode has been entered successfully
     return true;
@@ -83,29 +87,34 @@ bool WaypointMode::exit() {
     return true;   // Return true to indicate that the mode has been exited successfully
 }
 
-void WaypointMode::update(double dt) {
+void WaypointMode::update(const TickContext & ctx) {
+
+    // Track the waypoints set while in this mode
+    const Waypoint & waypoint = this->waypoint_.read();
+    if (this->waypoint_.read_version() != this->waypoint_version_) {
+        this->waypoint_version_ = this->waypoint_.read_version();
+        this->target_pos = waypoint.position;
+        this->target_yaw = waypoint.yaw;
+    }
 
     // Set the controller to track the target position and attitude
-    this->controller_->set_position(this->target_pos, this->target_yaw, dt);
+    this->controller_->set_position(this->target_pos, this->target_yaw, ctx);
 }
 
 void WaypointMode::waypoint_callback(const pegasus_msgs::srv::Waypoint::Request::SharedPtr request, const pegasus_msgs::srv::Waypoint::Response::SharedPtr response) {
     
-    // Set the waypoint
-    this->target_pos[0] = request->position[0];
-    this->target_pos[1] = request->position[1];
-    this->target_pos[2] = request->position[2];
-    this->target_yaw = request->yaw;
-
-    // Set the waypoint flag
-    this->waypoint_set_ = true;
+    // Set the waypoint (without modifying the target being tracked by the control loop)
+    Waypoint waypoint;
+    waypoint.position = Eigen::Vector3d(request->position[0], request->position[1], request->position[2]);
+    waypoint.yaw = request->yaw;
+    this->waypoint_.publish(waypoint);
 
     // Return true to indicate that the waypoint has been set successfully
     response->success = true;
-    RCLCPP_WARN(this->node_->get_logger(), "Waypoint set to (%f, %f, %f) with yaw %f", this->target_pos[0], this->target_pos[1], this->target_pos[2], this->target_yaw);
+    RCLCPP_WARN(this->node_->get_logger(), "Waypoint set to (%f, %f, %f) with yaw %f", waypoint.position[0], waypoint.position[1], waypoint.position[2], waypoint.yaw);
 }
 
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
-PLUGINLIB_EXPORT_CLASS(autopilot::WaypointMode, autopilot::Mode)
\ No newline at end of file
+AUTOPILOT_EXPORT_MODE(autopilot::WaypointMode)
\ No newline at end of file
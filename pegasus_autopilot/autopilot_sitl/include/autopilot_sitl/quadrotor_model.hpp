@@ -0,0 +1,146 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <Eigen/Dense>
+
+#include "autopilot/state.hpp"
+#include "thrust_curves/thrust_curve_variant.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Simple rigid-body model of a quadrotor, used to simulate the vehicle without an external simulator. 
+ * The vehicle receives the same inputs as the onboard microcontroller (attitude or attitude-rate + total thrust force),
+ * the thrust force goes through the thrust curve of the vehicle and a first-order model of the motors and the angular
+ * velocity of the vehicle tracks the desired body rates with a first-order response (as if closed by the onboard rate controller).
+ * All the quantities follow the conventions of the autopilot: position and velocity in the inertial frame (NED) and angular 
+ * velocity in the body frame (FRD)
+ */
+class QuadrotorModel {
+
+public:
+
+    using SharedPtr = std::shared_ptr<QuadrotorModel>;
+    using UniquePtr = std::unique_ptr<QuadrotorModel>;
+
+    // Physical parameters of the simulated vehicle
+    struct Config {
+        double mass{1.5};                                   // Mass of the vehicle (Kg)
+        double gravity{9.81};                               // Acceleration of gravity (m/s^2)
+        std::optional<Pegasus::ThrustCurveVariant> thrust_curve; // Thrust curve to convert between force (N) and throttle (0-100%)
+        double motor_time_constant{0.03};                   // Time constant of the response of the motors (s)
+        double rate_time_constant{0.05};                    // Time constant of the response of the onboard rate controller (s)
+        double attitude_gain{6.0};                          // Gain of the onboard attitude controller (1/s)
+        Eigen::Vector3d drag{0.1, 0.1, 0.2};                // Linear drag coefficients in the inertial frame (N.s/m)
+        Eigen::Vector3d max_rate{220.0, 220.0, 200.0};      // Maximum body rates (deg/s)
+    };
+
+    explicit QuadrotorModel(const Config & config);
+
+    /**
+     * @brief Set the desired attitude rate and the total thrust force of the vehicle
+     * @param attitude_rate The desired angular velocity in the body frame (deg/s)
+     * @param thrust_force The desired total thrust force (N)
+     */
+    void set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force);
+
+    /**
+     * @brief Set the desired attitude and the total thrust force of the vehicle
+     * @param attitude The desired attitude [roll, pitch, yaw] according to the Z-Y-X convention (deg)
+     * @param thrust_force The desired total thrust force (N)
+     */
+    void set_attitude(const Eigen::Vector3d & attitude, double thrust_force);
+
+    /**
+     * @brief Integrate the dynamics of the vehicle forward in time
+     * @param dt The integration step (s)
+     */
+    void step(double dt);
+
+    /**
+     * @brief Arm or disarm the motors. When disarmed, the motors do not produce any thrust
+     */
+    inline void set_armed(bool armed) { armed_ = armed; }
+    inline bool armed() const { return armed_; }
+
+    /**
+     * @brief Place the vehicle at rest at a given position and yaw (in radians)
+     */
+    void reset(const Eigen::Vector3d & position, double yaw);
+
+    // Current state of the vehicle (without stamp) and other quantities of interest
+    inline const State & get_state() const { return state_; }
+    inline bool on_ground() const { return on_ground_; }
+    inline double get_thrust() const { return thrust_; }
+    inline double get_hover_thrust() const { return config_.mass * config_.gravity; }
+
+private:
+
+    // The physical parameters of the vehicle
+    Config config_;
+
+    // The state of the rigid body
+    State state_;
+    bool on_ground_{true};
+    bool armed_{false};
+
+    // The inputs of the vehicle
+    bool attitude_control_{false};
+    Eigen::Vector3d desired_rate_{Eigen::Vector3d::Zero()};
+    Eigen::Quaterniond desired_attitude_{1.0, 0.0, 0.0, 0.0};
+    double desired_throttle_{0.0};
+
+    // The current throttle of the motors (0-100%) and corresponding thrust force (N)
+    double throttle_{0.0};
+    double thrust_{0.0};
+};
+
+} // namespace autopilot
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <memory>
+#include <string>
+#include <Eigen/Dense>
+
+// ROS imports
+#include "rclcpp/rclcpp.hpp"
+
+// ROS 2 messages used to control the vehicle
+#include "pegasus_msgs/msg/control_attitude.hpp"
+
+// Pegasus imports
+#include "autopilot/autopilot.hpp"
+#include "quadrotor_model.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Software-in-the-loop harness that flies a mission with the autopilot (and all its plugins) on a simulated quadrotor.
+ * The autopilot and the vehicle are stepped in lockstep on a simulated clock, such that the mission runs as fast as the
+ * computer allows: the state of the vehicle is fed directly to the autopilot, the control loop is stepped by the harness,
+ * and the commands of the controller are received through the intra-process communication of ROS 2 (no middleware in the loop).
+ * The harness also emulates the onboard microcontroller of the vehicle (arming, offboard mode and disarming after landing)
+ */
+class Sitl : public rclcpp::Node {
+
+public:
+
+    // Summary of a simulated mission
+    struct Result {
+        bool success{false};            // Whether the mission was completed
+        std::string failure;            // Reason for the mission to fail (if it failed)
+        double simulated_time{0.0};     // Duration of the mission in simulated time (s)
+        double wall_time{0.0};          // Time it took to simulate the mission (s)
+        double max_tracking_error{0.0}; // Maximum distance to the reference while following it or hovering (m)
+    };
+
+    /**
+     * @brief Create the harness for a given autopilot. The autopilot must be created with the control loop
+     * stepped externally (autopilot.trigger = external) and both nodes must use the intra-process communication
+     */
+    Sitl(const rclcpp::NodeOptions & options, std::shared_ptr<Autopilot> autopilot);
+
+    /**
+     * @brief Fly the full mission: arm, takeoff, follow a circular trajectory (or hover), land and disarm
+     * @return The summary of the mission
+     */
+    Result run();
+
+private:
+
+    // Steps of the mission flown by the harness. After the takeoff, the vehicle either follows a circle or hovers in place
+    enum class MissionStep { ARM, TAKEOFF, FOLLOW_TRAJECTORY, HOVER, LAND, FINISHED };
+    enum class MissionType { CIRCLE, HOVER };
+
+    // Initializations of the simulated vehicle and the ROS 2 interface
+    void initialize_vehicle();
+    void initialize_subscribers();
+
+    // Emulate the onboard microcontroller of the vehicle (status and disarm after landing)
+    void update_fmu(double dt);
+
+    // Advance the mission. Returns false when the mission finished (successfully or not)
+    bool update_mission(double time, Result & result);
+    void next_step(MissionStep step, double time);
+    bool add_trajectory();
+
+    // Subscriber callbacks to receive the commands of the controller
+    void attitude_callback(const pegasus_msgs::msg::ControlAttitude::ConstSharedPtr msg);
+    void attitude_rate_callback(const pegasus_msgs::msg::ControlAttitude::ConstSharedPtr msg);
+
+    // The autopilot under test and the executor used to deliver the messages between the nodes
+    std::shared_ptr<Autopilot> autopilot_;
+    rclcpp::executors::SingleThreadedExecutor executor_;
+
+    // The simulated vehicle and the emulated status of its onboard microcontroller
+    QuadrotorModel::UniquePtr model_;
+    VehicleConstants vehicle_constants_;
+    VehicleStatus status_;
+    bool has_flown_{false};
+    double landed_time_{0.0};
+    double auto_disarm_time_{2.0};
+
+    // Simulation configurations
+    double physics_rate_{500.0};
+    double real_time_factor_{0.0};
+    double max_duration_{300.0};
+
+    // Mission configurations and progress
+    MissionType mission_type_{MissionType::CIRCLE};
+    MissionStep step_{MissionStep::ARM};
+    double step_start_{0.0};
+    double step_timeout_{60.0};
+    double takeoff_tolerance_{0.1};
+    double takeoff_altitude_{0.0};
+    double takeoff_target_{0.0};
+    double circle_radius_{1.0};
+    double circle_speed_{0.5};
+    Eigen::Vector3d circle_center_{Eigen::Vector3d::Zero()};
+    double hover_duration_{10.0};
+    Eigen::Vector3d hover_position_{Eigen::Vector3d::Zero()};
+    double max_tracking_error_{0.0};
+
+    // ROS 2 subscribers for the commands of the controller
+    rclcpp::Subscription<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_subscriber_;
+    rclcpp::Subscription<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_rate_subscriber_;
+};
+
+} // namespace autopilot
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+import os
+from ament_index_python.packages import get_package_share_directory
+
+from launch import LaunchDescription
+from launch.substitutions import LaunchConfiguration
+from launch.actions import DeclareLaunchArgument
+from launch_ros.actions import Node
+
+def generate_launch_description():
+    
+    # ----------------------------------------
+    # ---- DECLARE THE LAUNCH ARGUMENTS ------
+    # ----------------------------------------
+    
+    # Namespace and ID of the vehicle as parameter received by the launch file
+    id_arg = DeclareLaunchArgument('vehicle_id', default_value='1', description='Drone ID in the network')
+    namespace_arg = DeclareLaunchArgument('vehicle_ns', default_value='drone', description='Namespace to append to every topic and node name')
+
+    # Get the name of the .yaml configuration files either from the packages or an external source
+    autopilot_yaml_arg = DeclareLaunchArgument(
+        'autopilot_yaml', 
+        default_value=os.path.join(get_package_share_directory('autopilot'), 'config', 'autopilot.yaml'),
+        description='The configurations for the autopilot to run')
+    
+    sitl_yaml_arg = DeclareLaunchArgument(
+        'sitl_yaml', 
+        default_value=os.path.join(get_package_share_directory('autopilot_sitl'), 'config', 'sitl.yaml'),
+        description='The configurations of the simulated vehicle and the mission to fly')
+
+    # Create the process that runs the autopilot and the simulated vehicle in lockstep (the node names are set by the executable)
+    sitl_node = Node(
+        package='autopilot_sitl',
+        namespace=[
+            LaunchConfiguration('vehicle_ns'), 
+            LaunchConfiguration('vehicle_id')],
+        executable='autopilot_sitl',
+        output="screen",
+        emulate_tty=True,
+        parameters=[
+            LaunchConfiguration('autopilot_yaml'),
+            LaunchConfiguration('sitl_yaml'),
+            {
+                'vehicle_id': LaunchConfiguration('vehicle_id'),
+                'vehicle_ns': LaunchConfiguration('vehicle_ns')
+            }
+        ]
+    )
+        
+    # Return the node to be launched by ROS2
+    return LaunchDescription([
+        # Launch arguments
+        id_arg,
+        namespace_arg,
+        autopilot_yaml_arg,
+        sitl_yaml_arg,
+        # Launch files
+        sitl_node])
@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <memory>
+#include "rclcpp/rclcpp.hpp"
+#include "autopilot/autopilot.hpp"
+#include "autopilot_sitl/sitl.hpp"
+
+int main(int argc, char ** argv) {
+    
+    // Initialize ROS2
+    rclcpp::init(argc, argv);
+
+    // Both nodes exchange messages through the intra-process communication only
+    auto options = rclcpp::NodeOptions().use_intra_process_comms(true);
+
+    // Create the autopilot node, with the control loop stepped by the simulator
+    auto autopilot_options = rclcpp::NodeOptions(options)
+        .arguments({"--ros-args", "-r", "__node:=autopilot", "--"})
+        .append_parameter_override("autopilot.trigger", "external")
+        .append_parameter_override("autopilot.realtime.enabled", false);
+    auto autopilot_node = std::make_shared<autopilot::Autopilot>(autopilot_options);
+
+    // Create the simulator and fly the mission
+    auto sitl_node = std::make_shared<autopilot::Sitl>(options, autopilot_node);
+    autopilot::Sitl::Result result = sitl_node->run();
+
+    // Report the result of the mission (the exit code can be used to run regression flights in CI)
+    if (result.success) {
+        RCLCPP_INFO(sitl_node->get_logger(), "Mission completed in %.2f s of simulated time (%.3f s of wall time, %.1fx faster than real time). Max tracking error: %.3f m", 
+            result.simulated_time, result.wall_time, result.simulated_time / result.wall_time, result.max_tracking_error);
+    } else {
+        RCLCPP_ERROR(sitl_node->get_logger(), "Mission failed after %.2f s of simulated time: %s", result.simulated_time, result.failure.c_str());
+    }
+
+    rclcpp::shutdown();
+    return result.success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
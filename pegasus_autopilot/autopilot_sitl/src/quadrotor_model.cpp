@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "pegasus_utils/rotations.hpp"
+#include "autopilot_sitl/quadrotor_model.hpp"
+
+namespace autopilot {
+
+QuadrotorModel::QuadrotorModel(const Config & config) : config_(config) {
+
+    // The thrust curve is required to convert the desired force into throttle (as done by the onboard microcontroller)
+    if (!config_.thrust_curve) throw std::runtime_error("QuadrotorModel requires a thrust curve");
+}
+
+void QuadrotorModel::reset(const Eigen::Vector3d & position, double yaw) {
+
+    // Place the vehicle at rest, levelled with the ground
+    state_ = State();
+    state_.position = position;
+    state_.attitude = Eigen::Quaterniond(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+    on_ground_ = position[2] >= 0.0;
+
+    // Stop the motors
+    desired_rate_ = Eigen::Vector3d::Zero();
+    desired_attitude_ = state_.attitude;
+    desired_throttle_ = 0.0;
+    throttle_ = 0.0;
+    thrust_ = 0.0;
+}
+
+void QuadrotorModel::set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force) {
+
+    // Save the desired body rates (in rad/s), limited to what the onboard rate controller accepts
+    for (unsigned int i = 0; i < 3; i++) {
+        desired_rate_[i] = Pegasus::Rotations::deg_to_rad(std::clamp(attitude_rate[i], -config_.max_rate[i], config_.max_rate[i]));
+    }
+
+    // Convert the desired force to throttle, using the thrust curve of the vehicle
+    desired_throttle_ = config_.thrust_curve->force_to_percentage(thrust_force);
+    attitude_control_ = false;
+}
+
+void QuadrotorModel::set_attitude(const Eigen::Vector3d & attitude, double thrust_force) {
+
+    // Save the desired attitude (converted from euler angles in degrees)
+    Eigen::Vector3d attitude_rad(
+        Pegasus::Rotations::deg_to_rad(attitude[0]),
+        Pegasus::Rotations::deg_to_rad(attitude[1]),
+        Pegasus::Rotations::deg_to_rad(attitude[2]));
+    desired_attitude_ = Pegasus::Rotations::euler_to_quaternion(attitude_rad);
+
+    // Convert the desired force to throttle, using the thrust curve of the vehicle
+    desired_throttle_ = config_.thrust_curve->force_to_percentage(thrust_force);
+    attitude_control_ = true;
+}
+
+void QuadrotorModel::step(double dt) {
+
+    // Response of the motors (first-order model on the throttle) and the corresponding thrust force
+    const double throttle_target = armed_ ? desired_throttle_ : 0.0;
+    throttle_ += (throttle_target - throttle_) * std::min(1.0, dt / config_.motor_time_constant);
+    thrust_ = armed_ ? std::max(0.0, config_.thrust_curve->percentage_to_force(throttle_)) : 0.0;
+
+    // Compute the body rates requested to the onboard rate controller (when tracking an attitude, use a proportional controller on the attitude error)
+    Eigen::Vector3d rate_reference = desired_rate_;
+    if (attitude_control_) {
+        Eigen::Quaterniond attitude_error = state_.attitude.conjugate() * desired_attitude_;
+        if (attitude_error.w() < 0.0) attitude_error.coeffs() = -attitude_error.coeffs();
+        rate_reference = 2.0 * config_.attitude_gain * attitude_error.vec();
+        for (unsigned int i = 0; i < 3; i++) {
+            const double max_rate = Pegasus::Rotations::deg_to_rad(config_.max_rate[i]);
+            rate_reference[i] = std::clamp(rate_reference[i], -max_rate, max_rate);
+        }
+    }
+
+    // Response of the onboard rate controller (first-order model on the angular velocity)
+    state_.angular_velocity += (rate_reference - state_.angular_velocity) * std::min(1.0, dt / config_.rate_time_constant);
+
+    // Translational dynamics (NED): gravity, thrust along the -Z axis of the body and linear drag
+    const Eigen::Vector3d acceleration = Eigen::Vector3d(0.0, 0.0, config_.gravity) 
+        - (thrust_ / config_.mass) * (state_.attitude * Eigen::Vector3d::UnitZ())
+        - config_.drag.cwiseProduct(state_.velocity) / config_.mass;
+
+    // Integrate the position and velocity (semi-implicit euler)
+    state_.velocity += acceleration * dt;
+    state_.position += state_.velocity * dt;
+
+    // Integrate the attitude exactly on SO(3), assuming a constant angular velocity during the step
+    const double angle = state_.angular_velocity.norm() * dt;
+    if (angle > 1e-12) {
+        state_.attitude = (state_.attitude * Eigen::Quaterniond(Eigen::AngleAxisd(angle, state_.angular_velocity.normalized()))).normalized();
+    }
+
+    // Contact with the ground (z = 0 in NED). The vehicle rests levelled on the ground until the thrust lifts it off
+    on_ground_ = state_.position[2] >= 0.0 && state_.velocity[2] >= 0.0;
+    if (on_ground_) {
+        state_.position[2] = 0.0;
+        state_.velocity = Eigen::Vector3d::Zero();
+        state_.angular_velocity = Eigen::Vector3d::Zero();
+        state_.attitude = Eigen::Quaterniond(Eigen::AngleAxisd(Pegasus::Rotations::yaw_from_quaternion(state_.attitude), Eigen::Vector3d::UnitZ()));
+    }
+}
+
+} // namespace autopilot
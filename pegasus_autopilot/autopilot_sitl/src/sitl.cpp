@@ -0,0 +1,379 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <map>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+#include "pegasus_utils/rotations.hpp"
+#include "static_trajectories/circle.hpp"
+#include "static_trajectory_manager/static_trajectory_manager.hpp"
+#include "autopilot_sitl/sitl.hpp"
+
+namespace autopilot {
+
+Sitl::Sitl(const rclcpp::NodeOptions & options, std::shared_ptr<Autopilot> autopilot) : Node("sitl", options), autopilot_(autopilot) {
+
+    // Simulation configurations
+    this->declare_parameter<double>("sitl.physics_rate", 500.0);
+    this->declare_parameter<double>("sitl.real_time_factor", 0.0);
+    this->declare_parameter<double>("sitl.max_duration", 300.0);
+    physics_rate_ = this->get_parameter("sitl.physics_rate").as_double();
+    real_time_factor_ = this->get_parameter("sitl.real_time_factor").as_double();
+    max_duration_ = this->get_parameter("sitl.max_duration").as_double();
+
+    // Mission configurations
+    this->declare_parameter<double>("sitl.mission.step_timeout", 60.0);
+    this->declare_parameter<double>("sitl.mission.takeoff_tolerance", 0.1);
+    this->declare_parameter<double>("sitl.mission.circle.radius", 1.0);
+    this->declare_parameter<double>("sitl.mission.circle.speed", 0.5);
+    this->declare_parameter<std::string>("sitl.mission.type", "circle");
+    this->declare_parameter<double>("sitl.mission.hover.duration", 10.0);
+    this->declare_parameter<double>("sitl.mission.max_tracking_error", 0.0);
+    step_timeout_ = this->get_parameter("sitl.mission.step_timeout").as_double();
+    takeoff_tolerance_ = this->get_parameter("sitl.mission.takeoff_tolerance").as_double();
+    circle_radius_ = this->get_parameter("sitl.mission.circle.radius").as_double();
+    circle_speed_ = this->get_parameter("sitl.mission.circle.speed").as_double();
+    hover_duration_ = this->get_parameter("sitl.mission.hover.duration").as_double();
+    max_tracking_error_ = this->get_parameter("sitl.mission.max_tracking_error").as_double();
+
+    const std::string mission_type = this->get_parameter("sitl.mission.type").as_string();
+    if (mission_type != "circle" && mission_type != "hover") {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Invalid mission type: " << mission_type << ". Valid options are: circle, hover");
+        std::exit(EXIT_FAILURE);
+    }
+    mission_type_ = (mission_type == "hover") ? MissionType::HOVER : MissionType::CIRCLE;
+
+    // Initialize the simulated vehicle and the ROS 2 interface
+    initialize_vehicle();
+    initialize_subscribers();
+}
+
+void Sitl::initialize_vehicle() {
+
+    // Get the mass and the thrust curve of the vehicle (same parameters as the ones used by the mavlink interface on the real vehicle)
+    this->declare_parameter<int>("vehicle_id", 1);
+    this->declare_parameter<double>("dynamics.mass", 1.5);
+    this->declare_parameter<std::string>("dynamics.thrust_curve.identifier", "Quadratic");
+    this->declare_parameter<std::vector<std::string>>("dynamics.thrust_curve.parameter_names", std::vector<std::string>({"a", "b", "c", "scale"}));
+    this->declare_parameter<std::vector<double>>("dynamics.thrust_curve.parameters", std::vector<double>({34.03, 7.151, -0.012, 100.0}));
+
+    vehicle_constants_.id = this->get_parameter("vehicle_id").as_int();
+    vehicle_constants_.mass = this->get_parameter("dynamics.mass").as_double();
+    vehicle_constants_.thrust_curve_id = this->get_parameter("dynamics.thrust_curve.identifier").as_string();
+    vehicle_constants_.thurst_curve_params = this->get_parameter("dynamics.thrust_curve.parameter_names").as_string_array();
+    vehicle_constants_.thrust_curve_values = this->get_parameter("dynamics.thrust_curve.parameters").as_double_array();
+
+    if (vehicle_constants_.thurst_curve_params.size() != vehicle_constants_.thrust_curve_values.size()) {
+        RCLCPP_ERROR(this->get_logger(), "Configuration for the thrust curve parameters and parameters names have a diferent sizes");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Create the thrust curve of the vehicle
+    std::map<std::string, double> gains;
+    for (unsigned int i = 0; i < vehicle_constants_.thrust_curve_values.size(); i++) gains[vehicle_constants_.thurst_curve_params[i]] = vehicle_constants_.thrust_curve_values[i];
+
+    // Get the parameters of the simulated dynamics
+    this->declare_parameter<double>("sitl.model.motor_time_constant", 0.03);
+    this->declare_parameter<double>("sitl.model.rate_time_constant", 0.05);
+    this->declare_parameter<double>("sitl.model.attitude_gain", 6.0);
+    this->declare_parameter<std::vector<double>>("sitl.model.drag", std::vector<double>({0.1, 0.1, 0.2}));
+    this->declare_parameter<std::vector<double>>("sitl.model.initial_position", std::vector<double>({0.0, 0.0, 0.0}));
+    this->declare_parameter<double>("sitl.model.initial_yaw", 0.0);
+    this->declare_parameter<double>("sitl.fmu.auto_disarm_time", 2.0);
+
+    QuadrotorModel::Config config;
+    config.mass = vehicle_constants_.mass;
+    config.motor_time_constant = this->get_parameter("sitl.model.motor_time_constant").as_double();
+    config.rate_time_constant = this->get_parameter("sitl.model.rate_time_constant").as_double();
+    config.attitude_gain = this->get_parameter("sitl.model.attitude_gain").as_double();
+    std::vector<double> drag = this->get_parameter("sitl.model.drag").as_double_array();
+    std::vector<double> initial_position = this->get_parameter("sitl.model.initial_position").as_double_array();
+    auto_disarm_time_ = this->get_parameter("sitl.fmu.auto_disarm_time").as_double();
+
+    if (drag.size() != 3 || initial_position.size() != 3) {
+        RCLCPP_ERROR(this->get_logger(), "The drag coefficients and the initial position of the vehicle must have 3 elements");
+        std::exit(EXIT_FAILURE);
+    }
+    config.drag = Eigen::Vector3d(drag[0], drag[1], drag[2]);
+
+    try {
+        config.thrust_curve.emplace(Pegasus::ThrustCurveVariant::create(vehicle_constants_.thrust_curve_id, gains));
+    } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(this->get_logger(), "Failed to create the thrust curve of the vehicle: " << e.what());
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Create the vehicle, at rest on the ground
+    model_ = std::make_unique<QuadrotorModel>(config);
+    model_->reset(Eigen::Vector3d(initial_position[0], initial_position[1], initial_position[2]), Pegasus::Rotations::deg_to_rad(this->get_parameter("sitl.model.initial_yaw").as_double()));
+}
+
+void Sitl::initialize_subscribers() {
+
+    // Subscribe to the same topics that the mavlink interface subscribes to on the real vehicle
+    this->declare_parameter<std::string>("sitl.subscribers.control_attitude", "fmu/in/force/attitude");
+    this->declare_parameter<std::string>("sitl.subscribers.control_attitude_rate", "fmu/in/force/attitude_rate");
+
+    attitude_subscriber_ = this->create_subscription<pegasus_msgs::msg::ControlAttitude>(
+        this->get_parameter("sitl.subscribers.control_attitude").as_string(), rclcpp::SensorDataQoS(), std::bind(&Sitl::attitude_callback, this, std::placeholders::_1));
+    attitude_rate_subscriber_ = this->create_subscription<pegasus_msgs::msg::ControlAttitude>(
+        this->get_parameter("sitl.subscribers.control_attitude_rate").as_string(), rclcpp::SensorDataQoS(), std::bind(&Sitl::attitude_rate_callback, this, std::placeholders::_1));
+}
+
+Sitl::Result Sitl::run() {
+
+    Result result;
+    const auto wall_start = std::chrono::steady_clock::now();
+
+    // Deliver the messages between the autopilot and the harness on this thread only, when the harness decides to
+    executor_.add_node(autopilot_);
+    executor_.add_node(this->shared_from_this());
+
+    // Receiving the vehicle constants lets the autopilot load the modes, controller, geofencing and trajectory manager
+    autopilot_->set_vehicle_constants(vehicle_constants_);
+    takeoff_altitude_ = autopilot_->get_parameter("autopilot.TakeoffMode.takeoff_altitude").as_double();
+
+    // The simulated clock starts at the current time of the autopilot and advances by fixed physics steps
+    const rclcpp::Time start = autopilot_->get_clock()->now();
+    const double control_rate = autopilot_->get_parameter("autopilot.rate").as_double();
+    const std::int64_t physics_step = static_cast<std::int64_t>(1.0e9 / physics_rate_);
+    const std::int64_t control_period = static_cast<std::int64_t>(1.0e9 / control_rate);
+    std::int64_t time = 0;
+    std::int64_t next_control = 0;
+
+    RCLCPP_INFO(this->get_logger(), "Starting the mission (physics at %.1f Hz, control loop at %.1f Hz)", physics_rate_, control_rate);
+
+    while (rclcpp::ok()) {
+
+        // Run one iteration of the control loop of the autopilot, with the state of the vehicle at this exact time instant
+        if (time >= next_control) {
+
+            const rclcpp::Time now(start.nanoseconds() + time, start.get_clock_type());
+            update_fmu(control_period * 1.0e-9);
+
+            State state = model_->get_state();
+            state.stamp = now.nanoseconds();
+            autopilot_->set_state(state);
+            autopilot_->set_status(status_);
+            autopilot_->update(now);
+
+            // Receive the commands of the controller, which are applied until the next iteration of the control loop
+            executor_.spin_some();
+
+            // Advance the mission and stop when it is finished
+            if (!update_mission(time * 1.0e-9, result)) break;
+            next_control += control_period;
+
+            // If requested, slow down the simulation to a multiple of real time
+            if (real_time_factor_ > 0.0) {
+                std::this_thread::sleep_until(wall_start + std::chrono::nanoseconds(static_cast<std::int64_t>(time / real_time_factor_)));
+            }
+        }
+
+        // Integrate the dynamics of the vehicle
+        model_->step(physics_step * 1.0e-9);
+        time += physics_step;
+
+        if (time * 1.0e-9 > max_duration_) {
+            result.failure = "Mission did not finish within " + std::to_string(max_duration_) + " s";
+            break;
+        }
+    }
+
+    // Summary of the mission
+    result.simulated_time = time * 1.0e-9;
+    result.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    return result;
+}
+
+void Sitl::update_fmu(double dt) {
+
+    // Detect the landing as the onboard microcontroller does: on the ground with low thrust for some time after having flown
+    has_flown_ = has_flown_ || !model_->on_ground();
+    landed_time_ = (model_->armed() && has_flown_ && model_->on_ground() && model_->get_thrust() < 0.5 * model_->get_hover_thrust()) ? landed_time_ + dt : 0.0;
+
+    // Disarm the vehicle automatically after landing
+    if (landed_time_ >= auto_disarm_time_) {
+        RCLCPP_INFO(this->get_logger(), "Landing detected. Disarming the vehicle");
+        model_->set_armed(false);
+        status_.offboard = false;
+        has_flown_ = false;
+        landed_time_ = 0.0;
+    }
+
+    // Update the status of the vehicle
+    status_.armed = model_->armed();
+    status_.flying = !model_->on_ground();
+}
+
+void Sitl::next_step(MissionStep step, double time) {
+
+    step_ = step;
+    step_start_ = time;
+
+    switch (step_) {
+
+        case MissionStep::ARM:
+            break;
+        
+        case MissionStep::TAKEOFF:
+            takeoff_target_ = model_->get_state().position[2] + takeoff_altitude_;
+            autopilot_->change_mode("TakeoffMode");
+            break;
+
+        case MissionStep::FOLLOW_TRAJECTORY:
+            if (!add_trajectory()) RCLCPP_WARN(this->get_logger(), "The trajectory manager does not accept static trajectories. Following an empty trajectory");
+            autopilot_->change_mode("FollowTrajectoryMode");
+            break;
+
+        case MissionStep::HOVER:
+            hover_position_ = model_->get_state().position;
+            if (autopilot_->get_mode() != "HoldMode") autopilot_->change_mode("HoldMode");
+            break;
+
+        case MissionStep::LAND:
+            autopilot_->change_mode("LandMode");
+            break;
+
+        case MissionStep::FINISHED:
+            break;
+    }
+}
+
+bool Sitl::update_mission(double time, Result & result) {
+
+    const State & state = model_->get_state();
+    const std::string mode = autopilot_->get_mode();
+
+    // Check if the current step of the mission is taking too long
+    if (step_ != MissionStep::FINISHED && time - step_start_ > step_timeout_) {
+        result.failure = "Mission step timed out in mode: " + mode;
+        return false;
+    }
+
+    switch (step_) {
+
+        case MissionStep::ARM:
+
+            // The vehicle accepts the arm and offboard requests straight away (so the ArmMode does not need to invoke the services)
+            if (!model_->armed()) {
+                model_->set_armed(true);
+                status_.offboard = true;
+                autopilot_->change_mode("ArmMode");
+            }
+            if (mode == "ArmMode") next_step(MissionStep::TAKEOFF, time);
+            return true;
+
+        case MissionStep::TAKEOFF:
+
+            // Wait for the vehicle to reach the takeoff altitude
+            if (std::abs(state.position[2] - takeoff_target_) < takeoff_tolerance_ && state.velocity.norm() < takeoff_tolerance_) {
+                next_step(mission_type_ == MissionType::HOVER ? MissionStep::HOVER : MissionStep::FOLLOW_TRAJECTORY, time);
+            }
+            return true;
+
+        case MissionStep::FOLLOW_TRAJECTORY: {
+
+            // Measure the distance to the circle being followed
+            const Eigen::Vector3d error = state.position - circle_center_;
+            result.max_tracking_error = std::max(result.max_tracking_error, std::hypot(error.head<2>().norm() - circle_radius_, error[2]));
+
+            // The FollowTrajectoryMode switches to HoldMode when the trajectory is finished
+            if (mode == "HoldMode") next_step(MissionStep::LAND, time);
+            return true;
+        }
+
+        case MissionStep::HOVER:
+
+            // Measure the distance to the position where the vehicle started hovering, and land after hovering for some time
+            result.max_tracking_error = std::max(result.max_tracking_error, (state.position - hover_position_).norm());
+            if (time - step_start_ >= hover_duration_) next_step(MissionStep::LAND, time);
+            return true;
+
+        case MissionStep::LAND:
+
+            // Wait for the vehicle to land and be disarmed
+            if (mode == "DisarmMode" && !model_->armed()) next_step(MissionStep::FINISHED, time);
+            return true;
+
+        case MissionStep::FINISHED:
+
+            // The mission also fails if the vehicle strayed too far from the reference (if a limit is set)
+            if (max_tracking_error_ > 0.0 && result.max_tracking_error > max_tracking_error_) {
+                result.failure = "Max tracking error of " + std::to_string(result.max_tracking_error) + " m is above the limit of " + std::to_string(max_tracking_error_) + " m";
+                return false;
+            }
+            result.success = true;
+            return false;
+    }
+
+    return false;
+}
+
+bool Sitl::add_trajectory() {
+
+    // Static trajectories can only be added to the StaticTrajectoryManager
+    auto trajectory_manager = std::dynamic_pointer_cast<StaticTrajectoryManager>(autopilot_->get_trajectory_manager());
+    if (!trajectory_manager) return false;
+
+    // Create a horizontal circle that starts at the current position of the vehicle (gamma = 0 corresponds to [radius, 0, 0] from the center)
+    circle_center_ = model_->get_state().position - Eigen::Vector3d(circle_radius_, 0.0, 0.0);
+    trajectory_manager->add_trajectory(std::make_shared<Circle>(circle_center_, Eigen::Vector3d(0.0, 0.0, 1.0), circle_radius_, circle_speed_));
+    return true;
+}
+
+void Sitl::attitude_callback(const pegasus_msgs::msg::ControlAttitude::ConstSharedPtr msg) {
+    model_->set_attitude(Eigen::Vector3d(msg->attitude[0], msg->attitude[1], msg->attitude[2]), msg->thrust);
+}
+
+void Sitl::attitude_rate_callback(const pegasus_msgs::msg::ControlAttitude::ConstSharedPtr msg) {
+    model_->set_attitude_rate(Eigen::Vector3d(msg->attitude[0], msg->attitude[1], msg->attitude[2]), msg->thrust);
+}
+
+} // namespace autopilot
@@ -75,8 +75,18 @@ public:
      */
     bool check_geofencing_violation() override;
 
+    /** 
+     * @brief Checks if a geofencing violation has ocurred, using the state captured at the beginning of the control loop iteration
+     * @param ctx The context of the current control loop iteration
+     * @return true if a geofencing violation has ocurred, false otherwise
+     */
+    bool check_geofencing_violation(const TickContext & ctx) override;
+
 protected:
 
+    /** @brief Checks if a given position is outside the box */
+    bool is_outside(const Eigen::Vector3d & position) const;
+
     /** @brief Limits for the box that will trigger the geofencing violation */
     Eigen::Vector2d limits_x_;
     Eigen::Vector2d limits_y_;
@@ -80,7 +80,16 @@ void BoxGeofencing::initialize() {
 bool BoxGeofencing::check_geofencing_violation() {
 
     // Get the current position of the vehicle
-    Eigen::Vector3d position = get_vehicle_state_().position;
+    return is_outside(get_vehicle_state_().position);
+}
+
+bool BoxGeofencing::check_geofencing_violation(const TickContext & ctx) {
+
+    // Use the position of the vehicle captured at the beginning of the iteration
+    return is_outside(ctx.state.position);
+}
+
+bool BoxGeofencing::is_outside(const Eigen::Vector3d & position) const {
 
     // Check if the position is outside the limits
     if(position(0) < limits_x_(0) || position(0) > limits_x_(1) || position(1) < limits_y_(0) || position(1) > limits_y_(1) || position(2) < limits_z_(0) || position(2) > limits_z_(1)) {
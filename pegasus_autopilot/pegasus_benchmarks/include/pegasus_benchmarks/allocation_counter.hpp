@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+namespace Pegasus::Benchmarks {
+
+/**
+ * @brief Number of heap allocations (malloc, calloc, realloc and aligned allocations, which also
+ * back operator new) performed by the process since it started. The counter is updated by the
+ * malloc hook defined in allocation_counter.cpp
+ * @return The total number of heap allocations
+ */
+std::uint64_t allocation_count();
+
+/**
+ * @brief Counts the heap allocations performed while the benchmark loop runs and reports them
+ * as the "allocs/op" counter of the benchmark (averaged over the iterations). It must be created
+ * right before the benchmark loop, such that the allocations of the setup are not counted:
+ *
+ *   AllocationCounter allocations(state);
+ *   for (auto _ : state) { ... }
+ */
+class AllocationCounter {
+
+public:
+
+    explicit AllocationCounter(benchmark::State & state) : state_(state), start_(allocation_count()) {}
+
+    ~AllocationCounter() {
+        state_.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocation_count() - start_), benchmark::Counter::kAvgIterations);
+    }
+
+    AllocationCounter(const AllocationCounter &) = delete;
+    AllocationCounter & operator=(const AllocationCounter &) = delete;
+
+private:
+
+    benchmark::State & state_;
+    std::uint64_t start_;
+};
+
+} // namespace Pegasus::Benchmarks
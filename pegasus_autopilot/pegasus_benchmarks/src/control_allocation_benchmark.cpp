@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <cmath>
+#include <array>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <Eigen/Core>
+
+#include "autopilot_controllers/control_allocation.hpp"
+#include "thrust_curves/thrust_curve_variant.hpp"
+#include "pegasus_benchmarks/allocation_counter.hpp"
+
+namespace {
+
+// Geometry of a multirotor with the rotors evenly spaced on a circle, alternating the direction of rotation
+template <typename T>
+std::vector<typename autopilot::ControlAllocation<T>::Rotor> make_rotors(int num_rotors, T arm_length, T km) {
+    std::vector<typename autopilot::ControlAllocation<T>::Rotor> rotors;
+    for (int i = 0; i < num_rotors; i++) {
+        const T angle = T(M_PI) / num_rotors + T(2 * M_PI) * i / num_rotors;
+        rotors.push_back({arm_length * std::cos(angle), arm_length * std::sin(angle), (i % 2 == 0) ? km : -km});
+    }
+    return rotors;
+}
+
+// Geometry of the Iris quadrotor (the same as in the autopilot configuration)
+template <typename T>
+std::vector<typename autopilot::ControlAllocation<T>::Rotor> iris_rotors() {
+    return {{T(0.1515), T(0.245), T(0.05)}, {T(-0.1515), T(-0.1875), T(0.05)}, {T(0.1515), T(-0.245), T(-0.05)}, {T(-0.1515), T(0.1875), T(-0.05)}};
+}
+
+// Total thrust (N) and torques (Nm) that span the operation of the vehicle, including commands that saturate the rotors
+constexpr std::array<double, 8> thrusts{15.0, 5.0, 25.0, 15.0, 1.0, 27.0, 15.0, 10.0};
+constexpr std::array<std::array<double, 3>, 8> torques{{
+    {0.0, 0.0, 0.0}, {0.1, -0.1, 0.02}, {-0.2, 0.3, 0.05}, {0.5, 0.0, -0.1},
+    {0.3, 0.3, 0.0}, {0.0, -0.4, 0.2}, {1.5, -1.5, 0.5}, {-0.05, 0.05, -0.3}
+}};
+
+// Maximum thrust of each rotor (N)
+constexpr double max_thrust = 7.0;
+
+template <typename T>
+void BM_ControlAllocation_Allocate(benchmark::State & state, std::vector<typename autopilot::ControlAllocation<T>::Rotor> rotors) {
+
+    // The mixer is computed only once, before the control loop
+    autopilot::ControlAllocation<T> allocation(rotors, static_cast<T>(max_thrust));
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        const Eigen::Matrix<T, 3, 1> torque(static_cast<T>(torques[i][0]), static_cast<T>(torques[i][1]), static_cast<T>(torques[i][2]));
+        benchmark::DoNotOptimize(allocation.allocate(static_cast<T>(thrusts[i]), torque).data());
+        benchmark::ClobberMemory();
+        i = (i + 1) % thrusts.size();
+    }
+}
+
+// Full allocation step of the controllers with the motors output: mixer, desaturation and conversion of the thrust of each motor to a percentage
+template <typename T>
+void BM_ControlAllocation_AllocateToPercentage(benchmark::State & state, std::vector<typename autopilot::ControlAllocation<T>::Rotor> rotors) {
+
+    autopilot::ControlAllocation<T> allocation(rotors, static_cast<T>(max_thrust));
+    const Pegasus::ThrustCurveVariant curve = Pegasus::ThrustCurveVariant::create("Quadratic", {{"a", 34.03}, {"b", 7.151}, {"c", -0.012}, {"scale", 100.0}});
+    Eigen::VectorXd motor_speed = Eigen::VectorXd::Zero(allocation.num_rotors());
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        const Eigen::Matrix<T, 3, 1> torque(static_cast<T>(torques[i][0]), static_cast<T>(torques[i][1]), static_cast<T>(torques[i][2]));
+        const auto & rotor_thrusts = allocation.allocate(static_cast<T>(thrusts[i]), torque);
+        for (int j = 0; j < rotor_thrusts.size(); j++) motor_speed[j] = curve.force_to_percentage(rotor_thrusts.size() * static_cast<double>(rotor_thrusts[j]));
+        benchmark::DoNotOptimize(motor_speed.data());
+        benchmark::ClobberMemory();
+        i = (i + 1) % thrusts.size();
+    }
+}
+
+// Computing the mixer from the geometry of the airframe (only done at startup, for reference)
+void BM_ControlAllocation_ComputeMixer(benchmark::State & state) {
+    const std::vector<autopilot::ControlAllocation<double>::Rotor> rotors = make_rotors<double>(static_cast<int>(state.range(0)), 0.25, 0.05);
+    for (auto _ : state) {
+        autopilot::ControlAllocation<double> allocation(rotors, max_thrust);
+        benchmark::DoNotOptimize(allocation.mixer().data());
+    }
+}
+
+// Register the benchmarks of each airframe, in double and single precision
+bool register_control_allocation_benchmarks() {
+
+    benchmark::RegisterBenchmark("BM_ControlAllocation_Allocate/Iris", BM_ControlAllocation_Allocate<double>, iris_rotors<double>());
+    benchmark::RegisterBenchmark("BM_ControlAllocation_Allocate/Hexa", BM_ControlAllocation_Allocate<double>, make_rotors<double>(6, 0.25, 0.05));
+    benchmark::RegisterBenchmark("BM_ControlAllocation_Allocate/Octo", BM_ControlAllocation_Allocate<double>, make_rotors<double>(8, 0.25, 0.05));
+    benchmark::RegisterBenchmark("BM_ControlAllocation_Allocate/Iris/float", BM_ControlAllocation_Allocate<float>, iris_rotors<float>());
+    benchmark::RegisterBenchmark("BM_ControlAllocation_Allocate/Octo/float", BM_ControlAllocation_Allocate<float>, make_rotors<float>(8, 0.25f, 0.05f));
+    benchmark::RegisterBenchmark("BM_ControlAllocation_AllocateToPercentage/Iris", BM_ControlAllocation_AllocateToPercentage<double>, iris_rotors<double>());
+    benchmark::RegisterBenchmark("BM_ControlAllocation_AllocateToPercentage/Iris/float", BM_ControlAllocation_AllocateToPercentage<float>, iris_rotors<float>());
+    benchmark::RegisterBenchmark("BM_ControlAllocation_ComputeMixer", BM_ControlAllocation_ComputeMixer)->Arg(4)->Arg(6)->Arg(8);
+    return true;
+}
+
+const bool registered = register_control_allocation_benchmarks();
+
+} // namespace
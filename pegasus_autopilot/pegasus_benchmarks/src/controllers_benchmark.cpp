@@ -0,0 +1,245 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <benchmark/benchmark.h>
+
+#include "rclcpp/rclcpp.hpp"
+#include "autopilot/state.hpp"
+#include "autopilot/tick_context.hpp"
+#include "autopilot/trajectory_manager.hpp"
+#include "autopilot_controllers/pid_controller.hpp"
+#include "autopilot_controllers/mellinger_controller.hpp"
+#include "autopilot_controllers/mpc_controller.hpp"
+#include "pegasus_benchmarks/allocation_counter.hpp"
+
+namespace {
+
+/**
+ * @brief Controller with the ROS publishers stubbed out. The commands that would be sent to the vehicle
+ * are kept in memory (such that the compiler cannot discard them), so that only the computations of the 
+ * controller are measured
+ */
+template <typename ControllerT>
+class StubbedController : public ControllerT {
+
+public:
+
+    using ControllerT::set_attitude;
+    using ControllerT::set_attitude_rate;
+
+    autopilot::ControlStatus set_attitude(const Eigen::Vector3d & attitude, double thrust_force, double dt=0) noexcept override {
+        command << attitude, thrust_force;
+        return autopilot::ControlStatus::OK;
+    }
+
+    autopilot::ControlStatus set_attitude_rate(const Eigen::Vector3d & attitude_rate, double thrust_force, double dt=0) noexcept override {
+        command << attitude_rate, thrust_force;
+        return autopilot::ControlStatus::OK;
+    }
+
+    // The last command computed by the controller
+    Eigen::Vector4d command{Eigen::Vector4d::Zero()};
+};
+
+/**
+ * @brief Controller that also has the publisher of the debug statistics stubbed out
+ */
+template <typename ControllerT>
+class StubbedStatisticsController : public StubbedController<ControllerT> {
+
+protected:
+
+    void publish_statistics(const rclcpp::Time & stamp) override {}
+};
+
+using PIDControllerStub = StubbedStatisticsController<autopilot::PIDController>;
+using MellingerControllerStub = StubbedStatisticsController<autopilot::MellingerController>;
+using MPCControllerStub = StubbedController<autopilot::MPCController>;
+
+// Dynamical constants of the vehicle (the mass and thrust curve of the iris used in simulation)
+const autopilot::VehicleConstants vehicle_constants{0, 1.5, "Quadratic", {"a", "b", "c", "scale"}, {34.03, 7.151, -0.012, 100.0}};
+
+/**
+ * @brief Circular trajectory with a constant speed, provided to the MPC as the preview of the references
+ */
+class CircleTrajectory : public autopilot::TrajectoryManager {
+
+public:
+
+    void initialize() override {}
+    Eigen::Vector3d pd(const double gamma) const noexcept override { return Eigen::Vector3d(radius * std::cos(gamma), radius * std::sin(gamma), -1.5); }
+    Eigen::Vector3d d_pd(const double gamma) const noexcept override { return Eigen::Vector3d(-radius * std::sin(gamma), radius * std::cos(gamma), 0.0); }
+    Eigen::Vector3d d2_pd(const double gamma) const noexcept override { return Eigen::Vector3d(-radius * std::cos(gamma), -radius * std::sin(gamma), 0.0); }
+    double vd(const double gamma) const noexcept override { return speed / radius; }
+    double min_gamma() const noexcept override { return 0.0; }
+    double max_gamma() const noexcept override { return 100.0; }
+    bool empty() const noexcept override { return false; }
+
+    const double radius{2.0};
+    const double speed{2.0};
+};
+
+// State of the vehicle, hovering slightly off the references with a small tilt
+autopilot::State make_state() {
+    autopilot::State state;
+    state.position = Eigen::Vector3d(0.1, -0.2, -1.0);
+    state.velocity = Eigen::Vector3d(0.05, 0.0, -0.1);
+    state.attitude = Eigen::Quaterniond(0.999, 0.02, -0.03, 0.01).normalized();
+    state.angular_velocity = Eigen::Vector3d(0.01, 0.02, 0.0);
+    return state;
+}
+
+// Position references followed by the controllers, such that the integral and the saturation are exercised
+const std::array<Eigen::Vector3d, 4> positions{
+    Eigen::Vector3d(0.0, 0.0, -1.0),
+    Eigen::Vector3d(0.5, 0.0, -1.2),
+    Eigen::Vector3d(0.5, 0.5, -1.5),
+    Eigen::Vector3d(-2.0, 1.0, -0.5)
+};
+
+/**
+ * @brief Creates and initializes a controller with the default gains of the autopilot. Each controller gets its 
+ * own node, since the parameters of the gains can only be declared once per node
+ */
+template <typename ControllerT>
+std::unique_ptr<ControllerT> make_controller(const std::string & name) {
+
+    auto options = rclcpp::NodeOptions()
+        .start_parameter_services(false)
+        .start_parameter_event_publisher(false)
+        .use_global_arguments(false)
+        .append_parameter_override("autopilot." + name + ".gains.kp", std::vector<double>{10.0, 10.0, 10.0})
+        .append_parameter_override("autopilot." + name + ".gains.kd", std::vector<double>{9.0, 9.0, 9.0})
+        .append_parameter_override("autopilot." + name + ".gains.ki", std::vector<double>{0.2, 0.2, 0.1})
+        .append_parameter_override("autopilot." + name + ".gains.kr", std::vector<double>{5.0, 5.0, 5.0})
+        .append_parameter_override("autopilot." + name + ".gains.min_output", std::vector<double>{-100.0, -100.0, -100.0})
+        .append_parameter_override("autopilot." + name + ".gains.max_output", std::vector<double>{100.0, 100.0, 100.0})
+        .append_parameter_override("autopilot." + name + ".weights.position", std::vector<double>{10.0, 10.0, 10.0})
+        .append_parameter_override("autopilot." + name + ".weights.velocity", std::vector<double>{1.0, 1.0, 1.0})
+        .append_parameter_override("autopilot." + name + ".weights.acceleration", std::vector<double>{0.1, 0.1, 0.1});
+
+    auto controller = std::make_unique<ControllerT>();
+    autopilot::Controller::Config config;
+    config.node = rclcpp::Node::make_shared("benchmark_" + name, options);
+    config.get_vehicle_state = []() { return make_state(); };
+    config.get_vehicle_status = []() { return autopilot::VehicleStatus{true, true, true}; };
+    config.get_vehicle_constants = []() -> const autopilot::VehicleConstants & { return vehicle_constants; };
+    controller->initialize_controller(config);
+    return controller;
+}
+
+// Run the position controller with the state of the vehicle captured at the beginning of the control loop iteration
+template <typename ControllerT>
+void run_set_position(benchmark::State & state, ControllerT & controller) {
+
+    const autopilot::TickContext ctx{make_state(), autopilot::VehicleStatus{true, true, true}, vehicle_constants, 0.02, rclcpp::Time(0, 0)};
+    const Eigen::Vector3d velocity(0.2, -0.1, 0.0);
+    const Eigen::Vector3d acceleration(0.1, 0.0, 0.0);
+    const Eigen::Vector3d jerk(0.01, 0.0, 0.0);
+    const Eigen::Vector3d snap(Eigen::Vector3d::Zero());
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        controller.set_position(positions[i], velocity, acceleration, jerk, snap, 30.0, 5.0, ctx);
+        benchmark::DoNotOptimize(controller.command);
+        i = (i + 1) % positions.size();
+    }
+}
+
+void BM_MellingerController_SetPosition(benchmark::State & state) {
+    auto controller = make_controller<MellingerControllerStub>("MellingerController");
+    run_set_position(state, *controller);
+}
+BENCHMARK(BM_MellingerController_SetPosition);
+
+void BM_PIDController_SetPosition(benchmark::State & state) {
+    auto controller = make_controller<PIDControllerStub>("PIDController");
+    run_set_position(state, *controller);
+}
+BENCHMARK(BM_PIDController_SetPosition);
+
+void BM_MPCController_SetPosition(benchmark::State & state) {
+    auto controller = make_controller<MPCControllerStub>("MPCController");
+    run_set_position(state, *controller);
+}
+BENCHMARK(BM_MPCController_SetPosition);
+
+void BM_MPCController_FollowTrajectory(benchmark::State & state) {
+
+    auto controller = make_controller<MPCControllerStub>("MPCController");
+    auto trajectory = std::make_shared<CircleTrajectory>();
+    const autopilot::TickContext ctx{make_state(), autopilot::VehicleStatus{true, true, true}, vehicle_constants, 0.02, rclcpp::Time(0, 0)};
+    double gamma = 0.0;
+    double iterations = 0.0;
+    double converged = 0.0;
+
+    // The vehicle is kept at the same state, while the reference moves along the trajectory
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        const double d_gamma = trajectory->vd(gamma);
+        controller->set_trajectory_preview(trajectory, gamma);
+        controller->set_position(trajectory->position(gamma), trajectory->velocity(gamma, d_gamma), trajectory->acceleration(gamma, d_gamma), Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero(), 0.0, 0.0, ctx);
+        benchmark::DoNotOptimize(controller->command);
+        iterations += controller->get_solver_info().iterations;
+        converged += controller->get_solver_info().converged;
+        gamma = gamma + d_gamma * ctx.dt < trajectory->max_gamma() ? gamma + d_gamma * ctx.dt : 0.0;
+    }
+
+    // Average number of iterations of the solver and fraction of the solves that reached the tolerances
+    state.counters["iterations"] = benchmark::Counter(iterations, benchmark::Counter::kAvgIterations);
+    state.counters["converged"] = benchmark::Counter(converged, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_MPCController_FollowTrajectory);
+
+} // namespace
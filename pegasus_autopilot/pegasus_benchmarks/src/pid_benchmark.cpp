@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <array>
+#include <benchmark/benchmark.h>
+
+#include "pid/pid.hpp"
+#include "pegasus_benchmarks/allocation_counter.hpp"
+
+namespace {
+
+using Pid3 = Pegasus::Pid<3>;
+
+// Sequence of errors fed to the PID, such that the integral and the saturation are exercised
+const std::array<Pid3::Vector, 4> errors{
+    Pid3::Vector(0.1, -0.2, 0.5),
+    Pid3::Vector(3.0, -4.0, 0.01),
+    Pid3::Vector(-0.05, 1.5, -2.0),
+    Pid3::Vector(0.0, 0.3, -0.3)
+};
+
+// Gains of the position PID in the default autopilot configuration
+Pid3 make_pid() {
+    Pid3::Gains gains;
+    gains.kp = Pid3::Vector(8.0, 8.0, 8.0);
+    gains.kd = Pid3::Vector(3.0, 3.0, 3.0);
+    gains.ki = Pid3::Vector(0.2, 0.2, 0.1);
+    gains.kff = Pid3::Vector(1.0, 1.0, 1.0);
+    gains.min_output = Pid3::Vector::Constant(-20.0);
+    gains.max_output = Pid3::Vector::Constant(20.0);
+    return Pid3(gains);
+}
+
+// Derivative of the error computed numerically by the PID
+void BM_Pid_ComputeOutput(benchmark::State & state) {
+
+    Pid3 pid = make_pid();
+    const Pid3::Vector feed_forward(0.5, 0.0, -9.81);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pid.compute_output(errors[i], feed_forward, 0.02));
+        i = (i + 1) % errors.size();
+    }
+}
+BENCHMARK(BM_Pid_ComputeOutput);
+
+// Derivative of the error provided by the caller
+void BM_Pid_ComputeOutputWithDerivative(benchmark::State & state) {
+
+    Pid3 pid = make_pid();
+    const Pid3::Vector feed_forward(0.5, 0.0, -9.81);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pid.compute_output(errors[i], -errors[i], feed_forward, 0.02));
+        i = (i + 1) % errors.size();
+    }
+}
+BENCHMARK(BM_Pid_ComputeOutputWithDerivative);
+
+} // namespace
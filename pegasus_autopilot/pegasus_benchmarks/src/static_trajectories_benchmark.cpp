@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <Eigen/Core>
+#include <benchmark/benchmark.h>
+
+#include "static_trajectory_manager/static_trajectory.hpp"
+#include "static_trajectories/contiguous_segments.hpp"
+#include "pegasus_benchmarks/allocation_counter.hpp"
+
+namespace {
+
+// Number of values of gamma sampled at random (spread over the whole trajectory)
+constexpr std::size_t RANDOM_SAMPLES = 4096;
+
+// Number of samples taken in each section when gamma moves forward, as done by the control loop
+constexpr double SAMPLES_PER_SECTION = 8.0;
+
+// Create a trajectory with the given number of sections, alternating between lines, circles and lemniscates
+// (the arcs are left out, since they log every position to the console)
+std::vector<autopilot::StaticTrajectory::SharedPtr> make_sections(std::size_t count) {
+
+    std::vector<autopilot::StaticTrajectory::SharedPtr> sections;
+    sections.reserve(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        const Eigen::Vector3d start(static_cast<double>(i), 0.0, -1.0);
+        switch (i % 3) {
+            case 0: sections.emplace_back(std::make_shared<autopilot::Line>(start, start + Eigen::Vector3d(1.0, 0.5, 0.0), 1.0)); break;
+            case 1: sections.emplace_back(std::make_shared<autopilot::Circle>(start, Eigen::Vector3d::UnitZ(), 2.0, 1.0)); break;
+            default: sections.emplace_back(std::make_shared<autopilot::Lemniscate>(start, Eigen::Vector3d::UnitZ(), 2.0, 1.0)); break;
+        }
+    }
+    return sections;
+}
+
+// Accumulated parametric lengths of the sections, as in the table of the trajectory manager
+std::vector<double> make_max_values(const std::vector<autopilot::StaticTrajectory::SharedPtr> & sections) {
+    std::vector<double> max_values;
+    max_values.reserve(sections.size());
+    for (const auto & section : sections) max_values.emplace_back((max_values.empty() ? 0.0 : max_values.back()) + section->max_gamma());
+    return max_values;
+}
+
+/**
+ * @brief Samples the trajectory at values of gamma that either move forward through all the sections (sequential)
+ * or jump between random sections. The section is found with a binary search in both layouts, so that only the 
+ * cost of reaching and sampling the section is compared
+ */
+class GammaSequence {
+
+public:
+
+    GammaSequence(const std::vector<double> & max_values, bool random) : max_values_(max_values), random_(random) {
+
+        const double max_gamma = max_values_.back();
+        step_ = max_gamma / (SAMPLES_PER_SECTION * static_cast<double>(max_values_.size()));
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> distribution(0.0, max_gamma);
+        if (random_) for (std::size_t i = 0; i < RANDOM_SAMPLES; i++) gammas_.emplace_back(distribution(generator));
+    }
+
+    // Get the next value of gamma and the index of its section (and normalize gamma to the section)
+    inline std::size_t next(double & gamma) {
+
+        if (random_) {
+            gamma = gammas_[i_];
+            i_ = (i_ + 1) % gammas_.size();
+        } else {
+            gamma = gamma_;
+            gamma_ = gamma_ + step_ > max_values_.back() ? 0.0 : gamma_ + step_;
+        }
+
+        const std::size_t index = std::lower_bound(max_values_.begin(), max_values_.end(), gamma) - max_values_.begin();
+        if (index > 0) gamma -= max_values_[index - 1];
+        return index;
+    }
+
+private:
+
+    const std::vector<double> & max_values_;
+    bool random_;
+    std::vector<double> gammas_;
+    std::size_t i_{0};
+    double gamma_{0.0};
+    double step_{0.0};
+};
+
+void BM_StaticTrajectory_Pointers(benchmark::State & state, bool random) {
+
+    const std::vector<autopilot::StaticTrajectory::SharedPtr> sections = make_sections(state.range(0));
+    const std::vector<double> max_values = make_max_values(sections);
+    GammaSequence sequence(max_values, random);
+    double gamma = 0.0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        const std::size_t index = sequence.next(gamma);
+        benchmark::DoNotOptimize(sections[index]->sample(gamma, 3));
+    }
+}
+
+void BM_StaticTrajectory_Contiguous(benchmark::State & state, bool random) {
+
+    const std::vector<double> max_values = make_max_values(make_sections(state.range(0)));
+    GammaSequence sequence(max_values, random);
+    double gamma = 0.0;
+
+    // Keep only the copies of the sections in the contiguous storage
+    autopilot::ContiguousSegments segments;
+    for (const auto & section : make_sections(state.range(0))) segments.add(section);
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        const std::size_t index = sequence.next(gamma);
+        benchmark::DoNotOptimize(segments.sample_segment(index, gamma, 3));
+    }
+}
+
+// Register the benchmarks of both layouts of the sections, for trajectories with 10, 1k and 100k sections
+bool register_static_trajectory_benchmarks() {
+
+    for (bool random : {false, true}) {
+        const std::string access = random ? "Random" : "Sequential";
+        benchmark::RegisterBenchmark(("BM_StaticTrajectory_Pointers/" + access).c_str(), BM_StaticTrajectory_Pointers, random)->Arg(10)->Arg(1000)->Arg(100000);
+        benchmark::RegisterBenchmark(("BM_StaticTrajectory_Contiguous/" + access).c_str(), BM_StaticTrajectory_Contiguous, random)->Arg(10)->Arg(1000)->Arg(100000);
+    }
+    return true;
+}
+
+const bool registered = register_static_trajectory_benchmarks();
+
+} // namespace
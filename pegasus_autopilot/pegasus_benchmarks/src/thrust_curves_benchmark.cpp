@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "thrust_curves/thrust_curves.hpp"
+#include "thrust_curves/thrust_curve_variant.hpp"
+#include "pegasus_benchmarks/allocation_counter.hpp"
+
+namespace {
+
+// Parameters of each thrust curve registered in the factory (taken from the vehicle configurations when available)
+const std::vector<std::pair<std::string, std::map<std::string, double>>> thrust_curves{
+    {"Quadratic", {{"a", 34.03}, {"b", 7.151}, {"c", -0.012}, {"scale", 100.0}}},
+    {"Arctan", {{"a", 12.38808}, {"b", 0.01430}, {"c", -0.54490}, {"d", 6.22994}}},
+    {"LinearExponential", {{"a", 0.3}, {"b", -0.05}, {"c", 2.0}, {"d", 0.0}, {"scale", 1.0}}}
+};
+
+// Forces (in Newton) and percentages (0-100%) that span the range of the curves, including saturated inputs
+constexpr std::array<double, 8> forces{-1.0, 0.5, 2.0, 5.0, 9.81, 12.0, 20.0, 50.0};
+constexpr std::array<double, 8> percentages{-5.0, 0.0, 10.0, 35.0, 50.0, 72.0, 100.0, 120.0};
+
+// Create the thrust curves through the factory, as done by the autopilot (optionally sampled into a lookup table)
+Pegasus::ThrustCurve::SharedPtr make_thrust_curve(const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+    Pegasus::ThrustCurve::SharedPtr curve = Pegasus::ThrustCurveFactory::get_instance().create_thrust_curve(parameters, identifier);
+    if (tabulated) return Pegasus::TabulatedThrustCurve::from_curve(curve);
+    return curve;
+}
+
+void BM_ThrustCurve_ForceToPercentage(benchmark::State & state, const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+
+    Pegasus::ThrustCurve::SharedPtr curve = make_thrust_curve(identifier, parameters, tabulated);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(curve->force_to_percentage(forces[i]));
+        i = (i + 1) % forces.size();
+    }
+}
+
+void BM_ThrustCurve_PercentageToForce(benchmark::State & state, const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+
+    Pegasus::ThrustCurve::SharedPtr curve = make_thrust_curve(identifier, parameters, tabulated);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(curve->percentage_to_force(percentages[i]));
+        i = (i + 1) % percentages.size();
+    }
+}
+
+// Create the thrust curves by value, as done by the mavlink interface and the simulator (optionally sampled into a lookup table)
+Pegasus::ThrustCurveVariant make_thrust_curve_variant(const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+    Pegasus::ThrustCurveVariant curve = Pegasus::ThrustCurveVariant::create(identifier, parameters);
+    if (tabulated) return Pegasus::TabulatedCurve::from_curve(curve);
+    return curve;
+}
+
+void BM_ThrustCurveVariant_ForceToPercentage(benchmark::State & state, const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+
+    const Pegasus::ThrustCurveVariant curve = make_thrust_curve_variant(identifier, parameters, tabulated);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(curve.force_to_percentage(forces[i]));
+        i = (i + 1) % forces.size();
+    }
+}
+
+void BM_ThrustCurveVariant_PercentageToForce(benchmark::State & state, const std::string & identifier, const std::map<std::string, double> & parameters, bool tabulated) {
+
+    const Pegasus::ThrustCurveVariant curve = make_thrust_curve_variant(identifier, parameters, tabulated);
+    std::size_t i = 0;
+
+    Pegasus::Benchmarks::AllocationCounter allocations(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(curve.percentage_to_force(percentages[i]));
+        i = (i + 1) % percentages.size();
+    }
+}
+
+// Register the benchmarks of each thrust curve. The curves are only created when the benchmarks run, since the
+// thrust curves may not be registered in the factory yet during the static initialization of this executable
+bool register_thrust_curve_benchmarks() {
+
+    for (const auto & [identifier, parameters] : thrust_curves) {
+        for (bool tabulated : {false, true}) {
+            const std::string name = identifier + (tabulated ? "/Tabulated" : "");
+            benchmark::RegisterBenchmark(("BM_ThrustCurve_ForceToPercentage/" + name).c_str(), BM_ThrustCurve_ForceToPercentage, identifier, parameters, tabulated);
+            benchmark::RegisterBenchmark(("BM_ThrustCurve_PercentageToForce/" + name).c_str(), BM_ThrustCurve_PercentageToForce, identifier, parameters, tabulated);
+            benchmark::RegisterBenchmark(("BM_ThrustCurveVariant_ForceToPercentage/" + name).c_str(), BM_ThrustCurveVariant_ForceToPercentage, identifier, parameters, tabulated);
+            benchmark::RegisterBenchmark(("BM_ThrustCurveVariant_PercentageToForce/" + name).c_str(), BM_ThrustCurveVariant_PercentageToForce, identifier, parameters, tabulated);
+        }
+    }
+    return true;
+}
+
+const bool registered = register_thrust_curve_benchmarks();
+
+} // namespace
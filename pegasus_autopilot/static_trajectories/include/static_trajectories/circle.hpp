@@ -121,6 +121,14 @@ public:
     double vehicle_speed(const double gamma) const override;
     double vd(const double gamma) const override;
 
+    /**
+     * @brief This function returns every quantity of the trajectory at a given value of gamma at once
+     * @param gamma The parameter that paramaterizes the trajectory
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    TrajectorySample sample(const double gamma, const int derivative_order) const override;
+
 protected:
 
     /** @brief The speed in m/s the vehicle should follow the path at */
@@ -152,6 +160,14 @@ public:
     
     virtual void initialize() override;
 
+    // Segments of a batch: center [3], normal [3], radius, speed
+    virtual SegmentType segment_type() const override { return CIRCLE; }
+    virtual std::size_t segment_size() const override { return 8; }
+    virtual StaticTrajectory::SharedPtr build_segment(const Segment & segment) const override;
+
+    // Storage of the sections of this library by value (ContiguousSegments)
+    virtual SegmentStorage::SharedPtr create_segment_storage() const override;
+
 protected:
 
     // Service callback to setup a circle trajectory
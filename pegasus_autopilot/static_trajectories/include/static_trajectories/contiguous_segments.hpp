@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <variant>
+#include <type_traits>
+
+// Storage of the trajectory sections used by the trajectory manager
+#include <static_trajectory_manager/segment_storage.hpp>
+
+// The trajectory sections stored by value
+#include "arc.hpp"
+#include "csv.hpp"
+#include "line.hpp"
+#include "circle.hpp"
+#include "lemniscate.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Storage of the trajectory sections that keeps the lines, arcs, circles and lemniscates by value in blocks of std::variant
+ * (each block is a contiguous vector), such that sampling a section does not follow a pointer to a separate allocation for each section.
+ * The sections are sampled with std::visit and a call to the sample method of the concrete type (which is not virtual). The csv
+ * trajectories are kept as views to the trajectory (their rows are too large to be copied), and the types of other libraries through
+ * their pointer. The blocks are shared between the storage and its snapshots, so a snapshot only copies the pointers to the blocks
+ */
+class ContiguousSegments final : public SegmentStorage {
+
+public:
+
+    using SharedPtr = std::shared_ptr<ContiguousSegments>;
+
+    /**
+     * @brief View of a csv trajectory, that samples it without a virtual call (and keeps its rows alive)
+     */
+    struct CSVView {
+        std::shared_ptr<const CSVTrajectory> trajectory;
+    };
+
+    using Segment = std::variant<Line, Arc, Circle, Lemniscate, CSVView, StaticTrajectory::SharedPtr>;
+
+    SegmentStorage::SharedPtr create() const override { return std::make_shared<ContiguousSegments>(); }
+    SegmentStorage::ConstSharedPtr snapshot() const override { return std::make_shared<ContiguousSegments>(*this); }
+
+    /**
+     * @brief Add a section at the end of the storage. The sections of the types known by the storage are copied (only if 
+     * their dynamic type is exactly that type, so that derived types are not sliced), and all the others are kept by pointer
+     * @param trajectory The trajectory section
+     */
+    void add(const StaticTrajectory::SharedPtr & trajectory) override;
+
+    std::size_t size() const override { return size_; }
+
+    TrajectorySample sample(const std::size_t index, const double gamma, const int derivative_order) const noexcept override {
+        return sample_segment(index, gamma, derivative_order);
+    }
+
+    /**
+     * @brief Same as sample(), but can be inlined by the callers that know the type of the storage
+     */
+    inline TrajectorySample sample_segment(const std::size_t index, const double gamma, const int derivative_order) const noexcept {
+        return std::visit([gamma, derivative_order](const auto & segment) {
+            using Type = std::decay_t<decltype(segment)>;
+            if constexpr (std::is_same_v<Type, StaticTrajectory::SharedPtr>) return segment->sample(gamma, derivative_order);
+            else if constexpr (std::is_same_v<Type, CSVView>) return segment.trajectory->CSVTrajectory::sample(gamma, derivative_order);
+            else return segment.Type::sample(gamma, derivative_order);
+        }, (*blocks_[index / BLOCK_SIZE])[index % BLOCK_SIZE]);
+    }
+
+private:
+
+    // Number of sections of each block (a power of 2, such that finding the block of a section is a shift)
+    static constexpr std::size_t BLOCK_SIZE{256};
+    using Block = std::vector<Segment>;
+
+    // Get the last block, to add a section to it. A new block is created if the last one is full, and the last block
+    // is copied first if a snapshot still uses it (the full blocks are never modified, so they are always shared)
+    Block & writable_block();
+
+    // The trajectory sections, in the order they were added, in blocks of BLOCK_SIZE sections
+    std::vector<std::shared_ptr<Block>> blocks_;
+    std::size_t size_{0};
+};
+
+} // namespace autopilot
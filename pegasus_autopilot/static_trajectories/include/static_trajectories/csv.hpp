@@ -47,8 +47,10 @@
  ****************************************************************************/
 #pragma once
 
+#include <span>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include <Eigen/Core>
 
 // ROS imports
@@ -61,6 +63,9 @@
 #include <static_trajectory_manager/static_trajectory.hpp>
 #include <static_trajectory_manager/static_trajectory_factory.hpp>
 
+// Memory map of the csv and cache files
+#include "mapped_file.hpp"
+
 namespace autopilot {
 
 class CSVTrajectory: public StaticTrajectory {
@@ -71,7 +76,44 @@ public:
     using UniquePtr = std::unique_ptr<CSVTrajectory>;
     using WeakPtr = std::weak_ptr<CSVTrajectory>;
 
-    CSVTrajectory(const std::string & filename, const Eigen::Vector3d & offset, bool check_z_negative);
+    /**
+     * @brief One row of the csv file, with the same layout as the columns of the file (and the rows of the binary cache)
+     */
+    struct Row {
+        double time;
+        double pos[3];
+        double vel[3];
+        double acc[3];
+        double jerk[3];
+        double yaw;
+        double yaw_rate;
+    };
+    static_assert(sizeof(Row) == 15 * sizeof(double), "The rows of the csv trajectory must not have padding");
+
+    /**
+     * @brief Header of the binary cache (.ptraj) of a csv file. The cache is only valid
+     * if the size, modification time and hash of the csv file match the ones stored here
+     */
+    struct CacheHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t columns;
+        std::uint64_t rows;
+        std::int64_t source_mtime;
+        std::uint64_t source_size;
+        std::uint64_t source_hash;
+        std::uint8_t reserved[16];
+    };
+    static_assert(sizeof(CacheHeader) == 64, "The rows of the binary cache must be aligned to 64 bytes");
+
+    /**
+     * @brief Constructor for a new CSV trajectory
+     * @param filename The path of the csv file (time, x, y, z, vx, vy, vz, ax, ay, az, jx, jy, jz, yaw (rad), yaw_rate (rad/s))
+     * @param offset The offset to add to the position of the trajectory
+     * @param check_z_negative Whether to invert the z coordinate of the rows where it is positive (NED)
+     * @param use_cache Whether to load the trajectory from (and save it to) a binary cache next to the csv file (filename + ".ptraj")
+     */
+    CSVTrajectory(const std::string & filename, const Eigen::Vector3d & offset, bool check_z_negative, bool use_cache=false);
 
     /**
      * @brief The section parametric equation 
@@ -130,21 +172,44 @@ public:
      */
     double vd(const double gamma) const override;
 
+    /**
+     * @brief This function returns every quantity of the trajectory at a given value of gamma at once
+     * @param gamma The parameter that paramaterizes the trajectory
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    TrajectorySample sample(const double gamma, const int derivative_order) const override;
+
 protected:
 
-    void parse_csv(const std::string & filename);
+    void parse_csv(const MappedFile & file);
     int get_closest_index(const double gamma) const;
 
-    // The vectors that stores the data that represents the trajectory
-    std::vector<double> time_;
-    
-    std::vector<Eigen::Vector3d> pos_;
-    std::vector<Eigen::Vector3d> vel_;
-    std::vector<Eigen::Vector3d> acc_;
-    std::vector<Eigen::Vector3d> jerk_;
+    // Load the trajectory from the binary cache. Returns false if the cache does not exist or does not match the csv file
+    bool load_cache(const std::string & cache_filename, const MappedFile & csv_file, std::uint64_t csv_hash);
+
+    // Save the parsed trajectory to the binary cache (atomically, through a temporary file)
+    void save_cache(const std::string & cache_filename, const MappedFile & csv_file, std::uint64_t csv_hash) const;
+
+    // Hash (FNV-1a, 64 bits) of the content of a file, used to validate the binary cache
+    static std::uint64_t hash(const char * data, std::size_t size);
+
+    // Get the position, velocity, acceleration and jerk of a row (with the offset and the z inversion applied)
+    Eigen::Vector3d position(const int idx) const;
+    Eigen::Vector3d derivative(const int idx, const double (&value)[3]) const;
 
-    std::vector<double> yaw_;
-    std::vector<double> yaw_rate_;
+    // Whether the z coordinate of a row should be inverted
+    inline bool invert_z(const int idx) const { return check_z_negative_ && rows_[idx].pos[2] + offset_[2] > 0.0; }
+
+    // The rows of the trajectory, either owned by parsed_rows_ (parsed from the csv file) or by cache_ (memory mapped)
+    std::span<const Row> rows_;
+    std::vector<Row> parsed_rows_;
+    MappedFile cache_;
+
+    // The offset to add to the position and whether to invert the positive z coordinates (applied when the rows are read,
+    // so that the rows can be memory mapped from the read-only cache)
+    Eigen::Vector3d offset_;
+    bool check_z_negative_;
 
     // Get the rate at which the trajectory is sampled
     double dt_;
@@ -156,6 +221,15 @@ public:
 
     virtual void initialize() override;
 
+    // Segments of a batch: offset [3], check_z_negative (0 or 1), and the path of the csv file
+    virtual SegmentType segment_type() const override { return CSV; }
+    virtual std::size_t segment_size() const override { return 4; }
+    virtual bool segment_has_file() const override { return true; }
+    virtual StaticTrajectory::SharedPtr build_segment(const Segment & segment) const override;
+
+    // Storage of the sections of this library by value (ContiguousSegments)
+    virtual SegmentStorage::SharedPtr create_segment_storage() const override;
+
 protected:
 
     // Service callback to setup a csv trajectory
@@ -163,6 +237,9 @@ protected:
 
     // Service to append a csv trajectory to the trajectory manager
     rclcpp::Service<pegasus_msgs::srv::AddCsv>::SharedPtr add_csv_service_{nullptr};
+
+    // Whether to keep a binary cache (.ptraj) next to the csv files, so that loading the same file again does not parse it
+    bool use_cache_{false};
 };
 
 } //namespace autopilot
\ No newline at end of file
@@ -74,6 +74,7 @@ public:
 
     double vehicle_speed(const double gamma) const override;
     double vd(const double gamma) const override;
+    TrajectorySample sample(const double gamma, const int derivative_order) const override;
     
 protected:
 
@@ -94,6 +95,14 @@ public:
 
     virtual void initialize() override;
 
+    // Segments of a batch: start [3], end [3], speed
+    virtual SegmentType segment_type() const override { return LINE; }
+    virtual std::size_t segment_size() const override { return 7; }
+    virtual StaticTrajectory::SharedPtr build_segment(const Segment & segment) const override;
+
+    // Storage of the sections of this library by value (ContiguousSegments)
+    virtual SegmentStorage::SharedPtr create_segment_storage() const override;
+
 protected:
 
     // Service callback to setup a line trajectory
@@ -46,7 +46,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
 #include "static_trajectories/arc.hpp"
-#include <iostream>
+#include "static_trajectories/contiguous_segments.hpp"
 
 namespace autopilot {
 
@@ -104,10 +104,6 @@ Eigen::Vector3d Arc::pd(const double gamma) const {
     // rotate the plane where the circle is located. Otherwise, we are just multiplying by the identity matrix
     pd = rotation_ * pd;
 
-    std::cout << "radius: " << radius_ << std::endl;
-    std::cout << "curr_angle: " << curr_angle << std::endl;
-    std::cout << "pd: " << pd.transpose() << std::endl;
-
     // Add theoffset to the circle after the rotation, otherwise the offset would also get rotated
     return pd + center_;
 }
@@ -124,11 +120,8 @@ Eigen::Vector3d Arc::d_pd(const double gamma) const {
     d_pd[2] = 0.0;
 
     // If the "normal_" vector is different than [0.0, 0.0, 1.0], then 
-    // rotate the plane where the circle is located. Otherwise, we are just multiplying by the identity matrix
-    d_pd = rotation_ * d_pd;
-
-    // Add theoffset to the circle after the rotation, otherwise the offset would also get rotated
-    return d_pd + center_;
+    // rotate the plane where the circle is located. The offset of the center does not affect the derivatives
+    return rotation_ * d_pd;
 }
 
 Eigen::Vector3d Arc::d2_pd(const double gamma) const {
@@ -143,11 +136,8 @@ Eigen::Vector3d Arc::d2_pd(const double gamma) const {
     dd_pd[2] = 0.0;
 
     // If the "normal_" vector is different than [0.0, 0.0, 1.0], then 
-    // rotate the plane where the circle is located. Otherwise, we are just multiplying by the identity matrix
-    dd_pd = rotation_ * dd_pd;
-
-    // Add theoffset to the circle after the rotation, otherwise the offset would also get rotated
-    return dd_pd + center_;
+    // rotate the plane where the circle is located. The offset of the center does not affect the derivatives
+    return rotation_ * dd_pd;
 }
 
 
@@ -191,6 +181,34 @@ double Arc::vd(const double gamma) const {
     return vd;
 }
 
+TrajectorySample Arc::sample(const double gamma, const int derivative_order) const {
+
+    // Compute the angle of the arc and its trigonometric functions only once for all the derivatives
+    const double w = -clockwise_direction_ * M_PI;
+    const double curr_angle = init_angle_ + w * gamma;
+    const double s = sin(curr_angle);
+    const double c = cos(curr_angle);
+
+    TrajectorySample sample;
+
+    // Position in the plane of the arc, rotated and offset by the center
+    sample.pd = rotation_ * Eigen::Vector3d(radius_ * c, radius_ * s, 0.0) + center_;
+
+    // The first derivative is always needed to compute the desired speed in the trajectory frame
+    sample.d_pd = rotation_ * Eigen::Vector3d(-radius_ * w * s, radius_ * w * c, 0.0);
+    if (derivative_order >= 2) sample.d2_pd = rotation_ * Eigen::Vector3d(-radius_ * std::pow(w, 2) * c, -radius_ * std::pow(w, 2) * s, 0.0);
+
+    // Point the vehicle to the center of the arc
+    const Eigen::Vector3d center_to_pd = center_ - sample.pd;
+    sample.yaw = std::atan2(center_to_pd[1], center_to_pd[0]);
+    sample.d_yaw = 0.0;
+
+    // Desired speeds of the vehicle and in the trajectory frame
+    sample.vehicle_speed = vehicle_speed_;
+    sample.vd = parameter_speed(vehicle_speed_, sample.d_pd);
+    return sample;
+}
+
 void ArcFactory::initialize() {
     
     // Load the service topic from the parameter server
@@ -205,16 +223,26 @@ void ArcFactory::arc_callback(const pegasus_msgs::srv::AddArc::Request::SharedPt
     // Log the parameters of the path section to be added
     RCLCPP_INFO_STREAM(node_->get_logger(), "Adding arc to path. Speed: " << request->speed.parameters[0] << ", start: [" << request->start[0] << "," << request->start[1] << "], center: [" << request->center[0] << "," << request->center[1] << "," << request->center[2] << "], normal: [" << request->normal[0] << "," << request->normal[1] << "," << request->normal[2] << "], clockwise: " << request->clockwise_direction << ".");
 
-    // Create a new arc
-    Arc::SharedPtr arc = std::make_shared<Arc>(Eigen::Vector2d(request->start.data()), Eigen::Vector3d(request->center.data()), Eigen::Vector3d(request->normal.data()), request->speed.parameters[0], request->clockwise_direction);
-
-    // Add the arc to the path
-    this->add_trajectory_to_manager(arc);
+    // Create a new arc in the background and add it to the path once it is built
+    this->submit_trajectory_to_manager("arc", [request]() {
+        return std::make_shared<Arc>(Eigen::Vector2d(request->start.data()), Eigen::Vector3d(request->center.data()), Eigen::Vector3d(request->normal.data()), request->speed.parameters[0], request->clockwise_direction);
+    });
 
-    // Update the response
+    // Update the response (the arc was accepted)
     response->success = true;
 }
 
+StaticTrajectory::SharedPtr ArcFactory::build_segment(const Segment & segment) const {
+
+    // Create the arc from the parameters of the segment
+    const std::vector<double> & p = segment.parameters;
+    return std::make_shared<Arc>(Eigen::Vector2d(p[0], p[1]), Eigen::Vector3d(p[2], p[3], p[4]), Eigen::Vector3d(p[5], p[6], p[7]), p[8], p[9] != 0.0);
+}
+
+SegmentStorage::SharedPtr ArcFactory::create_segment_storage() const {
+    return std::make_shared<ContiguousSegments>();
+}
+
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
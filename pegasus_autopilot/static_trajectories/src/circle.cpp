@@ -46,6 +46,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
 #include "static_trajectories/circle.hpp"
+#include "static_trajectories/contiguous_segments.hpp"
 
 namespace autopilot {
 
@@ -158,19 +159,36 @@ double Circle::vehicle_speed(const double gamma) const {
 
 double Circle::vd(const double gamma) const {
 
-    // Define a zero velocity variable
-    double vd = 0.0;
+    // Convert the speed from the vehicle frame to the path frame
+    return parameter_speed(vehicle_speed_, d_pd(gamma));
+}
 
-    // Compute the derivative norm
-    double derivative_norm = d_pd(gamma).norm();
+TrajectorySample Circle::sample(const double gamma, const int derivative_order) const {
 
-    // Convert the speed from the vehicle frame to the path frame
-    if(derivative_norm != 0) vd = vehicle_speed_ / derivative_norm;
+    // Compute the trigonometric functions only once for all the derivatives
+    const double w = 2 * M_PI;
+    const double s = sin(gamma * w);
+    const double c = cos(gamma * w);
+
+    TrajectorySample sample;
+
+    // Position in the plane of the circle, rotated and offset by the center
+    sample.pd = rotation_ * Eigen::Vector3d(radius_ * c, radius_ * s, 0.0) + center_;
+
+    // The first derivative is always needed to compute the desired speed in the trajectory frame
+    sample.d_pd = rotation_ * Eigen::Vector3d(-radius_ * w * s, radius_ * w * c, 0.0);
+    if (derivative_order >= 2) sample.d2_pd = rotation_ * Eigen::Vector3d(-radius_ * std::pow(w, 2) * c, -radius_ * std::pow(w, 2) * s, 0.0);
+    if (derivative_order >= 3) sample.d3_pd = rotation_ * Eigen::Vector3d(radius_ * std::pow(w, 3) * s, -radius_ * std::pow(w, 3) * c, 0.0);
 
-    // If the speed exploded because the derivative norm was hill posed, then set it to a very small value as something wrong has happened
-    if(!std::isfinite(vd)) vd = 0.00000001;
+    // Point the vehicle to the center of the circle
+    const Eigen::Vector3d center_to_pd = center_ - sample.pd;
+    sample.yaw = std::atan2(center_to_pd[1], center_to_pd[0]);
+    sample.d_yaw = 0.0;
 
-    return vd;
+    // Desired speeds of the vehicle and in the trajectory frame
+    sample.vehicle_speed = vehicle_speed_;
+    sample.vd = parameter_speed(vehicle_speed_, sample.d_pd);
+    return sample;
 }
 
 void CircleFactory::initialize() {
@@ -187,20 +205,34 @@ void CircleFactory::circle_callback(const pegasus_msgs::srv::AddCircle::Request:
     // Log the parameters of the path section to be added
     RCLCPP_INFO_STREAM(node_->get_logger(), "Adding circle to path. Speed: " << request->speed.parameters[0] << ", center: [" << request->center[0] << "," << request->center[1] << "," << request->center[2] << "], normal: [" << request->normal[0] << "," << request->normal[1] << "," << request->normal[2] << "], radius: " << request->radius << ".");
 
-    // Create a new line
-    Circle::SharedPtr circle = std::make_shared<Circle>(
-        Eigen::Vector3d(request->center.data()), 
-        Eigen::Vector3d(request->normal.data()), 
-        request->radius, 
-        request->speed.parameters[0]);
+    // Create a new circle in the background and add it to the path once it is built
+    this->submit_trajectory_to_manager("circle", [request]() {
+        return std::make_shared<Circle>(
+            Eigen::Vector3d(request->center.data()), 
+            Eigen::Vector3d(request->normal.data()), 
+            request->radius, 
+            request->speed.parameters[0]);
+    });
 
-    // Add the circle to the path
-    this->add_trajectory_to_manager(circle);
-
-    // Set the response to true
+    // Set the response to true (the circle was accepted)
     response->success = true;
 }
 
+StaticTrajectory::SharedPtr CircleFactory::build_segment(const Segment & segment) const {
+
+    // Create the circle from the parameters of the segment
+    const std::vector<double> & p = segment.parameters;
+    return std::make_shared<Circle>(
+        Eigen::Vector3d(p[0], p[1], p[2]), 
+        Eigen::Vector3d(p[3], p[4], p[5]), 
+        p[6], 
+        p[7]);
+}
+
+SegmentStorage::SharedPtr CircleFactory::create_segment_storage() const {
+    return std::make_shared<ContiguousSegments>();
+}
+
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
@@ -0,0 +1,87 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include <typeinfo>
+#include "static_trajectories/contiguous_segments.hpp"
+
+namespace autopilot {
+
+void ContiguousSegments::add(const StaticTrajectory::SharedPtr & trajectory) {
+
+    // Copy the sections of the known types and keep the others (e.g. from other plugins) by pointer
+    const std::type_info & type = typeid(*trajectory);
+    Block & block = writable_block();
+
+    if (type == typeid(Line)) block.emplace_back(static_cast<const Line &>(*trajectory));
+    else if (type == typeid(Arc)) block.emplace_back(static_cast<const Arc &>(*trajectory));
+    else if (type == typeid(Circle)) block.emplace_back(static_cast<const Circle &>(*trajectory));
+    else if (type == typeid(Lemniscate)) block.emplace_back(static_cast<const Lemniscate &>(*trajectory));
+    else if (type == typeid(CSVTrajectory)) block.emplace_back(CSVView{std::static_pointer_cast<const CSVTrajectory>(trajectory)});
+    else block.emplace_back(trajectory);
+    size_++;
+}
+
+ContiguousSegments::Block & ContiguousSegments::writable_block() {
+
+    // Start a new block when the last one is full
+    if (blocks_.empty() || blocks_.back()->size() == BLOCK_SIZE) {
+        blocks_.emplace_back(std::make_shared<Block>());
+        blocks_.back()->reserve(BLOCK_SIZE);
+        return *blocks_.back();
+    }
+
+    // Copy the last block if it is shared with a snapshot (at most BLOCK_SIZE - 1 sections), so the snapshot is not modified
+    if (blocks_.back().use_count() > 1) {
+        std::shared_ptr<Block> block = std::make_shared<Block>();
+        block->reserve(BLOCK_SIZE);
+        block->assign(blocks_.back()->begin(), blocks_.back()->end());
+        blocks_.back() = std::move(block);
+    }
+    return *blocks_.back();
+}
+
+} // namespace autopilot
@@ -45,126 +45,254 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
+#include <cmath>
+#include <array>
+#include <cstring>
 #include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <filesystem>
 #include "static_trajectories/csv.hpp"
+#include "static_trajectories/contiguous_segments.hpp"
 
 namespace autopilot {
 
-CSVTrajectory::CSVTrajectory(const std::string & filename, const Eigen::Vector3d & offset, bool check_z_negative) {
+// Identification of the binary cache files. The version must be increased if the layout of the rows or the header changes
+static constexpr char CACHE_MAGIC[8] = {'P', 'T', 'R', 'A', 'J', '\0', '\0', '\0'};
+static constexpr std::uint32_t CACHE_VERSION = 1;
+static constexpr std::uint32_t CSV_COLUMNS = 15;
 
-    // Parse the csv file
-    parse_csv(filename);
+CSVTrajectory::CSVTrajectory(const std::string & filename, const Eigen::Vector3d & offset, bool check_z_negative, bool use_cache) :
+    offset_(offset), check_z_negative_(check_z_negative) {
 
-    // Add the offset to the position
-    for (auto &pos : pos_) pos += offset;
+    // Map the csv file in memory
+    MappedFile file(filename);
+
+    // Attempt to load the trajectory from the binary cache first, if it was parsed before
+    const std::string cache_filename = filename + ".ptraj";
+    const std::uint64_t csv_hash = use_cache ? hash(file.data(), file.size()) : 0;
+    
+    if (!use_cache || !load_cache(cache_filename, file, csv_hash)) {
+
+        // Parse the csv file
+        parse_csv(file);
+
+        // Save the parsed rows, so that the next time the same file is loaded it does not need to be parsed
+        if (use_cache) save_cache(cache_filename, file, csv_hash);
+    }
 
     // Check if the z coordinate is always negative or zero (because, in the case of the pegasus, the z axis points down - NED standard)
+    // The z-coordinate is inverted on the position, velocity, acceleration and jerk when the rows are read
     if (check_z_negative) {
         RCLCPP_WARN_STREAM(rclcpp::get_logger("rclcpp"), "Checking if the z coordinate is always negative or zero in the trajectory. If not, it will be reversed.");
-        
-        for (int i=0; i < pos_.size(); i++) {
-            if (pos_[i](2) > 0.0) {
-                // Invert the z-coordinate on the position, velocity, acceleration and jerk
-                pos_[i](2) *= -1.0;
-                vel_[i](2) *= -1.0;
-                acc_[i](2) *= -1.0;
-                jerk_[i](2) *= -1.0;
-            }
-        }
     }
 
     // Set the maximum gamma to the last time in the trajectory
-    max_gamma_ = time_.back();
+    max_gamma_ = rows_.back().time;
+
+    // Get the rate at which the trajectory is sampled
+    dt_ = rows_[1].time - rows_[0].time;
 }
 
-void CSVTrajectory::parse_csv(const std::string & filename) {
+void CSVTrajectory::parse_csv(const MappedFile & file) {
 
     // time, x, y, z, vx, vy, vz, ax, ay, az, jx, jy, jz, yaw (rad), yaw_rate (rad/s)
     // time,   pos  ,    vel    ,    acc    ,    jerk   , yaw (rad), yaw_rate (rad/s)
+    const char * it = file.data();
+    const char * end = file.data() + file.size();
 
-    // Create an input filestream
-    std::ifstream in(filename);
-
-    // Make sure the file is open
-    if(!in.is_open()) throw std::runtime_error("Could not open file");
+    // Reserve one row per line of the file, to avoid reallocations while parsing
+    parsed_rows_.clear();
+    parsed_rows_.reserve(std::count(it, end, '\n') + 1);
 
     // Iterate over the lines of the csv file
-    std::string line;
-
-    while(std::getline(in, line)) {
-
-        // Create a stringstream of the current line
-        std::stringstream ss(line);
-
-        // Create a vector of all the columns in the line
-        std::vector<std::string> row;
-        std::string cell;
+    std::size_t line = 0;
+    while (it < end) {
+
+        // Get the limits of the current line
+        const char * line_end = static_cast<const char *>(std::memchr(it, '\n', end - it));
+        if (line_end == nullptr) line_end = end;
+        line++;
+
+        // Skip empty lines (e.g. the last line of the file)
+        const char * last = line_end;
+        while (last > it && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t')) last--;
+        if (last == it) {
+            it = line_end + 1;
+            continue;
+        }
 
-        while(std::getline(ss, cell, ',')) {
-            row.push_back(cell);
+        // Convert each column of the line directly to a double, without any intermediate string
+        std::array<double, CSV_COLUMNS> values;
+        std::size_t column = 0;
+        while (true) {
+
+            // Skip the leading white spaces and plus signs (not accepted by from_chars)
+            while (it < last && (*it == ' ' || *it == '\t')) it++;
+            if (it < last && *it == '+') it++;
+
+            // Check the size of the row
+            if (column == CSV_COLUMNS) throw std::runtime_error("CSV file has wrong number of columns (line " + std::to_string(line) + ")");
+
+            // Convert the column
+            auto [ptr, error] = std::from_chars(it, last, values[column]);
+            if (error != std::errc()) throw std::runtime_error("CSV file has an invalid number (line " + std::to_string(line) + ", column " + std::to_string(column + 1) + ")");
+            column++;
+
+            // Skip the trailing white spaces and move to the next column (or to the end of the line)
+            it = ptr;
+            while (it < last && (*it == ' ' || *it == '\t')) it++;
+            if (it == last) break;
+            if (*it != ',') throw std::runtime_error("CSV file has an invalid number (line " + std::to_string(line) + ", column " + std::to_string(column) + ")");
+            it++;
         }
 
         // Check the size of the row
-        if (row.size() != 15) throw std::runtime_error("CSV file has wrong number of columns");
-
-        // Convert the row to the correct format
-        double time = std::stod(row[0]);
-        Eigen::Vector3d pos(std::stod(row[1]), std::stod(row[2]), std::stod(row[3]));
-        Eigen::Vector3d vel(std::stod(row[4]), std::stod(row[5]), std::stod(row[6]));
-        Eigen::Vector3d acc(std::stod(row[7]), std::stod(row[8]), std::stod(row[9]));
-        Eigen::Vector3d jerk(std::stod(row[10]), std::stod(row[11]), std::stod(row[12]));
-        double yaw = std::stod(row[13]);
-        double yaw_rate = std::stod(row[14]);
-
-        // Append the data to the correct vectors
-        time_.push_back(time);
-        pos_.push_back(pos);
-        vel_.push_back(vel);
-        acc_.push_back(acc);
-        jerk_.push_back(jerk);
-        yaw_.push_back(yaw);
-        yaw_rate_.push_back(yaw_rate);
-    }
+        if (column != CSV_COLUMNS) throw std::runtime_error("CSV file has wrong number of columns (line " + std::to_string(line) + ")");
+
+        // Append the row (the columns have the same layout as the row)
+        Row & row = parsed_rows_.emplace_back();
+        std::memcpy(&row, values.data(), sizeof(Row));
 
-    // Check if all the vectors have the same size
-    if (time_.size() != pos_.size() || time_.size() != vel_.size() || time_.size() != acc_.size() || time_.size() != jerk_.size() || time_.size() != yaw_.size() || time_.size() != yaw_rate_.size()) {
-        throw std::runtime_error("CSV file has vectors with different sizes. CSV file containing the trajectory is not valid.");
+        it = line_end + 1;
     }
 
+    // A trajectory needs at least two rows to compute the rate at which it is sampled
+    if (parsed_rows_.size() < 2) throw std::runtime_error("CSV file has less than two rows. CSV file containing the trajectory is not valid.");
+
     // Check if the time in the csv file is monotonically increasing
-    // Attempt to reverse the vectors if it is not
-    if(!std::is_sorted(time_.begin(), time_.end())) {
-        std::reverse(time_.begin(), time_.end());
-        std::reverse(pos_.begin(), pos_.end());
-        std::reverse(vel_.begin(), vel_.end());
-        std::reverse(acc_.begin(), acc_.end());
-        std::reverse(jerk_.begin(), jerk_.end());
-        std::reverse(yaw_.begin(), yaw_.end());
-        std::reverse(yaw_rate_.begin(), yaw_rate_.end());
-    } 
+    // Attempt to reverse the rows if it is not
+    auto by_time = [](const Row & a, const Row & b) { return a.time < b.time; };
+    if (!std::is_sorted(parsed_rows_.begin(), parsed_rows_.end(), by_time)) {
+        std::reverse(parsed_rows_.begin(), parsed_rows_.end());
+    }
 
     // Check if the time in the csv file is monotonically increasing, if it is still not, throw an error
-    if(!std::is_sorted(time_.begin(), time_.end())) {
+    if (!std::is_sorted(parsed_rows_.begin(), parsed_rows_.end(), by_time)) {
         throw std::runtime_error("CSV file has non-monotonically increasing time. CSV file containing the trajectory is not valid.");
     }
 
     // Check if the time starts at 0.0
-    if (time_[0] != 0.0) throw std::runtime_error("CSV file does not start at time 0.0. CSV file containing the trajectory is not valid.");
+    if (parsed_rows_[0].time != 0.0) throw std::runtime_error("CSV file does not start at time 0.0. CSV file containing the trajectory is not valid.");
 
-    // Get the rate at which the trajectory is sampled
-    dt_ = time_[1] - time_[0];
+    rows_ = parsed_rows_;
+}
+
+bool CSVTrajectory::load_cache(const std::string & cache_filename, const MappedFile & csv_file, std::uint64_t csv_hash) {
+
+    // Check if the cache exists
+    std::error_code error;
+    if (!std::filesystem::exists(cache_filename, error)) return false;
+
+    try {
+
+        // Map the cache in memory
+        MappedFile cache(cache_filename);
+        if (cache.size() < sizeof(CacheHeader)) return false;
+
+        // Check that the cache was generated from the same csv file (and with the same format)
+        CacheHeader header;
+        std::memcpy(&header, cache.data(), sizeof(CacheHeader));
+
+        if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION || header.columns != CSV_COLUMNS ||
+            header.source_size != csv_file.size() || header.source_mtime != csv_file.mtime() || header.source_hash != csv_hash ||
+            header.rows < 2 || cache.size() != sizeof(CacheHeader) + header.rows * sizeof(Row)) {
+            RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"), "Binary cache " << cache_filename << " is outdated. Parsing the csv file again.");
+            return false;
+        }
+
+        // Use the rows directly from the memory mapped cache (they were validated when the cache was saved)
+        cache_ = std::move(cache);
+        rows_ = std::span<const Row>(reinterpret_cast<const Row *>(cache_.data() + sizeof(CacheHeader)), header.rows);
+
+    } catch (const std::exception & ex) {
+        RCLCPP_WARN_STREAM(rclcpp::get_logger("rclcpp"), "Could not load the binary cache " << cache_filename << ": " << ex.what());
+        return false;
+    }
+
+    RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"), "Loaded " << rows_.size() << " rows from the binary cache " << cache_filename);
+    return true;
+}
+
+void CSVTrajectory::save_cache(const std::string & cache_filename, const MappedFile & csv_file, std::uint64_t csv_hash) const {
+
+    // Fill the header with the information of the csv file the rows were parsed from
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.columns = CSV_COLUMNS;
+    header.rows = rows_.size();
+    header.source_mtime = csv_file.mtime();
+    header.source_size = csv_file.size();
+    header.source_hash = csv_hash;
+
+    // Write to a temporary file first, so that a partially written cache is never loaded
+    const std::string tmp_filename = cache_filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(CacheHeader));
+    out.write(reinterpret_cast<const char *>(rows_.data()), rows_.size_bytes());
+    out.close();
+
+    // Replace the previous cache. Failing to save the cache is not an error, as the trajectory was already parsed
+    std::error_code error;
+    if (out.fail()) {
+        RCLCPP_WARN_STREAM(rclcpp::get_logger("rclcpp"), "Could not write the binary cache " << tmp_filename);
+        std::filesystem::remove(tmp_filename, error);
+        return;
+    }
+
+    std::filesystem::rename(tmp_filename, cache_filename, error);
+    if (error) {
+        RCLCPP_WARN_STREAM(rclcpp::get_logger("rclcpp"), "Could not write the binary cache " << cache_filename << ": " << error.message());
+        std::filesystem::remove(tmp_filename, error);
+    }
+}
+
+std::uint64_t CSVTrajectory::hash(const char * data, std::size_t size) {
+
+    // FNV-1a hash, applied to 8 bytes at a time (the cache is only read on the machine that wrote it)
+    std::uint64_t hash = 14695981039346656037ull;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(std::uint64_t));
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+
+    // Hash the remaining bytes one at a time
+    for (; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
 }
 
 int CSVTrajectory::get_closest_index(const double gamma) const {
 
     // Check if the gamma is within the bounds of the trajectory
     if (gamma < 0.0) return 0;
-    if (gamma > time_.back()) return time_.size()-1;
+    if (gamma > rows_.back().time) return rows_.size()-1;
 
     // Devide the gamma by the time step to get the index
     return std::round(gamma / dt_);
 }
 
+Eigen::Vector3d CSVTrajectory::position(const int idx) const {
+
+    // Add the offset to the position and invert the z coordinate if needed
+    Eigen::Vector3d pos = Eigen::Map<const Eigen::Vector3d>(rows_[idx].pos) + offset_;
+    if (invert_z(idx)) pos(2) *= -1.0;
+    return pos;
+}
+
+Eigen::Vector3d CSVTrajectory::derivative(const int idx, const double (&value)[3]) const {
+
+    // Invert the z coordinate if it was inverted on the position
+    Eigen::Vector3d derivative = Eigen::Map<const Eigen::Vector3d>(value);
+    if (invert_z(idx)) derivative(2) *= -1.0;
+    return derivative;
+}
 
 Eigen::Vector3d CSVTrajectory::pd(const double gamma) const {
 
@@ -172,7 +300,7 @@ Eigen::Vector3d CSVTrajectory::pd(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the position
-    return pos_[idx];
+    return position(idx);
 }
 
 Eigen::Vector3d CSVTrajectory::d_pd(const double gamma) const {
@@ -181,7 +309,7 @@ Eigen::Vector3d CSVTrajectory::d_pd(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Re turn the velocity
-    return vel_[idx];
+    return derivative(idx, rows_[idx].vel);
 }
 
 Eigen::Vector3d CSVTrajectory::d2_pd(const double gamma) const {
@@ -190,7 +318,7 @@ Eigen::Vector3d CSVTrajectory::d2_pd(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the acceleration
-    return acc_[idx];
+    return derivative(idx, rows_[idx].acc);
 }
 
 Eigen::Vector3d CSVTrajectory::d3_pd(const double gamma) const {
@@ -199,7 +327,7 @@ Eigen::Vector3d CSVTrajectory::d3_pd(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the jerk
-    return jerk_[idx];
+    return derivative(idx, rows_[idx].jerk);
 }
 
 
@@ -209,7 +337,7 @@ double CSVTrajectory::yaw(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the yaw
-    return yaw_[idx];
+    return rows_[idx].yaw;
 }
 
 double CSVTrajectory::d_yaw(const double gamma) const {
@@ -218,7 +346,7 @@ double CSVTrajectory::d_yaw(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the yaw rate
-    return yaw_rate_[idx];
+    return rows_[idx].yaw_rate;
 }
 
 double CSVTrajectory::vehicle_speed(const double gamma) const {
@@ -227,7 +355,7 @@ double CSVTrajectory::vehicle_speed(const double gamma) const {
     int idx = get_closest_index(gamma);
 
     // Return the vehicle speed
-    return vel_[idx].norm();
+    return Eigen::Map<const Eigen::Vector3d>(rows_[idx].vel).norm();
 }
 
 double CSVTrajectory::vd(const double gamma) const {
@@ -238,11 +366,33 @@ double CSVTrajectory::vd(const double gamma) const {
     return 1.0;
 }
 
+TrajectorySample CSVTrajectory::sample(const double gamma, const int derivative_order) const {
+
+    // Get the index of the closest time to gamma (only once for all the quantities)
+    int idx = get_closest_index(gamma);
+    const Row & row = rows_[idx];
+
+    TrajectorySample sample;
+    sample.pd = position(idx);
+    if (derivative_order >= 1) sample.d_pd = derivative(idx, row.vel);
+    if (derivative_order >= 2) sample.d2_pd = derivative(idx, row.acc);
+    if (derivative_order >= 3) sample.d3_pd = derivative(idx, row.jerk);
+    sample.yaw = row.yaw;
+    sample.d_yaw = row.yaw_rate;
+    sample.vehicle_speed = Eigen::Map<const Eigen::Vector3d>(row.vel).norm();
+    sample.vd = 1.0;
+    return sample;
+}
+
 void CSVFactory::initialize() {
 
     // Load the service topic from the parameter server
     node_->declare_parameter<std::string>("autopilot.StaticTrajectoryManager.CSVFactory.service", "path/add_csv");
 
+    // Load whether to keep a binary cache of the parsed csv files
+    node_->declare_parameter<bool>("autopilot.StaticTrajectoryManager.CSVFactory.cache", false);
+    use_cache_ = node_->get_parameter("autopilot.StaticTrajectoryManager.CSVFactory.cache").as_bool();
+
     // Advertise the service to add a line to the path
     add_csv_service_ = node_->create_service<pegasus_msgs::srv::AddCsv>(node_->get_parameter("autopilot.StaticTrajectoryManager.CSVFactory.service").as_string(), std::bind(&CSVFactory::csv_callback, this, std::placeholders::_1, std::placeholders::_2));
 }
@@ -252,16 +402,28 @@ void CSVFactory::csv_callback(const pegasus_msgs::srv::AddCsv::Request::SharedPt
     // Log the parameters of the path section to be added
     RCLCPP_INFO_STREAM(node_->get_logger(), "Adding CSV file: " << request->csv_path << " to trajectory. Offset: " << request->offset[0] << "," << request->offset[1] << "," << request->offset[2] << ".");
 
-    // Create a new line
-    CSVTrajectory::SharedPtr csv_traj = std::make_shared<CSVTrajectory>(request->csv_path, Eigen::Vector3d(request->offset[0], request->offset[1], request->offset[2]), request->check_z_negative);
-
-    // Add the circle to the path
-    this->add_trajectory_to_manager(csv_traj);
+    // Parse the csv file in the background and add it to the path once it is loaded 
+    // (if the file does not exist or is not valid, the job is reported as failed)
+    const bool use_cache = use_cache_;
+    this->submit_trajectory_to_manager("csv " + request->csv_path, [request, use_cache]() {
+        return std::make_shared<CSVTrajectory>(request->csv_path, Eigen::Vector3d(request->offset[0], request->offset[1], request->offset[2]), request->check_z_negative, use_cache);
+    });
 
-    // Set the response to true
+    // Set the response to true (the file was accepted)
     response->success = true;
 }
 
+StaticTrajectory::SharedPtr CSVFactory::build_segment(const Segment & segment) const {
+
+    // Create the csv trajectory from the parameters of the segment
+    const std::vector<double> & p = segment.parameters;
+    return std::make_shared<CSVTrajectory>(segment.file, Eigen::Vector3d(p[0], p[1], p[2]), p[3] != 0.0, use_cache_);
+}
+
+SegmentStorage::SharedPtr CSVFactory::create_segment_storage() const {
+    return std::make_shared<ContiguousSegments>();
+}
+
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
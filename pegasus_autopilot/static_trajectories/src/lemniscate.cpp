@@ -46,6 +46,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
 #include "static_trajectories/lemniscate.hpp"
+#include "static_trajectories/contiguous_segments.hpp"
 
 namespace autopilot {
 
@@ -126,19 +127,42 @@ double Lemniscate::vehicle_speed(const double gamma) const {
 
 double Lemniscate::vd(const double gamma) const {
 
-    // Define a zero velocity variable
-    double vd = 0.0;
+    // Convert the speed from the vehicle frame to the path frame
+    return parameter_speed(vehicle_speed_, d_pd(gamma));
+}
 
-    // Compute the derivative norm
-    double derivative_norm = d_pd(gamma).norm();
+TrajectorySample Lemniscate::sample(const double gamma, const int derivative_order) const {
 
-    // Convert the speed from the vehicle frame to the path frame
-    if(derivative_norm != 0) vd = vehicle_speed_ / derivative_norm;
+    // Compute the trigonometric functions only once for all the derivatives
+    const double s = sin(2 * M_PI * gamma);
+    const double c = cos(2 * M_PI * gamma);
+    const double s2 = std::pow(s, 2);
+    const double c2 = std::pow(c, 2);
+    const double s4 = std::pow(s, 4);
+    const double denominator = s2 + 1;
+
+    TrajectorySample sample;
+
+    // Position in the plane of the lemniscate, rotated and offset by the center
+    sample.pd = rotation_ * Eigen::Vector3d(radius_ * c / denominator, radius_ * s * c / denominator, 0.0) + center_;
+
+    // The first derivative is always needed to compute the desired speed in the trajectory frame
+    sample.d_pd = rotation_ * Eigen::Vector3d(
+        -(2 * M_PI * radius_ * s * (s2 + (2 * std::pow(2 * M_PI * gamma, 2)) + 1)) / std::pow(denominator, 2),
+        -(2 * M_PI * radius_ * (s4 + (c2 + 1) * s2 - c2)) / std::pow(denominator, 2),
+        0.0);
 
-    // If the speed exploded because the derivative norm was hill posed, then set it to a very small value as something wrong has happened
-    if(!std::isfinite(vd)) vd = 0.00000001;
+    if (derivative_order >= 2) {
+        sample.d2_pd = rotation_ * Eigen::Vector3d(
+            (4 * std::pow(M_PI, 2) * radius_ * c * (5 * s4 + (6 * c2 + 4) * s2 - 2 * c2 - 1)) / std::pow(denominator, 3),
+            (8 * std::pow(M_PI, 2) * radius_ * c * s * (s4 + (c2 - 1) * s2 - 3 * c2 - 2)) / std::pow(denominator, 3),
+            0.0);
+    }
 
-    return vd;
+    // Desired speeds of the vehicle and in the trajectory frame
+    sample.vehicle_speed = vehicle_speed_;
+    sample.vd = parameter_speed(vehicle_speed_, sample.d_pd);
+    return sample;
 }
 
 void LemniscateFactory::initialize() {
@@ -155,18 +179,32 @@ void LemniscateFactory::lemniscate_callback(const pegasus_msgs::srv::AddLemnisca
     // Log the parameters of the path section to be added
     RCLCPP_INFO_STREAM(node_->get_logger(), "Adding lemniscate to path. Speed: " << request->speed.parameters[0] << ", center: [" << request->center[0] << "," << request->center[1] << "," << request->center[2] << "], normal: [" << request->normal[0] << "," << request->normal[1] << "," << request->normal[2] << "], radius: " << request->radius << ".");
     
-    // Create a new lemniscate
-    Lemniscate::SharedPtr lemniscate = std::make_shared<Lemniscate>(
-        Eigen::Vector3d(request->center.data()), 
-        Eigen::Vector3d(request->normal.data()), 
-        request->radius,
-        request->speed.parameters[0]);
+    // Create a new lemniscate in the background and add it to the path once it is built
+    this->submit_trajectory_to_manager("lemniscate", [request]() {
+        return std::make_shared<Lemniscate>(
+            Eigen::Vector3d(request->center.data()), 
+            Eigen::Vector3d(request->normal.data()), 
+            request->radius,
+            request->speed.parameters[0]);
+    });
+
+    // Update the response (the lemniscate was accepted)
+    response->success = true;
+}
 
-    // Add the new lemniscate to the path
-    this->add_trajectory_to_manager(lemniscate);
+StaticTrajectory::SharedPtr LemniscateFactory::build_segment(const Segment & segment) const {
 
-    // Update the response
-    response->success = true;
+    // Create the lemniscate from the parameters of the segment
+    const std::vector<double> & p = segment.parameters;
+    return std::make_shared<Lemniscate>(
+        Eigen::Vector3d(p[0], p[1], p[2]), 
+        Eigen::Vector3d(p[3], p[4], p[5]), 
+        p[6],
+        p[7]);
+}
+
+SegmentStorage::SharedPtr LemniscateFactory::create_segment_storage() const {
+    return std::make_shared<ContiguousSegments>();
 }
 
 } // namespace autopilot
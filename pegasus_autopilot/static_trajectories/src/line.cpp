@@ -46,6 +46,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
 #include "static_trajectories/line.hpp"
+#include "static_trajectories/contiguous_segments.hpp"
 
 namespace autopilot {
 
@@ -68,19 +69,18 @@ double Line::vehicle_speed(const double gamma) const {
 
 double Line::vd(const double gamma) const {
     
-    // Define a zero velocity variable
-    double vd = 0.0;
-
-    // Compute the derivative norm
-    double derivative_norm = d_pd(gamma).norm();
-
     // Convert the speed from the vehicle frame to the path frame
-    if(derivative_norm != 0) vd = vehicle_speed_ / derivative_norm;
+    return parameter_speed(vehicle_speed_, d_pd(gamma));
+}
 
-    // If the speed exploded because the derivative norm was hill posed, then set it to a very small value as something wrong has happened
-    if(!std::isfinite(vd)) vd = 0.00000001;
+TrajectorySample Line::sample(const double gamma, const int derivative_order) const {
 
-    return vd;
+    TrajectorySample sample;
+    sample.pd = start_ + gamma * slope_;
+    sample.d_pd = slope_;
+    sample.vehicle_speed = vehicle_speed_;
+    sample.vd = parameter_speed(vehicle_speed_, slope_);
+    return sample;
 }
 
 void LineFactory::initialize() {
@@ -97,19 +97,32 @@ void LineFactory::line_callback(const pegasus_msgs::srv::AddLine::Request::Share
     // Log the parameters of the path section to be added
     RCLCPP_INFO_STREAM(this->node_->get_logger(), "Adding line to the trajectory. Speed: " << request->speed.parameters[0] << ", start: [" << request->start[0] << "," << request->start[1] << "," << request->start[2] << "], end: [" << request->end[0] << "," << request->end[1] << "," << request->end[2] << "].");
 
-    // Create a new line
-    Line::SharedPtr line = std::make_shared<Line>(Eigen::Vector3d(
-        request->start.data()), 
-        Eigen::Vector3d(request->end.data()), 
-        request->speed.parameters[0]);
+    // Create a new line in the background and add it to the path once it is built
+    this->submit_trajectory_to_manager("line", [request]() {
+        return std::make_shared<Line>(
+            Eigen::Vector3d(request->start.data()), 
+            Eigen::Vector3d(request->end.data()), 
+            request->speed.parameters[0]);
+    });
 
-    // Add the line to the path
-    this->add_trajectory_to_manager(line);
-
-    // Set the response to true
+    // Set the response to true (the line was accepted)
     response->success = true;
 }
 
+StaticTrajectory::SharedPtr LineFactory::build_segment(const Segment & segment) const {
+
+    // Create the line from the parameters of the segment
+    const std::vector<double> & p = segment.parameters;
+    return std::make_shared<Line>(
+        Eigen::Vector3d(p[0], p[1], p[2]), 
+        Eigen::Vector3d(p[3], p[4], p[5]), 
+        p[6]);
+}
+
+SegmentStorage::SharedPtr LineFactory::create_segment_storage() const {
+    return std::make_shared<ContiguousSegments>();
+}
+
 } // namespace autopilot
 
 #include <pluginlib/class_list_macros.hpp>
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * 
+ *   Author: Marcelo Jacinto <marcelo.jacinto@tecnico.ulisboa.pt>
+ *   Copyright (c) 2024, Marcelo Jacinto. All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions 
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright 
+ * notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright 
+ * notice, this list of conditions and the following disclaimer in 
+ * the documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this 
+ * software must display the following acknowledgement: This product 
+ * includes software developed by Project Pegasus.
+ * 4. Neither the name of the copyright holder nor the names of its 
+ * contributors may be used to endorse or promote products derived 
+ * from this software without specific prior written permission.
+ *
+ * Additional Restrictions:
+ * 4. The Software shall be used for non-commercial purposes only. 
+ * This includes, but is not limited to, academic research, personal 
+ * projects, and non-profit organizations. Any commercial use of the 
+ * Software is strictly prohibited without prior written permission 
+ * from the copyright holders.
+ * 5. The Software shall not be used, directly or indirectly, for 
+ * military purposes, including but not limited to the development 
+ * of weapons, military simulations, or any other military applications. 
+ * Any military use of the Software is strictly prohibited without 
+ * prior written permission from the copyright holders.
+ * 6. The Software may be utilized for academic research purposes, 
+ * with the condition that proper acknowledgment is given in all 
+ * corresponding publications.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <autopilot/trajectory_sample.hpp>
+#include "static_trajectory.hpp"
+
+namespace autopilot {
+
+/**
+ * @brief Storage of the trajectory sections read by the control loop, as an alternative to the vector of pointers of the
+ * trajectory manager. The storage is provided by the libraries of the static trajectories (which know the concrete types
+ * of the sections), such that the sections can be stored by value and sampled without a virtual call for each of them.
+ * The storage of the writers is never published to the control loop: sections are added to it and an immutable snapshot is published
+ */
+class SegmentStorage {
+
+public:
+
+    using SharedPtr = std::shared_ptr<SegmentStorage>;
+    using ConstSharedPtr = std::shared_ptr<const SegmentStorage>;
+
+    virtual ~SegmentStorage() = default;
+
+    /**
+     * @brief Create an empty storage of the same type
+     */
+    virtual SegmentStorage::SharedPtr create() const = 0;
+
+    /**
+     * @brief Create an immutable snapshot of the storage, with the same sections. The snapshot is not changed by the sections
+     * added to the storage afterwards, but may share the sections already added with it (so it does not copy all of them)
+     */
+    virtual SegmentStorage::ConstSharedPtr snapshot() const = 0;
+
+    /**
+     * @brief Add a section at the end of the storage. Types that are not known by the storage
+     * (e.g. loaded from other plugins) must still be added and sampled through their virtual methods
+     * @param trajectory The trajectory section
+     */
+    virtual void add(const StaticTrajectory::SharedPtr & trajectory) = 0;
+
+    /**
+     * @brief The number of sections in the storage
+     */
+    virtual std::size_t size() const = 0;
+
+    /**
+     * @brief Sample one of the sections (same as StaticTrajectory::sample)
+     * @param index The index of the section (in the order they were added)
+     * @param gamma The parameter of the section, normalized to its own range
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    virtual TrajectorySample sample(const std::size_t index, const double gamma, const int derivative_order) const noexcept = 0;
+};
+
+} // namespace autopilot
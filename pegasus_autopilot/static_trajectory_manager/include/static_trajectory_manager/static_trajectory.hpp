@@ -47,8 +47,10 @@
  ****************************************************************************/
 #pragma once
 
+#include <cmath>
 #include <memory>
 #include <Eigen/Core>
+#include <autopilot/trajectory_sample.hpp>
 
 namespace autopilot {
 
@@ -151,6 +153,29 @@ public:
      */
     virtual double d2_vd(const double gamma) const { return 0.0; };
 
+    /**
+     * @brief This function returns every quantity of the trajectory at a given value of gamma at once. Trajectories
+     * should override it to share the intermediate computations (e.g. sines and cosines) between the derivatives
+     * @param gamma The parameter that paramaterizes the trajectory
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    virtual TrajectorySample sample(const double gamma, const int derivative_order) const {
+        TrajectorySample sample;
+        sample.pd = pd(gamma);
+        if (derivative_order >= 1) sample.d_pd = d_pd(gamma);
+        if (derivative_order >= 2) sample.d2_pd = d2_pd(gamma);
+        if (derivative_order >= 3) sample.d3_pd = d3_pd(gamma);
+        if (derivative_order >= 4) sample.d4_pd = d4_pd(gamma);
+        sample.yaw = yaw(gamma);
+        sample.d_yaw = d_yaw(gamma);
+        sample.vehicle_speed = vehicle_speed(gamma);
+        sample.vd = vd(gamma);
+        sample.d_vd = d_vd(gamma);
+        sample.d2_vd = d2_vd(gamma);
+        return sample;
+    }
+
     /**
      * @brief Getter for the minimum value of the variable that parameterizes the trajectory
      */
@@ -169,6 +194,29 @@ protected:
     StaticTrajectory(double min_gamma=0.0, double max_gamma=1.0) : 
         min_gamma_(min_gamma), max_gamma_(max_gamma) {}
 
+    /**
+     * @brief Convert the desired speed of the vehicle (in m/s) to the desired speed in the trajectory frame
+     * @param vehicle_speed The desired speed of the vehicle in m/s
+     * @param d_pd The first derivative of the trajectory with respect to gamma
+     * @return The desired speed in the trajectory frame (double)
+     */
+    static double parameter_speed(const double vehicle_speed, const Eigen::Vector3d & d_pd) {
+
+        // Define a zero velocity variable
+        double vd = 0.0;
+
+        // Compute the derivative norm
+        double derivative_norm = d_pd.norm();
+
+        // Convert the speed from the vehicle frame to the path frame
+        if(derivative_norm != 0) vd = vehicle_speed / derivative_norm;
+
+        // If the speed exploded because the derivative norm was hill posed, then set it to a very small value as something wrong has happened
+        if(!std::isfinite(vd)) vd = 0.00000001;
+
+        return vd;
+    }
+
     /**
      * @brief The minimum and maximum value of the variable that parameterizes the trajectory
      */
@@ -47,12 +47,17 @@
  ****************************************************************************/
 #pragma once
 
+#include <string>
+#include <vector>
 #include <memory>
+#include <cstdint>
+#include <stdexcept>
 #include <functional>
 
 #include "rclcpp/rclcpp.hpp"
 
 #include "static_trajectory.hpp"
+#include "segment_storage.hpp"
 
 namespace autopilot {
     
@@ -65,15 +70,53 @@ public:
     using UniquePtr = std::unique_ptr<StaticTrajectoryFactory>;
     using WeakPtr = std::weak_ptr<StaticTrajectoryFactory>;
 
+    // Types of the segments that can be added in a batch (the same values as the constants of the AddTrajectorySegments service)
+    enum SegmentType : std::uint8_t { LINE = 0, ARC = 1, CIRCLE = 2, LEMNISCATE = 3, CSV = 4, NONE = 255 };
+
+    // Parameters of one segment of a batch
+    struct Segment {
+        std::vector<double> parameters;
+        std::string file;
+    };
+
     // Configuration for the trajectory factory
     struct Config {
         rclcpp::Node::SharedPtr node;                                                 // ROS 2 node ptr (in case the mode needs to create publishers, subscribers, etc.)
         std::function<void(StaticTrajectory::SharedPtr)> add_trajectory_to_manager;   // Method that when called with a trajectory adds it to the trajectory server
+        std::function<std::uint64_t(const std::string &, std::function<StaticTrajectory::SharedPtr()>)> submit_trajectory_to_manager; // Method that builds a trajectory in the background and adds it to the trajectory server
     };
 
     // Method that must be implemented by the derived classes
     virtual void initialize() = 0;
 
+    /**
+     * @brief The type of the segments built by this factory when the trajectory is added in a batch. 
+     * Factories that can only add trajectories through their own service return NONE
+     */
+    virtual SegmentType segment_type() const { return NONE; }
+
+    /**
+     * @brief The number of parameters of each segment and whether it also takes a file
+     */
+    virtual std::size_t segment_size() const { return 0; }
+    virtual bool segment_has_file() const { return false; }
+
+    /**
+     * @brief Build the trajectory of one segment of a batch. Called from the worker threads of the trajectory
+     * manager, so it must not modify the factory
+     * @param segment The parameters of the segment (with segment_size() parameters)
+     * @return The trajectory (throws if the segment is not valid)
+     */
+    virtual StaticTrajectory::SharedPtr build_segment(const Segment & segment) const { 
+        throw std::runtime_error("The trajectory factory does not support batches"); 
+    }
+
+    /**
+     * @brief Create an empty storage for the trajectory sections that keeps the types of this library by value, used by the 
+     * trajectory manager instead of the vector of pointers when its storage is "contiguous". Factories that do not provide one return nullptr
+     */
+    virtual SegmentStorage::SharedPtr create_segment_storage() const { return nullptr; }
+
     // Method called internally by the trajectory server to initialize the factory
     void initialize_factory(const StaticTrajectoryFactory::Config & config) {
 
@@ -82,6 +125,7 @@ public:
 
         // Save the method to add a trajectory to the trajectory server
         add_trajectory_to_manager = config.add_trajectory_to_manager;
+        submit_trajectory_to_manager = config.submit_trajectory_to_manager;
 
         // Perform class specific initialization        
         initialize();
@@ -94,6 +138,11 @@ protected:
 
     // Method that when called with a trajectory adds it to the trajectory server
     std::function<void(StaticTrajectory::SharedPtr)> add_trajectory_to_manager{nullptr};
+
+    // Method that when called with a description and a function that builds a trajectory, builds it in a worker thread 
+    // (outside of the executor of the control loop) and adds it to the trajectory server. Returns the id of the job, 
+    // whose completion is reported on the jobs topic. The trajectories are added in the order they are submitted
+    std::function<std::uint64_t(const std::string &, std::function<StaticTrajectory::SharedPtr()>)> submit_trajectory_to_manager{nullptr};
 };
 
 } // namespace autopilot
\ No newline at end of file
@@ -48,7 +48,9 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <memory>
+#include <cstdint>
 #include <Eigen/Core>
 
 // ROS imports
@@ -57,12 +59,21 @@
 // Custom service to reset the trajectory
 #include "pegasus_msgs/srv/reset_path.hpp"
 
+// Status of the jobs that build the trajectories in the background
+#include "diagnostic_msgs/msg/diagnostic_status.hpp"
+
+// Service to add a batch of segments (generated by this package)
+#include "static_trajectory_manager/srv/add_trajectory_segments.hpp"
+
 // Base class import for defining a trajectory manager
 #include <autopilot/trajectory_manager.hpp>
+#include <autopilot/rcu_cell.hpp>
 
 // Definition of the static trajectories interface
 #include "static_trajectory.hpp"
 #include "static_trajectory_factory.hpp"
+#include "segment_storage.hpp"
+#include "worker_pool.hpp"
 
 namespace autopilot {
 
@@ -77,15 +88,33 @@ public:
     using UniquePtr = std::unique_ptr<StaticTrajectoryManager>;
     using WeakPtr = std::weak_ptr<StaticTrajectoryManager>;
 
+    /**
+     * @brief The trajectory sections and their accumulated parametric lengths. The table used by the control loop
+     * is never modified: a new table is built and published whenever a section is added or the trajectory is reset.
+     * With the "contiguous" storage, the sections are also kept by value in segments (a snapshot of the storage of the writers),
+     * which is used by sample()
+     */
+    struct Table {
+        std::vector<StaticTrajectory::SharedPtr> trajectories;
+        std::vector<double> max_values;
+        SegmentStorage::ConstSharedPtr segments{nullptr};
+    };
+
     virtual void initialize() override;
 
+    /**
+     * @brief The static trajectories implement the path, the desired speed along it and the speed of the vehicle
+     * @return The bitmask with all the TrajectoryCapability flags
+     */
+    Capabilities capabilities() const override { return TRAJECTORY_PATH | TRAJECTORY_PARAMETER_SPEED | TRAJECTORY_VEHICLE_SPEED; }
+
     /**
      * @brief This function returns the desired position of the vehicle at a given time
      * provided the parameter gamma which paramaterizes the trajectory
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired position of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d pd(const double gamma) const override;
+    virtual Eigen::Vector3d pd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired velocity of the vehicle at a given time
@@ -93,7 +122,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired velocity of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d_pd(const double gamma) const override;
+    virtual Eigen::Vector3d d_pd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired acceleration of the vehicle at a given time
@@ -101,7 +130,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired acceleration of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d2_pd(const double gamma) const override;
+    virtual Eigen::Vector3d d2_pd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired jerk of the vehicle at a given time
@@ -109,7 +138,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired jerk of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d3_pd(const double gamma) const override;
+    virtual Eigen::Vector3d d3_pd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired snap of the vehicle at a given time
@@ -117,7 +146,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired snap of the vehicle at a given time (Eigen::Vector3d)
      */
-    virtual Eigen::Vector3d d4_pd(const double gamma) const override;
+    virtual Eigen::Vector3d d4_pd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired yaw angle (in radians) of the vehicle at a given time
@@ -125,7 +154,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired yaw angle of the vehicle at a given time (radians)
      */
-    virtual double yaw(const double gamma) const override;
+    virtual double yaw(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired yaw rate (in radians/s) of the vehicle at a given time
@@ -133,14 +162,14 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired yaw rate of the vehicle at a given time (radians/s)
      */
-    virtual double d_yaw(const double gamma) const override;
+    virtual double d_yaw(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the vehicle speed in m/s at any given position in the trajectory
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired speed of the vehicle at a given time (double)
      */
-    virtual double vehicle_speed(const double gamma) const override;
+    virtual double vehicle_speed(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired vehicle speed in the trajectory frame
@@ -148,7 +177,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired speed of the vehicle at a given time (double)
      */
-    virtual double vd(const double gamma) const override;
+    virtual double vd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired vehicle acceleration in the trajectory frame
@@ -156,7 +185,7 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired acceleration of the vehicle at a given time (double)
      */
-    virtual double d_vd(const double gamma) const override;
+    virtual double d_vd(const double gamma) const noexcept override;
 
     /**
      * @brief This function returns the desired vehicle jerk in the trajectory frame
@@ -164,69 +193,114 @@ public:
      * @param gamma The parameter that paramaterizes the trajectory
      * @return The desired jerk of the vehicle at a given time (double)
      */
-    virtual double d2_vd(const double gamma) const override;
+    virtual double d2_vd(const double gamma) const noexcept override;
+
+    /**
+     * @brief This function returns every quantity of the trajectory at a given value of gamma with a single
+     * lookup of the trajectory section. The lookup starts at the section of the previous call, so it is O(1)
+     * while gamma moves forward along the trajectory
+     * @param gamma The parameter that paramaterizes the trajectory
+     * @param derivative_order The highest derivative of the position with respect to gamma to compute (0-4)
+     * @return The position and its derivatives, the yaw and yaw rate and the desired speeds (TrajectorySample)
+     */
+    virtual TrajectorySample sample(const double gamma, const int derivative_order=4) const noexcept override;
 
     /**
      * @brief This function returns the minimum value of the trajectory parameter gamma
      * @return The minimum value of the trajectory parameter gamma (double)
      */
-    double min_gamma() const override { return 0.0; }
+    double min_gamma() const noexcept override { return 0.0; }
 
     /**
      * @brief This function returns the maximum value of the trajectory parameter gamma
      * @return The maximum value of the trajectory parameter gamma (double)
      */
-    double max_gamma() const override { return trajectory_max_values_.back(); }
+    double max_gamma() const noexcept override { 
+        const Table & table = table_.read();
+        return table.max_values.empty() ? 0.0 : table.max_values.back(); 
+    }
 
     /**
      * @brief This functions returns whether the trajectory is empty or not
      * @return True if the trajectory is empty, false otherwise
      */
-    bool empty() const override { return trajectories_.empty(); }
-
-    /**
-     * @brief This function adds a trajectory to the trajectory manager
-     * vector of trajectories
-     */
-    inline void add_trajectory(StaticTrajectory::SharedPtr trajectory) {
-        
-        // Add the trajectory to the vector of trajectories
-        trajectories_.emplace_back(trajectory); 
-
-        // Add the trajectory max value to the vector of max values
-        if (trajectory_max_values_.empty()) {
-            trajectory_max_values_.emplace_back(trajectory->max_gamma());
-        } else {
-            trajectory_max_values_.emplace_back(trajectory_max_values_.back() + trajectory->max_gamma());
-        }
-        
-        // Log the trajectories max values at the moment
-        RCLCPP_INFO_STREAM(rclcpp::get_logger("static_trajectory_manager"), "Added trajectory number" << trajectories_.size() << " to the trajectory manager");
-        for(auto& v : trajectory_max_values_) {
-            RCLCPP_INFO_STREAM(rclcpp::get_logger("static_trajectory_manager"), "Trajectory max value: " << v);
-        }
-    }
+    bool empty() const noexcept override { return table_.read().trajectories.empty(); }
+
+    /**
+     * @brief Called once per iteration of the control loop. Reads the last table published, such that the previous tables
+     * are freed by the writers even while the current mode does not sample the trajectory
+     */
+    void tick() noexcept override { table_.read(); }
+
+    /**
+     * @brief This function adds a trajectory to the trajectory manager vector of trajectories, after the trajectories
+     * of the jobs that are still running. Can be called from any thread
+     */
+    void add_trajectory(StaticTrajectory::SharedPtr trajectory);
+
+    /**
+     * @brief This function builds a trajectory in one of the worker threads and adds it to the trajectory manager
+     * (in the order of submission) once it is built. Can be called from any thread
+     * @param description The description of the trajectory, reported on the jobs topic
+     * @param build The function that builds the trajectory (it may throw if the trajectory is not valid)
+     * @return The id of the job that builds the trajectory
+     */
+    std::uint64_t submit_trajectory(const std::string & description, std::function<StaticTrajectory::SharedPtr()> build);
+
+    /**
+     * @brief This function builds a batch of trajectories in one of the worker threads and adds all of them to the trajectory
+     * manager at once (in the order of submission), or none of them if any fails to build. Can be called from any thread
+     * @param description The description of the batch, reported on the jobs topic
+     * @param builds The functions that build each trajectory, in the order they are added (they may throw if the trajectory is not valid)
+     * @return The id of the job that builds the batch
+     */
+    std::uint64_t submit_trajectories(const std::string & description, std::vector<std::function<StaticTrajectory::SharedPtr()>> builds);
 
 protected:
 
     // Initialize the services that reset the path, etc.
     void initialize_services();
 
-    // Reset the trajectory, i.e. empty the vector of trajectories
-    inline void reset_trajectory() { 
-        trajectories_.clear(); 
-        trajectory_max_values_.clear(); 
-    }
+    // Reset the trajectory, i.e. empty the vector of trajectories and discard the trajectories still being built
+    void reset_trajectory();
+
+    // Result of a job that builds a trajectory (or a batch of trajectories)
+    struct Job {
+        std::string description;
+        std::vector<StaticTrajectory::SharedPtr> trajectories;
+        std::string error;
+    };
+
+    // Store the result of a job and add the trajectories of the finished jobs to the trajectory, in the order of submission
+    void finish_job(std::uint64_t id, Job job);
+
+    // Publish the state of a job on the jobs topic
+    void publish_job_status(std::uint64_t id, const Job & job, const std::string & state);
 
     // Get the index of the trajectory that is currently being followed in the vector of trajectories
-    int get_trajectory_index(const double gamma) const;
+    int get_trajectory_index(const Table & table, const double gamma) const;
 
     // Get the index of the trajectory that is currently being followed in the vector of trajectories
     // using a binary search with Olog(n) complexity, where n is the number of trajectories in the vector
-    int binary_search(double gamma, int left, int right) const;
+    int binary_search(const Table & table, double gamma, int left, int right) const;
+
+    // Get the index of the trajectory that is currently being followed in the vector of trajectories
+    // starting the search at the index of the previous call (amortized O(1) when gamma moves forward)
+    int cursor_index(const Table & table, const double gamma) const;
 
     // Normalize the parameter gamma to the range [0,max_gamma] for the trajectory with index "index"
-    double normalize_parameter(double gamma, int index) const;
+    double normalize_parameter(const Table & table, double gamma, int index) const;
+
+    /**
+     * @brief Callback to handle a request to add a batch of segments. The request has the type of each segment (types), 
+     * the parameters of all the segments concatenated in the same order (parameters), with the number of parameters 
+     * given by segment_size() of the factory of each type, and the files of the segments that take one (files).
+     * The batch is rejected if any type is not loaded or the number of parameters or files does not match
+     */
+    void add_segments_callback(const static_trajectory_manager::srv::AddTrajectorySegments::Request::SharedPtr request, const static_trajectory_manager::srv::AddTrajectorySegments::Response::SharedPtr response);
+
+    // Service to add a batch of segments
+    rclcpp::Service<static_trajectory_manager::srv::AddTrajectorySegments>::SharedPtr add_segments_service_{nullptr};
 
     // Callback to handle a trajectory reset request
     void reset_callback(const pegasus_msgs::srv::ResetPath::Request::SharedPtr request, const pegasus_msgs::srv::ResetPath::Response::SharedPtr response);
@@ -234,17 +308,41 @@ protected:
     // Static trajectories that can be loaded into the trajectory manager
     std::map<std::string, StaticTrajectoryFactory::UniquePtr> trajectory_factories_;
 
+    // Factories that build each type of segment of a batch
+    std::map<StaticTrajectoryFactory::SegmentType, const StaticTrajectoryFactory *> segment_factories_;
+
     // Configurations for the trajectory factories
     StaticTrajectoryFactory::Config trajectory_config_;
 
     // Service to reset the current trajectory
     rclcpp::Service<pegasus_msgs::srv::ResetPath>::SharedPtr reset_trajectory_service_{nullptr};
 
-    // Definition of the actual trajectories
-    std::vector<StaticTrajectory::SharedPtr> trajectories_;
-
-    // Vector of the accumulated trajectory parametric lengths (used for the trajectory indexing)
-    std::vector<double> trajectory_max_values_;
+    // Definition of the actual trajectories, read by the control loop without locks. The writers (services and worker threads)
+    // append the new trajectories to table_writer_ and segments_writer_, and publish a table with a snapshot of the segments
+    // once per batch of jobs added (protected by the table mutex)
+    mutable RcuCell<Table> table_;
+    std::mutex table_mutex_;
+    Table table_writer_;
+    SegmentStorage::SharedPtr segments_writer_{nullptr};
+
+    // Jobs that build the trajectories in the background. The finished jobs wait for the jobs submitted before them,
+    // so that the trajectories are added in order. Jobs submitted before the last reset are discarded (protected by the jobs mutex)
+    std::mutex jobs_mutex_;
+    std::uint64_t next_job_id_{1};
+    std::uint64_t next_commit_id_{1};
+    std::uint64_t cancelled_before_id_{1};
+    std::map<std::uint64_t, Job> finished_jobs_;
+
+    // Publisher of the state of the jobs
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticStatus>::SharedPtr jobs_publisher_{nullptr};
+
+    // Threads that build the trajectories (declared after the factories, so they are stopped before the factories are unloaded)
+    std::unique_ptr<WorkerPool> workers_{nullptr};
+
+    // Index of the trajectory section found by the last call to sample() and maximum number of sections
+    // walked from it before falling back to a binary search
+    mutable std::size_t cursor_{0};
+    static constexpr std::size_t MAX_CURSOR_STEPS{4};
 };
 
 } // namespace autopilot
\ No newline at end of file
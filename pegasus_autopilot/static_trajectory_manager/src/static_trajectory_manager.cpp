@@ -45,6 +45,8 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ****************************************************************************/
+#include <utility>
+#include <algorithm>
 #include <pluginlib/class_loader.hpp>
 
 #include "static_trajectory_manager/static_trajectory_factory.hpp"
@@ -64,6 +66,11 @@ void StaticTrajectoryManager::initialize() {
     // Setup the configurations for the trajectory factories
     trajectory_config_.node = node_;
     trajectory_config_.add_trajectory_to_manager = std::bind(&StaticTrajectoryManager::add_trajectory, this, std::placeholders::_1);
+    trajectory_config_.submit_trajectory_to_manager = std::bind(&StaticTrajectoryManager::submit_trajectory, this, std::placeholders::_1, std::placeholders::_2);
+
+    // Start the threads that build the trajectories outside of the executor that runs the control loop
+    node_->declare_parameter<int>("autopilot.StaticTrajectoryManager.workers", 1);
+    workers_ = std::make_unique<WorkerPool>(std::max<int>(1, node_->get_parameter("autopilot.StaticTrajectoryManager.workers").as_int()));
 
     // Log all the trajectory factories that are going to be loaded dynamically
     for(const std::string & trajectory : trajectories.as_string_array()) {
@@ -80,11 +87,42 @@ void StaticTrajectoryManager::initialize() {
             // Initialize the trajectory manager
             trajectory_factories_[trajectory]->initialize_factory(trajectory_config_);
 
+            // Save the factory that builds the segments of this type in a batch (if supported)
+            const StaticTrajectoryFactory::SegmentType type = trajectory_factories_[trajectory]->segment_type();
+            if (type != StaticTrajectoryFactory::NONE) segment_factories_[type] = trajectory_factories_[trajectory].get();
+
         } catch(const std::exception & ex) {
             RCLCPP_ERROR_STREAM(node_->get_logger(), "Exception while loading trajectory: " << ex.what() << ". Trajectory: " << trajectory);
         }
     }
 
+    // Select how the trajectory sections are stored for the control loop: "pointers" (a virtual call to each section) or 
+    // "contiguous" (the sections of the types known by the library of the factories are kept by value, in blocks of contiguous memory)
+    node_->declare_parameter<std::string>("autopilot.StaticTrajectoryManager.storage", "pointers");
+    const std::string storage = node_->get_parameter("autopilot.StaticTrajectoryManager.storage").as_string();
+
+    if (storage == "contiguous") {
+
+        // Get the storage from the first factory that provides one
+        SegmentStorage::SharedPtr segments{nullptr};
+        for (const auto & factory : trajectory_factories_) {
+            if (factory.second == nullptr) continue;
+            segments = factory.second->create_segment_storage();
+            if (segments != nullptr) break;
+        }
+
+        if (segments != nullptr) {
+            std::lock_guard<std::mutex> lock(table_mutex_);
+            segments_writer_ = segments;
+            table_writer_.segments = segments_writer_->snapshot();
+            table_.publish(table_writer_);
+        } else {
+            RCLCPP_WARN_STREAM(node_->get_logger(), "None of the trajectory factories provides a contiguous storage. Using the pointers to the trajectories.");
+        }
+    } else if (storage != "pointers") {
+        RCLCPP_WARN_STREAM(node_->get_logger(), "Unknown trajectory storage: " << storage << ". Using the pointers to the trajectories.");
+    }
+
     // Initialize the services that reset the trajectory, etc.
     initialize_services();
 }
@@ -93,12 +131,26 @@ void StaticTrajectoryManager::initialize() {
 void StaticTrajectoryManager::initialize_services() {
 
     node_->declare_parameter<std::string>("autopilot.StaticTrajectoryManager.services.reset_trajectory", "trajectory/reset_trajectory");
+    node_->declare_parameter<std::string>("autopilot.StaticTrajectoryManager.publishers.jobs", "trajectory/jobs");
+
+    // Create the publisher for the state of the jobs that build the trajectories (queued, added, failed or cancelled)
+    jobs_publisher_ = node_->create_publisher<diagnostic_msgs::msg::DiagnosticStatus>(
+        node_->get_parameter("autopilot.StaticTrajectoryManager.publishers.jobs").as_string(), 
+        rclcpp::QoS(100).reliable()
+    );
     
     // Create the service that resets the path
     reset_trajectory_service_ = node_->create_service<pegasus_msgs::srv::ResetPath>(
         node_->get_parameter("autopilot.StaticTrajectoryManager.services.reset_trajectory").as_string(),
         std::bind(&StaticTrajectoryManager::reset_callback, this, std::placeholders::_1, std::placeholders::_2)
     );
+
+    // Create the service that adds a batch of segments at once
+    node_->declare_parameter<std::string>("autopilot.StaticTrajectoryManager.services.add_segments", "trajectory/add_segments");
+    add_segments_service_ = node_->create_service<static_trajectory_manager::srv::AddTrajectorySegments>(
+        node_->get_parameter("autopilot.StaticTrajectoryManager.services.add_segments").as_string(),
+        std::bind(&StaticTrajectoryManager::add_segments_callback, this, std::placeholders::_1, std::placeholders::_2)
+    );
     
 }
 
@@ -115,201 +167,450 @@ void StaticTrajectoryManager::reset_callback(const pegasus_msgs::srv::ResetPath:
     RCLCPP_INFO_STREAM(node_->get_logger(), "Trajectory empty.");
 }
 
+// Callback to handle a request to add a batch of segments
+void StaticTrajectoryManager::add_segments_callback(const static_trajectory_manager::srv::AddTrajectorySegments::Request::SharedPtr request, const static_trajectory_manager::srv::AddTrajectorySegments::Response::SharedPtr response) {
+
+    response->success = false;
+    response->job_id = 0;
+
+    // Split the parameters and the files of the request by segment, checking that every segment can be built
+    std::vector<std::function<StaticTrajectory::SharedPtr()>> builds;
+    builds.reserve(request->types.size());
+    std::size_t parameter = 0;
+    std::size_t file = 0;
+
+    for (std::size_t i = 0; i < request->types.size(); i++) {
+
+        // Get the factory that builds the type of segment
+        auto factory = segment_factories_.find(static_cast<StaticTrajectoryFactory::SegmentType>(request->types[i]));
+        if (factory == segment_factories_.end()) {
+            RCLCPP_ERROR_STREAM(node_->get_logger(), "Rejected batch of segments: segment " << i << " has an unknown type (" << static_cast<int>(request->types[i]) << ")");
+            return;
+        }
+
+        // Get the parameters of the segment
+        StaticTrajectoryFactory::Segment segment;
+        const std::size_t size = factory->second->segment_size();
+        if (parameter + size > request->parameters.size()) {
+            RCLCPP_ERROR_STREAM(node_->get_logger(), "Rejected batch of segments: missing parameters for segment " << i);
+            return;
+        }
+        segment.parameters.assign(request->parameters.begin() + parameter, request->parameters.begin() + parameter + size);
+        parameter += size;
+
+        if (factory->second->segment_has_file()) {
+            if (file >= request->files.size()) {
+                RCLCPP_ERROR_STREAM(node_->get_logger(), "Rejected batch of segments: missing file for segment " << i);
+                return;
+            }
+            segment.file = request->files[file++];
+        }
+
+        // Build the segment in the background
+        builds.emplace_back([factory = factory->second, segment = std::move(segment)]() { return factory->build_segment(segment); });
+    }
+
+    // Every parameter and file must belong to a segment
+    if (parameter != request->parameters.size() || file != request->files.size()) {
+        RCLCPP_ERROR_STREAM(node_->get_logger(), "Rejected batch of segments: the number of parameters or files does not match the types of the segments");
+        return;
+    }
+
+    // Build all the segments in the background and add them to the trajectory at once
+    response->job_id = submit_trajectories("batch of " + std::to_string(builds.size()) + " segments", std::move(builds));
+    response->success = true;
+}
+
+void StaticTrajectoryManager::reset_trajectory() {
+
+    // Discard the jobs that were submitted before the reset
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        cancelled_before_id_ = next_job_id_;
+    }
+
+    // Publish an empty table
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    table_writer_.trajectories.clear();
+    table_writer_.max_values.clear();
+    if (segments_writer_ != nullptr) {
+        segments_writer_ = segments_writer_->create();
+        table_writer_.segments = segments_writer_->snapshot();
+    }
+    table_.publish(table_writer_);
+}
+
+void StaticTrajectoryManager::add_trajectory(StaticTrajectory::SharedPtr trajectory) {
+
+    // Reserve an id for the trajectory, so that it is added after the trajectories still being built
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        id = next_job_id_++;
+    }
+
+    // The trajectory is already built
+    finish_job(id, Job{"trajectory", {trajectory}, ""});
+}
+
+std::uint64_t StaticTrajectoryManager::submit_trajectory(const std::string & description, std::function<StaticTrajectory::SharedPtr()> build) {
+    std::vector<std::function<StaticTrajectory::SharedPtr()>> builds;
+    builds.emplace_back(std::move(build));
+    return submit_trajectories(description, std::move(builds));
+}
+
+std::uint64_t StaticTrajectoryManager::submit_trajectories(const std::string & description, std::vector<std::function<StaticTrajectory::SharedPtr()>> builds) {
+
+    // Reserve an id for the job
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        id = next_job_id_++;
+    }
+
+    // Let the client know the id of the job
+    Job job{description, {}, ""};
+    publish_job_status(id, job, "queued");
+    RCLCPP_INFO_STREAM(node_->get_logger(), "Queued job " << id << ": " << description);
+
+    // Build the trajectories in one of the worker threads. If any of them fails, none is added
+    workers_->submit([this, id, job = std::move(job), builds = std::move(builds)]() mutable {
+        try {
+            job.trajectories.reserve(builds.size());
+            for (std::size_t i = 0; i < builds.size(); i++) {
+                job.trajectories.emplace_back(builds[i]());
+                if (job.trajectories.back() == nullptr) throw std::runtime_error("The trajectory was not built");
+            }
+        } catch (const std::exception & ex) {
+            job.error = builds.size() > 1 ? "segment " + std::to_string(job.trajectories.size()) + ": " + ex.what() : ex.what();
+            job.trajectories.clear();
+        }
+        finish_job(id, std::move(job));
+    });
+
+    return id;
+}
+
+void StaticTrajectoryManager::finish_job(std::uint64_t id, Job job) {
+
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    finished_jobs_.emplace(id, std::move(job));
+
+    // Add the trajectories of the finished jobs, as long as all the jobs submitted before them are also finished
+    std::vector<std::pair<std::uint64_t, Job>> added;
+    for (auto it = finished_jobs_.find(next_commit_id_); it != finished_jobs_.end(); it = finished_jobs_.find(next_commit_id_)) {
+
+        Job & finished = it->second;
+
+        if (it->first < cancelled_before_id_) {
+            publish_job_status(it->first, finished, "cancelled");
+        } else if (!finished.error.empty()) {
+            RCLCPP_ERROR_STREAM(node_->get_logger(), "Exception while building trajectory (job " << it->first << "): " << finished.error << ". Trajectory: " << finished.description);
+            publish_job_status(it->first, finished, "failed");
+        } else {
+
+            // Append the new trajectories to the table of the writers (the control loop only sees them once the table is published)
+            std::lock_guard<std::mutex> table_lock(table_mutex_);
+            for (const StaticTrajectory::SharedPtr & trajectory : finished.trajectories) {
+                const double max_value = table_writer_.max_values.empty() ? 0.0 : table_writer_.max_values.back();
+                table_writer_.trajectories.emplace_back(trajectory);
+                table_writer_.max_values.emplace_back(max_value + trajectory->max_gamma());
+                if (segments_writer_ != nullptr) segments_writer_->add(trajectory);
+            }
+
+            // Log the trajectories max values at the moment
+            RCLCPP_INFO_STREAM(node_->get_logger(), "Added " << finished.trajectories.size() << " trajectories to the trajectory manager (job " << it->first << "). Number of trajectories: " << table_writer_.trajectories.size());
+            RCLCPP_INFO_STREAM(node_->get_logger(), "Trajectory max value: " << table_writer_.max_values.back());
+            added.emplace_back(it->first, std::move(finished));
+        }
+
+        finished_jobs_.erase(it);
+        next_commit_id_++;
+    }
+
+    if (added.empty()) return;
+
+    // Publish the trajectories of all the jobs added to the control loop at once, with a snapshot of the contiguous storage
+    {
+        std::lock_guard<std::mutex> table_lock(table_mutex_);
+        if (segments_writer_ != nullptr) table_writer_.segments = segments_writer_->snapshot();
+        table_.publish(table_writer_);
+    }
+    for (const auto & [added_id, added_job] : added) publish_job_status(added_id, added_job, "added");
+}
+
+void StaticTrajectoryManager::publish_job_status(std::uint64_t id, const Job & job, const std::string & state) {
+
+    if (jobs_publisher_ == nullptr) return;
+
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = job.error.empty() ? diagnostic_msgs::msg::DiagnosticStatus::OK : diagnostic_msgs::msg::DiagnosticStatus::ERROR;
+    status.name = "job " + std::to_string(id);
+    status.message = job.error.empty() ? job.description : job.description + ": " + job.error;
+    status.values.resize(3);
+    status.values[0].key = "job_id";
+    status.values[0].value = std::to_string(id);
+    status.values[1].key = "state";
+    status.values[1].value = state;
+    status.values[2].key = "trajectories";
+    status.values[2].value = std::to_string(job.trajectories.size());
+    jobs_publisher_->publish(status);
+}
 
-int StaticTrajectoryManager::get_trajectory_index(const double gamma) const {
+
+int StaticTrajectoryManager::get_trajectory_index(const Table & table, const double gamma) const {
 
     // If the vector of trajectories is empty, return -1
-    if(trajectories_.empty()) return -1;
+    if(table.trajectories.empty()) return -1;
 
     // If the gamma is smaller than the minimum gamma of the first trajectory, return the index of the first trajectory
     if(gamma < 0) return 0;
 
     // If the gamma is larger than the maximum gamma of the last trajectory, return the index of the last trajectory
-    if(gamma > trajectory_max_values_.back()) return trajectories_.size() - 1;
+    if(gamma > table.max_values.back()) return table.trajectories.size() - 1;
     
     // Get the index of the trajectory that is currently being followed in the vector of trajectories
-    return binary_search(gamma, 0, trajectories_.size() - 1);
+    return binary_search(table, gamma, 0, table.trajectories.size() - 1);
 }
 
-int StaticTrajectoryManager::binary_search(double gamma, int left, int right) const {
+int StaticTrajectoryManager::binary_search(const Table & table, double gamma, int left, int right) const {
     
     // Compute the middle index
     int mid = left + (right - left) / 2;
 
     // Get the minimum value for the index mid
-    double min_mid = mid == 0 ? 0 : trajectory_max_values_[mid - 1];
+    double min_mid = mid == 0 ? 0 : table.max_values[mid - 1];
 
     // Get the maximum value for the index mid
-    double max_mid = trajectory_max_values_[mid];
+    double max_mid = table.max_values[mid];
 
     // Apply the binary search algorithm
     if(gamma >= min_mid && gamma <= max_mid) return mid;
-    else if(gamma > max_mid) return binary_search(gamma, mid + 1, right);
-    else return binary_search(gamma, left, mid - 1);
+    else if(gamma > max_mid) return binary_search(table, gamma, mid + 1, right);
+    else return binary_search(table, gamma, left, mid - 1);
+}
+
+int StaticTrajectoryManager::cursor_index(const Table & table, const double gamma) const {
+
+    // If the vector of trajectories is empty, return -1
+    if(table.trajectories.empty()) return -1;
+
+    // Clamp the parameter to the first and last trajectories (not-a-number values go to the last one)
+    // The cursor might be past the end of the table, if the trajectory was reset since the previous call
+    const std::size_t last = table.trajectories.size() - 1;
+    if(gamma < 0) return cursor_ = 0;
+    if(!(gamma <= table.max_values.back())) return cursor_ = last;
+
+    // Walk a few sections from the one of the previous call, in the direction of gamma
+    std::size_t index = std::min(cursor_, last);
+    for(std::size_t step = 0; step <= MAX_CURSOR_STEPS; step++) {
+        
+        // Get the limits of the current section
+        double min_index = index == 0 ? 0 : table.max_values[index - 1];
+        double max_index = table.max_values[index];
+
+        if(gamma >= min_index && gamma <= max_index) return cursor_ = index;
+        else if(gamma > max_index) index++;
+        else index--;
+    }
+
+    // If gamma jumped far away from the previous section, find the first section whose maximum is not smaller than gamma
+    cursor_ = std::lower_bound(table.max_values.begin(), table.max_values.end(), gamma) - table.max_values.begin();
+    return cursor_;
 }
 
-double StaticTrajectoryManager::normalize_parameter(double gamma, int index) const {
+double StaticTrajectoryManager::normalize_parameter(const Table & table, double gamma, int index) const {
 
     // If the index is 0, then the gamma is already normalized, 
     // otherwise subtract the maximum value of the previous trajectory
-    return (index == 0) ? gamma : gamma - trajectory_max_values_[index - 1];
+    return (index == 0) ? gamma : gamma - table.max_values[index - 1];
 }
 
-Eigen::Vector3d StaticTrajectoryManager::pd(const double gamma) const {
+Eigen::Vector3d StaticTrajectoryManager::pd(const double gamma) const noexcept {
     
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return Eigen::Vector3d::Zero();
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
 
     // Return the position of the trajectory
-    return trajectories_[index]->pd(normalized_gamma);
+    return table.trajectories[index]->pd(normalized_gamma);
 }
 
-Eigen::Vector3d StaticTrajectoryManager::d_pd(const double gamma) const {
+Eigen::Vector3d StaticTrajectoryManager::d_pd(const double gamma) const noexcept {
     
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return Eigen::Vector3d::Zero();
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
 
-    return trajectories_[index]->d_pd(normalized_gamma);
+    return table.trajectories[index]->d_pd(normalized_gamma);
 }
 
-Eigen::Vector3d StaticTrajectoryManager::d2_pd(const double gamma) const {
+Eigen::Vector3d StaticTrajectoryManager::d2_pd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return Eigen::Vector3d::Zero();
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->d2_pd(normalized_gamma);
+    return table.trajectories[index]->d2_pd(normalized_gamma);
 }
 
-Eigen::Vector3d StaticTrajectoryManager::d3_pd(const double gamma) const {
+Eigen::Vector3d StaticTrajectoryManager::d3_pd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return Eigen::Vector3d::Zero();
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->d3_pd(normalized_gamma);
+    return table.trajectories[index]->d3_pd(normalized_gamma);
 }
 
-Eigen::Vector3d StaticTrajectoryManager::d4_pd(const double gamma) const {
+Eigen::Vector3d StaticTrajectoryManager::d4_pd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return Eigen::Vector3d::Zero();
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
 
-    return trajectories_[index]->d4_pd(normalized_gamma);
+    return table.trajectories[index]->d4_pd(normalized_gamma);
 }
 
 
-double StaticTrajectoryManager::yaw(const double gamma) const {
+double StaticTrajectoryManager::yaw(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->yaw(normalized_gamma);
+    return table.trajectories[index]->yaw(normalized_gamma);
 }
 
 
-double StaticTrajectoryManager::d_yaw(const double gamma) const {
+double StaticTrajectoryManager::d_yaw(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->d_yaw(normalized_gamma);
+    return table.trajectories[index]->d_yaw(normalized_gamma);
 }
 
-double StaticTrajectoryManager::vehicle_speed(double gamma) const {
+double StaticTrajectoryManager::vehicle_speed(double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->vehicle_speed(normalized_gamma);
+    return table.trajectories[index]->vehicle_speed(normalized_gamma);
 }
 
-double StaticTrajectoryManager::vd(const double gamma) const {
+double StaticTrajectoryManager::vd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
     
-    return trajectories_[index]->vd(normalized_gamma);
+    return table.trajectories[index]->vd(normalized_gamma);
 }
 
-double StaticTrajectoryManager::d_vd(const double gamma) const {
+double StaticTrajectoryManager::d_vd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
 
-    return trajectories_[index]->d_vd(normalized_gamma);
+    return table.trajectories[index]->d_vd(normalized_gamma);
 }
 
-double StaticTrajectoryManager::d2_vd(const double gamma) const {
+double StaticTrajectoryManager::d2_vd(const double gamma) const noexcept {
 
-    // Get the index of the section in the sections vector
-    int index = get_trajectory_index(gamma);
+    // Get the table of sections published to the control loop and the index of the section in it
+    const Table & table = table_.read();
+    int index = get_trajectory_index(table, gamma);
 
     // Safety check
     if (index == -1) return 0.0;
 
     // Make the gamma vary between 0 and max for a given trajectory section
-    double normalized_gamma = normalize_parameter(gamma, index);
+    double normalized_gamma = normalize_parameter(table, gamma, index);
+
+    return table.trajectories[index]->d2_vd(normalized_gamma);
+}
+
+TrajectorySample StaticTrajectoryManager::sample(const double gamma, const int derivative_order) const noexcept {
+
+    // Get the table of sections published to the control loop and the index of the section in it 
+    // (starting at the section of the previous sample)
+    const Table & table = table_.read();
+    int index = cursor_index(table, gamma);
+
+    // Safety check
+    if (index == -1) return TrajectorySample();
+
+    // Make the gamma vary between 0 and max for a given trajectory section
+    double normalized_gamma = normalize_parameter(table, gamma, index);
+
+    // Sample the section from the contiguous storage, if in use
+    if (table.segments != nullptr) return table.segments->sample(index, normalized_gamma, derivative_order);
 
-    return trajectories_[index]->d2_vd(normalized_gamma);
+    return table.trajectories[index]->sample(normalized_gamma, derivative_order);
 }
 
 } // namespace autopilot
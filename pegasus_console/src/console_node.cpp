@@ -122,7 +122,7 @@ void ConsoleNode::initialize_subscribers() {
     // Status of the autopilot
     autopilot_status_sub_ = this->create_subscription<pegasus_msgs::msg::AutopilotStatus>(
         this->get_parameter("console.subscribers.autopilot.status").as_string(), 
-        rclcpp::SensorDataQoS(), std::bind(&ConsoleNode::autopilot_status_callback, this, std::placeholders::_1));
+        rclcpp::QoS(1).reliable().transient_local(), std::bind(&ConsoleNode::autopilot_status_callback, this, std::placeholders::_1));
 
     gripper_angle_sub_ = this->create_subscription<capture_msgs::msg::Angle>(
         this->get_parameter("console.subscribers.gripper.gripper").as_string(), 
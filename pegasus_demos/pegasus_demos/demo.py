@@ -2,7 +2,7 @@
 
 import rclpy
 from rclpy.node import Node
-from rclpy.qos import qos_profile_sensor_data
+from rclpy.qos import QoSProfile, ReliabilityPolicy, DurabilityPolicy
 from pegasus_msgs.srv import Waypoint, AddCircle, SetMode
 from pegasus_msgs.msg import AutopilotStatus
 
@@ -36,7 +36,7 @@ class Drone(Node):
             self.get_logger().info('service not available, waiting again...')
 
         # Create subscriptions
-        self.create_subscription(AutopilotStatus, '/drone' + str(id) + '/autopilot/status', self.autopilot_status_callback, qos_profile_sensor_data)
+        self.create_subscription(AutopilotStatus, '/drone' + str(id) + '/autopilot/status', self.autopilot_status_callback, QoSProfile(depth=1, reliability=ReliabilityPolicy.RELIABLE, durability=DurabilityPolicy.TRANSIENT_LOCAL))
 
         # Requests messages
         self.waypoint_req = Waypoint.Request()
@@ -49,6 +49,8 @@
 
 #include <chrono>
 #include <atomic>
+#include <limits>
+#include <vector>
 #include <Eigen/Core>
 #include <mavsdk/mavsdk.h>
 #include <mavsdk/plugins/action/action.h>
@@ -191,6 +193,17 @@ public:
      */
     void set_inertial_acceleration(const float ax, const float ay, const float az);
 
+    /**
+     * @ingroup control_callbacks
+     * @brief Set the value of all the actuators (motors) of the vehicle at once, normalized between 0-100%. The values are sent
+     * in a single SET_ACTUATOR_CONTROL_TARGET mavlink message (first actuator control group), bypassing the attitude and rate
+     * controllers of the onboard micro-controller. Group 0 is the input of the PX4 mixer, so this only drives the motors
+     * directly with PX4 <= 1.13 and a passthrough mixer (PX4 >= 1.14 ignores the message)
+     * @param values The value of each actuator (up to 8), normalized between 0-100%
+     * @return true if the values were sent, false if there are more than 8 values (nothing is sent)
+     */
+    bool set_actuators(const std::vector<float> & values);
+
     /**
      * @brief Method to arm or disarm the vehicle
      * @param arm_disarm The boolean that is 1 to arm the vehicle and 0 to disarm
@@ -399,6 +412,13 @@ private:
      */
     mavsdk::Offboard::AccelerationNed acceleration_;
 
+    /**
+     * @ingroup mavsdk_control_messages
+     * @brief Message to set the value of all the actuators (motors) of the vehicle at once, with a single group of 8 controls
+     * normalized between 0 and 1 (unused actuators are set to NaN)
+     */
+    mavsdk::Offboard::ActuatorControl actuator_control_;
+
     /**
      * @ingroup mocap
      * @brief Message to set the position (X-Y-Z) and attitude (roll, pitch and yaw) of the vehicle, where the body frame of the vehicle
@@ -50,7 +50,7 @@
 #include "rclcpp/rclcpp.hpp"
 
 #include "mavlink_node.hpp"
-#include "thrust_curves/thrust_curves.hpp"
+#include "thrust_curves/thrust_curve_variant.hpp"
 
 // Messages for the sensor data (IMU, barometer, GPS, etc.)
 #include "sensor_msgs/msg/imu.hpp"
@@ -72,6 +72,7 @@
 #include "pegasus_msgs/msg/control_attitude.hpp"
 #include "pegasus_msgs/msg/control_velocity.hpp"
 #include "pegasus_msgs/msg/control_acceleration.hpp"
+#include "std_msgs/msg/float32_multi_array.hpp"
 
 // Services for arming, auto-landing, etc.
 #include "pegasus_msgs/srv/arm.hpp"
@@ -346,6 +347,14 @@ private:
      */
     void attitude_rate_force_callback(const pegasus_msgs::msg::ControlAttitude::ConstSharedPtr msg);
 
+    /**
+     * @ingroup subscriberCallbacks
+     * @brief Motors subscriber callback. The message should contain the value of each motor normalized between 0-100 %,
+     * which are all sent to the vehicle in a single mavlink message (instead of one service call per motor)
+     * @param msg A message with the desired value of each motor
+     */
+    void motors_thrust_callback(const std_msgs::msg::Float32MultiArray::ConstSharedPtr msg);
+
     /**
      * @ingroup subscriberCallbacks
      * @brief Motion Capture vehicle pose subscriber callback. This callback receives a message with the pose of the vehicle
@@ -542,6 +551,13 @@ private:
      */
     rclcpp::Subscription<pegasus_msgs::msg::ControlAttitude>::SharedPtr attitude_rate_force_sub_{nullptr};
 
+    /**
+     * @ingroup subscribers
+     * @brief Motors subscriber. The value of each motor should be normalized between 0-100 %. Only created when
+     * mavlink_interface.actuator_control.enabled is set (requires PX4 <= 1.13 with a passthrough mixer)
+     */
+    rclcpp::Subscription<std_msgs::msg::Float32MultiArray>::SharedPtr motors_thrust_sub_{nullptr};
+
     /**
      * @ingroup subscribers
      * @brief Subscriber for a position of the vehicle yielded by a Motion Capture System, if available. This
@@ -610,11 +626,11 @@ private:
     MavlinkNode::MavlinkNodeConfig mavlink_config_;
 
     /**
-     * @brief Thrust curve object used to set the conversion from thrust in Newton (N) to percentage
+     * @brief Thrust curve (held by value) used to set the conversion from thrust in Newton (N) to percentage
      * which is then sent to the mavlink onboard controller (initialized by the init_thrust_curve) which will
      * read this parameter from the ROS parameter server
      */
-    std::shared_ptr<Pegasus::ThrustCurve> thrust_curve_{nullptr};
+    std::optional<Pegasus::ThrustCurveVariant> thrust_curve_;
 
     // ROS 2 thread setup
     rclcpp::executors::MultiThreadedExecutor executor_;
@@ -222,6 +222,9 @@ void MavlinkNode::initialize_offboard() {
     // -----------------------------------------------------------------
     offboard_ = std::make_unique<mavsdk::Offboard>(this->system_);
 
+    // Allocate the group of controls used to set all the actuators at once (such that it is not allocated at every message)
+    actuator_control_.groups = {mavsdk::Offboard::ActuatorControlGroup{std::vector<float>(8, std::numeric_limits<float>::quiet_NaN())}};
+
     // ----------------------------------------------
     // Initialize all the necessary ROS2 subscribers
     // ----------------------------------------------
@@ -404,6 +407,33 @@ void MavlinkNode::set_inertial_acceleration(const float ax, const float ay, cons
     offboard_->set_acceleration_ned(acceleration_);
 }
 
+/**
+ * @ingroup control_callbacks
+ * @brief Set the value of all the actuators (motors) of the vehicle at once, normalized between 0-100%. The values are sent
+ * in a single SET_ACTUATOR_CONTROL_TARGET mavlink message, which writes the first actuator control group (actuator_controls_0).
+ * In PX4 this group is the input of the mixer (roll, pitch, yaw, thrust, ...), not the motors. The values only reach the motors
+ * directly with PX4 <= 1.13 and a mixer that passes each input of group 0 through to the corresponding output. PX4 >= 1.14
+ * (control allocation) ignores this message
+ * @param values The value of each actuator, normalized between 0-100%
+ * @return true if the values were sent, false if there are more values than actuator controls in the group (nothing is sent)
+ */
+bool MavlinkNode::set_actuators(const std::vector<float> & values) {
+
+    // Do not send a partial set of motors (the motors beyond the group would keep their previous value)
+    std::vector<float> & controls = actuator_control_.groups[0].controls;
+    if (values.size() > controls.size()) return false;
+
+    // Populate the MAVSDK structure with the value of each actuator scaled between 0-100%, converted to 0<->1 
+    // (0 is a stopped motor, as the thrust of the group). The actuators without a value are set to NaN, so they are not changed
+    for (std::size_t i = 0; i < controls.size(); i++) {
+        controls[i] = (i < values.size()) ? std::min(std::max(values[i] / 100.0f, 0.0f), 1.0f) : std::numeric_limits<float>::quiet_NaN();
+    }
+
+    // Send the message to the onboard vehicle controller (a single message for all the actuators)
+    offboard_->set_actuator_control(actuator_control_);
+    return true;
+}
+
 /**
  * @brief Method to arm or disarm the vehicle
  * @param arm_disarm The boolean that is 1 to arm the vehicle and 0 to disarm
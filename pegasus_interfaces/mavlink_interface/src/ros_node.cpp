@@ -267,6 +267,21 @@ void ROSNode::init_subscribers_and_services() {
     rclcpp::Parameter attitude_rate_thrust_topic = this->get_parameter("subscribers.control.thrust.attitude_rate");
     attitude_rate_thrust_sub_ = this->create_subscription<pegasus_msgs::msg::ControlAttitude>(
         attitude_rate_thrust_topic.as_string(), rclcpp::SensorDataQoS(), std::bind(&ROSNode::attitude_rate_thrust_callback, this, std::placeholders::_1));
+
+    // ------------------------------------------------------------------------
+    // Subscribe to the value of each motor (0-100%), streamed to the vehicle in a single message.
+    // Opt-in only: the message writes the input of the PX4 mixer (actuator_controls_0), so it only drives
+    // the motors with PX4 <= 1.13 and a passthrough mixer (PX4 >= 1.14 ignores it)
+    // ------------------------------------------------------------------------
+    this->declare_parameter<std::string>("subscribers.control.thrust.motors", "control/motors_thrust");
+    this->declare_parameter<bool>("mavlink_interface.actuator_control.enabled", false);
+    rclcpp::Parameter motors_thrust_topic = this->get_parameter("subscribers.control.thrust.motors");
+    if (this->get_parameter("mavlink_interface.actuator_control.enabled").as_bool()) {
+        motors_thrust_sub_ = this->create_subscription<std_msgs::msg::Float32MultiArray>(
+            motors_thrust_topic.as_string(), rclcpp::SensorDataQoS(), std::bind(&ROSNode::motors_thrust_callback, this, std::placeholders::_1));
+    } else {
+        RCLCPP_INFO(this->get_logger(), "Direct motor control disabled (mavlink_interface.actuator_control.enabled is false)");
+    }
     
     // If there is a thrust curve object already available, make 2 subcribers for controlling the 
     // attitude or attitude_rate along with the total desired force along the Z-axis expressed in Newton (N)
@@ -374,9 +389,6 @@ void ROSNode::init_subscribers_and_services() {
  * based on the configurations loaded from ROS parameter server
  */
 void ROSNode::init_thrust_curve() {
-    
-    // Get the singleton factory of thrust curves
-    auto thrust_curve_Factory = Pegasus::ThrustCurveFactory::get_instance();
 
     // Get from the ROS parameter server the mass of the vehicle
     this->declare_parameter<double>("dynamics.mass", 0.0);
@@ -415,8 +427,42 @@ void ROSNode::init_thrust_curve() {
         gains[parameter_names[i]] = parameters[i];
     }
 
-    // Instantiate a thrust curve object
-    thrust_curve_ = thrust_curve_Factory.create_thrust_curve(gains, thrust_curve_id.as_string());
+    // Get from the ROS parameter server whether the thrust curve should be replaced by a lookup table (with constant time conversions),
+    // sampled from the thrust curve above or loaded from the measurements of a thrust stand (CSV file with the percentage and force columns)
+    this->declare_parameter<bool>("dynamics.thrust_curve.tabulated.enabled", false);
+    this->declare_parameter<int>("dynamics.thrust_curve.tabulated.size", static_cast<int>(Pegasus::TabulatedCurve::DEFAULT_SIZE));
+    this->declare_parameter<std::string>("dynamics.thrust_curve.tabulated.csv", "");
+    bool tabulated = this->get_parameter("dynamics.thrust_curve.tabulated.enabled").as_bool();
+    std::size_t table_size = static_cast<std::size_t>(this->get_parameter("dynamics.thrust_curve.tabulated.size").as_int());
+    std::string csv = this->get_parameter("dynamics.thrust_curve.tabulated.csv").as_string();
+
+    if(!tabulated) {
+        // Instantiate a thrust curve object (held by value, such that the conversions in the callbacks are not virtual calls)
+        thrust_curve_.emplace(Pegasus::ThrustCurveVariant::create(thrust_curve_id.as_string(), gains));
+        return;
+    }
+
+    // Instantiate the lookup table
+    std::optional<Pegasus::TabulatedCurve> table;
+
+    if(csv.empty()) {
+        table.emplace(Pegasus::TabulatedCurve::from_curve(Pegasus::ThrustCurveVariant::create(thrust_curve_id.as_string(), gains), table_size));
+    } else {
+        table.emplace(Pegasus::TabulatedCurve::from_csv(csv, table_size));
+
+        // Share the measured curve with the autopilot, through the parameters of a tabulated thrust curve
+        vehicle_constants_msg_.thrust_curve.identifier = std::string(Pegasus::TabulatedCurve::IDENTIFIER);
+        vehicle_constants_msg_.thrust_curve.parameters.clear();
+        vehicle_constants_msg_.thrust_curve.values.clear();
+        for(const auto & [name, value] : table->to_map()) {
+            vehicle_constants_msg_.thrust_curve.parameters.push_back(name);
+            vehicle_constants_msg_.thrust_curve.values.push_back(value);
+        }
+    }
+
+    RCLCPP_INFO_STREAM(this->get_logger(), "Using a tabulated thrust curve with " << table_size << " entries (max force: " << table->get_max_force() << " N). Max error: " 
+        << table->get_approximation_error().force_to_percentage << " % (force to percentage), " << table->get_approximation_error().percentage_to_force << " N (percentage to force)");
+    thrust_curve_.emplace(std::move(*table));
 }
 
 /**
@@ -535,6 +581,19 @@ void ROSNode::attitude_rate_force_callback(const pegasus_msgs::msg::ControlAttit
     mavlink_node_->set_attitude_rate(msg->attitude[0], msg->attitude[1], msg->attitude[2], thrust);
 }
 
+/**
+ * @ingroup subscriberCallbacks
+ * @brief Motors subscriber callback. The message should contain the value of each motor normalized between 0-100 %,
+ * which are all sent to the vehicle in a single mavlink message (instead of one service call per motor)
+ * @param msg A message with the desired value of each motor
+ */
+void ROSNode::motors_thrust_callback(const std_msgs::msg::Float32MultiArray::ConstSharedPtr msg) {
+    // Send the value of all the motors thorugh mavlink for the onboard microcontroller
+    if (!mavlink_node_->set_actuators(msg->data)) {
+        RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 1000, "Motors message ignored: %zu motors received, at most 8 are supported", msg->data.size());
+    }
+}
+
 /**
  * @ingroup subscriberCallbacks
  * @brief Motion Capture vehicle pose subscriber callback. This callback receives a message with the pose of the vehicle